@@ -0,0 +1,154 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "InputMask.h"
+
+namespace Dodo {
+
+    ////////////////////////////////////////////////////////////////
+    // GAMEPAD CODE ////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    // Face buttons are named by position, South is A on Xbox and Cross on PlayStation.
+    enum class GamepadCode
+    {
+        South        ,
+        East         ,
+        West         ,
+        North        ,
+        LeftShoulder ,
+        RightShoulder,
+        LeftTrigger  ,
+        RightTrigger ,
+        Back         ,
+        Start        ,
+        Guide        ,
+        LeftStick    ,
+        RightStick   ,
+        DPadUp       ,
+        DPadRight    ,
+        DPadDown     ,
+        DPadLeft     ,
+        AutoCount    ,
+        None
+    };
+
+    enum class GamepadAxis
+    {
+        LeftX       ,
+        LeftY       ,
+        RightX      ,
+        RightY      ,
+        LeftTrigger ,
+        RightTrigger,
+        AutoCount   ,
+        None
+    };
+
+    ////////////////////////////////////////////////////////////////
+    // GAMEPAD /////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    // Gamepads are polled, the platform writes the latest state and every frame
+    // the edges are derived from the difference to the previous frame.
+    class Gamepad
+    {
+    public:
+        using Mask = InputMask<GamepadCode>;
+
+        Gamepad() = default;
+        virtual ~Gamepad() = default;
+
+        bool IsConnected() const
+        {
+            return m_IsConnected;
+        }
+
+        bool GetButton(GamepadCode gamepadCode) const
+        {
+            return m_State.Current.Test(gamepadCode);
+        }
+
+        bool GetButtonDown(GamepadCode gamepadCode) const
+        {
+            return m_Edges.Pressed.Test(gamepadCode);
+        }
+
+        bool GetButtonUp(GamepadCode gamepadCode) const
+        {
+            return m_Edges.Released.Test(gamepadCode);
+        }
+
+        // Sticks are in [-1.0, 1.0], triggers in [0.0, 1.0].
+        float GetAxis(GamepadAxis gamepadAxis) const
+        {
+            const auto axisIndex = static_cast<size_t>(gamepadAxis);
+            return (axisIndex < m_State.Axes.size()) ? m_State.Axes[axisIndex] : 0.0f;
+        }
+
+        const Mask& GetButtons() const { return m_State.Current; }
+        const Mask& GetButtonsDown() const { return m_Edges.Pressed; }
+        const Mask& GetButtonsUp() const { return m_Edges.Released; }
+        const Mask& GetButtonsHeld() const { return m_Edges.Held; }
+
+        void Update()
+        {
+            static const Mask s_NoEdges{};
+            m_State.Previous = m_State.Current;
+            m_State.Current = m_State.Polled;
+            m_Edges.Resolve(m_State.Current, m_State.Previous, s_NoEdges, s_NoEdges);
+        }
+
+        void Reset()
+        {
+            m_State = {};
+            m_Edges.Clear();
+        }
+
+    protected:
+        void OnConnectionChanged(bool isConnected)
+        {
+            m_IsConnected = isConnected;
+            if (!isConnected)
+            {
+                m_State.Polled.Clear();
+                m_State.Axes.fill(0.0f);
+            }
+        }
+
+        void OnPoll(const Mask& buttons)
+        {
+            m_State.Polled = buttons;
+        }
+
+        void OnAxis(GamepadAxis gamepadAxis, float value)
+        {
+            const auto axisIndex = static_cast<size_t>(gamepadAxis);
+            if (axisIndex < m_State.Axes.size())
+            {
+                m_State.Axes[axisIndex] = value;
+            }
+        }
+
+    private:
+        ////////////////////////////////////////////////////////////
+        // STATE ///////////////////////////////////////////////////
+        ////////////////////////////////////////////////////////////
+
+        struct State
+        {
+            static constexpr auto MaxAxisCount = static_cast<size_t>(GamepadAxis::AutoCount);
+            Mask Polled{};
+            Mask Current{};
+            Mask Previous{};
+            std::array<float, MaxAxisCount> Axes{};
+        };
+
+        State m_State{};
+        InputEdges<GamepadCode> m_Edges{};
+        bool m_IsConnected = false;
+    };
+
+}
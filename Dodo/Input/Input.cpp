@@ -7,13 +7,86 @@ namespace Dodo {
     // INPUT ///////////////////////////////////////////////////////
     ////////////////////////////////////////////////////////////////
 
-    Keyboard* Input::Keyboard = nullptr;
-    Mouse* Input::Mouse = nullptr;
+    Dodo::Keyboard* Input::Keyboard = nullptr;
+    Dodo::Mouse* Input::Mouse = nullptr;
+    Dodo::Gamepad* Input::Gamepad = nullptr;
 
-    void Input::Update()
+    void Input::Update(uint64_t untilTimestamp)
     {
+        DODO_PROFILE_SCOPE("Input::Update");
         Keyboard->Update();
         Mouse->Update();
+        s_FrameEvents.clear();
+
+        auto& queue = InputEventQueue::s_Queue;
+        if (s_Player.IsPlaying())
+        {
+            InputEvent discarded{};
+            while (queue.pop(discarded)) {}
+            s_Player.ConsumeFrame(s_FrameEvents);
+        }
+        else
+        {
+            while (const InputEvent* event = queue.front())
+            {
+                if (event->Timestamp > untilTimestamp)
+                {
+                    break;
+                }
+
+                s_FrameEvents.push_back(*event);
+                queue.pop();
+            }
+        }
+
+        for (const InputEvent& event : s_FrameEvents)
+        {
+            switch (event.EventType)
+            {
+                case InputEvent::Type::KeyDown:
+                case InputEvent::Type::KeyUp:
+                {
+                    Keyboard->ProcessEvent(event);
+                    break;
+                }
+
+                default:
+                {
+                    Mouse->ProcessEvent(event);
+                    break;
+                }
+            }
+        }
+
+        s_Recorder.RecordFrame(s_Frame++, s_FrameEvents);
+        Keyboard->ResolveEdges();
+        Mouse->ResolveEdges();
+        if (Gamepad)
+        {
+            Gamepad->Update();
+        }
+    }
+
+    bool Input::StartRecording(const std::filesystem::path& filePath)
+    {
+        return s_Recorder.Start(filePath);
+    }
+
+    void Input::StopRecording()
+    {
+        s_Recorder.Stop();
+    }
+
+    bool Input::StartReplay(const std::filesystem::path& filePath, InputPlayer::Timing timing)
+    {
+        Keyboard->Reset();
+        Mouse->Reset();
+        return s_Player.Open(filePath, timing);
+    }
+
+    void Input::StopReplay()
+    {
+        s_Player.Close();
     }
 
 }
\ No newline at end of file
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <vector>
+
+#include "Gamepad.h"
+#include "InputRecorder.h"
 #include "Keyboard.h"
 #include "Mouse.h"
 
@@ -47,15 +51,107 @@ namespace Dodo {
             return Mouse->GetButtonUp(mouseCode);
         }
 
-        static void Update();
+        static bool GetGamepadButton(GamepadCode gamepadCode)
+        {
+            return Gamepad && Gamepad->GetButton(gamepadCode);
+        }
+
+        static bool GetGamepadButtonDown(GamepadCode gamepadCode)
+        {
+            return Gamepad && Gamepad->GetButtonDown(gamepadCode);
+        }
+
+        static bool GetGamepadButtonUp(GamepadCode gamepadCode)
+        {
+            return Gamepad && Gamepad->GetButtonUp(gamepadCode);
+        }
+
+        static float GetGamepadAxis(GamepadAxis gamepadAxis)
+        {
+            return Gamepad ? Gamepad->GetAxis(gamepadAxis) : 0.0f;
+        }
+
+        ////////////////////////////////////////////////////////////
+        // MASKS ///////////////////////////////////////////////////
+        ////////////////////////////////////////////////////////////
+
+        static const Dodo::Keyboard::Mask& GetKeys()
+        {
+            return Keyboard->GetKeys();
+        }
+
+        static const Dodo::Keyboard::Mask& GetKeysDown()
+        {
+            return Keyboard->GetKeysDown();
+        }
+
+        static const Dodo::Keyboard::Mask& GetKeysUp()
+        {
+            return Keyboard->GetKeysUp();
+        }
+
+        static const Dodo::Keyboard::Mask& GetKeysHeld()
+        {
+            return Keyboard->GetKeysHeld();
+        }
+
+        static const Dodo::Mouse::Mask& GetMouseButtons()
+        {
+            return Mouse->GetButtons();
+        }
+
+        static const Dodo::Mouse::Mask& GetMouseButtonsDown()
+        {
+            return Mouse->GetButtonsDown();
+        }
+
+        static const Dodo::Mouse::Mask& GetMouseButtonsUp()
+        {
+            return Mouse->GetButtonsUp();
+        }
+
+        static const Dodo::Gamepad::Mask& GetGamepadButtons()
+        {
+            static const Dodo::Gamepad::Mask s_NoButtons{};
+            return Gamepad ? Gamepad->GetButtons() : s_NoButtons;
+        }
+
+        // Events the last Update consumed, in the order they happened.
+        static const std::vector<InputEvent>& GetEvents()
+        {
+            return s_FrameEvents;
+        }
+
+        // Consumes all queued events reported up to the given Timer tick.
+        static void Update(uint64_t untilTimestamp = UINT64_MAX);
+
+        ////////////////////////////////////////////////////////////
+        // RECORD & REPLAY /////////////////////////////////////////
+        ////////////////////////////////////////////////////////////
+
+        static bool StartRecording(const std::filesystem::path& filePath);
+        static void StopRecording();
+        // While replaying, live events are discarded so the session is reproducible.
+        static bool StartReplay(const std::filesystem::path& filePath, InputPlayer::Timing timing);
+        static void StopReplay();
+        static bool IsReplaying() { return s_Player.IsPlaying(); }
+        static bool IsReplayFinished() { return s_Player.IsFinished(); }
 
         virtual ~Input() = default;
 
     protected:
         Input() = default;
 
-        static Keyboard* Keyboard;
-        static Mouse* Mouse;
+        static Dodo::Keyboard* Keyboard;
+        static Dodo::Mouse* Mouse;
+        // Optional, null when the platform has no gamepad support.
+        static Dodo::Gamepad* Gamepad;
+
+    private:
+        static inline std::vector<InputEvent> s_FrameEvents{};
+        static inline uint64_t s_Frame = 0;
+        static inline InputRecorder s_Recorder{};
+        static inline InputPlayer s_Player{};
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/spsc_queue.h"
+#include "diagnostics/metrics.h"
+#include "diagnostics/timer.h"
+
+namespace Dodo {
+
+    ////////////////////////////////////////////////////////////////
+    // INPUT EVENT /////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    struct InputEvent
+    {
+        enum class Type : uint8_t
+        {
+            KeyDown    ,
+            KeyUp      ,
+            ButtonDown ,
+            ButtonUp   ,
+            WheelScroll
+        };
+
+        Type EventType = Type::KeyDown;
+        uint16_t Code = 0;
+        float Value = 0.0f;
+        // Timer ticks at which the event was reported by the OS.
+        uint64_t Timestamp = 0;
+    };
+
+    ////////////////////////////////////////////////////////////////
+    // INPUT EVENT QUEUE ///////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    // Events are pushed by the thread that pumps OS messages and consumed by
+    // Input::Update, so a key pressed and released within one frame is not lost.
+    class InputEventQueue
+    {
+    public:
+        static constexpr size_t Capacity = 1024;
+
+        static bool Push(InputEvent::Type type, uint16_t code, float value = 0.0f)
+        {
+            InputEvent event{};
+            event.EventType = type;
+            event.Code = code;
+            event.Value = value;
+            event.Timestamp = Timer::now();
+            if (!s_Queue.push(event))
+            {
+                DODO_METRIC_COUNTER_ADD("input.events_dropped", 1);
+                return false;
+            }
+
+            return true;
+        }
+
+    private:
+        static inline SpscQueue<InputEvent, Capacity> s_Queue{};
+
+        friend class Input;
+    };
+
+}
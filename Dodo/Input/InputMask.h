@@ -0,0 +1,180 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <initializer_list>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#   ifndef DODO_INPUT_SSE2
+#       define DODO_INPUT_SSE2
+#   endif
+#   include <emmintrin.h>
+#endif
+
+namespace Dodo {
+
+    ////////////////////////////////////////////////////////////////
+    // INPUT MASK //////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    // One bit per key or button, packed into 64 bit words so whole sets of inputs
+    // can be compared at once, e.g. to evaluate action mappings.
+    template<typename Code>
+    struct InputMask
+    {
+        static constexpr size_t BitCount = static_cast<size_t>(Code::AutoCount);
+        static constexpr size_t WordCount = (BitCount + 63) / 64;
+
+        alignas(16) std::array<uint64_t, WordCount> Words{};
+
+        InputMask() = default;
+
+        InputMask(std::initializer_list<Code> codes)
+        {
+            for (const Code code : codes)
+            {
+                Set(code, true);
+            }
+        }
+
+        bool Test(Code code) const
+        {
+            const auto index = static_cast<size_t>(code);
+            return (index < BitCount) && ((Words[index >> 6] >> (index & 63)) & 1);
+        }
+
+        void Set(Code code, bool value)
+        {
+            const auto index = static_cast<size_t>(code);
+            if (index >= BitCount)
+            {
+                return;
+            }
+
+            const uint64_t bit = uint64_t(1) << (index & 63);
+            Words[index >> 6] = value ? (Words[index >> 6] | bit) : (Words[index >> 6] & ~bit);
+        }
+
+        void Clear()
+        {
+            Words.fill(0);
+        }
+
+        bool Any() const
+        {
+            uint64_t bits = 0;
+            for (const uint64_t word : Words)
+            {
+                bits |= word;
+            }
+
+            return bits != 0;
+        }
+
+        size_t Count() const
+        {
+            size_t count = 0;
+            for (const uint64_t word : Words)
+            {
+                count += static_cast<size_t>(std::popcount(word));
+            }
+
+            return count;
+        }
+
+        // True if every input of the other mask is set in this one.
+        bool ContainsAll(const InputMask& other) const
+        {
+            uint64_t missing = 0;
+            for (size_t i = 0; i < WordCount; i++)
+            {
+                missing |= other.Words[i] & ~Words[i];
+            }
+
+            return missing == 0;
+        }
+
+        bool ContainsAny(const InputMask& other) const
+        {
+            uint64_t common = 0;
+            for (size_t i = 0; i < WordCount; i++)
+            {
+                common |= other.Words[i] & Words[i];
+            }
+
+            return common != 0;
+        }
+
+        bool operator==(const InputMask& other) const = default;
+
+        InputMask operator&(const InputMask& other) const
+        {
+            InputMask result{};
+            for (size_t i = 0; i < WordCount; i++)
+            {
+                result.Words[i] = Words[i] & other.Words[i];
+            }
+
+            return result;
+        }
+
+        InputMask operator|(const InputMask& other) const
+        {
+            InputMask result{};
+            for (size_t i = 0; i < WordCount; i++)
+            {
+                result.Words[i] = Words[i] | other.Words[i];
+            }
+
+            return result;
+        }
+    };
+
+    ////////////////////////////////////////////////////////////////
+    // INPUT EDGES /////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    // Pressed, released and held inputs of one frame. Down and up edges are the
+    // transitions reported by events during the frame, so taps shorter than a frame
+    // show up as both pressed and released.
+    template<typename Code>
+    struct InputEdges
+    {
+        InputMask<Code> Pressed{};
+        InputMask<Code> Released{};
+        InputMask<Code> Held{};
+
+        void Resolve(const InputMask<Code>& current, const InputMask<Code>& previous, const InputMask<Code>& downEdges, const InputMask<Code>& upEdges)
+        {
+            size_t i = 0;
+#ifdef DODO_INPUT_SSE2
+            for (; (i + 2) <= InputMask<Code>::WordCount; i += 2)
+            {
+                const __m128i cur  = _mm_load_si128(reinterpret_cast<const __m128i*>(&current.Words[i]));
+                const __m128i prev = _mm_load_si128(reinterpret_cast<const __m128i*>(&previous.Words[i]));
+                const __m128i down = _mm_load_si128(reinterpret_cast<const __m128i*>(&downEdges.Words[i]));
+                const __m128i up   = _mm_load_si128(reinterpret_cast<const __m128i*>(&upEdges.Words[i]));
+                // _mm_andnot_si128(a, b) computes ~a & b.
+                _mm_store_si128(reinterpret_cast<__m128i*>(&Pressed.Words[i]), _mm_or_si128(down, _mm_andnot_si128(prev, cur)));
+                _mm_store_si128(reinterpret_cast<__m128i*>(&Released.Words[i]), _mm_or_si128(up, _mm_andnot_si128(cur, prev)));
+                _mm_store_si128(reinterpret_cast<__m128i*>(&Held.Words[i]), _mm_andnot_si128(up, _mm_and_si128(cur, prev)));
+            }
+#endif
+            for (; i < InputMask<Code>::WordCount; i++)
+            {
+                Pressed.Words[i] = downEdges.Words[i] | (current.Words[i] & ~previous.Words[i]);
+                Released.Words[i] = upEdges.Words[i] | (previous.Words[i] & ~current.Words[i]);
+                Held.Words[i] = current.Words[i] & previous.Words[i] & ~upEdges.Words[i];
+            }
+        }
+
+        void Clear()
+        {
+            Pressed.Clear();
+            Released.Clear();
+            Held.Clear();
+        }
+    };
+
+}
@@ -0,0 +1,242 @@
+#include "pch.h"
+#include "InputRecorder.h"
+
+namespace Dodo {
+
+    ////////////////////////////////////////////////////////////////
+    // UTILS ///////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    namespace Utils {
+
+        static void WriteVarint(std::ostream& os, uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                os.put(static_cast<char>((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+
+            os.put(static_cast<char>(value));
+        }
+
+        static bool ReadVarint(std::istream& is, uint64_t& rValue)
+        {
+            rValue = 0;
+            for (uint32_t shift = 0; shift < 64; shift += 7)
+            {
+                const int byte = is.get();
+                if (byte == std::char_traits<char>::eof())
+                {
+                    return false;
+                }
+
+                rValue |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        template<typename T>
+        static void WriteRaw(std::ostream& os, const T& value)
+        {
+            os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template<typename T>
+        static bool ReadRaw(std::istream& is, T& rValue)
+        {
+            return static_cast<bool>(is.read(reinterpret_cast<char*>(&rValue), sizeof(T)));
+        }
+
+    }
+
+    ////////////////////////////////////////////////////////////////
+    // INPUT RECORDER //////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    InputRecorder::~InputRecorder()
+    {
+        Stop();
+    }
+
+    bool InputRecorder::Start(const std::filesystem::path& filePath)
+    {
+        Stop();
+        m_Stream = std::ofstream(filePath, std::ios::binary | std::ios::trunc);
+        if (!m_Stream)
+        {
+            DODO_LOG_ERROR("Failed to open input recording: {0}.", filePath.string());
+            return false;
+        }
+
+        Utils::WriteRaw(m_Stream, Magic);
+        Utils::WriteRaw(m_Stream, Version);
+        m_StartTimestamp = Timer::now();
+        m_PreviousFrame = 0;
+        m_PreviousTime = 0;
+        m_LastFrame = 0;
+        m_EventCount = 0;
+        m_HasStarted = false;
+        DODO_LOG_INFO("Recording input to: {0}.", filePath.string());
+        return true;
+    }
+
+    void InputRecorder::Stop()
+    {
+        if (!m_Stream.is_open())
+        {
+            return;
+        }
+
+        Utils::WriteVarint(m_Stream, m_LastFrame);
+        Utils::WriteVarint(m_Stream, 0);
+        m_Stream.put(static_cast<char>(EndOfStream));
+        m_Stream.close();
+        DODO_LOG_INFO("Recorded {0} input events over {1} frames.", m_EventCount, m_LastFrame + 1);
+    }
+
+    void InputRecorder::RecordFrame(uint64_t frame, const std::vector<InputEvent>& events)
+    {
+        if (!m_Stream.is_open())
+        {
+            return;
+        }
+
+        if (!m_HasStarted)
+        {
+            m_StartFrame = frame;
+            m_HasStarted = true;
+        }
+
+        const uint64_t relativeFrame = frame - m_StartFrame;
+        for (const InputEvent& event : events)
+        {
+            // Times are stored in nanoseconds so a recording replays on a machine with another TSC frequency.
+            const uint64_t time = (event.Timestamp > m_StartTimestamp) ? Timer::ticks_to_nanoseconds(event.Timestamp - m_StartTimestamp) : 0;
+            const uint64_t clampedTime = std::max(time, m_PreviousTime);
+            Utils::WriteVarint(m_Stream, relativeFrame - m_PreviousFrame);
+            Utils::WriteVarint(m_Stream, clampedTime - m_PreviousTime);
+            m_Stream.put(static_cast<char>(event.EventType));
+            Utils::WriteVarint(m_Stream, event.Code);
+            if (event.EventType == InputEvent::Type::WheelScroll)
+            {
+                Utils::WriteRaw(m_Stream, event.Value);
+            }
+
+            m_PreviousFrame = relativeFrame;
+            m_PreviousTime = clampedTime;
+            m_EventCount++;
+        }
+
+        m_LastFrame = relativeFrame;
+    }
+
+    ////////////////////////////////////////////////////////////////
+    // INPUT PLAYER ////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    bool InputPlayer::Open(const std::filesystem::path& filePath, Timing timing)
+    {
+        Close();
+        std::ifstream stream(filePath, std::ios::binary);
+        uint32_t magic = 0;
+        uint16_t version = 0;
+        if (!stream || !Utils::ReadRaw(stream, magic) || !Utils::ReadRaw(stream, version) || (magic != InputRecorder::Magic) || (version != InputRecorder::Version))
+        {
+            DODO_LOG_ERROR("Failed to open input recording: {0}.", filePath.string());
+            return false;
+        }
+
+        // The whole stream is decoded up front, replays should not hit the disk mid-frame.
+        uint64_t frame = 0;
+        uint64_t time = 0;
+        while (true)
+        {
+            uint64_t frameDelta = 0;
+            uint64_t timeDelta = 0;
+            if (!Utils::ReadVarint(stream, frameDelta) || !Utils::ReadVarint(stream, timeDelta))
+            {
+                DODO_LOG_WARNING("Input recording is truncated: {0}.", filePath.string());
+                break;
+            }
+
+            const int type = stream.get();
+            if (type == InputRecorder::EndOfStream)
+            {
+                // The end of stream marker stores the last frame as an absolute value.
+                m_LastFrame = frameDelta;
+                break;
+            }
+
+            uint64_t code = 0;
+            if ((type == std::char_traits<char>::eof()) || !Utils::ReadVarint(stream, code))
+            {
+                DODO_LOG_WARNING("Input recording is truncated: {0}.", filePath.string());
+                break;
+            }
+
+            frame += frameDelta;
+            time += timeDelta;
+            Record record{};
+            record.Frame = frame;
+            record.Time = time;
+            record.Event.EventType = static_cast<InputEvent::Type>(type);
+            record.Event.Code = static_cast<uint16_t>(code);
+            if ((record.Event.EventType == InputEvent::Type::WheelScroll) && !Utils::ReadRaw(stream, record.Event.Value))
+            {
+                break;
+            }
+
+            m_Records.push_back(record);
+            m_LastFrame = frame;
+        }
+
+        m_Timing = timing;
+        m_NextRecord = 0;
+        m_Frame = 0;
+        m_StartTimestamp = Timer::now();
+        m_IsPlaying = true;
+        DODO_LOG_INFO("Replaying {0} input events over {1} frames from: {2}.", m_Records.size(), m_LastFrame + 1, filePath.string());
+        return true;
+    }
+
+    void InputPlayer::Close()
+    {
+        m_Records.clear();
+        m_NextRecord = 0;
+        m_IsPlaying = false;
+    }
+
+    void InputPlayer::ConsumeFrame(std::vector<InputEvent>& rEvents)
+    {
+        if (!m_IsPlaying)
+        {
+            return;
+        }
+
+        const uint64_t now = Timer::now();
+        const uint64_t elapsed = Timer::ticks_to_nanoseconds(now - m_StartTimestamp);
+        while (m_NextRecord < m_Records.size())
+        {
+            const Record& record = m_Records.at(m_NextRecord);
+            const bool isDue = (m_Timing == Timing::Original) ? (record.Time <= elapsed) : (record.Frame <= m_Frame);
+            if (!isDue)
+            {
+                break;
+            }
+
+            InputEvent event = record.Event;
+            event.Timestamp = (m_Timing == Timing::Original) ? (m_StartTimestamp + Timer::nanoseconds_to_ticks(record.Time)) : now;
+            rEvents.push_back(event);
+            m_NextRecord++;
+        }
+
+        m_Frame++;
+    }
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "InputEvent.h"
+
+namespace Dodo {
+
+    ////////////////////////////////////////////////////////////////
+    // INPUT RECORDER //////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    // Writes the events consumed by Input::Update as a compact binary stream.
+    // Every record stores the frame and time delta to the previous one as varints,
+    // so an idle frame costs nothing and a key press a handful of bytes.
+    class InputRecorder
+    {
+    public:
+        static constexpr uint32_t Magic = 0x504E4944; // "DINP"
+        static constexpr uint16_t Version = 1;
+        // Record type marking the end of the stream, it stores the last recorded frame instead of a delta.
+        static constexpr uint8_t EndOfStream = 0xFF;
+
+        InputRecorder() = default;
+        ~InputRecorder();
+
+        bool Start(const std::filesystem::path& filePath);
+        void Stop();
+        bool IsRecording() const { return m_Stream.is_open(); }
+        void RecordFrame(uint64_t frame, const std::vector<InputEvent>& events);
+
+    private:
+        std::ofstream m_Stream{};
+        uint64_t m_StartFrame = 0;
+        uint64_t m_StartTimestamp = 0;
+        uint64_t m_PreviousFrame = 0;
+        uint64_t m_PreviousTime = 0;
+        uint64_t m_LastFrame = 0;
+        uint64_t m_EventCount = 0;
+        bool m_HasStarted = false;
+    };
+
+    ////////////////////////////////////////////////////////////////
+    // INPUT PLAYER ////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    class InputPlayer
+    {
+    public:
+        enum class Timing
+        {
+            // Events are released once the time since the start of the replay has
+            // caught up with the time they were recorded at.
+            Original,
+            // Events are released in the frame they were recorded in, which makes a
+            // replay deterministic regardless of the frame rate.
+            AsFastAsPossible
+        };
+
+        InputPlayer() = default;
+
+        bool Open(const std::filesystem::path& filePath, Timing timing);
+        void Close();
+        bool IsPlaying() const { return m_IsPlaying; }
+        bool IsFinished() const { return m_IsPlaying && (m_NextRecord >= m_Records.size()) && (m_Frame > m_LastFrame); }
+        // Appends the events that are due in this frame.
+        void ConsumeFrame(std::vector<InputEvent>& rEvents);
+
+    private:
+        struct Record
+        {
+            uint64_t Frame = 0;
+            uint64_t Time = 0;
+            InputEvent Event{};
+        };
+
+        std::vector<Record> m_Records{};
+        size_t m_NextRecord = 0;
+        Timing m_Timing = Timing::AsFastAsPossible;
+        uint64_t m_Frame = 0;
+        uint64_t m_LastFrame = 0;
+        uint64_t m_StartTimestamp = 0;
+        bool m_IsPlaying = false;
+    };
+
+}
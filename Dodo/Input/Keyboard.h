@@ -1,8 +1,9 @@
 #pragma once
 
-#include <array>
 #include <cstdint>
-#include <cstring>
+
+#include "InputEvent.h"
+#include "InputMask.h"
 
 namespace Dodo {
 
@@ -12,32 +13,124 @@ namespace Dodo {
 
     enum class KeyCode
     {
-        LeftArrow ,
-        UpArrow   ,
-        RightArrow,
-        DownArrow ,
-        Alpha0    ,
-        Alpha1    ,
-        Alpha2    ,
-        Alpha3    ,
-        Alpha4    ,
-        Alpha5    ,
-        Alpha6    ,
-        Alpha7    ,
-        Alpha8    ,
-        Alpha9    ,
-        Q         ,
-        W         ,
-        E         ,
-        R         ,
-        T         ,
-        Y         ,
-        u         ,
-        I         ,
-        O         ,
-        P         ,
-        A         ,
-        AutoCount ,
+        LeftArrow     ,
+        UpArrow       ,
+        RightArrow    ,
+        DownArrow     ,
+        Alpha0        ,
+        Alpha1        ,
+        Alpha2        ,
+        Alpha3        ,
+        Alpha4        ,
+        Alpha5        ,
+        Alpha6        ,
+        Alpha7        ,
+        Alpha8        ,
+        Alpha9        ,
+        A             ,
+        B             ,
+        C             ,
+        D             ,
+        E             ,
+        F             ,
+        G             ,
+        H             ,
+        I             ,
+        J             ,
+        K             ,
+        L             ,
+        M             ,
+        N             ,
+        O             ,
+        P             ,
+        Q             ,
+        R             ,
+        S             ,
+        T             ,
+        U             ,
+        V             ,
+        W             ,
+        X             ,
+        Y             ,
+        Z             ,
+        F1            ,
+        F2            ,
+        F3            ,
+        F4            ,
+        F5            ,
+        F6            ,
+        F7            ,
+        F8            ,
+        F9            ,
+        F10           ,
+        F11           ,
+        F12           ,
+        F13           ,
+        F14           ,
+        F15           ,
+        F16           ,
+        F17           ,
+        F18           ,
+        F19           ,
+        F20           ,
+        F21           ,
+        F22           ,
+        F23           ,
+        F24           ,
+        Space         ,
+        Enter         ,
+        Escape        ,
+        Tab           ,
+        Backspace     ,
+        Insert        ,
+        Delete        ,
+        Home          ,
+        End           ,
+        PageUp        ,
+        PageDown      ,
+        LeftShift     ,
+        RightShift    ,
+        LeftControl   ,
+        RightControl  ,
+        LeftAlt       ,
+        RightAlt      ,
+        LeftSuper     ,
+        RightSuper    ,
+        CapsLock      ,
+        NumLock       ,
+        ScrollLock    ,
+        PrintScreen   ,
+        Pause         ,
+        Menu          ,
+        Apostrophe    ,
+        Comma         ,
+        Minus         ,
+        Period        ,
+        Slash         ,
+        Semicolon     ,
+        Equal         ,
+        LeftBracket   ,
+        Backslash     ,
+        RightBracket  ,
+        GraveAccent   ,
+        Keypad0       ,
+        Keypad1       ,
+        Keypad2       ,
+        Keypad3       ,
+        Keypad4       ,
+        Keypad5       ,
+        Keypad6       ,
+        Keypad7       ,
+        Keypad8       ,
+        Keypad9       ,
+        KeypadDecimal ,
+        KeypadDivide  ,
+        KeypadMultiply,
+        KeypadSubtract,
+        KeypadAdd     ,
+        KeypadEnter   ,
+        KeypadEqual   ,
+        AutoCount     ,
         None
     };
 
@@ -48,51 +141,73 @@ namespace Dodo {
     class Keyboard
     {
     public:
+        using Mask = InputMask<KeyCode>;
+
         Keyboard() = default;
         virtual ~Keyboard() = default;
 
         bool GetKey(KeyCode keyCode) const
         {
-            const auto keyIndex = static_cast<size_t>(keyCode);
-            return m_State.Keys.at(keyIndex);
+            return m_State.Current.Test(keyCode);
         }
 
+        // True if the key went down during the last frame, even if it was released again.
         bool GetKeyDown(KeyCode keyCode) const
         {
-            const auto keyIndex = static_cast<size_t>(keyCode);
-            return m_State.Keys.at(keyIndex) && !m_PreviousState.Keys.at(keyIndex);
+            return m_Edges.Pressed.Test(keyCode);
         }
 
+        // True if the key went up during the last frame, even if it was pressed again.
         bool GetKeyUp(KeyCode keyCode) const
         {
-            const auto keyIndex = static_cast<size_t>(keyCode);
-            return m_PreviousState.Keys.at(keyIndex) && !m_State.Keys.at(keyIndex);
+            return m_Edges.Released.Test(keyCode);
         }
 
+        const Mask& GetKeys() const { return m_State.Current; }
+        const Mask& GetKeysDown() const { return m_Edges.Pressed; }
+        const Mask& GetKeysUp() const { return m_Edges.Released; }
+        const Mask& GetKeysHeld() const { return m_Edges.Held; }
+
+        // Starts a new frame, held keys carry over.
         void Update()
         {
-            // Move current state to previous.
-            std::memcpy(&m_PreviousState, &m_State, sizeof(State));
-            m_State.Clear();
+            m_State.Previous = m_State.Current;
+            m_State.DownEdges.Clear();
+            m_State.UpEdges.Clear();
+        }
+
+        void ProcessEvent(const InputEvent& event)
+        {
+            const auto keyCode = static_cast<KeyCode>(event.Code);
+            const bool isDown = event.EventType == InputEvent::Type::KeyDown;
+            if (isDown != m_State.Current.Test(keyCode))
+            {
+                (isDown ? m_State.DownEdges : m_State.UpEdges).Set(keyCode, true);
+                m_State.Current.Set(keyCode, isDown);
+            }
+        }
+
+        // Computes the masks of the frame once all of its events were processed.
+        void ResolveEdges()
+        {
+            m_Edges.Resolve(m_State.Current, m_State.Previous, m_State.DownEdges, m_State.UpEdges);
         }
 
         void Reset()
         {
-            m_State.Clear();
-            m_PreviousState.Clear();
+            m_State = {};
+            m_Edges.Clear();
         }
 
     protected:
         void OnKeyDown(KeyCode keyCode)
         {
-            const auto keyIndex = static_cast<size_t>(keyCode);
-            m_State.Keys.at(keyIndex) = true;
+            InputEventQueue::Push(InputEvent::Type::KeyDown, static_cast<uint16_t>(keyCode));
         }
 
         void OnKeyUp(KeyCode keyCode)
         {
-            const auto keyIndex = static_cast<size_t>(keyCode);
-            m_State.Keys.at(keyIndex) = false;
+            InputEventQueue::Push(InputEvent::Type::KeyUp, static_cast<uint16_t>(keyCode));
         }
 
     private:
@@ -102,17 +217,14 @@ namespace Dodo {
 
         struct State
         {
-            static constexpr auto MaxKeyCount = static_cast<size_t>(KeyCode::AutoCount);
-            std::array<bool, MaxKeyCount> Keys{};
-
-            void Clear()
-            {
-                std::memset(this, 0, sizeof(State));
-            }
+            Mask Current{};
+            Mask Previous{};
+            Mask DownEdges{};
+            Mask UpEdges{};
         };
 
         State m_State{};
-        State m_PreviousState{};
+        InputEdges<KeyCode> m_Edges{};
     };
 
 }
\ No newline at end of file
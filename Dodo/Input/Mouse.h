@@ -1,8 +1,9 @@
 #pragma once
 
-#include <array>
 #include <cstdint>
-#include <cstring>
+
+#include "InputEvent.h"
+#include "InputMask.h"
 
 namespace Dodo {
 
@@ -15,6 +16,8 @@ namespace Dodo {
         Left,
         Middle,
         Right,
+        X1,
+        X2,
         AutoCount,
         None
     };
@@ -26,9 +29,12 @@ namespace Dodo {
     class Mouse
     {
     public:
+        using Mask = InputMask<MouseCode>;
+
         Mouse() = default;
         virtual ~Mouse() = default;
 
+        // Sum of all wheel scrolls during the last frame.
         float GetWheelDelta() const
         {
             return m_State.WheelDelta;
@@ -36,51 +42,75 @@ namespace Dodo {
 
         bool GetButton(MouseCode mouseCode) const
         {
-            const auto buttonIndex = static_cast<size_t>(mouseCode);
-            return m_State.Buttons.at(buttonIndex);
+            return m_State.Current.Test(mouseCode);
         }
 
         bool GetButtonDown(MouseCode mouseCode) const
         {
-            const auto buttonIndex = static_cast<size_t>(mouseCode);
-            return m_State.Buttons.at(buttonIndex) && !m_PreviousState.Buttons.at(buttonIndex);
+            return m_Edges.Pressed.Test(mouseCode);
         }
 
         bool GetButtonUp(MouseCode mouseCode) const
         {
-            const auto buttonIndex = static_cast<size_t>(mouseCode);
-            return m_PreviousState.Buttons.at(buttonIndex) && !m_State.Buttons.at(buttonIndex);
+            return m_Edges.Released.Test(mouseCode);
         }
 
+        const Mask& GetButtons() const { return m_State.Current; }
+        const Mask& GetButtonsDown() const { return m_Edges.Pressed; }
+        const Mask& GetButtonsUp() const { return m_Edges.Released; }
+        const Mask& GetButtonsHeld() const { return m_Edges.Held; }
+
+        // Starts a new frame, held buttons carry over while the wheel only lasts one frame.
         void Update()
         {
-            // Move current state to previous.
-            std::memcpy(&m_PreviousState, &m_State, sizeof(State));
-            m_State.Clear();
+            m_State.WheelDelta = 0.0f;
+            m_State.Previous = m_State.Current;
+            m_State.DownEdges.Clear();
+            m_State.UpEdges.Clear();
+        }
+
+        void ProcessEvent(const InputEvent& event)
+        {
+            if (event.EventType == InputEvent::Type::WheelScroll)
+            {
+                m_State.WheelDelta += event.Value;
+                return;
+            }
+
+            const auto mouseCode = static_cast<MouseCode>(event.Code);
+            const bool isDown = event.EventType == InputEvent::Type::ButtonDown;
+            if (isDown != m_State.Current.Test(mouseCode))
+            {
+                (isDown ? m_State.DownEdges : m_State.UpEdges).Set(mouseCode, true);
+                m_State.Current.Set(mouseCode, isDown);
+            }
+        }
+
+        void ResolveEdges()
+        {
+            m_Edges.Resolve(m_State.Current, m_State.Previous, m_State.DownEdges, m_State.UpEdges);
         }
 
         void Reset()
         {
-            m_State.Clear();
-            m_PreviousState.Clear();
+            m_State = {};
+            m_Edges.Clear();
         }
 
     protected:
         void OnWheelScroll(float wheelDelta)
         {
-            m_State.WheelDelta = wheelDelta;
+            InputEventQueue::Push(InputEvent::Type::WheelScroll, 0, wheelDelta);
         }
 
         void OnButtonDown(MouseCode mouseCode)
         {
-            const auto buttonIndex = static_cast<size_t>(mouseCode);
-            m_State.Buttons.at(buttonIndex) = true;
+            InputEventQueue::Push(InputEvent::Type::ButtonDown, static_cast<uint16_t>(mouseCode));
         }
                         
         void OnButtonUp(MouseCode mouseCode)
         {
-            const auto buttonIndex = static_cast<size_t>(mouseCode);
-            m_State.Buttons.at(buttonIndex) = false;
+            InputEventQueue::Push(InputEvent::Type::ButtonUp, static_cast<uint16_t>(mouseCode));
         }
 
     private:
@@ -91,17 +121,14 @@ namespace Dodo {
         struct State
         {
             float WheelDelta = 0.0f;
-            static constexpr auto MaxButtonCount = static_cast<size_t>(MouseCode::AutoCount);
-            std::array<bool, MaxButtonCount> Buttons{};
-
-            void Clear()
-            {
-                std::memset(this, 0, sizeof(State));
-            }
+            Mask Current{};
+            Mask Previous{};
+            Mask DownEdges{};
+            Mask UpEdges{};
         };
 
         State m_State{};
-        State m_PreviousState{};
+        InputEdges<MouseCode> m_Edges{};
     };
 
 }
\ No newline at end of file
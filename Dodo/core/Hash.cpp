@@ -22,14 +22,20 @@ namespace Dodo {
     };
 
     size_t FNV1a::operator()(const std::string& octets)
+    {
+        return (*this)(octets.data(), octets.size());
+    }
+
+    size_t FNV1a::operator()(const void* data, size_t size)
     {
         // Reference for the algorithm and the values for
         // prime and offset basis online: http://www.isthe.com/chongo/tech/comp/fnv/.
         using FNV = TraitsFNV<size_t>;
+        const char* octets = static_cast<const char*>(data);
         size_t hash = FNV::OffsetBasis;
-        for (char octet : octets)
+        for (size_t i = 0; i < size; i++)
         {
-            hash ^= octet;
+            hash ^= octets[i];
             hash *= FNV::Prime;
         }
 
@@ -6,6 +6,7 @@ namespace Dodo {
     {
     public:
         size_t operator()(const std::string& octets);
+        size_t operator()(const void* data, size_t size);
     };
 
 }
\ No newline at end of file
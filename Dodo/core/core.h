@@ -43,6 +43,12 @@
 #   endif
 #endif
 
+#ifndef DODO_DISABLE_PROFILER
+#   ifndef DODO_ENABLE_PROFILER
+#       define DODO_ENABLE_PROFILER
+#   endif
+#endif
+
 #ifdef DODO_ENABLE_ASSERT
 #   ifndef DODO_ASSERT
 #       define DODO_ASSERT(CONDITION) if (!(CONDITION)) { DODO_DEBUG_BREAK(); }
@@ -55,10 +61,10 @@
 
 #include <cstddef>
 
-constexpr size_t operator"" _kb(size_t p_bytes) {
+constexpr size_t operator"" _kb(unsigned long long p_bytes) {
     return p_bytes * 1024;
 }
 
-constexpr size_t operator"" _mb(size_t p_bytes) {
+constexpr size_t operator"" _mb(unsigned long long p_bytes) {
     return p_bytes * 1024 * 1024;
 }
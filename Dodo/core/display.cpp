@@ -1,16 +1,55 @@
 #include "pch.h"
 #include "display.h"
-#ifdef DODO_WINDOWS
-#   include "platforms/windows/display_windows.h"
+#if defined(DODO_WINDOWS)
+#   include "platforms/Windows/display_windows.h"
+#elif defined(DODO_LINUX)
+#   include "platforms/Linux/display_headless.h"
+#   include "platforms/Linux/display_xcb.h"
 #endif
 
 namespace Dodo {
 
     Display& Display::singleton_get() {
         #if defined(DODO_WINDOWS)
+            if (s_prefer_headless) {
+                DODO_LOG_WARNING_TAG("Engine", "Headless display is not supported on Windows.");
+            }
+
             static DisplayWindows display{};
             return display;
+        #elif defined(DODO_LINUX)
+            // X11 when a server is reachable, e.g. a desktop or Xvfb, headless otherwise or when requested.
+            if (!s_prefer_headless && !std::getenv("DODO_HEADLESS")) {
+                static DisplayXcb display_xcb{};
+                if (display_xcb.is_connected()) {
+                    return display_xcb;
+                }
+            }
+
+            static DisplayHeadless display_headless{};
+            return display_headless;
         #endif
     }
 
+    void Display::_event_batch_push(std::vector<Event>& r_events, const Event& e) {
+        if (e.type == Event::Type::window_resize) {
+            for (auto it = r_events.rbegin(); it != r_events.rend(); it++) {
+                if (it->window != e.window) {
+                    continue;
+                }
+
+                // Only merge with the latest event of the window, a close in between keeps its order.
+                if (it->type == Event::Type::window_resize) {
+                    it->resized = e.resized;
+                    DODO_METRIC_COUNTER_ADD("display.resizes_coalesced", 1);
+                    return;
+                }
+
+                break;
+            }
+        }
+
+        r_events.push_back(e);
+    }
+
 }
\ No newline at end of file
@@ -35,6 +35,8 @@ namespace Dodo {
         };
 
         static Display& singleton_get();
+        // Must be called before the first singleton_get.
+        static void singleton_prefer_headless(bool prefer_headless) { s_prefer_headless = prefer_headless; }
 
         Display() = default;
         virtual ~Display() = default;
@@ -42,10 +44,19 @@ namespace Dodo {
         virtual WindowId window_create(const WindowSpecifications& window_specs) = 0;
         virtual const void* window_get_platform_data(WindowId window) const = 0;
         virtual void window_set_event_callback(WindowId window, const std::function<void(Event&)>& callback) = 0;
-        virtual void window_process_events(WindowId window) = 0;
+        // Drains the pending events of all windows in one pass and dispatches them to
+        // the window callbacks, with consecutive resizes of a window coalesced into one.
+        virtual void process_events() = 0;
         virtual void window_destroy(WindowId window) = 0;
         virtual uint32_t render_backend_get_count() const = 0;
         virtual Ref<RenderBackend> render_backend_get(size_t index) const = 0;
+
+    protected:
+        static inline bool s_prefer_headless = false;
+
+        // Appends the event to a batch, a resize replaces a resize of the same window
+        // already in the batch so only the final size is dispatched.
+        static void _event_batch_push(std::vector<Event>& r_events, const Event& e);
     };
 
 }
\ No newline at end of file
@@ -1,66 +1,227 @@
 #include "pch.h"
 #include "engine.h"
 
+#include "diagnostics/json.h"
+#include "diagnostics/memory_stats.h"
+#include "Input/Input.h"
+
 namespace Dodo {
 
     Engine::Engine(const CommandLineArgs& cmd_line_args) {
-        _display = Display::create ();
+        _settings = EngineSettings::from_command_line(cmd_line_args);
+        Display::singleton_prefer_headless(_settings.is_headless);
+        Profiler::set_enabled(!_settings.profile_path.empty());
+        _startup_begin = Timer::now();
+        _startup();
 
-        const RenderContext::Type desired_context_type = RenderContext::Type::vulkan;
-        for (size_t i = 0; i < _display->context_get_count(); i++) {
-            if (_display->context_get(i)->get_type() == desired_context_type) {
-                _context = _display->context_get(i);
-                break;
-            }
+        // Snapshots are only taken when something consumes them.
+        bool has_metrics_output = false;
+        if (!_settings.metrics_path.empty()) {
+            has_metrics_output |= Metrics::output_file_open(_settings.metrics_path);
         }
 
-        _context->initialize();
-        _renderer = _context->renderer_create();
-        size_t device_index = 0;
-        for (size_t i = 0; i < _context->adapter_get_count(); i++) {
-            if (_context->adapter_get(i).type == RenderContext::Adapter::Type::discrete) {
-                device_index = i;
-                break;
-            }
+        if (!_settings.metrics_socket_path.empty()) {
+            has_metrics_output |= Metrics::output_socket_open(_settings.metrics_socket_path);
         }
 
-        _renderer->initialize(device_index);
-
-        Display::WindowSpecifications main_window_specs = {};
-        main_window_specs.width = 1280;
-        main_window_specs.height = 720;
-        main_window_specs.title = "Dodo Engine";
-        _main_window_id = _display->window_create(main_window_specs);
-        _display->window_set_event_callback(_main_window_id, [this](Display::Event& e) { _on_event(e); });
+        Metrics::snapshot_interval_set(has_metrics_output ? 600 : 0);
 
-        RenderContext::SurfaceSpecifications main_surface_specs = {};
-        main_surface_specs.width = main_window_specs.width;
-        main_surface_specs.height = main_window_specs.height;
-        main_surface_specs.vsync_mode = RenderContext::VSyncMode::enabled;
-        _main_surface = _context->surface_create(_main_window_id, main_surface_specs, _display->window_get_platform_data(_main_window_id));
+        if (_settings.is_benchmark) {
+            // Keep every measured frame so the report percentiles are exact.
+            FrameStats::Specifications frame_stats_specs = {};
+            frame_stats_specs.history_capacity = std::max<size_t>(frame_stats_specs.history_capacity, _settings.benchmark_frame_count);
+            _frame_stats = FrameStats(frame_stats_specs);
+            DODO_LOG_INFO_TAG("Engine", "Benchmarking {0} frames after {1} warmup frames.", _settings.benchmark_frame_count, _settings.warmup_frame_count);
+        }
     }
 
     Engine::~Engine() {
+        if (_device) {
+            // Compile jobs on the thread pool reference the device, none may run past this point.
+            _device->pipeline_compilations_drain();
+            _device->pipeline_cache_save();
+        }
+
+        _frame_stats.log_summary(false);
+        _frame_stats.write_report("dodo_frame_stats.json");
+        if (!_settings.profile_path.empty()) {
+            // No zone may be pushed while the rings are read, tasks that already began finish theirs first.
+            Profiler::set_enabled(false);
+            _thread_pool.wait_for_idle();
+            Profiler::write_chrome_trace(_settings.profile_path);
+        }
+
+        Metrics::outputs_close();
     }
 
     void Engine::iterate_main_loop() {
-        _prepare_for_drawing();
+        if (!_device) {
+            return;
+        }
+
+        if (!_prepare_for_drawing()) {
+            _render_graph.de_initialize();
+            _upload_manager.de_initialize();
+            return;
+        }
+
+        if (_settings.submit_benchmark_count > 0) {
+            _run_submit_benchmark();
+            _render_graph.de_initialize();
+            _upload_manager.de_initialize();
+            return;
+        }
+
+        if (_settings.use_render_thread) {
+            _render_thread_start();
+        }
+
+        _clock.initialize({});
+        if (!_settings.record_path.empty() && !Input::StartRecording(_settings.record_path)) {
+            DODO_LOG_ERROR_TAG("Engine", "Failed to record input to {0}.", _settings.record_path.string());
+        }
+
+        if (!_settings.replay_path.empty() && !Input::StartReplay(_settings.replay_path, _settings.replay_timing)) {
+            DODO_LOG_ERROR_TAG("Engine", "Failed to replay input from {0}.", _settings.replay_path.string());
+        }
+
+        _frame_pacer.target_frame_time_set((_settings.target_frame_rate > 0.0) ? (1000.0 / _settings.target_frame_rate) : 0.0);
+        _benchmark_begin = Timer::now();
         while (_is_running) {
-            _display->window_process_events(_main_window_id);
+            DODO_PROFILE_SCOPE("Engine::iterate_main_loop");
+            _frame_stopwatch.Now();
+            _frame_begin = Timer::now();
+            _fence_wait_time = 0.0;
+            {
+                DODO_PROFILE_SCOPE("Engine::process_events");
+                _display->process_events();
+            }
+
+            {
+                DODO_PROFILE_SCOPE("Engine::simulate");
+                const uint32_t step_count = _clock.advance();
+                for (uint32_t i = 0; i < step_count; i++) {
+                    _simulate(_clock.fixed_step_get(), _clock.step_end_timestamp_get(i));
+                }
+            }
 
             _begin_frame();
-            // RENDER
+            // RENDER, blending the last two simulation states by _clock.alpha_get()
             _end_frame();
-            _execute_frame();
+            if (_settings.use_render_thread) {
+                _pending_packet.frame_index = _frame_index;
+                _pending_packet.frame_begin = _frame_begin;
+                const bool is_pushed = _frame_packets.push(_pending_packet);
+                DODO_ASSERT(is_pushed);
+                _ready_frame_packets.release();
+                _pending_packet = {};
+                _frame_index = (_frame_index + 1) % static_cast<uint32_t>(_frames.size());
+
+                FrameResult result = {};
+                while (_frame_results.pop(result)) {
+                    _record_frame_result(result);
+                }
+            }
+            else {
+                _acquire_framebuffer();
+                _record_frame_result(_execute_frame(_frame_index, _frame_begin));
+                _frames.at(_frame_index).wait_for_fence = true;
+                _frame_index = (_frame_index + 1) % static_cast<uint32_t>(_frames.size());
+            }
+
+            // The fence wait is idle time, the CPU cost of the frame is everything else.
+            const double cpu_frame_time = _frame_stopwatch.get_milliseconds() - _fence_wait_time;
+            _frame_stats.record(FrameStats::Metric::cpu_frame_time, cpu_frame_time);
+            _frame_stats.record(FrameStats::Metric::fence_wait_time, _fence_wait_time);
+            _frame_stats.end_frame();
+            // Device objects are created and destroyed on this thread, so their counts are read here.
+            _device->metrics_update();
+            Metrics::end_frame();
+
+            _frame_pipeline_controller.sample(cpu_frame_time, _gpu_profiler.resolved_frame_time_get(), _fence_wait_time, _last_frame_latency);
+            _last_frame_latency = -1.0;
+            FramePipelineController::Configuration configuration = {};
+            if (_frame_pipeline_controller.evaluate(configuration)) {
+                _frames_reconfigure(configuration);
+            }
+
+            _frame_pacer.wait(_frame_begin);
+
+            _frame_count++;
+            if (_settings.is_benchmark) {
+                if (_frame_count == _settings.warmup_frame_count) {
+                    // Warmup frames include shader compilation and first-use costs, they are not measured.
+                    _frame_stats.reset();
+                    _benchmark_begin = Timer::now();
+                }
+
+                if (_frame_count >= (static_cast<uint64_t>(_settings.warmup_frame_count) + _settings.benchmark_frame_count)) {
+                    _is_running = false;
+                }
+            }
+
+            if (Input::IsReplayFinished()) {
+                // A benchmark of a replay measures exactly the recorded session.
+                DODO_LOG_INFO_TAG("Engine", "Input replay finished after {0} frames.", _frame_count);
+                _is_replay_finished = true;
+                Input::StopReplay();
+                if (_settings.is_benchmark) {
+                    _is_running = false;
+                }
+            }
+        }
+
+        Input::StopReplay();
+        Input::StopRecording();
+
+        if (_settings.use_render_thread) {
+            _render_thread_stop();
+        }
+
+        _render_graph.de_initialize();
+        _upload_manager.de_initialize();
+        if (_settings.is_benchmark) {
+            _write_benchmark_report();
         }
     }
 
     void Engine::_on_event(Display::Event& e) {
-        if (e.window_id == _main_window_id) {
+        if (e.window == _main_window_id) {
             _main_window_on_event(e);
         }
 
-        _context->on_event(e);
+        if (_settings.use_render_thread && _render_thread.joinable()) {
+            // Surfaces belong to the render thread, backend events travel with the next frame.
+            // Only the final size matters, a resize replaces the latest pending resize of its window.
+            if (e.type == Display::Event::Type::window_resize) {
+                for (uint32_t i = _pending_packet.backend_event_count; i > 0; i--) {
+                    Display::Event& pending_event = _pending_packet.backend_events.at(i - 1);
+                    if (pending_event.window != e.window) {
+                        continue;
+                    }
+
+                    if (pending_event.type == Display::Event::Type::window_resize) {
+                        pending_event.resized = e.resized;
+                        DODO_METRIC_COUNTER_ADD("engine.backend_events_coalesced", 1);
+                        return;
+                    }
+
+                    break;
+                }
+            }
+
+            if (_pending_packet.backend_event_count < FramePacket::max_backend_event_count) {
+                _pending_packet.backend_events.at(_pending_packet.backend_event_count++) = e;
+            }
+            else {
+                DODO_METRIC_COUNTER_ADD("engine.backend_events_dropped", 1);
+                DODO_LOG_WARNING_TAG("Engine", "Too many window events in one frame, event dropped.");
+            }
+
+            return;
+        }
+
+        _backend->on_event(e);
     }
 
     void Engine::_main_window_on_event(Display::Event& e) {
@@ -75,51 +236,396 @@ namespace Dodo {
         }
     }
 
-    void Engine::_prepare_for_drawing() {
-        _main_queue_family = _renderer->command_queue_family_get(Renderer::CommandQueueFamilyType::draw, _main_surface);
-        _main_queue = _renderer->command_queue_create(_main_queue_family);
-        _swap_chain = _renderer->swap_chain_create(_main_surface);
+    void Engine::_startup() {
+        DODO_PROFILE_SCOPE("Engine::startup");
+        // Window creation overlaps with instance creation and adapter enumeration, the
+        // device and the surface are created in parallel once both are available.
+        Display::WindowSpecifications main_window_specs = {};
+        main_window_specs.width = 1280;
+        main_window_specs.height = 720;
+        main_window_specs.title = "Dodo Engine";
+
+        TaskGraph startup_graph = {};
+        const TaskGraph::NodeId display_node = startup_graph.node_add("display_create", [this]() {
+            _display = &Display::singleton_get();
+            const RenderBackend::Type desired_backend_type = RenderBackend::Type::vulkan;
+            for (size_t i = 0; i < _display->render_backend_get_count(); i++) {
+                if (_display->render_backend_get(i)->get_type() == desired_backend_type) {
+                    _backend = _display->render_backend_get(i);
+                    break;
+                }
+            }
+
+            DODO_ASSERT(_backend);
+        }, {}, TaskGraph::Affinity::main_thread);
+
+        const TaskGraph::NodeId backend_node = startup_graph.node_add("backend_initialize", [this]() {
+            _backend->initialize();
+            for (size_t i = 0; i < _backend->adapter_get_count(); i++) {
+                if (_backend->adapter_get(i).type == RenderBackend::Adapter::Type::performance) {
+                    _adapter_index = i;
+                    break;
+                }
+            }
+        }, { display_node });
+
+        // Windows receive their messages on the thread that created them.
+        const TaskGraph::NodeId window_node = startup_graph.node_add("window_create", [this, &main_window_specs]() {
+            _main_window_id = _display->window_create(main_window_specs);
+            _display->window_set_event_callback(_main_window_id, [this](Display::Event& e) { _on_event(e); });
+        }, { display_node }, TaskGraph::Affinity::main_thread);
+
+        startup_graph.node_add("device_create", [this]() {
+            _device = _backend->render_device_create();
+            if (!_device->initialize(_adapter_index)) {
+                DODO_LOG_ERROR_TAG("Engine", "Failed to create a render device on adapter {0}.", _backend->adapter_get(_adapter_index).name);
+                _device = nullptr;
+            }
+        }, { backend_node });
+
+        startup_graph.node_add("surface_create", [this, &main_window_specs]() {
+            RenderBackend::SurfaceSpecifications main_surface_specs = {};
+            main_surface_specs.width = main_window_specs.width;
+            main_surface_specs.height = main_window_specs.height;
+            main_surface_specs.vsync_mode = _settings.use_vsync ? RenderBackend::VSyncMode::enabled : RenderBackend::VSyncMode::disabled;
+            _main_surface = _backend->surface_create(_main_window_id, main_surface_specs, _display->window_get_platform_data(_main_window_id));
+        }, { backend_node, window_node });
+
+        startup_graph.execute(_thread_pool);
+
+        for (const TaskGraph::NodeTiming& timing : startup_graph.timings_get()) {
+            const double offset = Timer::ticks_to_milliseconds(timing.begin - _startup_begin);
+            const double duration = Timer::ticks_to_milliseconds(timing.end - timing.begin);
+            DODO_LOG_INFO_TAG("Engine", "Startup {0}: {1:.3f} ms, started at {2:.3f} ms.", timing.name, duration, offset);
+            Metrics::gauge_set(Metrics::gauge_register("startup." + timing.name + "_ms"), duration);
+        }
+
+        const double startup_time = Timer::ticks_to_milliseconds(Timer::now() - _startup_begin);
+        DODO_LOG_INFO_TAG("Engine", "Startup took {0:.3f} ms.", startup_time);
+        DODO_METRIC_GAUGE_SET("startup.total_ms", startup_time);
+    }
+
+    void Engine::_write_benchmark_report() const {
+        const double elapsed = Timer::ticks_to_milliseconds(Timer::now() - _benchmark_begin) * 1.0E-3;
+        const uint64_t measured_frame_count = _frame_stats.frame_count_get();
+        std::ofstream os(_settings.report_path, std::ios::trunc);
+        if (!os) {
+            DODO_LOG_ERROR("Failed to write benchmark report: {0}.", _settings.report_path.string());
+            return;
+        }
+
+        os << "{\n    \"settings\": {";
+        os << std::format("\"frames\": {}, \"warmup_frames\": {}, \"headless\": {}, \"vsync\": {}, \"render_thread\": {}, \"pipeline_depth\": {}, \"target_fps\": {}",
+            _settings.benchmark_frame_count, _settings.warmup_frame_count, _settings.is_headless, _settings.use_vsync, _settings.use_render_thread, _settings.pipeline_depth, _settings.target_frame_rate);
+        os << ", \"replay\": \"";
+        json_write_escaped(os, _settings.replay_path.string());
+        os << std::format("\", \"replay_finished\": {}", _is_replay_finished);
+        os << "},\n    \"adapter\": \"";
+        json_write_escaped(os, _backend->adapter_get(_adapter_index).name);
+        os << "\",";
+        os << std::format("\n    \"frame_count\": {},\n    \"elapsed_s\": {:.4f},\n    \"average_fps\": {:.2f},", measured_frame_count, elapsed, (elapsed > 0.0) ? (static_cast<double>(measured_frame_count) / elapsed) : 0.0);
+        os << std::format("\n    \"time_to_first_frame_ms\": {:.3f},", _time_to_first_frame.load());
+
+        // Milliseconds per frame for each frame metric.
+        os << "\n    \"timings\": {";
+        for (size_t i = 0; i < FrameStats::metric_count; i++) {
+            const auto metric = static_cast<FrameStats::Metric>(i);
+            const FrameStats::Summary summary = _frame_stats.summary_get(metric, false);
+            os << (i == 0 ? "\n" : ",\n");
+            os << std::format("        \"{}\": {{\"samples\": {}, \"min\": {:.4f}, \"mean\": {:.4f}, \"max\": {:.4f}, \"p50\": {:.4f}, \"p95\": {:.4f}, \"p99\": {:.4f}}}",
+                FrameStats::to_string(metric), summary.sample_count, summary.min, summary.mean, summary.max, summary.p50, summary.p95, summary.p99);
+        }
+
+        const MemoryStats memory_stats = MemoryStats::query();
+        os << "\n    },\n    \"memory\": {";
+        os << std::format("\"resident_bytes\": {}, \"peak_resident_bytes\": {}", memory_stats.resident_bytes, memory_stats.peak_resident_bytes);
+        os << "},\n    \"metrics\": {";
+        const Metrics::Snapshot snapshot = Metrics::snapshot_take();
+        for (size_t i = 0; i < snapshot.entries.size(); i++) {
+            const Metrics::Snapshot::Entry& entry = snapshot.entries.at(i);
+            os << (i == 0 ? "\n" : ",\n") << "        \"";
+            json_write_escaped(os, entry.name);
+            os << "\": " << entry.value;
+        }
+
+        os << "\n    }\n}\n";
+        DODO_LOG_INFO_TAG("Engine", "Benchmark finished, {0} frames in {1:.3f} s, report written to {2}.", measured_frame_count, elapsed, _settings.report_path.string());
+    }
+
+    void Engine::_run_submit_benchmark() {
+        // One empty command buffer submitted over and over, only the submit call is timed. On a null
+        // driver such as the Vulkan mock ICD, this is the overhead of the render device alone.
+        const uint32_t submit_count = _settings.submit_benchmark_count;
+        Frame& frame = _frames.at(0);
+        _device->command_buffer_begin(frame.draw_command_buffer);
+        _device->command_buffer_end(frame.draw_command_buffer);
+
+        RenderDevice::SubmitSpecifications submit_specs = {};
+        submit_specs.command_queue = _main_queue;
+        submit_specs.command_buffers = { &frame.draw_command_buffer, 1 };
+        submit_specs.fence = frame.fence;
+
+        std::vector<double> submit_times(submit_count);
+        for (uint32_t i = 0; i < submit_count; i++) {
+            const uint64_t submit_begin = Timer::now();
+            _device->command_queue_execute_and_present(submit_specs);
+            submit_times.at(i) = static_cast<double>(Timer::ticks_to_nanoseconds(Timer::now() - submit_begin));
+            _device->fence_wait(frame.fence);
+        }
+
+        double total_time = 0.0;
+        for (const double submit_time : submit_times) {
+            total_time += submit_time;
+        }
+
+        std::ranges::sort(submit_times);
+        const double mean = total_time / submit_count;
+        const double p50 = submit_times.at(submit_count / 2);
+        const double p99 = submit_times.at(std::min<size_t>((submit_count * 99) / 100, submit_count - 1));
+        DODO_METRIC_GAUGE_SET("engine.submit_benchmark_mean_ns", mean);
+        DODO_METRIC_GAUGE_SET("engine.submit_benchmark_p99_ns", p99);
+        DODO_LOG_INFO_TAG("Engine", "Submit benchmark, {0} submissions: mean {1:.0f} ns, p50 {2:.0f} ns, p99 {3:.0f} ns, max {4:.0f} ns.",
+            submit_count, mean, p50, p99, submit_times.back());
+    }
+
+    void Engine::_simulate(double step, uint64_t step_end_timestamp) {
+        // Each step only sees the input that happened before it ends.
+        Input::Update(step_end_timestamp);
+        // SIMULATE
+    }
 
+    bool Engine::_prepare_for_drawing() {
+        _main_queue_family = _device->command_queue_family_get(RenderDevice::CommandQueueFamilyType::draw, _main_surface);
+        _main_queue = _device->command_queue_create(_main_queue_family);
+        _swap_chain = _device->swap_chain_create(_main_surface);
+        _upload_manager.initialize(_device, {});
+
+        // One slot more than the pipeline depth, so the main thread can record while
+        // the render thread keeps pipeline depth frames in flight.
+        _frames_create(_settings.pipeline_depth + 1);
+
+        _render_graph.initialize(_device);
+        const RenderGraph::PassId draw_pass = _render_graph.pass_add("draw", {}, {}, [this](CommandBufferHandle command_buffer) {
+            _command_recorder.record(_thread_pool, command_buffer, _draw_jobs);
+        });
+        // The draw jobs render to the swap chain, which the graph does not track.
+        _render_graph.pass_mark_side_effects(draw_pass);
+        if (!_render_graph.compile()) {
+            DODO_LOG_ERROR_TAG("Engine", "Failed to compile the render graph.");
+            return false;
+        }
+
+        FramePipelineController::Specifications controller_specs = {};
+        controller_specs.goal = _settings.frame_goal;
+        controller_specs.latency_target = _settings.latency_target;
+        controller_specs.max_frames_in_flight = std::max(controller_specs.max_frames_in_flight, static_cast<uint32_t>(_frames.size()));
+        controller_specs.use_vsync = _settings.use_vsync;
+        FramePipelineController::Configuration configuration = {};
+        configuration.frames_in_flight = static_cast<uint32_t>(_frames.size());
+        configuration.vsync_mode = _backend->surface_get_vsync_mode(_main_surface);
+        _frame_pipeline_controller.initialize(controller_specs, configuration);
+        return true;
+    }
+
+    void Engine::_frames_create(uint32_t frame_count) {
         _frames.clear();
-        _frames.resize(_desired_framebuffer_count);
-        for (size_t i = 0; i < _desired_framebuffer_count; i++) {
+        _frames.resize(frame_count);
+        for (size_t i = 0; i < _frames.size(); i++) {
             Frame& frame = _frames.at(i);
-            frame.command_pool = _renderer->command_pool_create(_main_queue_family, Renderer::CommandListType::primary);
-            frame.fence = _renderer->fence_create();
-            frame.image_semaphore = _renderer->semaphore_create();
-            frame.draw_command_list = _renderer->command_list_create(frame.command_pool);
-            frame.present_semaphore = _renderer->semaphore_create();
+            frame.command_pool = _device->command_pool_create(_main_queue_family);
+            frame.fence = _device->fence_create();
+            frame.draw_command_buffer = _device->command_buffer_create(frame.command_pool, RenderDevice::CommandBufferType::primary);
+            frame.upload_semaphore = _device->semaphore_create();
+        }
+
+        _gpu_profiler.initialize(_device, static_cast<uint32_t>(_frames.size()));
+        _command_recorder.initialize(_device, _main_queue_family, static_cast<uint32_t>(_frames.size()), _thread_pool.thread_count_get());
+        _frame_index = 0;
+    }
+
+    void Engine::_frames_destroy() {
+        _gpu_profiler.de_initialize();
+        for (Frame& frame : _frames) {
+            if (frame.wait_for_fence) {
+                _device->fence_wait(frame.fence);
+            }
+
+            _device->command_buffer_destroy(frame.draw_command_buffer);
+            _device->command_pool_destroy(frame.command_pool);
+            _device->fence_destroy(frame.fence);
+            _device->semaphore_destroy(frame.upload_semaphore);
+        }
+
+        _command_recorder.de_initialize();
+        _frames.clear();
+    }
+
+    void Engine::_frames_reconfigure(const FramePipelineController::Configuration& configuration) {
+        DODO_PROFILE_SCOPE("Engine::frames_reconfigure");
+        // Everything in flight has to retire first, the render thread waits for its frames when it stops.
+        if (_settings.use_render_thread) {
+            _render_thread_stop();
+            FrameResult result = {};
+            while (_frame_results.pop(result)) {
+                _record_frame_result(result);
+            }
+
+            while (_free_frame_slots.try_acquire()) {
+            }
+        }
+
+        _frames_destroy();
+        _settings.pipeline_depth = configuration.frames_in_flight - 1;
+        _frames_create(configuration.frames_in_flight);
+
+        // Mailbox needs an image to present, one to queue and one to render to.
+        const uint32_t min_framebuffer_count = (configuration.vsync_mode == RenderBackend::VSyncMode::mailbox) ? 3 : 2;
+        _desired_framebuffer_count = std::max(configuration.frames_in_flight, min_framebuffer_count);
+        _backend->surface_set_vsync_mode(_main_surface, configuration.vsync_mode);
+        _backend->surface_set_needs_resize(_main_surface, true);
+
+        if (_settings.use_render_thread) {
+            _render_thread_start();
         }
     }
 
     void Engine::_begin_frame() {
+        DODO_PROFILE_SCOPE("Engine::begin_frame");
         Frame& frame = _frames.at(_frame_index);
-        if (frame.wait_for_fence) {
-            _renderer->fence_wait(frame.fence);
+        Stopwatch fence_stopwatch = {};
+        if (_settings.use_render_thread) {
+            // Released by the render thread after it waited for the fence of this slot.
+            _free_frame_slots.acquire();
+            _fence_wait_time = fence_stopwatch.get_milliseconds();
+        }
+        else if (frame.wait_for_fence) {
+            _device->fence_wait(frame.fence);
+            _fence_wait_time = fence_stopwatch.get_milliseconds();
             frame.wait_for_fence = false;
         }
 
-        auto swap_chain_status = Renderer::SwapChainStatus::ok;
-        FramebufferHandle framebuffer = _renderer->swap_chain_acquire_next_framebuffer(frame.image_semaphore, _swap_chain, frame.fence, swap_chain_status);
-        if (swap_chain_status == Renderer::SwapChainStatus::out_of_date) {
-            _renderer->swap_chain_resize(_main_queue, _swap_chain, _desired_framebuffer_count);
-            framebuffer = _renderer->swap_chain_acquire_next_framebuffer(frame.image_semaphore, _swap_chain, frame.fence, swap_chain_status);
-            DODO_ASSERT(swap_chain_status == Renderer::SwapChainStatus::ok);
+        // Everything recorded for this slot last time has retired, its pools are reset in bulk.
+        _device->command_pool_reset(frame.command_pool);
+        _command_recorder.begin_frame(_frame_index);
+        _device->command_buffer_begin(frame.draw_command_buffer);
+        _gpu_profiler.begin_frame(_frame_index, frame.draw_command_buffer);
+        if (_gpu_profiler.resolved_frame_time_get() >= 0.0) {
+            _frame_stats.record(FrameStats::Metric::gpu_frame_time, _gpu_profiler.resolved_frame_time_get());
         }
-
-        _renderer->command_list_begin(frame.draw_command_list);
     }
 
     void Engine::_end_frame() {
+        DODO_PROFILE_SCOPE("Engine::end_frame");
         Frame& frame = _frames.at(_frame_index);
-        _renderer->command_list_end(frame.draw_command_list);
+        _render_graph.execute(frame.draw_command_buffer);
+        _gpu_profiler.end_frame(frame.draw_command_buffer);
+        _device->command_buffer_end(frame.draw_command_buffer);
+        // Uploads recorded during the frame are submitted before its draws.
+        frame.wait_for_upload = _upload_manager.flush(frame.upload_semaphore);
     }
 
-    void Engine::_execute_frame() {
-        Frame& frame = _frames.at(_frame_index);
+    void Engine::_acquire_framebuffer() {
+        DODO_PROFILE_SCOPE("Engine::acquire_framebuffer");
+        auto swap_chain_status = RenderDevice::SwapChainStatus::success;
+        _framebuffer = _device->swap_chain_acquire_next_framebuffer(_main_queue, _swap_chain, swap_chain_status);
+        if (swap_chain_status == RenderDevice::SwapChainStatus::out_of_date) {
+            _device->swap_chain_recreate_or_resize(_main_queue, _swap_chain, _desired_framebuffer_count);
+            _framebuffer = _device->swap_chain_acquire_next_framebuffer(_main_queue, _swap_chain, swap_chain_status);
+        }
+    }
+
+    Engine::FrameResult Engine::_execute_frame(uint32_t frame_index, uint64_t frame_begin) {
+        DODO_PROFILE_SCOPE("Engine::execute_frame");
+        Frame& frame = _frames.at(frame_index);
+
+        RenderDevice::SubmitSpecifications submit_specs = {};
+        submit_specs.command_queue = _main_queue;
+        submit_specs.command_buffers = { &frame.draw_command_buffer, 1 };
+        if (frame.wait_for_upload) {
+            submit_specs.wait_semaphores = { &frame.upload_semaphore, 1 };
+        }
+
+        submit_specs.fence = frame.fence;
+        // Only present when an image was acquired, e.g. a minimized window has none.
+        submit_specs.swap_chain = _framebuffer ? _swap_chain : SwapChainHandle();
+        _device->command_queue_execute_and_present(submit_specs);
+
+        // Latency is measured from the start of the frame on the main thread until it was handed to the present engine.
+        const uint64_t now = Timer::now();
+        if (_last_present == 0) {
+            _time_to_first_frame = Timer::ticks_to_milliseconds(now - _startup_begin);
+            DODO_LOG_INFO_TAG("Engine", "Time to first frame: {0:.3f} ms.", _time_to_first_frame.load());
+            DODO_METRIC_GAUGE_SET("engine.time_to_first_frame_ms", _time_to_first_frame.load());
+        }
+
+        FrameResult result = {};
+        result.latency = Timer::ticks_to_milliseconds(now - frame_begin);
+        result.present_interval = (_last_present > 0) ? Timer::ticks_to_milliseconds(now - _last_present) : -1.0;
+        _last_present = now;
+        return result;
+    }
 
-        _renderer->command_queue_execute_and_present();
-        frame.wait_for_fence = true;
+    void Engine::_record_frame_result(const FrameResult& result) {
+        _frame_stats.record(FrameStats::Metric::frame_latency, result.latency);
+        _last_frame_latency = result.latency;
+        DODO_METRIC_HISTOGRAM_RECORD("engine.frame_latency_us", static_cast<uint64_t>(result.latency * 1000.0));
+        if (result.present_interval >= 0.0) {
+            _frame_stats.record(FrameStats::Metric::present_interval, result.present_interval);
+        }
+    }
+
+    void Engine::_render_thread_start() {
+        DODO_LOG_INFO_TAG("Engine", "Starting render thread with a pipeline depth of {0}.", _settings.pipeline_depth);
+        _free_frame_slots.release(static_cast<ptrdiff_t>(_frames.size()));
+        _render_thread = std::thread([this]() { _render_thread_main(); });
+    }
+
+    void Engine::_render_thread_stop() {
+        FramePacket packet = {};
+        packet.is_last = true;
+        // Blocks until a slot is free, the queue can not be full while one is.
+        _free_frame_slots.acquire();
+        const bool is_pushed = _frame_packets.push(packet);
+        DODO_ASSERT(is_pushed);
+        _ready_frame_packets.release();
+        _render_thread.join();
+    }
+
+    void Engine::_render_thread_main() {
+        DODO_PROFILE_THREAD("Render Thread");
+        std::deque<uint32_t> frames_in_flight = {};
+        FramePacket packet = {};
+        while (true) {
+            _ready_frame_packets.acquire();
+            const bool is_popped = _frame_packets.pop(packet);
+            DODO_ASSERT(is_popped);
+            if (packet.is_last) {
+                break;
+            }
+
+            DODO_PROFILE_SCOPE("Engine::render_thread_frame");
+            for (uint32_t i = 0; i < packet.backend_event_count; i++) {
+                _backend->on_event(packet.backend_events.at(i));
+            }
+
+            _acquire_framebuffer();
+            FrameResult result = _execute_frame(packet.frame_index, packet.frame_begin);
+            if (!_frame_results.push(result)) {
+                DODO_METRIC_COUNTER_ADD("engine.frame_results_dropped", 1);
+            }
+
+            frames_in_flight.push_back(packet.frame_index);
+            while (frames_in_flight.size() > _settings.pipeline_depth) {
+                _device->fence_wait(_frames.at(frames_in_flight.front()).fence);
+                frames_in_flight.pop_front();
+                _free_frame_slots.release();
+            }
+        }
+
+        while (!frames_in_flight.empty()) {
+            _device->fence_wait(_frames.at(frames_in_flight.front()).fence);
+            frames_in_flight.pop_front();
+        }
     }
 
 }
@@ -1,21 +1,24 @@
 #pragma once
 
+#include <semaphore>
+
 #include "display.h"
+#include "engine_clock.h"
+#include "engine_settings.h"
+#include "frame_pipeline_controller.h"
+#include "spsc_queue.h"
+#include "task_graph.h"
+#include "thread_pool.h"
+#include "renderer/render_backend.h"
 #include "renderer/render_device.h"
-#include "renderer/render_context.h"
+#include "renderer/command_recorder.h"
+#include "renderer/gpu_profiler.h"
+#include "renderer/render_graph.h"
+#include "renderer/upload_manager.h"
+#include "diagnostics/frame_stats.h"
 
 namespace Dodo {
 
-    struct CommandLineArgs {
-        const int count = 0;
-        const char* const* values = nullptr;
-
-        const char* operator[](size_t index) const {
-            DODO_ASSERT((index >= 0) && (index < count));
-            return values[index];
-        }
-    };
-
     class Engine {
     public:
         Engine(const CommandLineArgs& cmd_line_args);
@@ -26,33 +29,103 @@ namespace Dodo {
     private:
         void _on_event(Display::Event& e);
         void _main_window_on_event(Display::Event& e);
-        void _prepare_for_drawing();
+        struct FrameResult {
+            double latency = 0.0;
+            double present_interval = -1.0;
+        };
+
+        void _startup();
+        void _write_benchmark_report() const;
+        void _run_submit_benchmark();
+        void _simulate(double step, uint64_t step_end_timestamp);
+        bool _prepare_for_drawing();
+        void _frames_create(uint32_t frame_count);
+        void _frames_destroy();
+        void _frames_reconfigure(const FramePipelineController::Configuration& configuration);
         void _begin_frame();
         void _end_frame();
-        void _execute_frame();
+        void _acquire_framebuffer();
+        FrameResult _execute_frame(uint32_t frame_index, uint64_t frame_begin);
+        void _record_frame_result(const FrameResult& result);
+        void _render_thread_start();
+        void _render_thread_stop();
+        void _render_thread_main();
 
+        EngineSettings _settings = {};
+        ThreadPool _thread_pool = {};
+        uint64_t _startup_begin = 0;
+        // Written by whichever thread presents first.
+        std::atomic<double> _time_to_first_frame = 0.0;
         bool _is_running = true;
-        Ref<Display> _display = nullptr;
+        uint64_t _frame_count = 0;
+        bool _is_replay_finished = false;
+        uint64_t _benchmark_begin = 0;
+        size_t _adapter_index = 0;
+        Display* _display = nullptr;
         Display::WindowId _main_window_id = 0;
-        Ref<RenderContext> _context = nullptr;
+        Ref<RenderBackend> _backend = nullptr;
         Ref<RenderDevice> _device = nullptr;
-        SurfaceHandle _main_surface = SurfaceHandle::null();
-        CommandQueueFamilyHandle _main_queue_family = CommandQueueFamilyHandle::null();
-        CommandQueueHandle _main_queue = CommandQueueHandle::null();
-        SwapChainHandle _swap_chain = SwapChainHandle::null();
+        SurfaceHandle _main_surface = {};
+        CommandQueueFamilyHandle _main_queue_family = {};
+        CommandQueueHandle _main_queue = {};
+        SwapChainHandle _swap_chain = {};
+        FramebufferHandle _framebuffer = {};
 
         struct Frame {
-            CommandPoolHandle command_pool = CommandPoolHandle::null();
+            CommandPoolHandle command_pool = {};
             bool wait_for_fence = false;
-            FenceHandle fence = FenceHandle::null();
-            SemaphoreHandle image_semaphore = {};
-            CommandListHandle draw_command_list = {};
-            SemaphoreHandle present_semaphore = {};
+            FenceHandle fence = {};
+            CommandBufferHandle draw_command_buffer = {};
+            // Signaled by the upload flush of the frame.
+            SemaphoreHandle upload_semaphore = {};
+            bool wait_for_upload = false;
         };
 
         uint32_t _desired_framebuffer_count = 3;
         std::vector<Frame> _frames = {};
         uint32_t _frame_index = 0;
+        uint64_t _frame_begin = 0;
+        double _last_frame_latency = -1.0;
+        FramePipelineController _frame_pipeline_controller = {};
+
+        //////// RENDER THREAD ////
+        // The main thread records frame N+1 while the render thread acquires, submits
+        // and presents frame N. Packets reference a frame slot, a slot is handed back
+        // once the render thread waited for its fence, so the main thread runs at most
+        // pipeline depth frames ahead of the GPU.
+        struct FramePacket {
+            static constexpr size_t max_backend_event_count = 8;
+            uint32_t frame_index = 0;
+            uint64_t frame_begin = 0;
+            std::array<Display::Event, max_backend_event_count> backend_events = {};
+            uint32_t backend_event_count = 0;
+            bool is_last = false;
+        };
+
+        static constexpr size_t frame_packet_capacity = 8;
+        static_assert(EngineSettings::max_pipeline_depth < frame_packet_capacity);
+
+        std::thread _render_thread = {};
+        SpscQueue<FramePacket, frame_packet_capacity> _frame_packets = {};
+        SpscQueue<FrameResult, frame_packet_capacity> _frame_results = {};
+        std::counting_semaphore<frame_packet_capacity> _free_frame_slots{0};
+        std::counting_semaphore<frame_packet_capacity> _ready_frame_packets{0};
+        FramePacket _pending_packet = {};
+
+        EngineClock _clock = {};
+        FramePacer _frame_pacer = {};
+
+        GpuProfiler _gpu_profiler = {};
+        UploadManager _upload_manager = {};
+        CommandRecorder _command_recorder = {};
+        // Draw work of the frame, recorded on the thread pool and executed in this order.
+        std::vector<CommandRecorder::Job> _draw_jobs = {};
+        // Passes of a frame, compiled once when drawing is prepared and executed every frame.
+        RenderGraph _render_graph = {};
+        FrameStats _frame_stats = {};
+        Stopwatch _frame_stopwatch = {};
+        uint64_t _last_present = 0;
+        double _fence_wait_time = 0.0;
     };
 
 }
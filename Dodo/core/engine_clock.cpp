@@ -0,0 +1,115 @@
+#include "pch.h"
+#include "engine_clock.h"
+
+#include <cmath>
+
+#include "diagnostics/timer.h"
+
+namespace Dodo {
+
+    ////////////////////////////////////////////////////////////////
+    // ENGINE CLOCK ////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    void EngineClock::initialize(const Specifications& specs) {
+        DODO_ASSERT(specs.fixed_step > 0.0);
+        _specs = specs;
+        _last_advance = Timer::now();
+        _last_step_count = 0;
+        _delta = 0.0;
+        _accumulator = 0.0;
+        _step_count = 0;
+    }
+
+    uint32_t EngineClock::advance() {
+        const uint64_t now = Timer::now();
+        const double elapsed = Timer::ticks_to_milliseconds(now - _last_advance) * 1.0E-3;
+        _last_advance = now;
+        _delta = _is_paused ? 0.0 : (elapsed * _specs.time_scale);
+        _accumulator += _delta;
+
+        uint32_t step_count = 0;
+        while ((_accumulator >= _specs.fixed_step) && (step_count < _specs.max_steps_per_frame)) {
+            _accumulator -= _specs.fixed_step;
+            step_count++;
+        }
+
+        if (_accumulator >= _specs.fixed_step) {
+            const auto dropped_steps = static_cast<uint64_t>(_accumulator / _specs.fixed_step);
+            DODO_METRIC_COUNTER_ADD("engine.simulation_steps_dropped", dropped_steps);
+            _accumulator -= static_cast<double>(dropped_steps) * _specs.fixed_step;
+        }
+
+        _step_count += step_count;
+        _last_step_count = step_count;
+        DODO_METRIC_COUNTER_ADD("engine.simulation_steps", step_count);
+        return step_count;
+    }
+
+    uint64_t EngineClock::step_end_timestamp_get(uint32_t step_index) const {
+        DODO_ASSERT(step_index < _last_step_count);
+        if (_specs.time_scale <= 0.0) {
+            return _last_advance;
+        }
+
+        // The steps after this one and the leftover accumulator are still ahead of it.
+        const double remaining = (static_cast<double>(_last_step_count - step_index - 1) * _specs.fixed_step + _accumulator) / _specs.time_scale;
+        const uint64_t remaining_ticks = Timer::nanoseconds_to_ticks(static_cast<uint64_t>(remaining * 1.0E9));
+        return _last_advance - std::min(_last_advance, remaining_ticks);
+    }
+
+    ////////////////////////////////////////////////////////////////
+    // FRAME PACER /////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    void FramePacer::target_frame_time_set(double milliseconds) {
+        _target_frame_time = std::max(milliseconds, 0.0);
+    }
+
+    void FramePacer::wait(uint64_t frame_begin) {
+        if (_target_frame_time <= 0.0) {
+            return;
+        }
+
+        DODO_PROFILE_SCOPE("FramePacer::wait");
+        const uint64_t target = frame_begin + Timer::nanoseconds_to_ticks(static_cast<uint64_t>(_target_frame_time * 1.0E6));
+        while (true) {
+            const uint64_t now = Timer::now();
+            if (now >= target) {
+                break;
+            }
+
+            if (Timer::ticks_to_milliseconds(target - now) <= _sleep_estimate) {
+                break;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            _update_sleep_estimate(Timer::ticks_to_milliseconds(Timer::now() - now));
+        }
+
+        while (Timer::now() < target) {
+#ifdef DODO_TIMER_TSC
+            _mm_pause();
+#else
+            std::this_thread::yield();
+#endif
+        }
+
+        DODO_METRIC_HISTOGRAM_RECORD("engine.pacer_overshoot_us", Timer::ticks_to_nanoseconds(Timer::now() - target) / 1000);
+    }
+
+    void FramePacer::_update_sleep_estimate(double milliseconds) {
+        // A sleep far beyond the usual is a preemption, it would make the pacer spin for frames.
+        if (milliseconds > 10.0) {
+            return;
+        }
+
+        _sleep_count++;
+        const double delta = milliseconds - _sleep_mean;
+        _sleep_mean += delta / static_cast<double>(_sleep_count);
+        _sleep_m2 += delta * (milliseconds - _sleep_mean);
+        const double stddev = std::sqrt(_sleep_m2 / static_cast<double>(_sleep_count - 1));
+        _sleep_estimate = _sleep_mean + stddev;
+    }
+
+}
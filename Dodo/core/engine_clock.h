@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Dodo {
+
+    // Fixed timestep clock, the simulation advances in constant steps and rendering
+    // interpolates between the last two simulation states with alpha.
+    class EngineClock {
+    public:
+        struct Specifications {
+            double fixed_step = 1.0 / 60.0;
+            // After a hitch at most this many steps run in one frame, the rest of the
+            // backlog is dropped instead of spiralling further behind.
+            uint32_t max_steps_per_frame = 8;
+            double time_scale = 1.0;
+        };
+
+        void initialize(const Specifications& specs);
+        // Returns the number of fixed steps to simulate this frame.
+        uint32_t advance();
+        void pause(bool is_paused) { _is_paused = is_paused; }
+
+        double fixed_step_get() const { return _specs.fixed_step; }
+        // Real seconds since the previous advance, scaled and zero while paused.
+        double delta_get() const { return _delta; }
+        // Simulated seconds, always a multiple of the fixed step.
+        double simulation_time_get() const { return static_cast<double>(_step_count) * _specs.fixed_step; }
+        uint64_t step_count_get() const { return _step_count; }
+        // Fraction of a step between the previous and the current simulation state, in [0, 1).
+        double alpha_get() const { return _accumulator / _specs.fixed_step; }
+        // Timer ticks of the real time at which a step of the last advance ends, input
+        // reported up to then belongs to that step.
+        uint64_t step_end_timestamp_get(uint32_t step_index) const;
+
+    private:
+        Specifications _specs = {};
+        uint64_t _last_advance = 0;
+        uint32_t _last_step_count = 0;
+        double _delta = 0.0;
+        double _accumulator = 0.0;
+        uint64_t _step_count = 0;
+        bool _is_paused = false;
+    };
+
+    // Holds frames to a target frame time. Sleeping is coarse, so the pacer sleeps
+    // while the remaining time is above its estimate of the sleep overshoot and
+    // spins on the timer for the rest.
+    class FramePacer {
+    public:
+        // A target of zero disables pacing.
+        void target_frame_time_set(double milliseconds);
+        double target_frame_time_get() const { return _target_frame_time; }
+        // Waits until the target frame time has passed since frame_begin, in Timer ticks.
+        void wait(uint64_t frame_begin);
+
+    private:
+        void _update_sleep_estimate(double milliseconds);
+
+        double _target_frame_time = 0.0;
+        // Running mean and variance of observed 1 ms sleeps (Welford).
+        double _sleep_estimate = 1.0;
+        double _sleep_mean = 1.0;
+        double _sleep_m2 = 0.0;
+        uint64_t _sleep_count = 1;
+    };
+
+}
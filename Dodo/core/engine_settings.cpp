@@ -0,0 +1,167 @@
+#include "pch.h"
+#include "engine_settings.h"
+
+#include <charconv>
+#include <cmath>
+
+namespace Dodo {
+
+    namespace Utils {
+
+        static uint32_t parse_uint(std::string_view value, uint32_t fallback) {
+            uint32_t result = 0;
+            const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+            if ((error != std::errc()) || (end != value.data() + value.size())) {
+                DODO_LOG_WARNING_TAG("Engine", "Invalid number on the command line: {0}.", value);
+                return fallback;
+            }
+
+            return result;
+        }
+
+        static double parse_double(std::string_view value, double fallback) {
+            double result = 0.0;
+            const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+            if ((error != std::errc()) || (end != value.data() + value.size()) || !std::isfinite(result) || (result < 0.0)) {
+                DODO_LOG_WARNING_TAG("Engine", "Invalid number on the command line: {0}.", value);
+                return fallback;
+            }
+
+            return result;
+        }
+
+        static bool parse_switch(std::string_view value, bool fallback) {
+            if ((value == "on") || (value == "true") || (value == "1")) {
+                return true;
+            }
+
+            if ((value == "off") || (value == "false") || (value == "0")) {
+                return false;
+            }
+
+            DODO_LOG_WARNING_TAG("Engine", "Invalid switch on the command line: {0}.", value);
+            return fallback;
+        }
+
+    }
+
+    EngineSettings EngineSettings::from_command_line(const CommandLineArgs& cmd_line_args) {
+        EngineSettings settings = {};
+        bool is_vsync_set = false;
+        bool is_replay_timing_set = false;
+        for (int i = 1; i < cmd_line_args.count; i++) {
+            std::string_view name = cmd_line_args[i];
+            std::string_view value = {};
+            if (const size_t separator = name.find('='); separator != std::string_view::npos) {
+                value = name.substr(separator + 1);
+                name = name.substr(0, separator);
+            }
+
+            // Flags with a value also take it from the next argument, unless that is another flag.
+            auto value_get = [&]() -> std::string_view {
+                if (value.empty() && ((i + 1) < cmd_line_args.count) && !std::string_view(cmd_line_args[i + 1]).starts_with("--")) {
+                    value = cmd_line_args[++i];
+                }
+
+                return value;
+            };
+
+            if (name == "--benchmark") {
+                settings.is_benchmark = true;
+            }
+            else if (name == "--frames") {
+                settings.benchmark_frame_count = std::max(Utils::parse_uint(value_get(), settings.benchmark_frame_count), 1u);
+            }
+            else if (name == "--warmup") {
+                settings.warmup_frame_count = Utils::parse_uint(value_get(), settings.warmup_frame_count);
+            }
+            else if (name == "--report") {
+                settings.report_path = value_get();
+            }
+            else if (name == "--headless") {
+                settings.is_headless = true;
+            }
+            else if (name == "--vsync") {
+                settings.use_vsync = Utils::parse_switch(value_get(), settings.use_vsync);
+                is_vsync_set = true;
+            }
+            else if (name == "--render-thread") {
+                settings.use_render_thread = true;
+            }
+            else if (name == "--pipeline-depth") {
+                settings.pipeline_depth = std::clamp(Utils::parse_uint(value_get(), settings.pipeline_depth), 1u, max_pipeline_depth);
+            }
+            else if (name == "--target-fps") {
+                settings.target_frame_rate = Utils::parse_double(value_get(), 0.0);
+            }
+            else if (name == "--metrics") {
+                settings.metrics_path = value_get();
+            }
+            else if (name == "--metrics-socket") {
+                settings.metrics_socket_path = value_get();
+            }
+            else if (name == "--frame-goal") {
+                const std::string_view goal = value_get();
+                if (goal == "latency") {
+                    settings.frame_goal = FramePipelineController::Goal::latency;
+                }
+                else if (goal == "throughput") {
+                    settings.frame_goal = FramePipelineController::Goal::throughput;
+                }
+                else if (goal != "off") {
+                    DODO_LOG_WARNING_TAG("Engine", "Unknown frame goal: {0}.", goal);
+                }
+            }
+            else if (name == "--latency-target") {
+                settings.latency_target = Utils::parse_double(value_get(), settings.latency_target);
+            }
+            else if (name == "--submit-benchmark") {
+                settings.submit_benchmark_count = Utils::parse_uint(value_get(), settings.submit_benchmark_count);
+            }
+            else if (name == "--profile") {
+                settings.profile_path = value_get();
+            }
+            else if (name == "--record") {
+                settings.record_path = value_get();
+            }
+            else if (name == "--replay") {
+                settings.replay_path = value_get();
+            }
+            else if (name == "--replay-timing") {
+                const std::string_view timing = value_get();
+                if (timing == "original") {
+                    settings.replay_timing = InputPlayer::Timing::Original;
+                    is_replay_timing_set = true;
+                }
+                else if (timing == "step") {
+                    settings.replay_timing = InputPlayer::Timing::AsFastAsPossible;
+                    is_replay_timing_set = true;
+                }
+                else {
+                    DODO_LOG_WARNING_TAG("Engine", "Unknown replay timing: {0}.", timing);
+                }
+            }
+            else {
+                DODO_LOG_WARNING_TAG("Engine", "Unknown command line argument: {0}.", cmd_line_args[i]);
+            }
+        }
+
+        // With a target frame rate the pacer sets the pace, vsync would only add latency on top.
+        if (!is_vsync_set && (settings.target_frame_rate > 0.0)) {
+            settings.use_vsync = false;
+        }
+
+        // A benchmark replays by simulation step, so every run simulates the same input regardless of its frame rate.
+        if (!is_replay_timing_set && settings.is_benchmark) {
+            settings.replay_timing = InputPlayer::Timing::AsFastAsPossible;
+        }
+
+        if (!settings.record_path.empty() && !settings.replay_path.empty() && (settings.record_path == settings.replay_path)) {
+            DODO_LOG_WARNING_TAG("Engine", "Can not record to the replayed file {0}, recording is disabled.", settings.record_path.string());
+            settings.record_path.clear();
+        }
+
+        return settings;
+    }
+
+}
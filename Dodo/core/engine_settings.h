@@ -0,0 +1,64 @@
+#pragma once
+
+#include "frame_pipeline_controller.h"
+#include "Input/InputRecorder.h"
+
+namespace Dodo {
+
+    struct CommandLineArgs {
+        const int count = 0;
+        const char* const* values = nullptr;
+
+        const char* operator[](size_t index) const {
+            DODO_ASSERT(index < static_cast<size_t>(count));
+            return values[index];
+        }
+    };
+
+    // Everything that can be configured without touching the code. Flags take the
+    // form --name=value, --name value is accepted as well.
+    //
+    //     --benchmark             run a fixed number of frames, write a report and exit
+    //     --frames=N              measured benchmark frames
+    //     --warmup=N              benchmark frames run before measuring
+    //     --report=PATH           benchmark report, JSON
+    //     --headless              no window system, see DisplayHeadless
+    //     --vsync=on|off
+    //     --render-thread         submit and present on a dedicated thread
+    //     --pipeline-depth=N      frames in flight, 1 to 7
+    //     --target-fps=N          pace frames to a target rate, disables vsync unless set
+    //     --metrics=PATH          append metric snapshots to a JSON lines file
+    //     --metrics-socket=PATH   stream metric snapshots to a local socket
+    //     --frame-goal=GOAL       adapt frames in flight and present mode, off, latency or throughput
+    //     --latency-target=MS     frame latency the latency goal aims for
+    //     --submit-benchmark=N    time N empty submissions and exit, best run on a null driver
+    //     --profile=PATH          enable the CPU profiler and write a Chrome trace on exit
+    //     --record=PATH           record the input consumed by the simulation
+    //     --replay=PATH           replay recorded input instead of the live input, a benchmark ends with the replay
+    //     --replay-timing=TIMING  original or step, benchmarks default to step so they are deterministic
+    struct EngineSettings {
+        static constexpr uint32_t max_pipeline_depth = 7;
+
+        bool is_benchmark = false;
+        uint32_t benchmark_frame_count = 1000;
+        uint32_t warmup_frame_count = 100;
+        std::filesystem::path report_path = "dodo_benchmark.json";
+        bool is_headless = false;
+        bool use_vsync = true;
+        bool use_render_thread = false;
+        uint32_t pipeline_depth = 2;
+        double target_frame_rate = 0.0;
+        std::filesystem::path metrics_path = {};
+        std::filesystem::path metrics_socket_path = {};
+        FramePipelineController::Goal frame_goal = FramePipelineController::Goal::off;
+        double latency_target = 33.0;
+        uint32_t submit_benchmark_count = 0;
+        std::filesystem::path profile_path = {};
+        std::filesystem::path record_path = {};
+        std::filesystem::path replay_path = {};
+        InputPlayer::Timing replay_timing = InputPlayer::Timing::Original;
+
+        static EngineSettings from_command_line(const CommandLineArgs& cmd_line_args);
+    };
+
+}
@@ -1,7 +1,7 @@
-#pragma once
-
 #include "engine.h"
 #include "diagnostics/log.h"
+#include "diagnostics/profiler.h"
+#include "diagnostics/timer.h"
 
 ////////////////////////////////////////////////////////////////////
 // ENTRY POINT /////////////////////////////////////////////////////
@@ -10,6 +10,8 @@
 int main(int argc, char** argv)
 {
     Dodo::Log::init();
+    Dodo::Timer::init();
+    Dodo::Profiler::init();
 
     Dodo::Engine engine({ argc, argv });
     engine.iterate_main_loop();
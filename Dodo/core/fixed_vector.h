@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <utility>
+
+#include "core/core.h"
+
+namespace Dodo {
+
+    // Vector with inline storage for up to Capacity elements, it never allocates.
+    // Meant for short lists built on hot paths, e.g. the semaphores of a submission.
+    // Only pushed elements are constructed, an empty vector costs no more than its size.
+    template<typename T, size_t Capacity>
+    class FixedVector {
+    public:
+        static constexpr size_t capacity = Capacity;
+
+        FixedVector() {}
+        FixedVector(const FixedVector& other) { append(other); }
+        FixedVector& operator=(const FixedVector& other) {
+            if (this != &other) {
+                clear();
+                append(other);
+            }
+
+            return *this;
+        }
+
+        ~FixedVector() { clear(); }
+
+        // A full vector drops the value, which asserts in debug builds.
+        void push_back(const T& value) {
+            DODO_ASSERT(_size < Capacity);
+            if (_size < Capacity) {
+                new (data() + _size) T(value);
+                _size++;
+            }
+        }
+
+        // Constructs a value in place, the vector must not be full.
+        template<typename... Args>
+        T& emplace_back(Args&&... args) {
+            DODO_ASSERT(_size < Capacity);
+            T* value = new (data() + _size) T(std::forward<Args>(args)...);
+            _size++;
+            return *value;
+        }
+
+        // Appends as many values as fit, returns false when some were dropped.
+        bool append(std::span<const T> values) {
+            const size_t count = std::min(values.size(), Capacity - _size);
+            for (size_t i = 0; i < count; i++) {
+                new (data() + _size) T(values[i]);
+                _size++;
+            }
+
+            return count == values.size();
+        }
+
+        void clear() {
+            std::destroy_n(data(), _size);
+            _size = 0;
+        }
+
+        T& operator[](size_t index) {
+            DODO_ASSERT(index < _size);
+            return data()[index];
+        }
+
+        const T& operator[](size_t index) const {
+            DODO_ASSERT(index < _size);
+            return data()[index];
+        }
+
+        T* data() { return std::launder(reinterpret_cast<T*>(_storage)); }
+        const T* data() const { return std::launder(reinterpret_cast<const T*>(_storage)); }
+        size_t size() const { return _size; }
+        bool empty() const { return _size == 0; }
+        bool full() const { return _size == Capacity; }
+
+        T* begin() { return data(); }
+        T* end() { return data() + _size; }
+        const T* begin() const { return data(); }
+        const T* end() const { return data() + _size; }
+
+        operator std::span<T>() { return { data(), _size }; }
+        operator std::span<const T>() const { return { data(), _size }; }
+
+    private:
+        alignas(T) std::byte _storage[sizeof(T) * Capacity];
+        size_t _size = 0;
+    };
+}
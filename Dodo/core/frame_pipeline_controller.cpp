@@ -0,0 +1,120 @@
+#include "pch.h"
+#include "frame_pipeline_controller.h"
+
+namespace Dodo {
+
+    const char* FramePipelineController::to_string(Goal goal) {
+        switch (goal) {
+            case Goal::off       : return "off";
+            case Goal::latency   : return "latency";
+            case Goal::throughput: return "throughput";
+            default: break;
+        }
+
+        return "unknown";
+    }
+
+    void FramePipelineController::initialize(const Specifications& specs, const Configuration& configuration) {
+        DODO_ASSERT(specs.min_frames_in_flight <= specs.max_frames_in_flight);
+        _specs = specs;
+        _configuration = configuration;
+        _window = {};
+        _cool_down = 0;
+    }
+
+    void FramePipelineController::sample(double cpu_time, double gpu_time, double fence_wait_time, double latency) {
+        if (_specs.goal == Goal::off) {
+            return;
+        }
+
+        _window.frame_count++;
+        _window.cpu_time += cpu_time;
+        _window.fence_wait_time += fence_wait_time;
+        if (gpu_time >= 0.0) {
+            _window.gpu_time += gpu_time;
+            _window.gpu_sample_count++;
+        }
+
+        if (latency >= 0.0) {
+            _window.latency += latency;
+            _window.latency_sample_count++;
+        }
+    }
+
+    bool FramePipelineController::evaluate(Configuration& r_configuration) {
+        if (_window.frame_count < _specs.window_frame_count) {
+            return false;
+        }
+
+        const Window window = _window;
+        _window = {};
+        if (_cool_down > 0) {
+            // The window right after a change still contains frames of the old configuration.
+            _cool_down--;
+            return false;
+        }
+
+        const double frame_count = static_cast<double>(window.frame_count);
+        const double cpu_time = window.cpu_time / frame_count;
+        const double fence_wait_time = window.fence_wait_time / frame_count;
+        const double frame_time = cpu_time + fence_wait_time;
+        const double gpu_time = (window.gpu_sample_count > 0) ? (window.gpu_time / static_cast<double>(window.gpu_sample_count)) : frame_time;
+        const double latency = (window.latency_sample_count > 0) ? (window.latency / static_cast<double>(window.latency_sample_count)) : frame_time;
+
+        // The CPU stalls on fences although the GPU is not saturated, another frame in flight lets both overlap.
+        const bool is_pipeline_starved = (fence_wait_time > (0.1 * frame_time)) && (gpu_time < (0.9 * frame_time));
+
+        Configuration configuration = _configuration;
+        configuration.vsync_mode = _preferred_vsync_mode();
+        switch (_specs.goal) {
+            case Goal::latency: {
+                if ((latency > _specs.latency_target) && (configuration.frames_in_flight > _specs.min_frames_in_flight)) {
+                    configuration.frames_in_flight--;
+                }
+                else if ((latency < (0.7 * _specs.latency_target)) && is_pipeline_starved && (configuration.frames_in_flight < _specs.max_frames_in_flight)) {
+                    configuration.frames_in_flight++;
+                }
+
+                break;
+            }
+
+            case Goal::throughput: {
+                if (is_pipeline_starved && (configuration.frames_in_flight < _specs.max_frames_in_flight)) {
+                    configuration.frames_in_flight++;
+                }
+                else if ((fence_wait_time < (0.01 * frame_time)) && (configuration.frames_in_flight > _specs.min_frames_in_flight)) {
+                    // Nothing ever waits, the last frame in flight only adds latency.
+                    configuration.frames_in_flight--;
+                }
+
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        configuration.frames_in_flight = std::clamp(configuration.frames_in_flight, _specs.min_frames_in_flight, _specs.max_frames_in_flight);
+        if (configuration == _configuration) {
+            return false;
+        }
+
+        DODO_LOG_INFO_TAG("Engine", "Frame pipeline ({0}): cpu {1:.3f} ms, gpu {2:.3f} ms, fence wait {3:.3f} ms, latency {4:.3f} ms, {5} -> {6} frames in flight.",
+            to_string(_specs.goal), cpu_time, gpu_time, fence_wait_time, latency, _configuration.frames_in_flight, configuration.frames_in_flight);
+        _configuration = configuration;
+        _cool_down = _specs.cool_down_window_count;
+        r_configuration = configuration;
+        return true;
+    }
+
+    RenderBackend::VSyncMode FramePipelineController::_preferred_vsync_mode() const {
+        if (!_specs.use_vsync) {
+            return RenderBackend::VSyncMode::disabled;
+        }
+
+        // Mailbox shows the newest frame at the next vblank without blocking, FIFO
+        // queues frames and so trades latency for steady throughput.
+        return (_specs.goal == Goal::latency) ? RenderBackend::VSyncMode::mailbox : RenderBackend::VSyncMode::enabled;
+    }
+
+}
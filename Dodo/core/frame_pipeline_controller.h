@@ -0,0 +1,66 @@
+#pragma once
+
+#include "renderer/render_backend.h"
+
+namespace Dodo {
+
+    // Picks the number of frames in flight and the present mode from measured frame
+    // timings. Measurements are averaged over a window of frames and a change is
+    // followed by a cool down, so the configuration does not oscillate.
+    class FramePipelineController {
+    public:
+        enum class Goal {
+            off,
+            // Keep the frame latency below the target with as few frames in flight as possible.
+            latency,
+            // Keep the GPU busy, frames in flight grow while the CPU stalls on fences.
+            throughput
+        };
+
+        struct Specifications {
+            Goal goal = Goal::off;
+            double latency_target = 33.0;
+            uint32_t min_frames_in_flight = 2;
+            uint32_t max_frames_in_flight = 4;
+            uint32_t window_frame_count = 120;
+            uint32_t cool_down_window_count = 2;
+            // Whether the user allows tearing, present modes are only picked within this choice.
+            bool use_vsync = true;
+        };
+
+        struct Configuration {
+            uint32_t frames_in_flight = 2;
+            RenderBackend::VSyncMode vsync_mode = RenderBackend::VSyncMode::enabled;
+
+            bool operator==(const Configuration& other) const = default;
+        };
+
+        static const char* to_string(Goal goal);
+
+        void initialize(const Specifications& specs, const Configuration& configuration);
+        // Negative GPU time or latency means the value is not available this frame.
+        void sample(double cpu_time, double gpu_time, double fence_wait_time, double latency);
+        // Returns true once per window when the configuration should change.
+        bool evaluate(Configuration& r_configuration);
+        const Configuration& configuration_get() const { return _configuration; }
+
+    private:
+        struct Window {
+            uint32_t frame_count = 0;
+            double cpu_time = 0.0;
+            double fence_wait_time = 0.0;
+            double gpu_time = 0.0;
+            uint32_t gpu_sample_count = 0;
+            double latency = 0.0;
+            uint32_t latency_sample_count = 0;
+        };
+
+        RenderBackend::VSyncMode _preferred_vsync_mode() const;
+
+        Specifications _specs = {};
+        Configuration _configuration = {};
+        Window _window = {};
+        uint32_t _cool_down = 0;
+    };
+
+}
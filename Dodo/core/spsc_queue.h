@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "core/core.h"
+
+namespace Dodo {
+
+    // Bounded lock-free ring for exactly one producer and one consumer thread.
+    // Head and tail live on separate cache lines so both sides do not false share.
+    template<typename T, size_t Capacity>
+    class SpscQueue {
+        static_assert((Capacity > 0) && ((Capacity & (Capacity - 1)) == 0), "Capacity must be a power of two.");
+
+    public:
+        static constexpr size_t capacity = Capacity;
+
+        // Producer only, returns false when the queue is full.
+        bool push(const T& value) {
+            const size_t tail = _tail.load(std::memory_order_relaxed);
+            if ((tail - _head_cache) == Capacity) {
+                _head_cache = _head.load(std::memory_order_acquire);
+                if ((tail - _head_cache) == Capacity) {
+                    return false;
+                }
+            }
+
+            _data[tail & (Capacity - 1)] = value;
+            _tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer only, returns nullptr when the queue is empty.
+        const T* front() {
+            const size_t head = _head.load(std::memory_order_relaxed);
+            if (head == _tail_cache) {
+                _tail_cache = _tail.load(std::memory_order_acquire);
+                if (head == _tail_cache) {
+                    return nullptr;
+                }
+            }
+
+            return &_data[head & (Capacity - 1)];
+        }
+
+        // Consumer only, must follow a successful front().
+        void pop() {
+            _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        // Consumer only.
+        bool pop(T& r_value) {
+            const T* value = front();
+            if (!value) {
+                return false;
+            }
+
+            r_value = *value;
+            pop();
+            return true;
+        }
+
+        size_t size_approx() const {
+            return _tail.load(std::memory_order_relaxed) - _head.load(std::memory_order_relaxed);
+        }
+
+    private:
+        static constexpr size_t cache_line_size = 64;
+
+        alignas(cache_line_size) std::atomic<size_t> _head = 0;
+        size_t _tail_cache = 0;
+        alignas(cache_line_size) std::atomic<size_t> _tail = 0;
+        size_t _head_cache = 0;
+        alignas(cache_line_size) std::array<T, Capacity> _data = {};
+    };
+
+}
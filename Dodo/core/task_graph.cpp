@@ -0,0 +1,97 @@
+#include "pch.h"
+#include "task_graph.h"
+
+#include "diagnostics/timer.h"
+
+namespace Dodo {
+
+    TaskGraph::NodeId TaskGraph::node_add(const std::string& name, std::function<void()>&& work, std::initializer_list<NodeId> dependencies, Affinity affinity) {
+        const auto node_id = static_cast<NodeId>(_nodes.size());
+        auto node = std::make_unique<Node>();
+        node->name = name;
+        node->profile_name = Profiler::name_intern(name);
+        node->work = std::move(work);
+        node->affinity = affinity;
+        for (const NodeId dependency : dependencies) {
+            DODO_ASSERT(dependency < node_id);
+            _nodes.at(dependency)->dependents.push_back(node_id);
+            node->dependency_count++;
+        }
+
+        _nodes.push_back(std::move(node));
+        return node_id;
+    }
+
+    void TaskGraph::execute(ThreadPool& thread_pool) {
+        DODO_PROFILE_SCOPE("TaskGraph::execute");
+        _thread_pool = &thread_pool;
+        _completed_count = 0;
+        for (const auto& node : _nodes) {
+            node->remaining_dependency_count.store(node->dependency_count, std::memory_order_relaxed);
+        }
+
+        for (NodeId i = 0; i < _nodes.size(); i++) {
+            if (_nodes.at(i)->dependency_count == 0) {
+                _schedule(i);
+            }
+        }
+
+        // The calling thread runs main thread nodes until the whole graph completed.
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            _condition_var.wait(lock, [this]() -> bool { return !_main_thread_nodes.empty() || (_completed_count == _nodes.size()); });
+            if (_main_thread_nodes.empty()) {
+                break;
+            }
+
+            const NodeId node_id = _main_thread_nodes.front();
+            _main_thread_nodes.pop();
+            lock.unlock();
+            _run(node_id);
+            lock.lock();
+        }
+    }
+
+    std::vector<TaskGraph::NodeTiming> TaskGraph::timings_get() const {
+        std::vector<NodeTiming> timings = {};
+        timings.reserve(_nodes.size());
+        for (const auto& node : _nodes) {
+            timings.push_back({ node->name, node->begin, node->end });
+        }
+
+        return timings;
+    }
+
+    void TaskGraph::_schedule(NodeId node_id) {
+        Node& node = *_nodes.at(node_id);
+        if (node.affinity == Affinity::main_thread) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _main_thread_nodes.push(node_id);
+            _condition_var.notify_all();
+            return;
+        }
+
+        _thread_pool->add_task([this, node_id](void*) { _run(node_id); });
+    }
+
+    void TaskGraph::_run(NodeId node_id) {
+        Node& node = *_nodes.at(node_id);
+        node.begin = Timer::now();
+        {
+            DODO_PROFILE_SCOPE(node.profile_name);
+            node.work();
+        }
+
+        node.end = Timer::now();
+        for (const NodeId dependent : node.dependents) {
+            if (_nodes.at(dependent)->remaining_dependency_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                _schedule(dependent);
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _completed_count++;
+        _condition_var.notify_all();
+    }
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "thread_pool.h"
+
+namespace Dodo {
+
+    // A one-shot graph of tasks executed on the thread pool. A node starts as soon
+    // as all of its dependencies completed. Nodes with main thread affinity, e.g.
+    // creating windows, run on the thread that calls execute.
+    class TaskGraph {
+    public:
+        using NodeId = uint32_t;
+
+        enum class Affinity {
+            any,
+            main_thread
+        };
+
+        struct NodeTiming {
+            std::string name = {};
+            uint64_t begin = 0;
+            uint64_t end = 0;
+        };
+
+        // Dependencies must be added before the node, so the graph can not contain cycles.
+        NodeId node_add(const std::string& name, std::function<void()>&& work, std::initializer_list<NodeId> dependencies = {}, Affinity affinity = Affinity::any);
+        // Blocks until every node completed.
+        void execute(ThreadPool& thread_pool);
+        // Begin and end in Timer ticks, valid after execute.
+        std::vector<NodeTiming> timings_get() const;
+
+    private:
+        struct Node {
+            std::string name = {};
+            // Interned once when added, so running the node does not take the profiler lock.
+            const char* profile_name = nullptr;
+            std::function<void()> work = {};
+            Affinity affinity = Affinity::any;
+            std::vector<NodeId> dependents = {};
+            uint32_t dependency_count = 0;
+            std::atomic<uint32_t> remaining_dependency_count = 0;
+            uint64_t begin = 0;
+            uint64_t end = 0;
+        };
+
+        void _schedule(NodeId node_id);
+        void _run(NodeId node_id);
+
+        ThreadPool* _thread_pool = nullptr;
+        std::vector<std::unique_ptr<Node>> _nodes = {};
+        std::mutex _mutex = {};
+        std::condition_variable _condition_var = {};
+        std::queue<NodeId> _main_thread_nodes = {};
+        size_t _completed_count = 0;
+    };
+
+}
@@ -3,6 +3,8 @@
 
 namespace Dodo {
 
+    static thread_local uint32_t s_worker_thread_index = UINT32_MAX;
+
     ThreadPool::ThreadPool() {
         instance = this;
         const uint32_t max_thread_count = std::thread::hardware_concurrency();
@@ -10,6 +12,8 @@ namespace Dodo {
         threads.reserve(thread_count);
         for (size_t i = 0; i < thread_count; i++) {
             threads.emplace_back([this, i]() {
+                DODO_PROFILE_THREAD(std::format("Worker {0}", i));
+                s_worker_thread_index = static_cast<uint32_t>(i);
                 std::shared_ptr<Task> task = nullptr;
                 while (true) {
                     {
@@ -21,7 +25,6 @@ namespace Dodo {
 
                         task = task_queue.front();
                         task_queue.pop();
-                        tasks[task->id] = task;
                     }
 
                     process_task(task);
@@ -46,14 +49,24 @@ namespace Dodo {
         }
     }
 
-    ThreadPool::TaskId ThreadPool::add_task(Callable&& callable, const std::string& description, void* user_data) {
+    uint32_t ThreadPool::thread_index_get() const {
+        return (s_worker_thread_index < threads.size()) ? s_worker_thread_index : thread_count_get();
+    }
+
+    ThreadPool::TaskId ThreadPool::add_task(Callable&& callable, std::string_view description, void* user_data) {
         auto task = std::make_shared<Task>();
-        task->id = current_task_id++;
         task->callable = callable;
-        task->description = description;
+        // Interning takes the profiler lock, so tasks only pay for it while profiling.
+        if (Profiler::is_enabled() && !description.empty()) {
+            task->description = Profiler::name_intern(description);
+        }
+
         task->user_data = user_data;
 
         std::unique_lock<std::mutex> lock(mutex);
+        // Registered right away, a task that can not be found has already completed.
+        task->id = current_task_id++;
+        tasks[task->id] = task;
         task_queue.push(task);
         condition_var.notify_one();
 
@@ -66,15 +79,27 @@ namespace Dodo {
             std::unique_lock<std::mutex> lock(task->mutex);
             task->waiting_user_count++;
             task->condition_var.wait(lock, [task]() -> bool { return task->completed; });
-            remove_task(task_id);
         }
     }
 
+    void ThreadPool::wait_for_idle() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle_condition_var.wait(lock, [this]() -> bool { return tasks.empty(); });
+    }
+
     void ThreadPool::process_task(std::shared_ptr<Task> task) {
-        task->callable(task->user_data);
+        {
+            DODO_PROFILE_SCOPE(task->description ? task->description : "ThreadPool::process_task");
+            task->callable(task->user_data);
+        }
+
+        DODO_METRIC_COUNTER_ADD("thread_pool.tasks_executed", 1);
+
+        remove_task(task->id);
+
         // Task done!
-        task->completed = true;
         std::unique_lock<std::mutex> lock(task->mutex);
+        task->completed = true;
         if (task->waiting_user_count > 0) {
             task->condition_var.notify_all();
         }
@@ -90,6 +115,10 @@ namespace Dodo {
         if (tasks.contains(task_id)) {
             tasks.erase(task_id);
         }
+
+        if (tasks.empty()) {
+            idle_condition_var.notify_all();
+        }
     }
 
 }
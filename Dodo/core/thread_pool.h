@@ -15,14 +15,22 @@ namespace Dodo {
         ThreadPool();
         ~ThreadPool();
 
-        TaskId add_task(Callable&& callable, const std::string& description = "", void* user_data = nullptr);
+        // The description names the task in profiles.
+        TaskId add_task(Callable&& callable, std::string_view description = {}, void* user_data = nullptr);
         void wait_on_task_to_complete(TaskId task_id);
+        // Blocks until every task completed, including tasks added while waiting.
+        void wait_for_idle();
+
+        uint32_t thread_count_get() const { return static_cast<uint32_t>(threads.size()); }
+        // Index of the calling worker thread, thread_count_get() for any thread outside the pool.
+        uint32_t thread_index_get() const;
 
     private:
         struct Task {
             TaskId id = 0;
             Callable callable{};
-            std::string description{};
+            // Interned when the task was added while profiling, nullptr otherwise.
+            const char* description = nullptr;
             void* user_data = nullptr;
             bool completed = false;
             std::mutex mutex{};
@@ -39,6 +47,7 @@ namespace Dodo {
         std::vector<std::thread::native_handle_type> thread_handles{};
         std::mutex mutex{};
         std::condition_variable condition_var{};
+        std::condition_variable idle_condition_var{};
         bool stop = false;
         std::queue<std::shared_ptr<Task>> task_queue{};
         TaskId current_task_id = 0;
@@ -10,15 +10,22 @@ namespace Dodo {
 
     void Stopwatch::Now()
     {
-        m_StartTime = std::chrono::steady_clock::now();
+        m_StartTicks = Timer::now();
+    }
+
+    uint64_t Stopwatch::get_ticks() const
+    {
+        return Timer::now() - m_StartTicks;
+    }
+
+    uint64_t Stopwatch::get_nanoseconds() const
+    {
+        return Timer::ticks_to_nanoseconds(get_ticks());
     }
 
     double Stopwatch::get_milliseconds() const
     {
-        const auto stopTime = std::chrono::steady_clock::now();
-        using Nanoseconds = std::chrono::nanoseconds;
-        const auto duration = std::chrono::duration_cast<Nanoseconds>(stopTime - m_StartTime);
-        return static_cast<double>(duration.count()) * 1.0E-6;
+        return Timer::ticks_to_milliseconds(get_ticks());
     }
 
     double Stopwatch::GetSeconds() const
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "timer.h"
+
 namespace Dodo {
 
     class Stopwatch
@@ -8,11 +10,13 @@ namespace Dodo {
         Stopwatch();
 
         void Now();
+        uint64_t get_ticks() const;
+        uint64_t get_nanoseconds() const;
         double get_milliseconds() const;
         double GetSeconds() const;
 
     private:
-        std::chrono::steady_clock::time_point m_StartTime{};
+        uint64_t m_StartTicks = 0;
     };
 
 }
\ No newline at end of file
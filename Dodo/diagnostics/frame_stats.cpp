@@ -0,0 +1,188 @@
+#include "pch.h"
+#include "frame_stats.h"
+
+#include <cmath>
+
+namespace Dodo {
+
+    namespace Utils {
+
+        static constexpr float no_sample = -1.0f;
+
+        static double percentile_of_sorted(const std::vector<float>& sorted, double percentile) {
+            // Nearest-rank method.
+            const auto rank = static_cast<size_t>(std::ceil(percentile * static_cast<double>(sorted.size())));
+            return static_cast<double>(sorted.at(std::clamp<size_t>(rank, 1, sorted.size()) - 1));
+        }
+
+    }
+
+    const char* FrameStats::to_string(Metric metric) {
+        switch (metric) {
+            case Metric::cpu_frame_time  : return "cpu_frame_time";
+            case Metric::gpu_frame_time  : return "gpu_frame_time";
+            case Metric::fence_wait_time : return "fence_wait_time";
+            case Metric::present_interval: return "present_interval";
+            case Metric::frame_latency   : return "frame_latency";
+            default: break;
+        }
+
+        return "unknown";
+    }
+
+    FrameStats::FrameStats()
+        : FrameStats(Specifications{}) {}
+
+    FrameStats::FrameStats(const Specifications& specs)
+        : _specs(specs) {
+        DODO_ASSERT((_specs.history_capacity > 0) && (_specs.histogram_bucket_width > 0.0));
+        _frames.resize(_specs.history_capacity);
+        _scratch.reserve(_specs.history_capacity);
+        reset();
+    }
+
+    void FrameStats::record(Metric metric, double milliseconds) {
+        const auto metric_index = static_cast<size_t>(metric);
+        DODO_ASSERT(metric_index < metric_count);
+        _current.at(metric_index) = static_cast<float>(milliseconds);
+
+        Histogram& histogram = _histograms.at(metric_index);
+        const double bucket = std::max(milliseconds, 0.0) / histogram.bucket_width;
+        if (bucket < static_cast<double>(histogram.buckets.size())) {
+            histogram.buckets.at(static_cast<size_t>(bucket))++;
+        }
+        else {
+            histogram.overflow++;
+        }
+    }
+
+    void FrameStats::end_frame() {
+        _frames.at(_frame_count % _specs.history_capacity) = _current;
+        _frame_count++;
+        _current.fill(Utils::no_sample);
+        if ((_specs.summary_interval > 0) && ((_frame_count % _specs.summary_interval) == 0)) {
+            log_summary(true);
+        }
+    }
+
+    void FrameStats::reset() {
+        _current.fill(Utils::no_sample);
+        _frame_count = 0;
+        for (Histogram& histogram : _histograms) {
+            histogram.bucket_width = _specs.histogram_bucket_width;
+            histogram.buckets.assign(_specs.histogram_bucket_count, 0);
+            histogram.overflow = 0;
+        }
+    }
+
+    FrameStats::Summary FrameStats::summary_get(Metric metric, bool rolling) const {
+        const auto metric_index = static_cast<size_t>(metric);
+        const size_t history_size = _history_size_get();
+        const size_t first = (rolling && (history_size > _specs.rolling_window_size)) ? (history_size - _specs.rolling_window_size) : 0;
+        _scratch.clear();
+        for (size_t i = first; i < history_size; i++) {
+            const float sample = _history_get(i).at(metric_index);
+            if (sample != Utils::no_sample) {
+                _scratch.push_back(sample);
+            }
+        }
+
+        Summary summary = {};
+        if (_scratch.empty()) {
+            return summary;
+        }
+
+        std::sort(_scratch.begin(), _scratch.end());
+        double sum = 0.0;
+        for (const float sample : _scratch) {
+            sum += static_cast<double>(sample);
+        }
+
+        summary.sample_count = _scratch.size();
+        summary.min = static_cast<double>(_scratch.front());
+        summary.max = static_cast<double>(_scratch.back());
+        summary.mean = sum / static_cast<double>(_scratch.size());
+        summary.p50 = Utils::percentile_of_sorted(_scratch, 0.50);
+        summary.p95 = Utils::percentile_of_sorted(_scratch, 0.95);
+        summary.p99 = Utils::percentile_of_sorted(_scratch, 0.99);
+        return summary;
+    }
+
+    const FrameStats::Histogram& FrameStats::histogram_get(Metric metric) const {
+        return _histograms.at(static_cast<size_t>(metric));
+    }
+
+    void FrameStats::log_summary(bool rolling) const {
+        DODO_LOG_INFO_TAG("Engine", "Frame statistics ({0} frames, {1})...", _frame_count, rolling ? "rolling" : "total");
+        for (size_t i = 0; i < metric_count; i++) {
+            const auto metric = static_cast<Metric>(i);
+            const Summary summary = summary_get(metric, rolling);
+            if (summary.sample_count == 0) {
+                continue;
+            }
+
+            DODO_LOG_INFO_TAG("Engine", "    {0}: p50 {1:.3f} ms, p95 {2:.3f} ms, p99 {3:.3f} ms, max {4:.3f} ms.",
+                to_string(metric), summary.p50, summary.p95, summary.p99, summary.max);
+        }
+    }
+
+    bool FrameStats::write_report(const std::filesystem::path& file_path) const {
+        std::ofstream os(file_path, std::ios::trunc);
+        if (!os) {
+            DODO_LOG_ERROR("Failed to write frame statistics: {0}.", file_path.string());
+            return false;
+        }
+
+        return (file_path.extension() == ".csv") ? _write_csv(os) : _write_json(os);
+    }
+
+    const FrameStats::FrameSamples& FrameStats::_history_get(size_t index) const {
+        const uint64_t first = _frame_count - _history_size_get();
+        return _frames.at((first + index) % _specs.history_capacity);
+    }
+
+    bool FrameStats::_write_json(std::ostream& os) const {
+        os << "{\n    \"frame_count\": " << _frame_count << ",\n    \"history_frame_count\": " << _history_size_get() << ",\n    \"metrics\": {";
+        for (size_t i = 0; i < metric_count; i++) {
+            const auto metric = static_cast<Metric>(i);
+            const Summary summary = summary_get(metric, false);
+            os << (i == 0 ? "\n" : ",\n");
+            os << std::format("        \"{}\": {{\"samples\": {}, \"min\": {:.4f}, \"mean\": {:.4f}, \"max\": {:.4f}, \"p50\": {:.4f}, \"p95\": {:.4f}, \"p99\": {:.4f}, ",
+                to_string(metric), summary.sample_count, summary.min, summary.mean, summary.max, summary.p50, summary.p95, summary.p99);
+            const Histogram& histogram = _histograms.at(i);
+            os << std::format("\"histogram\": {{\"bucket_width_ms\": {}, \"overflow\": {}, \"buckets\": [", histogram.bucket_width, histogram.overflow);
+            for (size_t j = 0; j < histogram.buckets.size(); j++) {
+                os << (j == 0 ? "" : ", ") << histogram.buckets.at(j);
+            }
+
+            os << "]}}";
+        }
+
+        os << "\n    }\n}\n";
+        return os.good();
+    }
+
+    bool FrameStats::_write_csv(std::ostream& os) const {
+        os << "frame";
+        for (size_t i = 0; i < metric_count; i++) {
+            os << "," << to_string(static_cast<Metric>(i));
+        }
+
+        os << "\n";
+        const uint64_t first = _frame_count - _history_size_get();
+        for (size_t frame = 0; frame < _history_size_get(); frame++) {
+            os << (first + frame);
+            for (const float sample : _history_get(frame)) {
+                os << ",";
+                if (sample != Utils::no_sample) {
+                    os << std::format("{:.4f}", sample);
+                }
+            }
+
+            os << "\n";
+        }
+
+        return os.good();
+    }
+
+}
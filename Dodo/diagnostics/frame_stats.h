@@ -0,0 +1,77 @@
+#pragma once
+
+namespace Dodo {
+
+    class FrameStats {
+    public:
+        enum class Metric {
+            cpu_frame_time,
+            gpu_frame_time,
+            fence_wait_time,
+            present_interval,
+            frame_latency,
+            auto_count
+        };
+
+        static constexpr size_t metric_count = static_cast<size_t>(Metric::auto_count);
+
+        struct Summary {
+            size_t sample_count = 0;
+            double min = 0.0;
+            double mean = 0.0;
+            double max = 0.0;
+            double p50 = 0.0;
+            double p95 = 0.0;
+            double p99 = 0.0;
+        };
+
+        struct Specifications {
+            size_t rolling_window_size = 600;
+            uint32_t summary_interval = 600;
+            // Frames kept for percentiles and the CSV report, older frames get
+            // overwritten. Histograms keep counting every frame.
+            size_t history_capacity = 1 << 16;
+            double histogram_bucket_width = 0.5;
+            size_t histogram_bucket_count = 100;
+        };
+
+        // Fixed width buckets in milliseconds, samples past the last bucket are
+        // counted as overflow.
+        struct Histogram {
+            double bucket_width = 0.0;
+            std::vector<uint64_t> buckets = {};
+            uint64_t overflow = 0;
+        };
+
+        static const char* to_string(Metric metric);
+
+        FrameStats();
+        explicit FrameStats(const Specifications& specs);
+
+        void record(Metric metric, double milliseconds);
+        void end_frame();
+        void reset();
+        uint64_t frame_count_get() const { return _frame_count; }
+        Summary summary_get(Metric metric, bool rolling) const;
+        const Histogram& histogram_get(Metric metric) const;
+        void log_summary(bool rolling) const;
+        bool write_report(const std::filesystem::path& file_path) const;
+
+    private:
+        using FrameSamples = std::array<float, metric_count>;
+
+        size_t _history_size_get() const { return std::min<size_t>(_frame_count, _specs.history_capacity); }
+        // Index 0 is the oldest frame still in the history.
+        const FrameSamples& _history_get(size_t index) const;
+        bool _write_json(std::ostream& os) const;
+        bool _write_csv(std::ostream& os) const;
+
+        Specifications _specs = {};
+        FrameSamples _current = {};
+        std::vector<FrameSamples> _frames = {};
+        uint64_t _frame_count = 0;
+        std::array<Histogram, metric_count> _histograms = {};
+        mutable std::vector<float> _scratch = {};
+    };
+
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <ostream>
+#include <string_view>
+
+namespace Dodo {
+
+    // Writes text as the contents of a JSON string, without the surrounding quotes.
+    inline void json_write_escaped(std::ostream& os, std::string_view text) {
+        static constexpr char hex_digits[] = "0123456789abcdef";
+        for (const char character : text) {
+            switch (character) {
+                case '"' : os << "\\\""; break;
+                case '\\': os << "\\\\"; break;
+                case '\n': os << "\\n" ; break;
+                case '\r': os << "\\r" ; break;
+                case '\t': os << "\\t" ; break;
+                default:
+                    if (static_cast<unsigned char>(character) < 0x20) {
+                        os << "\\u00" << hex_digits[(character >> 4) & 0xF] << hex_digits[character & 0xF];
+                    }
+                    else {
+                        os << character;
+                    }
+                    break;
+            }
+        }
+    }
+
+}
@@ -12,6 +12,7 @@ namespace Dodo {
     static Log::TagDetailsMap s_default_tag_settings
     {
         { "Renderer", Log::TagDetails{ true, Log::Level::trace }},
+        { "Engine"  , Log::TagDetails{ true, Log::Level::trace }},
     };
 
     void Log::init()
@@ -2,6 +2,8 @@
 
 #include <spdlog/spdlog.h>
 
+#include "metrics.h"
+
 namespace Dodo {
 
     class Log
@@ -68,6 +70,7 @@ namespace Dodo {
     {
         if (!has_tag(tag))
         {
+            DODO_METRIC_COUNTER_ADD("log.records_dropped", 1);
             print_message(Level::warning, "Tag [{0}] is not enabled or doesn't exist!", tag);
             return;
         }
@@ -78,6 +81,10 @@ namespace Dodo {
             const std::string message = std::format(format, std::forward<Args>(args)...);
             print_message(level, "[{0}] {1}", tag, message);
         }
+        else
+        {
+            DODO_METRIC_COUNTER_ADD("log.records_dropped", 1);
+        }
     }
 
 }
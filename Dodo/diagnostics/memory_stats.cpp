@@ -0,0 +1,37 @@
+#include "pch.h"
+#include "memory_stats.h"
+
+#if defined(DODO_WINDOWS)
+#   include <Windows.h>
+#   include <psapi.h>
+#elif defined(DODO_LINUX)
+#   include <unistd.h>
+#endif
+
+namespace Dodo {
+
+    MemoryStats MemoryStats::query() {
+        MemoryStats stats = {};
+#if defined(DODO_WINDOWS)
+        PROCESS_MEMORY_COUNTERS counters = {};
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            stats.resident_bytes = static_cast<uint64_t>(counters.WorkingSetSize);
+            stats.peak_resident_bytes = static_cast<uint64_t>(counters.PeakWorkingSetSize);
+        }
+#elif defined(DODO_LINUX)
+        // VmRSS and VmHWM are the current and peak resident set size in kB.
+        std::ifstream status("/proc/self/status");
+        std::string line = {};
+        while (std::getline(status, line)) {
+            if (line.starts_with("VmRSS:")) {
+                stats.resident_bytes = std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+            }
+            else if (line.starts_with("VmHWM:")) {
+                stats.peak_resident_bytes = std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+            }
+        }
+#endif
+        return stats;
+    }
+
+}
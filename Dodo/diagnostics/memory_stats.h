@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Dodo {
+
+    // Process wide memory usage as reported by the OS.
+    struct MemoryStats {
+        uint64_t resident_bytes = 0;
+        uint64_t peak_resident_bytes = 0;
+
+        static MemoryStats query();
+    };
+
+}
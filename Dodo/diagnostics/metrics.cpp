@@ -0,0 +1,271 @@
+#include "pch.h"
+#include "metrics.h"
+
+#include <sstream>
+
+#include "diagnostics/json.h"
+
+#ifdef DODO_LINUX
+#   include <fcntl.h>
+#   include <sys/socket.h>
+#   include <sys/un.h>
+#   include <unistd.h>
+#endif
+
+namespace Dodo {
+
+    namespace Utils {
+
+        static const char* metric_type_to_string(Metrics::Type type) {
+            switch (type) {
+                case Metrics::Type::counter  : return "counter";
+                case Metrics::Type::gauge    : return "gauge";
+                case Metrics::Type::histogram: return "histogram";
+                default                      : return "unknown";
+            }
+        }
+
+    }
+
+    ////////////////////////////////////////////////////////////////
+    // METRICS /////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    struct MetricsOutputs {
+        std::ofstream file = {};
+#ifdef DODO_LINUX
+        std::filesystem::path socket_path = {};
+        int listen_socket = -1;
+        std::vector<int> client_sockets = {};
+#endif
+    };
+
+    static MetricsOutputs& get_outputs() {
+        static MetricsOutputs s_outputs{};
+        return s_outputs;
+    }
+
+    Metrics::MetricId Metrics::counter_register(std::string_view name) {
+        return _register(name, Type::counter, max_counter_count);
+    }
+
+    Metrics::MetricId Metrics::gauge_register(std::string_view name) {
+        return _register(name, Type::gauge, max_gauge_count);
+    }
+
+    Metrics::MetricId Metrics::histogram_register(std::string_view name) {
+        return _register(name, Type::histogram, max_histogram_count);
+    }
+
+    Metrics::Snapshot Metrics::snapshot_take() {
+        DODO_PROFILE_SCOPE("Metrics::snapshot_take");
+        Snapshot snapshot = {};
+        snapshot.frame = s_frame;
+        snapshot.timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+
+        std::unique_lock<std::mutex> lock(s_mutex);
+        snapshot.entries.reserve(s_descriptors.size());
+        for (const Descriptor& descriptor : s_descriptors) {
+            Snapshot::Entry& entry = snapshot.entries.emplace_back();
+            entry.name = descriptor.name;
+            entry.type = descriptor.type;
+            switch (descriptor.type) {
+                case Type::counter: {
+                    uint64_t value = 0;
+                    for (const auto& shard : s_shards) {
+                        value += shard->counters[descriptor.index].load(std::memory_order_relaxed);
+                    }
+
+                    entry.value = static_cast<double>(value);
+                    break;
+                }
+
+                case Type::gauge: {
+                    entry.value = s_gauges[descriptor.index].load(std::memory_order_relaxed);
+                    break;
+                }
+
+                case Type::histogram: {
+                    uint64_t sample_count = 0;
+                    for (const auto& shard : s_shards) {
+                        for (size_t i = 0; i < histogram_bucket_count; i++) {
+                            const uint64_t count = shard->histograms[descriptor.index][i].load(std::memory_order_relaxed);
+                            entry.buckets.at(i) += count;
+                            sample_count += count;
+                        }
+                    }
+
+                    entry.value = static_cast<double>(sample_count);
+                    break;
+                }
+            }
+        }
+
+        return snapshot;
+    }
+
+    bool Metrics::output_file_open(const std::filesystem::path& file_path) {
+        MetricsOutputs& outputs = get_outputs();
+        outputs.file = std::ofstream(file_path, std::ios::trunc);
+        if (!outputs.file) {
+            DODO_LOG_ERROR("Failed to open metrics output: {0}.", file_path.string());
+            return false;
+        }
+
+        return true;
+    }
+
+    bool Metrics::output_socket_open(const std::filesystem::path& socket_path) {
+#ifdef DODO_LINUX
+        MetricsOutputs& outputs = get_outputs();
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        const std::string path = socket_path.string();
+        if (path.size() >= sizeof(address.sun_path)) {
+            DODO_LOG_ERROR("Metrics socket path is too long: {0}.", path);
+            return false;
+        }
+
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        const int listen_socket = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listen_socket < 0) {
+            DODO_LOG_ERROR("Failed to create metrics socket: {0}.", path);
+            return false;
+        }
+
+        unlink(path.c_str());
+        if ((bind(listen_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) || (listen(listen_socket, 4) != 0)) {
+            DODO_LOG_ERROR("Failed to listen on metrics socket: {0}.", path);
+            close(listen_socket);
+            return false;
+        }
+
+        outputs.socket_path = socket_path;
+        outputs.listen_socket = listen_socket;
+        return true;
+#else
+        DODO_LOG_WARNING("Metrics sockets are not supported on this platform.");
+        return false;
+#endif
+    }
+
+    void Metrics::outputs_close() {
+        MetricsOutputs& outputs = get_outputs();
+        outputs.file.close();
+#ifdef DODO_LINUX
+        for (const int client_socket : outputs.client_sockets) {
+            close(client_socket);
+        }
+
+        outputs.client_sockets.clear();
+        if (outputs.listen_socket >= 0) {
+            close(outputs.listen_socket);
+            unlink(outputs.socket_path.string().c_str());
+            outputs.listen_socket = -1;
+        }
+#endif
+    }
+
+    void Metrics::end_frame() {
+        s_frame++;
+        if ((s_snapshot_interval > 0) && ((s_frame % s_snapshot_interval) == 0)) {
+            _write_snapshot(snapshot_take());
+        }
+    }
+
+    Metrics::MetricId Metrics::_register(std::string_view name, Type type, size_t max_count) {
+        std::unique_lock<std::mutex> lock(s_mutex);
+        for (const Descriptor& descriptor : s_descriptors) {
+            if (descriptor.name == name) {
+                DODO_ASSERT(descriptor.type == type);
+                return (descriptor.type == type) ? descriptor.index : invalid_metric;
+            }
+        }
+
+        size_t& type_count = s_type_counts.at(static_cast<size_t>(type));
+        if (type_count >= max_count) {
+            DODO_LOG_ERROR("Too many metrics of type {0}, {1} is ignored.", Utils::metric_type_to_string(type), name);
+            return invalid_metric;
+        }
+
+        Descriptor descriptor = {};
+        descriptor.name = name;
+        descriptor.type = type;
+        descriptor.index = static_cast<MetricId>(type_count++);
+        s_descriptors.push_back(descriptor);
+        return descriptor.index;
+    }
+
+    Metrics::Shard* Metrics::_shard_register() {
+        std::unique_lock<std::mutex> lock(s_mutex);
+        s_shards.push_back(std::make_unique<Shard>());
+        return s_shards.back().get();
+    }
+
+    void Metrics::_write_snapshot(const Snapshot& snapshot) {
+        DODO_PROFILE_SCOPE("Metrics::write_snapshot");
+        // One JSON object per line so scrapers can split the stream on newlines.
+        std::ostringstream os;
+        os << "{\"frame\":" << snapshot.frame << ",\"timestamp_ms\":" << snapshot.timestamp << ",\"metrics\":[";
+        for (size_t i = 0; i < snapshot.entries.size(); i++) {
+            const Snapshot::Entry& entry = snapshot.entries.at(i);
+            os << (i == 0 ? "" : ",") << "{\"name\":\"";
+            json_write_escaped(os, entry.name);
+            os << "\",\"type\":\"" << Utils::metric_type_to_string(entry.type) << "\",\"value\":" << entry.value;
+            if (entry.type == Type::histogram) {
+                // Only non-empty buckets, keyed by their exclusive upper bound.
+                os << ",\"buckets\":{";
+                bool first_bucket = true;
+                for (size_t j = 0; j < histogram_bucket_count; j++) {
+                    if (entry.buckets.at(j) == 0) {
+                        continue;
+                    }
+
+                    const uint64_t upper_bound = (j < 64) ? (uint64_t(1) << j) : UINT64_MAX;
+                    os << (first_bucket ? "" : ",") << "\"" << upper_bound << "\":" << entry.buckets.at(j);
+                    first_bucket = false;
+                }
+
+                os << "}";
+            }
+
+            os << "}";
+        }
+
+        os << "]}\n";
+        const std::string line = os.str();
+
+        MetricsOutputs& outputs = get_outputs();
+        if (outputs.file.is_open()) {
+            outputs.file << line;
+            outputs.file.flush();
+        }
+
+#ifdef DODO_LINUX
+        if (outputs.listen_socket < 0) {
+            return;
+        }
+
+        while (true) {
+            const int client_socket = accept4(outputs.listen_socket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (client_socket < 0) {
+                break;
+            }
+
+            outputs.client_sockets.push_back(client_socket);
+        }
+
+        // A client that can not keep up or went away is dropped instead of blocking the frame.
+        std::erase_if(outputs.client_sockets, [&line](int client_socket) {
+            const ssize_t written = send(client_socket, line.data(), line.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (written != static_cast<ssize_t>(line.size())) {
+                close(client_socket);
+                return true;
+            }
+
+            return false;
+        });
+#endif
+    }
+
+}
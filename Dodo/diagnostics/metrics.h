@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/core.h"
+
+namespace Dodo {
+
+    // Process wide counters, gauges and histograms. Recording never takes a lock:
+    // counters and histograms are written to a shard owned by the calling thread and
+    // only summed up when a snapshot is taken, gauges hold the last value set.
+    class Metrics {
+    public:
+        using MetricId = uint32_t;
+        static constexpr MetricId invalid_metric = UINT32_MAX;
+        static constexpr size_t max_counter_count = 128;
+        static constexpr size_t max_gauge_count = 128;
+        static constexpr size_t max_histogram_count = 32;
+        // Bucket i counts values in [2^(i-1), 2^i), bucket 0 counts zeros.
+        static constexpr size_t histogram_bucket_count = 65;
+
+        enum class Type {
+            counter,
+            gauge,
+            histogram
+        };
+
+        struct Snapshot {
+            struct Entry {
+                std::string name = {};
+                Type type = Type::counter;
+                double value = 0.0;
+                std::array<uint64_t, histogram_bucket_count> buckets = {};
+            };
+
+            uint64_t frame = 0;
+            uint64_t timestamp = 0;
+            std::vector<Entry> entries = {};
+        };
+
+        struct Shard {
+            std::array<std::atomic<uint64_t>, max_counter_count> counters = {};
+            std::array<std::array<std::atomic<uint64_t>, histogram_bucket_count>, max_histogram_count> histograms = {};
+        };
+
+        // Registering the same name again returns the same id.
+        static MetricId counter_register(std::string_view name);
+        static MetricId gauge_register(std::string_view name);
+        static MetricId histogram_register(std::string_view name);
+
+        static void counter_add(MetricId counter, uint64_t value = 1) {
+            if (counter == invalid_metric) {
+                return;
+            }
+
+            // Only the owning thread writes to a shard, a plain load and store is enough.
+            std::atomic<uint64_t>& slot = shard_get().counters[counter];
+            slot.store(slot.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        static void gauge_set(MetricId gauge, double value) {
+            if (gauge == invalid_metric) {
+                return;
+            }
+
+            s_gauges[gauge].store(value, std::memory_order_relaxed);
+        }
+
+        static void histogram_record(MetricId histogram, uint64_t value) {
+            if (histogram == invalid_metric) {
+                return;
+            }
+
+            std::atomic<uint64_t>& slot = shard_get().histograms[histogram][std::bit_width(value)];
+            slot.store(slot.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        static Snapshot snapshot_take();
+
+        // Every interval frames a snapshot is appended as a JSON line to the outputs, 0 disables it.
+        static void snapshot_interval_set(uint32_t frame_count) { s_snapshot_interval = frame_count; }
+        static bool output_file_open(const std::filesystem::path& file_path);
+        // Listens on a Unix domain socket, every connected client receives the snapshots.
+        static bool output_socket_open(const std::filesystem::path& socket_path);
+        static void outputs_close();
+        static void end_frame();
+
+        static Shard& shard_get() {
+            if (!s_shard) {
+                s_shard = _shard_register();
+            }
+
+            return *s_shard;
+        }
+
+    private:
+        struct Descriptor {
+            std::string name = {};
+            Type type = Type::counter;
+            MetricId index = 0;
+        };
+
+        static MetricId _register(std::string_view name, Type type, size_t max_count);
+        static Shard* _shard_register();
+        static void _write_snapshot(const Snapshot& snapshot);
+
+        static inline thread_local Shard* s_shard = nullptr;
+        static inline std::mutex s_mutex{};
+        static inline std::vector<std::unique_ptr<Shard>> s_shards{};
+        static inline std::vector<Descriptor> s_descriptors{};
+        static inline std::array<size_t, 3> s_type_counts{};
+        static inline std::array<std::atomic<double>, max_gauge_count> s_gauges{};
+        static inline uint32_t s_snapshot_interval = 0;
+        static inline uint64_t s_frame = 0;
+    };
+
+}
+
+////////////////////////////////////////////////////////////////////
+// METRICS /////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////
+
+// The metric is registered once per call site, NAME must be a constant.
+#define DODO_METRICS_CONCAT_IMPL(A, B) A##B
+#define DODO_METRICS_CONCAT(A, B) DODO_METRICS_CONCAT_IMPL(A, B)
+#define DODO_METRIC_COUNTER_ADD(NAME, VALUE) do { static const ::Dodo::Metrics::MetricId DODO_METRICS_CONCAT(metric_id_, __LINE__) = ::Dodo::Metrics::counter_register(NAME); ::Dodo::Metrics::counter_add(DODO_METRICS_CONCAT(metric_id_, __LINE__), VALUE); } while (0)
+#define DODO_METRIC_GAUGE_SET(NAME, VALUE) do { static const ::Dodo::Metrics::MetricId DODO_METRICS_CONCAT(metric_id_, __LINE__) = ::Dodo::Metrics::gauge_register(NAME); ::Dodo::Metrics::gauge_set(DODO_METRICS_CONCAT(metric_id_, __LINE__), VALUE); } while (0)
+#define DODO_METRIC_HISTOGRAM_RECORD(NAME, VALUE) do { static const ::Dodo::Metrics::MetricId DODO_METRICS_CONCAT(metric_id_, __LINE__) = ::Dodo::Metrics::histogram_register(NAME); ::Dodo::Metrics::histogram_record(DODO_METRICS_CONCAT(metric_id_, __LINE__), VALUE); } while (0)
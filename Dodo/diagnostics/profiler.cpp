@@ -0,0 +1,112 @@
+#include "pch.h"
+#include "profiler.h"
+
+#include <unordered_set>
+
+#include "diagnostics/json.h"
+
+namespace Dodo {
+
+    ////////////////////////////////////////////////////////////////
+    // PROFILER ////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    static std::unordered_set<std::string>& get_interned_names() {
+        static std::unordered_set<std::string> s_interned_names{};
+        return s_interned_names;
+    }
+
+    void Profiler::init() {
+        s_start_timestamp = timestamp_get();
+        thread_set_name("Main");
+    }
+
+    void Profiler::thread_set_name(const std::string& name) {
+        ThreadBuffer& thread_buffer = thread_buffer_get();
+        std::unique_lock<std::mutex> lock(s_mutex);
+        thread_buffer.thread_name = name;
+    }
+
+    const char* Profiler::name_intern(std::string_view name) {
+        std::unique_lock<std::mutex> lock(s_mutex);
+        auto [it, inserted] = get_interned_names().emplace(name);
+        return it->c_str();
+    }
+
+    Profiler::ThreadBuffer& Profiler::track_get(const std::string& name) {
+        std::unique_lock<std::mutex> lock(s_mutex);
+        for (auto& thread_buffer : s_thread_buffers) {
+            if (thread_buffer->is_track && (thread_buffer->thread_name == name)) {
+                return *thread_buffer;
+            }
+        }
+
+        auto track = std::make_unique<ThreadBuffer>();
+        track->thread_id = static_cast<uint32_t>(s_thread_buffers.size());
+        track->thread_name = name;
+        track->is_track = true;
+        s_thread_buffers.push_back(std::move(track));
+        return *s_thread_buffers.back();
+    }
+
+    bool Profiler::write_chrome_trace(const std::filesystem::path& file_path) {
+        std::ofstream os(file_path, std::ios::trunc);
+        if (!os) {
+            DODO_LOG_ERROR("Failed to write profile: {0}.", file_path.string());
+            return false;
+        }
+
+        // Chrome trace / Perfetto JSON format, all timestamps are in microseconds.
+        // Online: https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU.
+        std::unique_lock<std::mutex> lock(s_mutex);
+        os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        bool first_event = true;
+        auto begin_event = [&os, &first_event]() {
+            os << (first_event ? "\n" : ",\n");
+            first_event = false;
+        };
+
+        size_t zone_count = 0;
+        for (const auto& thread_buffer : s_thread_buffers) {
+            if (!thread_buffer->thread_name.empty()) {
+                begin_event();
+                os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread_buffer->thread_id << ",\"args\":{\"name\":\"";
+                json_write_escaped(os, thread_buffer->thread_name);
+                os << "\"}}";
+            }
+
+            const uint64_t write_count = thread_buffer->write_count.load(std::memory_order_acquire);
+            const uint64_t first = (write_count > ThreadBuffer::capacity) ? (write_count - ThreadBuffer::capacity) : 0;
+            for (uint64_t i = first; i < write_count; i++) {
+                const Zone& zone = thread_buffer->zones[i & (ThreadBuffer::capacity - 1)];
+                if (zone.begin < s_start_timestamp) {
+                    continue;
+                }
+
+                begin_event();
+                os << "{\"name\":\"";
+                json_write_escaped(os, zone.name ? zone.name : "Unknown");
+                os << std::format("\",\"cat\":\"{}\",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":1,\"tid\":{},\"args\":{{\"depth\":{}}}}}",
+                    thread_buffer->is_track ? "track" : "cpu",
+                    static_cast<double>(Timer::ticks_to_nanoseconds(zone.begin - s_start_timestamp)) * 1.0E-3,
+                    static_cast<double>(Timer::ticks_to_nanoseconds(zone.end - zone.begin)) * 1.0E-3,
+                    thread_buffer->thread_id,
+                    zone.depth);
+                zone_count++;
+            }
+        }
+
+        os << "\n]}\n";
+        DODO_LOG_INFO("Profile with {0} zones written to: {1}.", zone_count, file_path.string());
+        return true;
+    }
+
+    Profiler::ThreadBuffer* Profiler::_thread_buffer_register() {
+        std::unique_lock<std::mutex> lock(s_mutex);
+        auto thread_buffer = std::make_unique<ThreadBuffer>();
+        thread_buffer->thread_id = static_cast<uint32_t>(s_thread_buffers.size());
+        s_thread_buffers.push_back(std::move(thread_buffer));
+        return s_thread_buffers.back().get();
+    }
+
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/core.h"
+#include "diagnostics/timer.h"
+
+namespace Dodo {
+
+    class Profiler {
+    public:
+        struct Zone {
+            const char* name = nullptr;
+            uint64_t begin = 0;
+            uint64_t end = 0;
+            uint32_t depth = 0;
+        };
+
+        // Zones are written by a single thread into a fixed ring, the oldest
+        // zones get overwritten once the ring is full.
+        struct ThreadBuffer {
+            static constexpr size_t capacity = 1 << 16;
+
+            uint32_t thread_id = 0;
+            std::string thread_name = {};
+            bool is_track = false;
+            uint32_t depth = 0;
+            std::atomic<uint64_t> write_count = 0;
+            std::unique_ptr<Zone[]> zones = std::make_unique<Zone[]>(capacity);
+
+            void push(const Zone& zone) {
+                const uint64_t count = write_count.load(std::memory_order_relaxed);
+                zones[count & (capacity - 1)] = zone;
+                write_count.store(count + 1, std::memory_order_release);
+            }
+        };
+
+        static void init();
+        static void set_enabled(bool enabled) { s_enabled.store(enabled, std::memory_order_relaxed); }
+        static bool is_enabled() { return s_enabled.load(std::memory_order_relaxed); }
+        static void thread_set_name(const std::string& name);
+        static const char* name_intern(std::string_view name);
+        // A named timeline that is not tied to a thread, e.g. for GPU zones. Zones
+        // pushed to a track must all come from the same thread.
+        static ThreadBuffer& track_get(const std::string& name);
+        // Reads the zone rings of every thread, no other thread may push zones meanwhile.
+        static bool write_chrome_trace(const std::filesystem::path& file_path);
+
+        static uint64_t timestamp_get() {
+            return Timer::now();
+        }
+
+        static ThreadBuffer& thread_buffer_get() {
+            if (!s_thread_buffer) {
+                s_thread_buffer = _thread_buffer_register();
+            }
+
+            return *s_thread_buffer;
+        }
+
+    private:
+        static ThreadBuffer* _thread_buffer_register();
+
+        static inline std::atomic<bool> s_enabled = false;
+        static inline thread_local ThreadBuffer* s_thread_buffer = nullptr;
+        static inline std::mutex s_mutex{};
+        static inline std::vector<std::unique_ptr<ThreadBuffer>> s_thread_buffers{};
+        static inline uint64_t s_start_timestamp = 0;
+    };
+
+    class ProfileScope {
+    public:
+        ProfileScope(const char* name) {
+            if (!Profiler::is_enabled()) {
+                return;
+            }
+
+            _buffer = &Profiler::thread_buffer_get();
+            _name = name;
+            _depth = _buffer->depth++;
+            _begin = Profiler::timestamp_get();
+        }
+
+        ~ProfileScope() {
+            if (!_buffer) {
+                return;
+            }
+
+            const uint64_t end = Profiler::timestamp_get();
+            _buffer->depth--;
+            _buffer->push({ _name, _begin, end, _depth });
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        Profiler::ThreadBuffer* _buffer = nullptr;
+        const char* _name = nullptr;
+        uint64_t _begin = 0;
+        uint32_t _depth = 0;
+    };
+
+}
+
+////////////////////////////////////////////////////////////////////
+// PROFILE SCOPES //////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////
+
+#define DODO_PROFILE_CONCAT_IMPL(A, B) A##B
+#define DODO_PROFILE_CONCAT(A, B) DODO_PROFILE_CONCAT_IMPL(A, B)
+
+#ifdef DODO_ENABLE_PROFILER
+#   define DODO_PROFILE_SCOPE(NAME) ::Dodo::ProfileScope DODO_PROFILE_CONCAT(profile_scope_, __LINE__)(NAME)
+#   define DODO_PROFILE_SCOPE_DYNAMIC(NAME) ::Dodo::ProfileScope DODO_PROFILE_CONCAT(profile_scope_, __LINE__)(::Dodo::Profiler::is_enabled() ? ::Dodo::Profiler::name_intern(NAME) : nullptr)
+#   define DODO_PROFILE_THREAD(NAME) ::Dodo::Profiler::thread_set_name(NAME)
+#else
+#   define DODO_PROFILE_SCOPE(...)
+#   define DODO_PROFILE_SCOPE_DYNAMIC(...)
+#   define DODO_PROFILE_THREAD(...)
+#endif
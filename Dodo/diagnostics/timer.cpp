@@ -0,0 +1,144 @@
+#include "pch.h"
+#include "timer.h"
+
+#if defined(DODO_WINDOWS)
+#   include <Windows.h>
+#elif defined(DODO_LINUX)
+#   include <time.h>
+#endif
+
+#if defined(DODO_TIMER_TSC) && !defined(_MSC_VER)
+#   include <cpuid.h>
+#endif
+
+namespace Dodo {
+
+    void Timer::init() {
+        if (_source_get() == Source::tsc) {
+            DODO_LOG_INFO("Timer uses the invariant TSC at {0:.3f} MHz.", static_cast<double>(s_frequency) * 1.0E-6);
+        }
+        else if (!has_invariant_tsc()) {
+            DODO_LOG_WARNING("Invariant TSC not available, timer falls back to the monotonic clock.");
+        }
+        else {
+            DODO_LOG_WARNING("TSC calibration failed, timer falls back to the monotonic clock.");
+        }
+    }
+
+    Timer::Source Timer::_source_select() {
+        static std::once_flag s_once_flag;
+        std::call_once(s_once_flag, []() {
+            Source source = Source::monotonic;
+#ifdef DODO_TIMER_TSC
+            const uint64_t tsc_frequency = has_invariant_tsc() ? _calibrate_tsc() : 0;
+            if (tsc_frequency != 0) {
+                s_frequency = tsc_frequency;
+                s_nanoseconds_per_tick = 1.0E9 / static_cast<double>(tsc_frequency);
+                source = Source::tsc;
+            }
+#endif
+            s_source.store(source, std::memory_order_release);
+        });
+
+        return s_source.load(std::memory_order_acquire);
+    }
+
+    bool Timer::has_invariant_tsc() {
+#ifdef DODO_TIMER_TSC
+        // CPUID.80000007H:EDX[8] reports a TSC that runs at a constant rate in all
+        // P-, C- and T-states, which is required to compare ticks across cores.
+        uint32_t registers[4] = {};
+#   ifdef _MSC_VER
+        __cpuid(reinterpret_cast<int*>(registers), 0x80000000);
+        if (registers[0] < 0x80000007) {
+            return false;
+        }
+
+        __cpuid(reinterpret_cast<int*>(registers), 0x80000007);
+#   else
+        if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007) {
+            return false;
+        }
+
+        __get_cpuid(0x80000007, &registers[0], &registers[1], &registers[2], &registers[3]);
+#   endif
+        return (registers[3] & (1u << 8)) != 0;
+#else
+        return false;
+#endif
+    }
+
+    uint64_t Timer::host_now() {
+#if defined(DODO_WINDOWS)
+        LARGE_INTEGER counter = {};
+        QueryPerformanceCounter(&counter);
+        return static_cast<uint64_t>(counter.QuadPart);
+#elif defined(DODO_LINUX)
+        timespec time = {};
+        clock_gettime(CLOCK_MONOTONIC, &time);
+        return static_cast<uint64_t>(time.tv_sec) * 1000000000 + static_cast<uint64_t>(time.tv_nsec);
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    uint64_t Timer::host_to_ticks(uint64_t host_timestamp) {
+        const uint64_t ticks_before = now_serialized();
+        const uint64_t host_nanoseconds = _host_to_nanoseconds(host_now());
+        const uint64_t ticks_after = now_serialized();
+        const uint64_t ticks = ticks_before + (ticks_after - ticks_before) / 2;
+        const uint64_t nanoseconds = _host_to_nanoseconds(host_timestamp);
+        if (nanoseconds >= host_nanoseconds) {
+            return ticks + nanoseconds_to_ticks(nanoseconds - host_nanoseconds);
+        }
+
+        return ticks - std::min(ticks, nanoseconds_to_ticks(host_nanoseconds - nanoseconds));
+    }
+
+    uint64_t Timer::_host_to_nanoseconds(uint64_t host_timestamp) {
+#if defined(DODO_WINDOWS)
+        static const uint64_t frequency = []() {
+            LARGE_INTEGER value = {};
+            QueryPerformanceFrequency(&value);
+            return static_cast<uint64_t>(value.QuadPart);
+        }();
+
+        // Split to avoid overflowing the multiplication.
+        return (host_timestamp / frequency) * 1000000000 + ((host_timestamp % frequency) * 1000000000) / frequency;
+#else
+        return host_timestamp;
+#endif
+    }
+
+    uint64_t Timer::_calibrate_tsc() {
+#ifdef DODO_TIMER_TSC
+        // Measure the TSC against the monotonic clock a few times and keep the median,
+        // so a preempted round does not skew the result.
+        static constexpr size_t round_count = 5;
+        static constexpr uint64_t round_duration = 10000000;
+        std::array<uint64_t, round_count> frequencies = {};
+        auto read_tsc = []() -> uint64_t {
+            uint32_t processor_id = 0;
+            return __rdtscp(&processor_id);
+        };
+
+        for (size_t i = 0; i < round_count; i++) {
+            const uint64_t begin_time = _monotonic_now();
+            const uint64_t begin_ticks = read_tsc();
+            uint64_t end_time = begin_time;
+            while ((end_time - begin_time) < round_duration) {
+                end_time = _monotonic_now();
+            }
+
+            const uint64_t end_ticks = read_tsc();
+            frequencies.at(i) = static_cast<uint64_t>(static_cast<double>(end_ticks - begin_ticks) * 1.0E9 / static_cast<double>(end_time - begin_time));
+        }
+
+        std::sort(frequencies.begin(), frequencies.end());
+        return frequencies.at(round_count / 2);
+#else
+        return 0;
+#endif
+    }
+
+}
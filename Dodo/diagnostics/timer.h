@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "core/core.h"
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#   ifndef DODO_TIMER_TSC
+#       define DODO_TIMER_TSC
+#   endif
+#   ifdef _MSC_VER
+#       include <intrin.h>
+#   else
+#       include <x86intrin.h>
+#   endif
+#endif
+
+namespace Dodo {
+
+    // Tick source for every fine-grained measurement in the engine. Ticks come from
+    // the invariant TSC when available, otherwise from the monotonic OS clock. The
+    // source is picked once, on the first read or in init(), so every tick ever
+    // handed out is in the same unit.
+    class Timer {
+    public:
+        enum class Source {
+            none,
+            tsc,
+            monotonic
+        };
+
+        // Picks the source if no tick was read yet and logs it.
+        static void init();
+        static Source source_get() { return _source_get(); }
+        static uint64_t frequency_get() { _source_get(); return s_frequency; }
+        static bool has_invariant_tsc();
+
+        static uint64_t now() {
+#ifdef DODO_TIMER_TSC
+            if (_source_get() == Source::tsc) {
+                return __rdtsc();
+            }
+#endif
+            return _monotonic_now();
+        }
+
+        // Waits for all previous instructions to retire before reading the counter.
+        static uint64_t now_serialized() {
+#ifdef DODO_TIMER_TSC
+            if (_source_get() == Source::tsc) {
+                uint32_t processor_id = 0;
+                return __rdtscp(&processor_id);
+            }
+#endif
+            return _monotonic_now();
+        }
+
+        static uint64_t ticks_to_nanoseconds(uint64_t ticks) {
+            return static_cast<uint64_t>(static_cast<double>(ticks) * s_nanoseconds_per_tick);
+        }
+
+        static double ticks_to_milliseconds(uint64_t ticks) {
+            return static_cast<double>(ticks) * s_nanoseconds_per_tick * 1.0E-6;
+        }
+
+        static uint64_t nanoseconds_to_ticks(uint64_t nanoseconds) {
+            return static_cast<uint64_t>(static_cast<double>(nanoseconds) / s_nanoseconds_per_tick);
+        }
+
+        // The raw OS clock that graphics APIs call the host time domain,
+        // QueryPerformanceCounter ticks on Windows and CLOCK_MONOTONIC nanoseconds
+        // on Linux.
+        static uint64_t host_now();
+        // Maps a host clock value to ticks by pairing the host clock with now().
+        static uint64_t host_to_ticks(uint64_t host_timestamp);
+
+    private:
+        static Source _source_get() {
+            const Source source = s_source.load(std::memory_order_acquire);
+            return (source != Source::none) ? source : _source_select();
+        }
+
+        static Source _source_select();
+        // Nanoseconds since an arbitrary point, like std::chrono::steady_clock.
+        static uint64_t _monotonic_now() { return _host_to_nanoseconds(host_now()); }
+        static uint64_t _host_to_nanoseconds(uint64_t host_timestamp);
+        static uint64_t _calibrate_tsc();
+
+        static inline std::atomic<Source> s_source = Source::none;
+        static inline uint64_t s_frequency = 1000000000;
+        static inline double s_nanoseconds_per_tick = 1.0;
+    };
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Dodo {
+
+    // Bump allocator over an abstract range of offsets for data that dies together, e.g.
+    // everything uploaded for one frame. Individual allocations are never freed, reset() releases all.
+    class LinearAllocator {
+    public:
+        static constexpr uint64_t invalid_offset = UINT64_MAX;
+
+        LinearAllocator() = default;
+        explicit LinearAllocator(uint64_t size) { initialize(size); }
+
+        void initialize(uint64_t size) {
+            _size = size;
+            _offset = 0;
+        }
+
+        // Alignment must be a power of two, returns invalid_offset when the range is exhausted.
+        uint64_t allocate(uint64_t size, uint64_t alignment = 1) {
+            const uint64_t offset = (_offset + alignment - 1) & ~(alignment - 1);
+            if ((offset > _size) || (size > _size - offset)) {
+                return invalid_offset;
+            }
+
+            _offset = offset + size;
+            return offset;
+        }
+
+        void reset() { _offset = 0; }
+
+        uint64_t size_get() const { return _size; }
+        uint64_t used_get() const { return _offset; }
+
+    private:
+        uint64_t _size = 0;
+        uint64_t _offset = 0;
+    };
+
+}
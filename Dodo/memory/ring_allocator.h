@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Dodo {
+
+    // FIFO allocator over an abstract range of offsets, e.g. a staging buffer the GPU consumes
+    // in submission order. Head and tail are running byte counters, a marker taken with
+    // head_get() releases everything allocated before it once the consumer is done.
+    class RingAllocator {
+    public:
+        static constexpr uint64_t invalid_offset = UINT64_MAX;
+
+        RingAllocator() = default;
+        explicit RingAllocator(uint64_t size) { initialize(size); }
+
+        void initialize(uint64_t size) {
+            _size = size;
+            _head = 0;
+            _tail = 0;
+        }
+
+        // Alignment must be a power of two. Allocations never wrap, the end of the range is
+        // skipped instead. Returns invalid_offset when the ring is too full.
+        uint64_t allocate(uint64_t size, uint64_t alignment = 1) {
+            if (size > _size) {
+                return invalid_offset;
+            }
+
+            // An empty ring restarts at offset zero, so allocations up to the full size fit.
+            // Outstanding markers are at most the new tail and release nothing.
+            if ((_head == _tail) && ((_head % _size) != 0)) {
+                _head += _size - (_head % _size);
+                _tail = _head;
+            }
+
+            const uint64_t position = _head % _size;
+            uint64_t offset = (position + alignment - 1) & ~(alignment - 1);
+            uint64_t head = _head + (offset - position);
+            if ((offset + size) > _size) {
+                head = _head + (_size - position);
+                offset = 0;
+            }
+
+            if ((head + size - _tail) > _size) {
+                return invalid_offset;
+            }
+
+            _head = head + size;
+            return offset;
+        }
+
+        uint64_t head_get() const { return _head; }
+
+        void release(uint64_t marker) {
+            if (marker > _tail) {
+                _tail = marker;
+            }
+        }
+
+        uint64_t size_get() const { return _size; }
+        uint64_t used_get() const { return _head - _tail; }
+
+    private:
+        uint64_t _size = 0;
+        uint64_t _head = 0;
+        uint64_t _tail = 0;
+    };
+
+}
@@ -0,0 +1,277 @@
+#include "pch.h"
+#include "tlsf_allocator.h"
+
+#include <bit>
+
+namespace Dodo {
+
+    namespace Utils {
+
+        static uint64_t align_up(uint64_t value, uint64_t alignment) {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        static uint32_t find_last_set(uint64_t value) {
+            return 63 - static_cast<uint32_t>(std::countl_zero(value));
+        }
+
+    }
+
+    void TlsfAllocator::initialize(uint64_t size) {
+        _size = size & ~(granularity - 1);
+        _used = 0;
+        _allocation_count = 0;
+        _fl_bitmap = 0;
+        _sl_bitmaps.fill(0);
+        for (auto& heads : _free_heads) {
+            heads.fill(invalid_node);
+        }
+
+        _nodes.clear();
+        _free_nodes.clear();
+        if (_size > 0) {
+            const uint32_t node_index = _node_create(0, _size);
+            _nodes.at(node_index).is_free = true;
+            _free_list_insert(node_index);
+        }
+    }
+
+    TlsfAllocator::Allocation TlsfAllocator::allocate(uint64_t size, uint64_t alignment) {
+        DODO_ASSERT((alignment > 0) && ((alignment & (alignment - 1)) == 0));
+        size = Utils::align_up(std::max<uint64_t>(size, 1), granularity);
+        alignment = std::max(alignment, granularity);
+        if (size > _size) {
+            return {};
+        }
+
+        uint32_t fl = 0;
+        uint32_t sl = 0;
+        _mapping_search(size, fl, sl);
+        uint32_t node_index = _find_free(fl, sl);
+        if ((node_index != invalid_node) && (alignment > granularity)) {
+            const Node& node = _nodes.at(node_index);
+            if ((Utils::align_up(node.offset, alignment) + size) > (node.offset + node.size)) {
+                // Offsets are multiples of the granularity, so at most this much padding is needed in front.
+                _mapping_search(std::min(size + (alignment - granularity), _size), fl, sl);
+                node_index = _find_free(fl, sl);
+            }
+        }
+
+        if (node_index == invalid_node) {
+            return {};
+        }
+
+        _free_list_remove(node_index);
+        const uint64_t padding = Utils::align_up(_nodes.at(node_index).offset, alignment) - _nodes.at(node_index).offset;
+        if (padding > 0) {
+            // The physical neighbours of a free range are never free, the padding stays a separate free range.
+            const uint32_t padding_index = _node_create(_nodes.at(node_index).offset, padding);
+            Node& padding_node = _nodes.at(padding_index);
+            Node& node = _nodes.at(node_index);
+            padding_node.prev_physical = node.prev_physical;
+            padding_node.next_physical = node_index;
+            padding_node.is_free = true;
+            if (node.prev_physical != invalid_node) {
+                _nodes.at(node.prev_physical).next_physical = padding_index;
+            }
+
+            node.prev_physical = padding_index;
+            node.offset += padding;
+            node.size -= padding;
+            _free_list_insert(padding_index);
+        }
+
+        if (_nodes.at(node_index).size > size) {
+            const uint32_t remainder_index = _node_create(_nodes.at(node_index).offset + size, _nodes.at(node_index).size - size);
+            Node& remainder_node = _nodes.at(remainder_index);
+            Node& node = _nodes.at(node_index);
+            remainder_node.prev_physical = node_index;
+            remainder_node.next_physical = node.next_physical;
+            remainder_node.is_free = true;
+            if (node.next_physical != invalid_node) {
+                _nodes.at(node.next_physical).prev_physical = remainder_index;
+            }
+
+            node.next_physical = remainder_index;
+            node.size = size;
+            _free_list_insert(remainder_index);
+        }
+
+        Node& node = _nodes.at(node_index);
+        node.is_free = false;
+        _used += node.size;
+        _allocation_count++;
+
+        Allocation allocation = {};
+        allocation.offset = node.offset;
+        allocation.node = node_index;
+        return allocation;
+    }
+
+    void TlsfAllocator::free(Allocation allocation) {
+        if (!allocation.is_valid()) {
+            return;
+        }
+
+        uint32_t node_index = allocation.node;
+        DODO_ASSERT((node_index < _nodes.size()) && !_nodes.at(node_index).is_free);
+        _used -= _nodes.at(node_index).size;
+        _allocation_count--;
+
+        const uint32_t prev_index = _nodes.at(node_index).prev_physical;
+        if ((prev_index != invalid_node) && _nodes.at(prev_index).is_free) {
+            _free_list_remove(prev_index);
+            Node& prev_node = _nodes.at(prev_index);
+            const Node& node = _nodes.at(node_index);
+            prev_node.size += node.size;
+            prev_node.next_physical = node.next_physical;
+            if (node.next_physical != invalid_node) {
+                _nodes.at(node.next_physical).prev_physical = prev_index;
+            }
+
+            _node_release(node_index);
+            node_index = prev_index;
+        }
+
+        const uint32_t next_index = _nodes.at(node_index).next_physical;
+        if ((next_index != invalid_node) && _nodes.at(next_index).is_free) {
+            _free_list_remove(next_index);
+            Node& node = _nodes.at(node_index);
+            const Node& next_node = _nodes.at(next_index);
+            node.size += next_node.size;
+            node.next_physical = next_node.next_physical;
+            if (next_node.next_physical != invalid_node) {
+                _nodes.at(next_node.next_physical).prev_physical = node_index;
+            }
+
+            _node_release(next_index);
+        }
+
+        _nodes.at(node_index).is_free = true;
+        _free_list_insert(node_index);
+    }
+
+    uint64_t TlsfAllocator::largest_free_range_get() const {
+        if (_fl_bitmap == 0) {
+            return 0;
+        }
+
+        const uint32_t fl = Utils::find_last_set(_fl_bitmap);
+        const uint32_t sl = Utils::find_last_set(_sl_bitmaps.at(fl));
+        uint64_t largest = 0;
+        for (uint32_t node_index = _free_heads.at(fl).at(sl); node_index != invalid_node; node_index = _nodes.at(node_index).next_free) {
+            largest = std::max(largest, _nodes.at(node_index).size);
+        }
+
+        return largest;
+    }
+
+    void TlsfAllocator::_mapping_insert(uint64_t size, uint32_t& r_fl, uint32_t& r_sl) {
+        if (size < small_size) {
+            r_fl = 0;
+            r_sl = static_cast<uint32_t>(size >> granularity_log2);
+            return;
+        }
+
+        const uint32_t last_set = Utils::find_last_set(size);
+        r_fl = last_set - fl_shift + 1;
+        r_sl = static_cast<uint32_t>(size >> (last_set - sl_count_log2)) ^ sl_count;
+    }
+
+    void TlsfAllocator::_mapping_search(uint64_t size, uint32_t& r_fl, uint32_t& r_sl) {
+        // Rounds up to the next size class, so any range found in it is large enough.
+        if (size >= small_size) {
+            const uint64_t round = (uint64_t(1) << (Utils::find_last_set(size) - sl_count_log2)) - 1;
+            size = (size > UINT64_MAX - round) ? UINT64_MAX : size + round;
+        }
+
+        _mapping_insert(size, r_fl, r_sl);
+    }
+
+    uint32_t TlsfAllocator::_find_free(uint32_t fl, uint32_t sl) const {
+        if (fl >= fl_count) {
+            return invalid_node;
+        }
+
+        uint32_t sl_bitmap = (sl < sl_count) ? (_sl_bitmaps.at(fl) & (~0u << sl)) : 0;
+        if (sl_bitmap == 0) {
+            const uint64_t fl_bitmap = (fl + 1 < 64) ? (_fl_bitmap & (~uint64_t(0) << (fl + 1))) : 0;
+            if (fl_bitmap == 0) {
+                return invalid_node;
+            }
+
+            fl = static_cast<uint32_t>(std::countr_zero(fl_bitmap));
+            sl_bitmap = _sl_bitmaps.at(fl);
+        }
+
+        sl = static_cast<uint32_t>(std::countr_zero(sl_bitmap));
+        return _free_heads.at(fl).at(sl);
+    }
+
+    void TlsfAllocator::_free_list_insert(uint32_t node_index) {
+        uint32_t fl = 0;
+        uint32_t sl = 0;
+        _mapping_insert(_nodes.at(node_index).size, fl, sl);
+        Node& node = _nodes.at(node_index);
+        const uint32_t head_index = _free_heads.at(fl).at(sl);
+        node.prev_free = invalid_node;
+        node.next_free = head_index;
+        if (head_index != invalid_node) {
+            _nodes.at(head_index).prev_free = node_index;
+        }
+
+        _free_heads.at(fl).at(sl) = node_index;
+        _fl_bitmap |= uint64_t(1) << fl;
+        _sl_bitmaps.at(fl) |= 1u << sl;
+    }
+
+    void TlsfAllocator::_free_list_remove(uint32_t node_index) {
+        uint32_t fl = 0;
+        uint32_t sl = 0;
+        _mapping_insert(_nodes.at(node_index).size, fl, sl);
+        Node& node = _nodes.at(node_index);
+        if (node.prev_free != invalid_node) {
+            _nodes.at(node.prev_free).next_free = node.next_free;
+        }
+        else {
+            _free_heads.at(fl).at(sl) = node.next_free;
+        }
+
+        if (node.next_free != invalid_node) {
+            _nodes.at(node.next_free).prev_free = node.prev_free;
+        }
+
+        node.prev_free = invalid_node;
+        node.next_free = invalid_node;
+        if (_free_heads.at(fl).at(sl) == invalid_node) {
+            _sl_bitmaps.at(fl) &= ~(1u << sl);
+            if (_sl_bitmaps.at(fl) == 0) {
+                _fl_bitmap &= ~(uint64_t(1) << fl);
+            }
+        }
+    }
+
+    uint32_t TlsfAllocator::_node_create(uint64_t offset, uint64_t size) {
+        uint32_t node_index = invalid_node;
+        if (!_free_nodes.empty()) {
+            node_index = _free_nodes.back();
+            _free_nodes.pop_back();
+        }
+        else {
+            node_index = static_cast<uint32_t>(_nodes.size());
+            _nodes.emplace_back();
+        }
+
+        Node& node = _nodes.at(node_index);
+        node = {};
+        node.offset = offset;
+        node.size = size;
+        return node_index;
+    }
+
+    void TlsfAllocator::_node_release(uint32_t node_index) {
+        _nodes.at(node_index) = {};
+        _free_nodes.push_back(node_index);
+    }
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Dodo {
+
+    // Two level segregated fit allocator over an abstract range of offsets. It never touches
+    // the memory it manages, so it can sub-allocate GPU memory blocks. Allocation and free are
+    // O(1): free ranges are kept in size classes found through two bitmaps, and neighbouring
+    // free ranges are merged immediately.
+    class TlsfAllocator {
+    public:
+        static constexpr uint64_t invalid_offset = UINT64_MAX;
+        static constexpr uint32_t invalid_node = UINT32_MAX;
+
+        struct Allocation {
+            uint64_t offset = invalid_offset;
+            uint32_t node = invalid_node;
+
+            bool is_valid() const { return node != invalid_node; }
+        };
+
+        TlsfAllocator() = default;
+        explicit TlsfAllocator(uint64_t size) { initialize(size); }
+
+        void initialize(uint64_t size);
+        // Alignment must be a power of two, returns an invalid allocation when no range fits.
+        Allocation allocate(uint64_t size, uint64_t alignment = 1);
+        void free(Allocation allocation);
+
+        uint64_t size_get() const { return _size; }
+        uint64_t used_get() const { return _used; }
+        uint32_t allocation_count_get() const { return _allocation_count; }
+        bool is_empty() const { return _allocation_count == 0; }
+        // Scans at most one size class, cheap enough for statistics.
+        uint64_t largest_free_range_get() const;
+
+    private:
+        static constexpr uint32_t granularity_log2 = 4;
+        static constexpr uint64_t granularity = uint64_t(1) << granularity_log2;
+        static constexpr uint32_t sl_count_log2 = 5;
+        static constexpr uint32_t sl_count = 1 << sl_count_log2;
+        // Sizes below this are mapped linearly into the first level 0.
+        static constexpr uint32_t fl_shift = sl_count_log2 + granularity_log2;
+        static constexpr uint64_t small_size = uint64_t(1) << fl_shift;
+        static constexpr uint32_t fl_count = 64 - fl_shift + 1;
+
+        struct Node {
+            uint64_t offset = 0;
+            uint64_t size = 0;
+            uint32_t prev_physical = invalid_node;
+            uint32_t next_physical = invalid_node;
+            uint32_t prev_free = invalid_node;
+            uint32_t next_free = invalid_node;
+            bool is_free = false;
+        };
+
+        static void _mapping_insert(uint64_t size, uint32_t& r_fl, uint32_t& r_sl);
+        static void _mapping_search(uint64_t size, uint32_t& r_fl, uint32_t& r_sl);
+        uint32_t _find_free(uint32_t fl, uint32_t sl) const;
+        void _free_list_insert(uint32_t node_index);
+        void _free_list_remove(uint32_t node_index);
+        uint32_t _node_create(uint64_t offset, uint64_t size);
+        void _node_release(uint32_t node_index);
+
+        uint64_t _size = 0;
+        uint64_t _used = 0;
+        uint32_t _allocation_count = 0;
+        uint64_t _fl_bitmap = 0;
+        std::array<uint32_t, fl_count> _sl_bitmaps = {};
+        std::array<std::array<uint32_t, sl_count>, fl_count> _free_heads = {};
+        std::vector<Node> _nodes = {};
+        std::vector<uint32_t> _free_nodes = {};
+    };
+
+}
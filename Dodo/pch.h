@@ -29,5 +29,7 @@
 
 #include "core/core.h"
 #include "diagnostics/log.h"
-#include "diagnostics/stopwatch.h"
+#include "diagnostics/metrics.h"
+#include "diagnostics/profiler.h"
+#include "diagnostics/Stopwatch.h"
 #include "memory/ref.h"
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "pch.h"
+
+#ifdef DODO_LINUX
+
+#include "HeadlessInput.h"
+
+namespace Dodo {
+
+    ////////////////////////////////////////////////////////////////
+    // HEADLESS KEYBOARD ///////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    HeadlessKeyboard::HeadlessKeyboard()
+    {
+        Reset();
+    }
+
+    ////////////////////////////////////////////////////////////////
+    // HEADLESS MOUSE //////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    HeadlessMouse::HeadlessMouse()
+    {
+        Reset();
+    }
+
+    ////////////////////////////////////////////////////////////////
+    // HEADLESS INPUT DATA /////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    struct HeadlessInputData
+    {
+        HeadlessKeyboard Keyboard{};
+        HeadlessMouse Mouse{};
+    };
+
+    static HeadlessInputData s_Data{};
+
+    ////////////////////////////////////////////////////////////////
+    // HEADLESS INPUT //////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    void HeadlessInput::Init()
+    {
+        Keyboard = &s_Data.Keyboard;
+        Mouse = &s_Data.Mouse;
+    }
+
+    HeadlessKeyboard& HeadlessInput::GetKeyboard()
+    {
+        return s_Data.Keyboard;
+    }
+
+    HeadlessMouse& HeadlessInput::GetMouse()
+    {
+        return s_Data.Mouse;
+    }
+
+}
+
+#endif
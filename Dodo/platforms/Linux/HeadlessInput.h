@@ -0,0 +1,53 @@
+#pragma once
+
+#ifdef DODO_LINUX
+
+#include "Input/Input.h"
+
+namespace Dodo {
+
+    ////////////////////////////////////////////////////////////////
+    // HEADLESS KEYBOARD ///////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    // Without a window system nothing reports input, events come from a replay or
+    // are injected, e.g. by an automated run.
+    class HeadlessKeyboard : public Keyboard
+    {
+    public:
+        HeadlessKeyboard();
+
+        using Keyboard::OnKeyDown;
+        using Keyboard::OnKeyUp;
+    };
+
+    ////////////////////////////////////////////////////////////////
+    // HEADLESS MOUSE //////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    class HeadlessMouse : public Mouse
+    {
+    public:
+        HeadlessMouse();
+
+        using Mouse::OnWheelScroll;
+        using Mouse::OnButtonDown;
+        using Mouse::OnButtonUp;
+    };
+
+    ////////////////////////////////////////////////////////////////
+    // HEADLESS INPUT //////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    class HeadlessInput : public Input
+    {
+    public:
+        static void Init();
+
+        static HeadlessKeyboard& GetKeyboard();
+        static HeadlessMouse& GetMouse();
+    };
+
+}
+
+#endif
@@ -0,0 +1,292 @@
+#include "pch.h"
+
+#ifdef DODO_LINUX
+
+#include "XcbInput.h"
+
+namespace Dodo {
+
+    ////////////////////////////////////////////////////////////////
+    // UTILS ///////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    namespace Utils {
+
+        // X keycodes of evdev based servers are the Linux input event codes offset by 8.
+        static constexpr xcb_keycode_t EvdevKeycodeOffset = 8;
+
+        static KeyCode ConvertKeycodeToKeyCode(xcb_keycode_t keycode)
+        {
+            if (keycode < EvdevKeycodeOffset)
+            {
+                return KeyCode::None;
+            }
+
+            const uint32_t scancode = keycode - EvdevKeycodeOffset;
+            // Digits 1 to 9, function keys 1 to 10 and 13 to 24 are contiguous in both tables.
+            if ((scancode >= 2) && (scancode <= 10))
+            {
+                return static_cast<KeyCode>(static_cast<int>(KeyCode::Alpha1) + (scancode - 2));
+            }
+
+            if ((scancode >= 59) && (scancode <= 68))
+            {
+                return static_cast<KeyCode>(static_cast<int>(KeyCode::F1) + (scancode - 59));
+            }
+
+            if ((scancode >= 183) && (scancode <= 194))
+            {
+                return static_cast<KeyCode>(static_cast<int>(KeyCode::F13) + (scancode - 183));
+            }
+
+            switch (scancode)
+            {
+                case 1  : return KeyCode::Escape;
+                case 11 : return KeyCode::Alpha0;
+                case 12 : return KeyCode::Minus;
+                case 13 : return KeyCode::Equal;
+                case 14 : return KeyCode::Backspace;
+                case 15 : return KeyCode::Tab;
+                case 16 : return KeyCode::Q;
+                case 17 : return KeyCode::W;
+                case 18 : return KeyCode::E;
+                case 19 : return KeyCode::R;
+                case 20 : return KeyCode::T;
+                case 21 : return KeyCode::Y;
+                case 22 : return KeyCode::U;
+                case 23 : return KeyCode::I;
+                case 24 : return KeyCode::O;
+                case 25 : return KeyCode::P;
+                case 26 : return KeyCode::LeftBracket;
+                case 27 : return KeyCode::RightBracket;
+                case 28 : return KeyCode::Enter;
+                case 29 : return KeyCode::LeftControl;
+                case 30 : return KeyCode::A;
+                case 31 : return KeyCode::S;
+                case 32 : return KeyCode::D;
+                case 33 : return KeyCode::F;
+                case 34 : return KeyCode::G;
+                case 35 : return KeyCode::H;
+                case 36 : return KeyCode::J;
+                case 37 : return KeyCode::K;
+                case 38 : return KeyCode::L;
+                case 39 : return KeyCode::Semicolon;
+                case 40 : return KeyCode::Apostrophe;
+                case 41 : return KeyCode::GraveAccent;
+                case 42 : return KeyCode::LeftShift;
+                case 43 : return KeyCode::Backslash;
+                case 44 : return KeyCode::Z;
+                case 45 : return KeyCode::X;
+                case 46 : return KeyCode::C;
+                case 47 : return KeyCode::V;
+                case 48 : return KeyCode::B;
+                case 49 : return KeyCode::N;
+                case 50 : return KeyCode::M;
+                case 51 : return KeyCode::Comma;
+                case 52 : return KeyCode::Period;
+                case 53 : return KeyCode::Slash;
+                case 54 : return KeyCode::RightShift;
+                case 55 : return KeyCode::KeypadMultiply;
+                case 56 : return KeyCode::LeftAlt;
+                case 57 : return KeyCode::Space;
+                case 58 : return KeyCode::CapsLock;
+                case 69 : return KeyCode::NumLock;
+                case 70 : return KeyCode::ScrollLock;
+                case 71 : return KeyCode::Keypad7;
+                case 72 : return KeyCode::Keypad8;
+                case 73 : return KeyCode::Keypad9;
+                case 74 : return KeyCode::KeypadSubtract;
+                case 75 : return KeyCode::Keypad4;
+                case 76 : return KeyCode::Keypad5;
+                case 77 : return KeyCode::Keypad6;
+                case 78 : return KeyCode::KeypadAdd;
+                case 79 : return KeyCode::Keypad1;
+                case 80 : return KeyCode::Keypad2;
+                case 81 : return KeyCode::Keypad3;
+                case 82 : return KeyCode::Keypad0;
+                case 83 : return KeyCode::KeypadDecimal;
+                case 87 : return KeyCode::F11;
+                case 88 : return KeyCode::F12;
+                case 96 : return KeyCode::KeypadEnter;
+                case 97 : return KeyCode::RightControl;
+                case 98 : return KeyCode::KeypadDivide;
+                case 99 : return KeyCode::PrintScreen;
+                case 100: return KeyCode::RightAlt;
+                case 102: return KeyCode::Home;
+                case 103: return KeyCode::UpArrow;
+                case 104: return KeyCode::PageUp;
+                case 105: return KeyCode::LeftArrow;
+                case 106: return KeyCode::RightArrow;
+                case 107: return KeyCode::End;
+                case 108: return KeyCode::DownArrow;
+                case 109: return KeyCode::PageDown;
+                case 110: return KeyCode::Insert;
+                case 111: return KeyCode::Delete;
+                case 117: return KeyCode::KeypadEqual;
+                case 119: return KeyCode::Pause;
+                case 125: return KeyCode::LeftSuper;
+                case 126: return KeyCode::RightSuper;
+                case 127: return KeyCode::Menu;
+                default : break;
+            }
+
+            return KeyCode::None;
+        }
+
+        static MouseCode ConvertButtonToMouseCode(xcb_button_t button)
+        {
+            switch (button)
+            {
+                case 1 : return MouseCode::Left;
+                case 2 : return MouseCode::Middle;
+                case 3 : return MouseCode::Right;
+                case 8 : return MouseCode::X1;
+                case 9 : return MouseCode::X2;
+                default: break;
+            }
+
+            return MouseCode::None;
+        }
+
+        static uint8_t GetEventType(const xcb_generic_event_t* event)
+        {
+            return event->response_type & ~0x80;
+        }
+
+    }
+
+    ////////////////////////////////////////////////////////////////
+    // XCB KEYBOARD ////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    XcbKeyboard::XcbKeyboard()
+    {
+        Reset();
+    }
+
+    bool XcbKeyboard::ProcessEvent(const xcb_generic_event_t* event)
+    {
+        const uint8_t eventType = Utils::GetEventType(event);
+        if ((eventType != XCB_KEY_PRESS) && (eventType != XCB_KEY_RELEASE))
+        {
+            return false;
+        }
+
+        const auto* keyEvent = reinterpret_cast<const xcb_key_press_event_t*>(event);
+        const KeyCode keyCode = Utils::ConvertKeycodeToKeyCode(keyEvent->detail);
+        if (keyCode == KeyCode::None)
+        {
+            return false;
+        }
+
+        if (eventType == XCB_KEY_PRESS)
+        {
+            OnKeyDown(keyCode);
+        }
+        else
+        {
+            OnKeyUp(keyCode);
+        }
+
+        return true;
+    }
+
+    ////////////////////////////////////////////////////////////////
+    // XCB MOUSE ///////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    XcbMouse::XcbMouse()
+    {
+        Reset();
+    }
+
+    bool XcbMouse::ProcessEvent(const xcb_generic_event_t* event)
+    {
+        const uint8_t eventType = Utils::GetEventType(event);
+        if ((eventType != XCB_BUTTON_PRESS) && (eventType != XCB_BUTTON_RELEASE))
+        {
+            return false;
+        }
+
+        const auto* buttonEvent = reinterpret_cast<const xcb_button_press_event_t*>(event);
+        // The wheel is reported as buttons 4 and 5, one press per notch.
+        if ((buttonEvent->detail == 4) || (buttonEvent->detail == 5))
+        {
+            if (eventType == XCB_BUTTON_PRESS)
+            {
+                OnWheelScroll((buttonEvent->detail == 4) ? 1.0f : -1.0f);
+            }
+
+            return true;
+        }
+
+        const MouseCode mouseCode = Utils::ConvertButtonToMouseCode(buttonEvent->detail);
+        if (mouseCode == MouseCode::None)
+        {
+            return false;
+        }
+
+        if (eventType == XCB_BUTTON_PRESS)
+        {
+            OnButtonDown(mouseCode);
+        }
+        else
+        {
+            OnButtonUp(mouseCode);
+        }
+
+        return true;
+    }
+
+    ////////////////////////////////////////////////////////////////
+    // XCB INPUT DATA //////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    struct XcbInputData
+    {
+        XcbKeyboard Keyboard{};
+        XcbMouse Mouse{};
+    };
+
+    static XcbInputData s_Data{};
+
+    ////////////////////////////////////////////////////////////////
+    // XCB INPUT ///////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    void XcbInput::Init()
+    {
+        Keyboard = &s_Data.Keyboard;
+        Mouse = &s_Data.Mouse;
+    }
+
+    bool XcbInput::ProcessEvent(const xcb_generic_event_t* event)
+    {
+        if (s_Data.Keyboard.ProcessEvent(event))
+        {
+            return true;
+        }
+
+        if (s_Data.Mouse.ProcessEvent(event))
+        {
+            return true;
+        }
+
+        return false;
+    }
+
+    bool XcbInput::IsKeyRepeat(const xcb_generic_event_t* release, const xcb_generic_event_t* next)
+    {
+        if ((Utils::GetEventType(release) != XCB_KEY_RELEASE) || !next || (Utils::GetEventType(next) != XCB_KEY_PRESS))
+        {
+            return false;
+        }
+
+        const auto* releaseEvent = reinterpret_cast<const xcb_key_release_event_t*>(release);
+        const auto* pressEvent = reinterpret_cast<const xcb_key_press_event_t*>(next);
+        return (releaseEvent->detail == pressEvent->detail) && (releaseEvent->time == pressEvent->time);
+    }
+
+}
+
+#endif
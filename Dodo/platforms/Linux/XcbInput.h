@@ -0,0 +1,52 @@
+#pragma once
+
+#ifdef DODO_LINUX
+
+#include <xcb/xcb.h>
+
+#include "Input/Input.h"
+
+namespace Dodo {
+
+    ////////////////////////////////////////////////////////////////
+    // XCB KEYBOARD ////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    // Keys are mapped by their physical position, as on a US layout.
+    class XcbKeyboard : public Keyboard
+    {
+    public:
+        XcbKeyboard();
+
+        bool ProcessEvent(const xcb_generic_event_t* event);
+    };
+
+    ////////////////////////////////////////////////////////////////
+    // XCB MOUSE ///////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    class XcbMouse : public Mouse
+    {
+    public:
+        XcbMouse();
+
+        bool ProcessEvent(const xcb_generic_event_t* event);
+    };
+
+    ////////////////////////////////////////////////////////////////
+    // XCB INPUT ///////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    class XcbInput : public Input
+    {
+    public:
+        static void Init();
+
+        static bool ProcessEvent(const xcb_generic_event_t* event);
+        // X reports an auto-repeated key as a release directly followed by a press with the same time.
+        static bool IsKeyRepeat(const xcb_generic_event_t* release, const xcb_generic_event_t* next);
+    };
+
+}
+
+#endif
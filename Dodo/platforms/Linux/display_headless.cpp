@@ -0,0 +1,100 @@
+#include "pch.h"
+
+#ifdef DODO_LINUX
+
+#include "display_headless.h"
+#include "HeadlessInput.h"
+#ifdef DODO_VULKAN
+#   include "render_backend_vulkan_headless.h"
+#endif
+
+namespace Dodo {
+
+    DisplayHeadless::DisplayHeadless() {
+        HeadlessInput::Init();
+#ifdef DODO_VULKAN
+        auto backend_vk = Ref<RenderBackendVulkanHeadless>::create();
+        _render_backends.push_back(backend_vk);
+#endif
+    }
+
+    Display::WindowId DisplayHeadless::window_create(const WindowSpecifications& window_specs) {
+        const WindowId window_id = _window_id_counter++;
+        WindowData& data = _window_data[window_id];
+        data.window = window_id;
+        data.platform_data.width = window_specs.width;
+        data.platform_data.height = window_specs.height;
+        data.title = window_specs.title;
+        return window_id;
+    }
+
+    const void* DisplayHeadless::window_get_platform_data(WindowId window_id) const {
+        if (!_window_data.contains(window_id)) {
+            return nullptr;
+        }
+
+        return &_window_data.at(window_id).platform_data;
+    }
+
+    void DisplayHeadless::window_set_event_callback(WindowId window, const std::function<void(Event&)>& callback) {
+        if (_window_data.contains(window)) {
+            _window_data.at(window).event_callback = callback;
+        }
+    }
+
+    void DisplayHeadless::process_events() {
+        // Swapped out first, a callback may push new events or destroy a window.
+        std::vector<Event> events = {};
+        std::swap(events, _pending_events);
+        for (Event& e : events) {
+            if (!_window_data.contains(e.window)) {
+                continue;
+            }
+
+            WindowData& data = _window_data.at(e.window);
+            if (e.type == Event::Type::window_resize) {
+                data.platform_data.width = e.resized.width;
+                data.platform_data.height = e.resized.height;
+            }
+
+            if (data.event_callback) {
+                data.event_callback(e);
+            }
+        }
+    }
+
+    void DisplayHeadless::window_destroy(WindowId window) {
+        _window_data.erase(window);
+    }
+
+    uint32_t DisplayHeadless::render_backend_get_count() const {
+        return static_cast<uint32_t>(_render_backends.size());
+    }
+
+    Ref<RenderBackend> DisplayHeadless::render_backend_get(size_t index) const {
+        return _render_backends.at(index);
+    }
+
+    void DisplayHeadless::window_push_resize(WindowId window, uint32_t width, uint32_t height) {
+        if (_window_data.contains(window)) {
+            Event e = {};
+            e.window = window;
+            e.type = Event::Type::window_resize;
+            e.resized.width = width;
+            e.resized.height = height;
+            _event_batch_push(_pending_events, e);
+        }
+    }
+
+    void DisplayHeadless::window_push_close(WindowId window) {
+        if (_window_data.contains(window)) {
+            Event e = {};
+            e.window = window;
+            e.type = Event::Type::window_close;
+            _event_batch_push(_pending_events, e);
+        }
+    }
+
+}
+
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#ifdef DODO_LINUX
+
+#include "core/display.h"
+#include "renderer/render_backend.h"
+
+namespace Dodo {
+
+    // Display without a window system for offscreen and CI runs. Windows are only a
+    // size, resize and close events are synthesized and delivered on the next
+    // process_events.
+    class DisplayHeadless : public Display {
+    public:
+        struct PlatformData {
+            uint32_t width = 0;
+            uint32_t height = 0;
+        };
+
+        DisplayHeadless();
+
+        WindowId window_create(const WindowSpecifications& window_specs) override;
+        const void* window_get_platform_data(WindowId window) const override;
+        void window_set_event_callback(WindowId window, const std::function<void(Event&)>& callback) override;
+        void process_events() override;
+        void window_destroy(WindowId window) override;
+        uint32_t render_backend_get_count() const override;
+        Ref<RenderBackend> render_backend_get(size_t index) const override;
+
+        void window_push_resize(WindowId window, uint32_t width, uint32_t height);
+        void window_push_close(WindowId window);
+
+    private:
+        struct WindowData {
+            WindowId window = invalid_window;
+            PlatformData platform_data = {};
+            std::string title = {};
+            std::function<void(Event&)> event_callback = {};
+        };
+
+        std::vector<Ref<RenderBackend>> _render_backends = {};
+        WindowId _window_id_counter = 0;
+        std::map<WindowId, WindowData> _window_data = {};
+        std::vector<Event> _pending_events = {};
+    };
+
+}
+
+#endif
@@ -0,0 +1,228 @@
+#include "pch.h"
+
+#ifdef DODO_LINUX
+
+#include "display_xcb.h"
+#include "XcbInput.h"
+#ifdef DODO_VULKAN
+#   include "render_backend_vulkan_xcb.h"
+#endif
+
+namespace Dodo {
+
+    DisplayXcb::DisplayXcb() {
+        int screen_index = 0;
+        _connection = xcb_connect(nullptr, &screen_index);
+        if (xcb_connection_has_error(_connection)) {
+            // No X server, e.g. CI without Xvfb. The caller falls back to another display.
+            xcb_disconnect(_connection);
+            _connection = nullptr;
+            return;
+        }
+
+        xcb_screen_iterator_t screen_it = xcb_setup_roots_iterator(xcb_get_setup(_connection));
+        for (int i = 0; i < screen_index; i++) {
+            xcb_screen_next(&screen_it);
+        }
+
+        _screen = screen_it.data;
+        _wm_protocols_atom = _intern_atom("WM_PROTOCOLS");
+        _wm_delete_window_atom = _intern_atom("WM_DELETE_WINDOW");
+        XcbInput::Init();
+
+#ifdef DODO_VULKAN
+        auto backend_vk = Ref<RenderBackendVulkanXcb>::create();
+        _render_backends.push_back(backend_vk);
+#endif
+    }
+
+    DisplayXcb::~DisplayXcb() {
+        if (_connection) {
+            for (const auto& [window, data] : _window_data) {
+                xcb_destroy_window(_connection, data.platform_data.window);
+            }
+
+            xcb_disconnect(_connection);
+        }
+    }
+
+    bool DisplayXcb::is_connected() const {
+        return _connection != nullptr;
+    }
+
+    Display::WindowId DisplayXcb::window_create(const WindowSpecifications& window_specs) {
+        if (!_connection) {
+            return invalid_window;
+        }
+
+        const xcb_window_t xcb_window = xcb_generate_id(_connection);
+        const uint32_t value_mask = XCB_CW_BACK_PIXEL | XCB_CW_EVENT_MASK;
+        const uint32_t event_mask = XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_KEY_PRESS | XCB_EVENT_MASK_KEY_RELEASE | XCB_EVENT_MASK_BUTTON_PRESS | XCB_EVENT_MASK_BUTTON_RELEASE;
+        const uint32_t values[] = { _screen->black_pixel, event_mask };
+        xcb_create_window(
+            _connection,
+            XCB_COPY_FROM_PARENT,
+            xcb_window,
+            _screen->root,
+            0, 0,
+            static_cast<uint16_t>(window_specs.width), static_cast<uint16_t>(window_specs.height),
+            0,
+            XCB_WINDOW_CLASS_INPUT_OUTPUT,
+            _screen->root_visual,
+            value_mask,
+            values
+        );
+
+        // Ask the window manager for a client message instead of killing the connection on close.
+        xcb_change_property(_connection, XCB_PROP_MODE_REPLACE, xcb_window, _wm_protocols_atom, XCB_ATOM_ATOM, 32, 1, &_wm_delete_window_atom);
+        xcb_change_property(_connection, XCB_PROP_MODE_REPLACE, xcb_window, XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 8, static_cast<uint32_t>(window_specs.title.size()), window_specs.title.c_str());
+        xcb_map_window(_connection, xcb_window);
+        xcb_flush(_connection);
+
+        const WindowId window_id = _window_id_counter++;
+        WindowData& data = _window_data[window_id];
+        data.window = window_id;
+        data.platform_data.connection = _connection;
+        data.platform_data.window = xcb_window;
+        data.width = window_specs.width;
+        data.height = window_specs.height;
+        data.title = window_specs.title;
+        return window_id;
+    }
+
+    const void* DisplayXcb::window_get_platform_data(WindowId window_id) const {
+        if (!_window_data.contains(window_id)) {
+            return nullptr;
+        }
+
+        return &_window_data.at(window_id).platform_data;
+    }
+
+    void DisplayXcb::window_set_event_callback(WindowId window, const std::function<void(Event&)>& callback) {
+        if (_window_data.contains(window)) {
+            _window_data.at(window).event_callback = callback;
+        }
+    }
+
+    void DisplayXcb::process_events() {
+        if (!_connection) {
+            return;
+        }
+
+        // The connection has one queue for all windows, it is drained completely before
+        // anything is dispatched so a drag-resize results in a single resize per pump.
+        // Input goes straight to the input event queue, stamped with the time it was read.
+        xcb_generic_event_t* next_event = nullptr;
+        while (xcb_generic_event_t* xcb_event = next_event ? std::exchange(next_event, nullptr) : xcb_poll_for_event(_connection)) {
+            switch (xcb_event->response_type & ~0x80) {
+                case XCB_KEY_RELEASE: {
+                    next_event = xcb_poll_for_queued_event(_connection);
+                    if (XcbInput::IsKeyRepeat(xcb_event, next_event)) {
+                        // The key is still held, drop both halves of the repeat.
+                        free(next_event);
+                        next_event = nullptr;
+                        break;
+                    }
+
+                    XcbInput::ProcessEvent(xcb_event);
+                    break;
+                }
+
+                case XCB_KEY_PRESS:
+                case XCB_BUTTON_PRESS:
+                case XCB_BUTTON_RELEASE: {
+                    XcbInput::ProcessEvent(xcb_event);
+                    break;
+                }
+
+                case XCB_CONFIGURE_NOTIFY: {
+                    const auto* configure = reinterpret_cast<const xcb_configure_notify_event_t*>(xcb_event);
+                    WindowData* data = _window_data_find(configure->window);
+                    if (!data || ((data->width == configure->width) && (data->height == configure->height))) {
+                        break;
+                    }
+
+                    data->width = configure->width;
+                    data->height = configure->height;
+
+                    Event e = {};
+                    e.window = data->window;
+                    e.type = Event::Type::window_resize;
+                    e.resized.width = configure->width;
+                    e.resized.height = configure->height;
+                    _event_batch_push(_pending_events, e);
+                    break;
+                }
+
+                case XCB_CLIENT_MESSAGE: {
+                    const auto* message = reinterpret_cast<const xcb_client_message_event_t*>(xcb_event);
+                    WindowData* data = _window_data_find(message->window);
+                    if (!data || (message->data.data32[0] != _wm_delete_window_atom)) {
+                        break;
+                    }
+
+                    Event e = {};
+                    e.window = data->window;
+                    e.type = Event::Type::window_close;
+                    _event_batch_push(_pending_events, e);
+                    break;
+                }
+
+                default:
+                    break;
+            }
+
+            free(xcb_event);
+        }
+
+        std::vector<Event> events = {};
+        std::swap(events, _pending_events);
+        for (Event& e : events) {
+            if (_window_data.contains(e.window) && _window_data.at(e.window).event_callback) {
+                _window_data.at(e.window).event_callback(e);
+            }
+        }
+    }
+
+    void DisplayXcb::window_destroy(WindowId window) {
+        if (_window_data.contains(window)) {
+            xcb_destroy_window(_connection, _window_data.at(window).platform_data.window);
+            xcb_flush(_connection);
+            _window_data.erase(window);
+        }
+    }
+
+    uint32_t DisplayXcb::render_backend_get_count() const {
+        return static_cast<uint32_t>(_render_backends.size());
+    }
+
+    Ref<RenderBackend> DisplayXcb::render_backend_get(size_t index) const {
+        return _render_backends.at(index);
+    }
+
+    xcb_atom_t DisplayXcb::_intern_atom(const char* name) const {
+        const xcb_intern_atom_cookie_t cookie = xcb_intern_atom(_connection, 0, static_cast<uint16_t>(std::strlen(name)), name);
+        xcb_intern_atom_reply_t* reply = xcb_intern_atom_reply(_connection, cookie, nullptr);
+        if (!reply) {
+            DODO_LOG_ERROR_TAG("Engine", "Failed to intern X atom {0}.", name);
+            return XCB_ATOM_NONE;
+        }
+
+        const xcb_atom_t atom = reply->atom;
+        free(reply);
+        return atom;
+    }
+
+    DisplayXcb::WindowData* DisplayXcb::_window_data_find(xcb_window_t xcb_window) {
+        for (auto& [window, data] : _window_data) {
+            if (data.platform_data.window == xcb_window) {
+                return &data;
+            }
+        }
+
+        return nullptr;
+    }
+
+}
+
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+
+#ifdef DODO_LINUX
+
+#include <xcb/xcb.h>
+
+#include "core/display.h"
+#include "renderer/render_backend.h"
+
+namespace Dodo {
+
+    class DisplayXcb : public Display {
+    public:
+        struct PlatformData {
+            xcb_connection_t* connection = nullptr;
+            xcb_window_t window = 0;
+        };
+
+        DisplayXcb();
+        virtual ~DisplayXcb() override;
+
+        bool is_connected() const;
+        WindowId window_create(const WindowSpecifications& window_specs) override;
+        const void* window_get_platform_data(WindowId window) const override;
+        void window_set_event_callback(WindowId window, const std::function<void(Event&)>& callback) override;
+        void process_events() override;
+        void window_destroy(WindowId window) override;
+        uint32_t render_backend_get_count() const override;
+        Ref<RenderBackend> render_backend_get(size_t index) const override;
+
+    private:
+        struct WindowData {
+            WindowId window = invalid_window;
+            PlatformData platform_data = {};
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::string title = {};
+            std::function<void(Event&)> event_callback = {};
+        };
+
+        xcb_atom_t _intern_atom(const char* name) const;
+        WindowData* _window_data_find(xcb_window_t xcb_window);
+
+        std::vector<Ref<RenderBackend>> _render_backends = {};
+        xcb_connection_t* _connection = nullptr;
+        xcb_screen_t* _screen = nullptr;
+        xcb_atom_t _wm_protocols_atom = XCB_ATOM_NONE;
+        xcb_atom_t _wm_delete_window_atom = XCB_ATOM_NONE;
+        WindowId _window_id_counter = 0;
+        std::map<WindowId, WindowData> _window_data = {};
+        std::vector<Event> _pending_events = {};
+    };
+
+}
+
+#endif
@@ -0,0 +1,27 @@
+#include "pch.h"
+
+#if defined(DODO_VULKAN) && defined(DODO_LINUX)
+
+#include "render_backend_vulkan_headless.h"
+
+namespace Dodo {
+
+    SurfaceHandle RenderBackendVulkanHeadless::surface_create(Display::WindowId window, const SurfaceSpecifications& surface_specs, const void* platform_data) {
+        Surface surface_info = {};
+        surface_info.vk_surface = VK_NULL_HANDLE;
+        surface_info.width = surface_specs.width;
+        surface_info.height = surface_specs.height;
+        surface_info.vsync_mode = surface_specs.vsync_mode;
+
+        SurfaceHandle surface = _surface_owner.create(std::move(surface_info));
+        _surfaces[window] = surface;
+        return surface;
+    }
+
+    const char* RenderBackendVulkanHeadless::_get_platform_surface_extension() const {
+        return nullptr;
+    }
+
+}
+
+#endif
@@ -0,0 +1,24 @@
+#pragma once
+
+#if defined(DODO_VULKAN) && defined(DODO_LINUX)
+
+#include "renderer/vulkan/render_backend_vulkan.h"
+
+namespace Dodo {
+
+    // Vulkan without any surface extension, e.g. for lavapipe on machines with
+    // neither a GPU nor a display server. Surfaces only carry a size and
+    // frames are submitted without presenting.
+    class RenderBackendVulkanHeadless : public RenderBackendVulkan {
+    public:
+        RenderBackendVulkanHeadless() = default;
+
+        SurfaceHandle surface_create(Display::WindowId window, const SurfaceSpecifications& surface_specs, const void* platform_data) override;
+
+    protected:
+        const char* _get_platform_surface_extension() const override;
+    };
+
+}
+
+#endif
@@ -0,0 +1,39 @@
+#include "pch.h"
+
+#if defined(DODO_VULKAN) && defined(DODO_LINUX)
+
+#include "render_backend_vulkan_xcb.h"
+#include "display_xcb.h"
+
+#include <vulkan/vulkan_xcb.h>
+
+namespace Dodo {
+
+    SurfaceHandle RenderBackendVulkanXcb::surface_create(Display::WindowId window, const SurfaceSpecifications& surface_specs, const void* platform_data) {
+        const auto& data = *static_cast<const DisplayXcb::PlatformData*>(platform_data);
+
+        VkXcbSurfaceCreateInfoKHR create_info = {};
+        create_info.sType = VK_STRUCTURE_TYPE_XCB_SURFACE_CREATE_INFO_KHR;
+        create_info.connection = data.connection;
+        create_info.window = data.window;
+        VkSurfaceKHR vk_surface = nullptr;
+        DODO_ASSERT_VK_RESULT(vkCreateXcbSurfaceKHR(instance_get(), &create_info, NULL, &vk_surface));
+
+        Surface surface_info = {};
+        surface_info.vk_surface = vk_surface;
+        surface_info.width = surface_specs.width;
+        surface_info.height = surface_specs.height;
+        surface_info.vsync_mode = surface_specs.vsync_mode;
+
+        SurfaceHandle surface = _surface_owner.create(std::move(surface_info));
+        _surfaces[window] = surface;
+        return surface;
+    }
+
+    const char* RenderBackendVulkanXcb::_get_platform_surface_extension() const {
+        return VK_KHR_XCB_SURFACE_EXTENSION_NAME;
+    }
+
+}
+
+#endif
@@ -0,0 +1,21 @@
+#pragma once
+
+#if defined(DODO_VULKAN) && defined(DODO_LINUX)
+
+#include "renderer/vulkan/render_backend_vulkan.h"
+
+namespace Dodo {
+
+    class RenderBackendVulkanXcb : public RenderBackendVulkan {
+    public:
+        RenderBackendVulkanXcb() = default;
+
+        SurfaceHandle surface_create(Display::WindowId window, const SurfaceSpecifications& surface_specs, const void* platform_data) override;
+
+    protected:
+        const char* _get_platform_surface_extension() const override;
+    };
+
+}
+
+#endif
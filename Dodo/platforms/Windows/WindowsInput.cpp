@@ -1,4 +1,7 @@
 #include "pch.h"
+
+#ifdef DODO_WINDOWS
+
 #include "WindowsInput.h"
 
 namespace Dodo {
@@ -11,24 +14,78 @@ namespace Dodo {
 
         static KeyCode ConvertVirtualKeyToKeyCode(SHORT virtualKey)
         {
+            // Letters, digits and function keys are contiguous in both tables.
+            if ((virtualKey >= 'A') && (virtualKey <= 'Z'))
+            {
+                return static_cast<KeyCode>(static_cast<int>(KeyCode::A) + (virtualKey - 'A'));
+            }
+
+            if ((virtualKey >= '0') && (virtualKey <= '9'))
+            {
+                return static_cast<KeyCode>(static_cast<int>(KeyCode::Alpha0) + (virtualKey - '0'));
+            }
+
+            if ((virtualKey >= VK_F1) && (virtualKey <= VK_F24))
+            {
+                return static_cast<KeyCode>(static_cast<int>(KeyCode::F1) + (virtualKey - VK_F1));
+            }
+
+            if ((virtualKey >= VK_NUMPAD0) && (virtualKey <= VK_NUMPAD9))
+            {
+                return static_cast<KeyCode>(static_cast<int>(KeyCode::Keypad0) + (virtualKey - VK_NUMPAD0));
+            }
+
             switch (virtualKey)
             {
-                case VK_LEFT  : return KeyCode::LeftArrow;
-                case VK_UP    : return KeyCode::UpArrow;
-                case VK_RIGHT : return KeyCode::RightArrow;
-                case VK_DOWN  : return KeyCode::DownArrow;
-                case '0'      : return KeyCode::Alpha0;
-                case '1'      : return KeyCode::Alpha1;
-                case '2'      : return KeyCode::Alpha2;
-                case '3'      : return KeyCode::Alpha3;
-                case '4'      : return KeyCode::Alpha4;
-                case '5'      : return KeyCode::Alpha5;
-                case '6'      : return KeyCode::Alpha6;
-                case '7'      : return KeyCode::Alpha7;
-                case '8'      : return KeyCode::Alpha8;
-                case '9'      : return KeyCode::Alpha9;
-                case 'A'      : return KeyCode::A;
-                default       : DODO_ASSERT(false, "KeyCode not supported!");
+                case VK_LEFT       : return KeyCode::LeftArrow;
+                case VK_UP         : return KeyCode::UpArrow;
+                case VK_RIGHT      : return KeyCode::RightArrow;
+                case VK_DOWN       : return KeyCode::DownArrow;
+                case VK_SPACE      : return KeyCode::Space;
+                case VK_RETURN     : return KeyCode::Enter;
+                case VK_ESCAPE     : return KeyCode::Escape;
+                case VK_TAB        : return KeyCode::Tab;
+                case VK_BACK       : return KeyCode::Backspace;
+                case VK_INSERT     : return KeyCode::Insert;
+                case VK_DELETE     : return KeyCode::Delete;
+                case VK_HOME       : return KeyCode::Home;
+                case VK_END        : return KeyCode::End;
+                case VK_PRIOR      : return KeyCode::PageUp;
+                case VK_NEXT       : return KeyCode::PageDown;
+                case VK_SHIFT      :
+                case VK_LSHIFT     : return KeyCode::LeftShift;
+                case VK_RSHIFT     : return KeyCode::RightShift;
+                case VK_CONTROL    :
+                case VK_LCONTROL   : return KeyCode::LeftControl;
+                case VK_RCONTROL   : return KeyCode::RightControl;
+                case VK_MENU       :
+                case VK_LMENU      : return KeyCode::LeftAlt;
+                case VK_RMENU      : return KeyCode::RightAlt;
+                case VK_LWIN       : return KeyCode::LeftSuper;
+                case VK_RWIN       : return KeyCode::RightSuper;
+                case VK_CAPITAL    : return KeyCode::CapsLock;
+                case VK_NUMLOCK    : return KeyCode::NumLock;
+                case VK_SCROLL     : return KeyCode::ScrollLock;
+                case VK_SNAPSHOT   : return KeyCode::PrintScreen;
+                case VK_PAUSE      : return KeyCode::Pause;
+                case VK_APPS       : return KeyCode::Menu;
+                case VK_OEM_7      : return KeyCode::Apostrophe;
+                case VK_OEM_COMMA  : return KeyCode::Comma;
+                case VK_OEM_MINUS  : return KeyCode::Minus;
+                case VK_OEM_PERIOD : return KeyCode::Period;
+                case VK_OEM_2      : return KeyCode::Slash;
+                case VK_OEM_1      : return KeyCode::Semicolon;
+                case VK_OEM_PLUS   : return KeyCode::Equal;
+                case VK_OEM_4      : return KeyCode::LeftBracket;
+                case VK_OEM_5      : return KeyCode::Backslash;
+                case VK_OEM_6      : return KeyCode::RightBracket;
+                case VK_OEM_3      : return KeyCode::GraveAccent;
+                case VK_DECIMAL    : return KeyCode::KeypadDecimal;
+                case VK_DIVIDE     : return KeyCode::KeypadDivide;
+                case VK_MULTIPLY   : return KeyCode::KeypadMultiply;
+                case VK_SUBTRACT   : return KeyCode::KeypadSubtract;
+                case VK_ADD        : return KeyCode::KeypadAdd;
+                default            : break;
             }
             
             return KeyCode::None;
@@ -61,6 +118,11 @@ namespace Dodo {
             {
                 const auto virtualKey = static_cast<SHORT>(wparam);
                 const KeyCode keyCode = Utils::ConvertVirtualKeyToKeyCode(virtualKey);
+                if (keyCode == KeyCode::None)
+                {
+                    return false;
+                }
+
                 if (HIWORD(lparam) & KF_UP)
                 {
                     OnKeyUp(keyCode);
@@ -160,4 +222,6 @@ namespace Dodo {
         return false;
     }
 
-}
\ No newline at end of file
+}
+
+#endif
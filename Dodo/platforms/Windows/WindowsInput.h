@@ -1,5 +1,7 @@
 #pragma once
 
+#ifdef DODO_WINDOWS
+
 #include <Windows.h>
 
 #include "Input/Input.h"
@@ -42,4 +44,6 @@ namespace Dodo {
         static bool WndProc(HWND handle, UINT msg, WPARAM wparam, LPARAM lparam);
     };
 
-}
\ No newline at end of file
+}
+
+#endif
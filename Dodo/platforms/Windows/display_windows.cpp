@@ -3,6 +3,7 @@
 #ifdef DODO_WINDOWS
 
 #include "display_windows.h"
+#include "WindowsInput.h"
 #ifdef DODO_VULKAN
 #   include "render_backend_vulkan_windows.h"
 #endif
@@ -10,9 +11,10 @@
 namespace Dodo {
 
     DisplayWindows::DisplayWindows() {
+        WindowsInput::Init();
 #ifdef DODO_VULKAN
-        auto context_vk = Ref<RenderBackendVulkanWindows>::create();
-        _contexts.push_back(context_vk);
+        auto backend_vk = Ref<RenderBackendVulkanWindows>::create();
+        _render_backends.push_back(backend_vk);
 #endif
     }
 
@@ -57,12 +59,13 @@ namespace Dodo {
 
         const WindowId window_id = _window_id_counter++;
         WindowData& data = _window_data[window_id];
-        data.window_id = window_id;
+        data.window = window_id;
         data.platform_data.hinstance = hinstance;
         data.platform_data.hwnd = hwnd;
         data.width = window_specs.width;
         data.height = window_specs.height;
         data.title = window_specs.title;
+        data.display = this;
 
         SetWindowLongPtrW(hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(&data));
         window_show_and_focus(window_id);
@@ -84,21 +87,29 @@ namespace Dodo {
         }
     }
 
-    void DisplayWindows::window_set_event_callback(WindowId window, Func<void(Event&)>&& callback) {
+    void DisplayWindows::window_set_event_callback(WindowId window, const std::function<void(Event&)>& callback) {
         if (_window_data.contains(window)) {
-            _window_data.at(window).event_callback = std::move(callback);
+            _window_data.at(window).event_callback = callback;
         }
     }
 
-    void DisplayWindows::window_process_events(WindowId window) {
-        if (_window_data.contains(window)) {
-            MSG msg = {};
-            ZeroMemory(&msg, sizeof(MSG));
-            while (PeekMessageW(&msg, _window_data.at(window).platform_data.hwnd, 0, 0, PM_REMOVE)) {
-                // Translate virtual key message into character message.
-                TranslateMessage(&msg);
-                // Dispatch message to window procedure.
-                DispatchMessageW(&msg);
+    void DisplayWindows::process_events() {
+        MSG msg = {};
+        ZeroMemory(&msg, sizeof(MSG));
+        // A null window drains the messages of every window on this thread, the window
+        // procedure only batches events so they are dispatched after the queue is empty.
+        while (PeekMessageW(&msg, NULL, 0, 0, PM_REMOVE)) {
+            // Translate virtual key message into character message.
+            TranslateMessage(&msg);
+            // Dispatch message to window procedure.
+            DispatchMessageW(&msg);
+        }
+
+        std::vector<Event> events = {};
+        std::swap(events, _pending_events);
+        for (Event& e : events) {
+            if (_window_data.contains(e.window) && _window_data.at(e.window).event_callback) {
+                _window_data.at(e.window).event_callback(e);
             }
         }
     }
@@ -116,12 +127,12 @@ namespace Dodo {
         return &_window_data.at(window_id).platform_data;
     }
 
-    uint32_t DisplayWindows::context_get_count() const {
-        return static_cast<uint32_t>(_contexts.size());
+    uint32_t DisplayWindows::render_backend_get_count() const {
+        return static_cast<uint32_t>(_render_backends.size());
     }
 
-    Dodo::Ref<Dodo::RenderContext> DisplayWindows::context_get(size_t index) const {
-        return _contexts.at(index);
+    Ref<RenderBackend> DisplayWindows::render_backend_get(size_t index) const {
+        return _render_backends.at(index);
     }
 
     LRESULT DisplayWindows::_wnd_proc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam) {
@@ -130,6 +141,9 @@ namespace Dodo {
             return DefWindowProcW(hwnd, msg, wparam, lparam);
         }
 
+        // Input messages still reach DefWindowProcW, e.g. so Alt+F4 keeps working.
+        WindowsInput::WndProc(hwnd, msg, wparam, lparam);
+
         auto& window_data = *reinterpret_cast<WindowData*>(user_data);
         switch (msg) {
             case WM_SIZE: {
@@ -143,19 +157,19 @@ namespace Dodo {
                 window_data.height = height;
 
                 Event e = {};
-                e.window_id = window_data.window_id;
+                e.window = window_data.window;
                 e.type = Event::Type::window_resize;
                 e.resized.width = width;
                 e.resized.height = height;
-                window_data.event_callback(e);
+                _event_batch_push(window_data.display->_pending_events, e);
                 break;
             }
 
             case WM_CLOSE: {
                 Event e = {};
-                e.window_id = window_data.window_id;
+                e.window = window_data.window;
                 e.type = Event::Type::window_close;
-                window_data.event_callback(e);
+                _event_batch_push(window_data.display->_pending_events, e);
                 PostQuitMessage(0);
                 break;
             }
@@ -20,7 +20,7 @@ namespace Dodo {
         WindowId window_create(const WindowSpecifications& window_specs) override;
         const void* window_get_platform_data(WindowId window) const override;
         void window_set_event_callback(WindowId window, const std::function<void(Event&)>& callback) override;
-        void window_process_events(WindowId window) override;
+        void process_events() override;
         void window_destroy(WindowId window) override;
         uint32_t render_backend_get_count() const override;
         Ref<RenderBackend> render_backend_get(size_t index) const override;
@@ -33,13 +33,18 @@ namespace Dodo {
             uint32_t height{0};
             std::string title{};
             std::function<void(Event&)> event_callback{};
+            DisplayWindows* display = nullptr;
         };
 
+        void window_show_and_focus(WindowId window_id);
+        void window_focus(WindowId window_id);
+
         static LRESULT CALLBACK _wnd_proc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam);
 
-        std::vector<Ref<RenderContext>> _contexts = {};
+        std::vector<Ref<RenderBackend>> _render_backends = {};
         WindowId _window_id_counter = 0;
         std::map<WindowId, WindowData> _window_data = {};
+        std::vector<Event> _pending_events = {};
     };
 
 }
@@ -2,13 +2,13 @@
 
 #if defined(DODO_VULKAN) && defined(DODO_WINDOWS)
 
-#include "renderer/vulkan/render_context_vulkan.h"
+#include "renderer/vulkan/render_backend_vulkan.h"
 
 namespace Dodo {
 
-    class RenderContextVulkanWindows : public RenderContextVulkan {
+    class RenderBackendVulkanWindows : public RenderBackendVulkan {
     public:
-        RenderContextVulkanWindows() = default;
+        RenderBackendVulkanWindows() = default;
 
         SurfaceHandle surface_create(Display::WindowId window, const SurfaceSpecifications& surface_specs, const void* platform_data) override;
 
@@ -18,4 +18,4 @@ namespace Dodo {
 
 }
 
-#endif
\ No newline at end of file
+#endif
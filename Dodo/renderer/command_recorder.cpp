@@ -0,0 +1,100 @@
+#include "pch.h"
+#include "command_recorder.h"
+
+namespace Dodo {
+
+    CommandRecorder::~CommandRecorder() {
+        de_initialize();
+    }
+
+    void CommandRecorder::initialize(Ref<RenderDevice> device, CommandQueueFamilyHandle command_queue_family, uint32_t frame_count, uint32_t thread_count, uint32_t max_job_count) {
+        DODO_PROFILE_SCOPE("CommandRecorder::initialize");
+        DODO_ASSERT(!_device);
+        _device = device;
+        _command_queue_family = command_queue_family;
+        _max_job_count = max_job_count;
+        _frames.resize(frame_count);
+        for (Frame& frame : _frames) {
+            // Any thread may end up running every job of the frame.
+            frame.thread_command_pools.resize(thread_count + 1);
+            for (ThreadCommandPool& thread_command_pool : frame.thread_command_pools) {
+                thread_command_pool.command_pool = _device->command_pool_create(_command_queue_family);
+                thread_command_pool.command_buffers.resize(_max_job_count);
+                for (CommandBufferHandle& command_buffer : thread_command_pool.command_buffers) {
+                    command_buffer = _device->command_buffer_create(thread_command_pool.command_pool, RenderDevice::CommandBufferType::secondary);
+                }
+            }
+        }
+
+        _frame_index = 0;
+        _job_count = 0;
+    }
+
+    void CommandRecorder::de_initialize() {
+        if (!_device) {
+            return;
+        }
+
+        for (Frame& frame : _frames) {
+            for (ThreadCommandPool& thread_command_pool : frame.thread_command_pools) {
+                for (const CommandBufferHandle& command_buffer : thread_command_pool.command_buffers) {
+                    _device->command_buffer_destroy(command_buffer);
+                }
+
+                _device->command_pool_destroy(thread_command_pool.command_pool);
+            }
+        }
+
+        _frames.clear();
+        _device = nullptr;
+    }
+
+    void CommandRecorder::begin_frame(uint32_t frame_index) {
+        DODO_PROFILE_SCOPE("CommandRecorder::begin_frame");
+        _frame_index = frame_index;
+        _job_count = 0;
+        for (ThreadCommandPool& thread_command_pool : _frames.at(_frame_index).thread_command_pools) {
+            if (thread_command_pool.used_count > 0) {
+                _device->command_pool_reset(thread_command_pool.command_pool);
+                thread_command_pool.used_count = 0;
+            }
+        }
+    }
+
+    void CommandRecorder::record(ThreadPool& thread_pool, CommandBufferHandle primary_command_buffer, std::span<const Job> jobs) {
+        DODO_PROFILE_SCOPE("CommandRecorder::record");
+        DODO_ASSERT(_device && primary_command_buffer);
+        if (jobs.size() > (_max_job_count - _job_count)) {
+            DODO_LOG_ERROR_TAG("Renderer", "{0} record jobs exceed the maximum of {1} per frame!", _job_count + jobs.size(), _max_job_count);
+            jobs = jobs.first(_max_job_count - _job_count);
+        }
+
+        if (jobs.empty()) {
+            return;
+        }
+
+        Frame& frame = _frames.at(_frame_index);
+        DODO_ASSERT(frame.thread_command_pools.size() > thread_pool.thread_count_get());
+        _job_count += static_cast<uint32_t>(jobs.size());
+        _recorded_command_buffers.assign(jobs.size(), CommandBufferHandle());
+        _tasks.clear();
+        for (size_t i = 0; i < jobs.size(); i++) {
+            _tasks.push_back(thread_pool.add_task([this, &frame, &thread_pool, &jobs, i](void*) {
+                ThreadCommandPool& thread_command_pool = frame.thread_command_pools.at(thread_pool.thread_index_get());
+                const CommandBufferHandle command_buffer = thread_command_pool.command_buffers.at(thread_command_pool.used_count++);
+                _device->command_buffer_begin(command_buffer);
+                jobs[i](command_buffer);
+                _device->command_buffer_end(command_buffer);
+                _recorded_command_buffers.at(i) = command_buffer;
+            }, "CommandRecorder::job"));
+        }
+
+        for (const ThreadPool::TaskId task : _tasks) {
+            thread_pool.wait_on_task_to_complete(task);
+        }
+
+        DODO_METRIC_COUNTER_ADD("renderer.recorded_secondary_command_buffers", jobs.size());
+        _device->command_buffer_execute_commands(primary_command_buffer, _recorded_command_buffers);
+    }
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "render_device.h"
+#include "core/thread_pool.h"
+
+namespace Dodo {
+
+    // Records the draw work of a frame in parallel on the thread pool. Command pools are not
+    // thread safe, so every thread records secondary command buffers from its own pool, one
+    // pool per thread and frame in flight. The primary command buffer executes the secondaries
+    // in job order, the result does not depend on which thread ran which job.
+    class CommandRecorder {
+    public:
+        using Job = std::function<void(CommandBufferHandle command_buffer)>;
+
+        CommandRecorder() = default;
+        ~CommandRecorder();
+
+        // Command buffers are created here for max_job_count jobs per frame, the render thread may read
+        // the device handle pools while frames are recorded.
+        void initialize(Ref<RenderDevice> device, CommandQueueFamilyHandle command_queue_family, uint32_t frame_count, uint32_t thread_count, uint32_t max_job_count = 16);
+        void de_initialize();
+
+        // Resets the pools of the frame in bulk, must be called after the frame's fence wait.
+        void begin_frame(uint32_t frame_index);
+        // Blocks until every job recorded its secondary command buffer, then executes them on the
+        // primary command buffer. Jobs must not create or destroy device objects, jobs beyond the
+        // maximum per frame are dropped.
+        void record(ThreadPool& thread_pool, CommandBufferHandle primary_command_buffer, std::span<const Job> jobs);
+
+    private:
+        struct ThreadCommandPool {
+            CommandPoolHandle command_pool = {};
+            std::vector<CommandBufferHandle> command_buffers = {};
+            // Only touched by the thread that owns the pool while jobs run.
+            uint32_t used_count = 0;
+        };
+
+        struct Frame {
+            // One pool per worker thread, the last one for threads outside the thread pool.
+            std::vector<ThreadCommandPool> thread_command_pools = {};
+        };
+
+        Ref<RenderDevice> _device = nullptr;
+        CommandQueueFamilyHandle _command_queue_family = {};
+        std::vector<Frame> _frames = {};
+        uint32_t _frame_index = 0;
+        uint32_t _max_job_count = 0;
+        // Jobs recorded in the current frame, every thread pool has command buffers for all of them.
+        uint32_t _job_count = 0;
+        std::vector<CommandBufferHandle> _recorded_command_buffers = {};
+        std::vector<ThreadPool::TaskId> _tasks = {};
+    };
+
+}
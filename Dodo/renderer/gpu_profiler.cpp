@@ -0,0 +1,123 @@
+#include "pch.h"
+#include "gpu_profiler.h"
+
+namespace Dodo {
+
+    GpuProfiler::~GpuProfiler() {
+        de_initialize();
+    }
+
+    void GpuProfiler::initialize(Ref<RenderDevice> device, uint32_t frame_count, uint32_t max_zone_count) {
+        DODO_ASSERT(!_device);
+        _device = device;
+        _max_query_count = max_zone_count * 2;
+        _timestamps.resize(_max_query_count);
+        _frames.resize(frame_count);
+        _is_active = true;
+        for (Frame& frame : _frames) {
+            frame.query_pool = _device->timestamp_query_pool_create(_max_query_count);
+            frame.zones.reserve(max_zone_count);
+            _is_active &= !frame.query_pool.is_null();
+        }
+
+        if (!_is_active) {
+            DODO_LOG_WARNING_TAG("Renderer", "Timestamp queries are not supported, GPU zones are disabled.");
+        }
+    }
+
+    void GpuProfiler::de_initialize() {
+        if (!_device) {
+            return;
+        }
+
+        for (Frame& frame : _frames) {
+            if (frame.query_pool) {
+                _device->timestamp_query_pool_destroy(frame.query_pool);
+            }
+        }
+
+        _frames.clear();
+        _device = nullptr;
+        _is_active = false;
+    }
+
+    void GpuProfiler::begin_frame(uint32_t frame_index, CommandBufferHandle command_buffer) {
+        DODO_PROFILE_SCOPE("GpuProfiler::begin_frame");
+        _resolved_frame_time = -1.0;
+        if (!_is_active) {
+            return;
+        }
+
+        _frame_index = frame_index;
+        Frame& frame = _frames.at(_frame_index);
+        if (frame.query_count > 0) {
+            _resolve(frame);
+        }
+
+        _device->timestamp_query_pool_reset(command_buffer, frame.query_pool);
+        frame.zones.clear();
+        frame.query_count = 0;
+        _depth = 0;
+        _frame_zone = zone_begin(command_buffer, "Frame");
+    }
+
+    void GpuProfiler::end_frame(CommandBufferHandle command_buffer) {
+        zone_end(command_buffer, _frame_zone);
+        _frame_zone = invalid_zone;
+    }
+
+    uint32_t GpuProfiler::zone_begin(CommandBufferHandle command_buffer, const char* name) {
+        if (!_is_active) {
+            return invalid_zone;
+        }
+
+        Frame& frame = _frames.at(_frame_index);
+        if ((frame.query_count + 2) > _max_query_count) {
+            return invalid_zone;
+        }
+
+        Zone zone = {};
+        zone.name = name;
+        zone.depth = _depth++;
+        zone.begin_query = frame.query_count++;
+        zone.end_query = frame.query_count++;
+        _device->command_buffer_write_timestamp(command_buffer, frame.query_pool, zone.begin_query);
+        frame.zones.push_back(zone);
+        return static_cast<uint32_t>(frame.zones.size() - 1);
+    }
+
+    void GpuProfiler::zone_end(CommandBufferHandle command_buffer, uint32_t zone_index) {
+        if (zone_index == invalid_zone) {
+            return;
+        }
+
+        Frame& frame = _frames.at(_frame_index);
+        _depth--;
+        _device->command_buffer_write_timestamp(command_buffer, frame.query_pool, frame.zones.at(zone_index).end_query);
+    }
+
+    void GpuProfiler::_resolve(Frame& frame) {
+        DODO_PROFILE_SCOPE("GpuProfiler::resolve");
+        // The frame's fence has signaled, so the results are normally ready. If they
+        // are not, the zones of that frame are dropped instead of stalling.
+        if (!_device->timestamp_query_pool_get_results(frame.query_pool, frame.query_count, _timestamps.data())) {
+            return;
+        }
+
+        Profiler::ThreadBuffer* track = Profiler::is_enabled() ? &Profiler::track_get("GPU") : nullptr;
+        for (const Zone& zone : frame.zones) {
+            const uint64_t begin = _timestamps.at(zone.begin_query);
+            const uint64_t end = std::max(begin, _timestamps.at(zone.end_query));
+            if (track) {
+                track->push({ zone.name, begin, end, zone.depth });
+            }
+        }
+
+        // The first zone always is the "Frame" zone.
+        const Zone& frame_zone = frame.zones.front();
+        const uint64_t begin = _timestamps.at(frame_zone.begin_query);
+        const uint64_t end = std::max(begin, _timestamps.at(frame_zone.end_query));
+        _resolved_frame_time = Timer::ticks_to_milliseconds(end - begin);
+    }
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "render_device.h"
+
+namespace Dodo {
+
+    // Measures GPU zones with timestamp queries. Every frame in flight owns its own query
+    // pool, results are read back without stalling once the frame's fence has signaled
+    // and end up on the "GPU" track of the Profiler.
+    class GpuProfiler {
+    public:
+        static constexpr uint32_t invalid_zone = UINT32_MAX;
+
+        GpuProfiler() = default;
+        ~GpuProfiler();
+
+        void initialize(Ref<RenderDevice> device, uint32_t frame_count, uint32_t max_zone_count = 256);
+        void de_initialize();
+
+        // Must be called after the frame's fence wait, right after the command buffer began.
+        void begin_frame(uint32_t frame_index, CommandBufferHandle command_buffer);
+        void end_frame(CommandBufferHandle command_buffer);
+        uint32_t zone_begin(CommandBufferHandle command_buffer, const char* name);
+        void zone_end(CommandBufferHandle command_buffer, uint32_t zone_index);
+
+        // GPU time of the most recently resolved frame, negative if none was resolved in begin_frame.
+        double resolved_frame_time_get() const { return _resolved_frame_time; }
+
+    private:
+        struct Zone {
+            const char* name = nullptr;
+            uint32_t depth = 0;
+            uint32_t begin_query = 0;
+            uint32_t end_query = 0;
+        };
+
+        struct Frame {
+            QueryPoolHandle query_pool = {};
+            std::vector<Zone> zones = {};
+            uint32_t query_count = 0;
+        };
+
+        void _resolve(Frame& frame);
+
+        Ref<RenderDevice> _device = nullptr;
+        std::vector<Frame> _frames = {};
+        std::vector<uint64_t> _timestamps = {};
+        uint32_t _max_query_count = 0;
+        uint32_t _frame_index = 0;
+        uint32_t _frame_zone = invalid_zone;
+        uint32_t _depth = 0;
+        double _resolved_frame_time = -1.0;
+        bool _is_active = false;
+    };
+
+    class GpuProfileScope {
+    public:
+        GpuProfileScope(GpuProfiler& profiler, CommandBufferHandle command_buffer, const char* name)
+            : _profiler(profiler), _command_buffer(command_buffer), _zone_index(profiler.zone_begin(command_buffer, name)) {}
+
+        ~GpuProfileScope() {
+            _profiler.zone_end(_command_buffer, _zone_index);
+        }
+
+        GpuProfileScope(const GpuProfileScope&) = delete;
+        GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+    private:
+        GpuProfiler& _profiler;
+        CommandBufferHandle _command_buffer = {};
+        uint32_t _zone_index = GpuProfiler::invalid_zone;
+    };
+
+}
+
+#ifdef DODO_ENABLE_PROFILER
+#   define DODO_GPU_PROFILE_SCOPE(PROFILER, COMMAND_BUFFER, NAME) ::Dodo::GpuProfileScope DODO_PROFILE_CONCAT(gpu_profile_scope_, __LINE__)(PROFILER, COMMAND_BUFFER, NAME)
+#else
+#   define DODO_GPU_PROFILE_SCOPE(...)
+#endif
@@ -0,0 +1,89 @@
+#include "pch.h"
+#include "pipeline_state.h"
+
+#include "core/Hash.h"
+
+namespace Dodo {
+
+    namespace Utils {
+
+        // Field by field, the padding of the structures would make equal states differ.
+        template<typename T>
+        static void append_bytes(std::string& r_bytes, const T& value) {
+            r_bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        static void append_attachment_formats(std::string& r_bytes, const RenderDevice::PipelineSpecifications& specs) {
+            append_bytes(r_bytes, specs.color_formats.size());
+            for (const RenderDevice::TextureFormat format : specs.color_formats) {
+                append_bytes(r_bytes, format);
+            }
+
+            append_bytes(r_bytes, specs.has_depth_stencil);
+            append_bytes(r_bytes, specs.depth_stencil_format);
+        }
+
+    }
+
+    std::string PipelineState::key_make(const RenderDevice::PipelineSpecifications& specs) {
+        std::string key = {};
+        Utils::append_bytes(key, specs.shaders.size());
+        for (const RenderDevice::ShaderSpecifications& shader : specs.shaders) {
+            Utils::append_bytes(key, shader.stage);
+            Utils::append_bytes(key, shader.spirv.size());
+            Utils::append_bytes(key, FNV1a()(shader.spirv.data(), shader.spirv.size() * sizeof(uint32_t)));
+            Utils::append_bytes(key, shader.entry_point.size());
+            key.append(shader.entry_point);
+        }
+
+        Utils::append_bytes(key, specs.vertex_bindings.size());
+        for (const RenderDevice::VertexBinding& binding : specs.vertex_bindings) {
+            Utils::append_bytes(key, binding.binding);
+            Utils::append_bytes(key, binding.stride);
+            Utils::append_bytes(key, binding.is_per_instance);
+        }
+
+        Utils::append_bytes(key, specs.vertex_attributes.size());
+        for (const RenderDevice::VertexAttribute& attribute : specs.vertex_attributes) {
+            Utils::append_bytes(key, attribute.location);
+            Utils::append_bytes(key, attribute.binding);
+            Utils::append_bytes(key, attribute.format);
+            Utils::append_bytes(key, attribute.offset);
+        }
+
+        Utils::append_bytes(key, specs.topology);
+        Utils::append_bytes(key, specs.cull_mode);
+        Utils::append_bytes(key, specs.is_depth_test_enabled);
+        Utils::append_bytes(key, specs.is_depth_write_enabled);
+        Utils::append_bytes(key, specs.depth_compare_op);
+        Utils::append_bytes(key, specs.is_blend_enabled);
+        Utils::append_attachment_formats(key, specs);
+        Utils::append_bytes(key, specs.push_constant_size);
+        return key;
+    }
+
+    std::string PipelineState::render_pass_key_make(const RenderDevice::PipelineSpecifications& specs) {
+        std::string key = {};
+        Utils::append_attachment_formats(key, specs);
+        return key;
+    }
+
+    PipelineState::BindAction PipelineState::bind_action_resolve(RenderDevice::PipelineStatus status, RenderDevice::PipelineBindPolicy bind_policy, RenderDevice::PipelineStatus fallback_status) {
+        if (status == RenderDevice::PipelineStatus::ready) {
+            return BindAction::bind;
+        }
+
+        if (status == RenderDevice::PipelineStatus::failed) {
+            return BindAction::skip;
+        }
+
+        switch (bind_policy) {
+            case RenderDevice::PipelineBindPolicy::wait : return BindAction::wait;
+            case RenderDevice::PipelineBindPolicy::fallback : return (fallback_status == RenderDevice::PipelineStatus::ready) ? BindAction::bind_fallback : BindAction::skip;
+            case RenderDevice::PipelineBindPolicy::skip : return BindAction::skip;
+        }
+
+        return BindAction::skip;
+    }
+
+}
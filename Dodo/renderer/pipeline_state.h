@@ -0,0 +1,28 @@
+#pragma once
+
+#include "render_device.h"
+
+namespace Dodo {
+
+    // The parts of pipeline handling that do not depend on the graphics API.
+    class PipelineState {
+    public:
+        enum class BindAction {
+            bind,
+            // Compiles on the calling thread or waits for the worker that does, then binds.
+            wait,
+            bind_fallback,
+            skip
+        };
+
+        // Every field that makes up the state as bytes, pipelines with equal keys are interchangeable. The
+        // SPIR-V goes in as its size and hash, so the key stays small whatever the size of the shaders.
+        // The fallback is not part of the state.
+        static std::string key_make(const RenderDevice::PipelineSpecifications& specs);
+        // Only the attachment formats, pipelines with equal keys compile against the same render pass.
+        static std::string render_pass_key_make(const RenderDevice::PipelineSpecifications& specs);
+        // Pipelines without a fallback pass failed as its status.
+        static BindAction bind_action_resolve(RenderDevice::PipelineStatus status, RenderDevice::PipelineBindPolicy bind_policy, RenderDevice::PipelineStatus fallback_status);
+    };
+
+}
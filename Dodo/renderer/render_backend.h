@@ -59,6 +59,9 @@ namespace Dodo {
         virtual void surface_set_size(SurfaceHandle surface, uint32_t width, uint32_t height) = 0;
         virtual bool surface_get_needs_resize(SurfaceHandle surface) = 0;
         virtual void surface_set_needs_resize(SurfaceHandle surface, bool needs_resize) = 0;
+        virtual VSyncMode surface_get_vsync_mode(SurfaceHandle surface) = 0;
+        // Takes effect when the swap chain of the surface is recreated next.
+        virtual void surface_set_vsync_mode(SurfaceHandle surface, VSyncMode vsync_mode) = 0;
         virtual void surface_destroy(SurfaceHandle surface) = 0;
         virtual uint32_t adapter_get_count() const = 0;
         virtual const Adapter& adapter_get(size_t index) const = 0;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <span>
+
 #include "render_backend.h"
 #include "render_handle.h"
 
@@ -14,6 +16,10 @@ namespace Dodo {
     DODO_DEFINE_RENDER_HANDLE(SwapChain);
     DODO_DEFINE_RENDER_HANDLE(Framebuffer);
     DODO_DEFINE_RENDER_HANDLE(Buffer);
+    DODO_DEFINE_RENDER_HANDLE(Texture);
+    DODO_DEFINE_RENDER_HANDLE(TextureHeap);
+    DODO_DEFINE_RENDER_HANDLE(QueryPool);
+    DODO_DEFINE_RENDER_HANDLE(Pipeline);
 
     class RenderDevice : public RefCounted {
     public:
@@ -34,30 +40,335 @@ namespace Dodo {
             error
         };
 
+        enum class MemoryUsage {
+            gpu_only,
+            // Persistently mapped, written by the CPU and read by the GPU, e.g. staging and per frame constants.
+            cpu_to_gpu,
+            // Persistently mapped and cached where possible, e.g. readbacks.
+            gpu_to_cpu
+        };
+
+        enum BufferUsageBits : uint32_t {
+            buffer_usage_transfer_src = 1 << 0,
+            buffer_usage_transfer_dst = 1 << 1,
+            buffer_usage_uniform      = 1 << 2,
+            buffer_usage_storage      = 1 << 3,
+            buffer_usage_index        = 1 << 4,
+            buffer_usage_vertex       = 1 << 5,
+            buffer_usage_indirect     = 1 << 6
+        };
+
+        struct BufferSpecifications {
+            uint64_t size = 0;
+            uint32_t usage = 0;
+            MemoryUsage memory_usage = MemoryUsage::gpu_only;
+        };
+
+        enum class TextureFormat {
+            rgba8_unorm,
+            rgba8_srgb,
+            bgra8_unorm,
+            bgra8_srgb,
+            rgba16_float,
+            rgba32_float,
+            r32_float,
+            depth32_float,
+            depth24_stencil8
+        };
+
+        enum TextureUsageBits : uint32_t {
+            texture_usage_transfer_src             = 1 << 0,
+            texture_usage_transfer_dst             = 1 << 1,
+            texture_usage_sampled                  = 1 << 2,
+            texture_usage_storage                  = 1 << 3,
+            texture_usage_color_attachment         = 1 << 4,
+            texture_usage_depth_stencil_attachment = 1 << 5
+        };
+
+        struct TextureSpecifications {
+            uint32_t width = 1;
+            uint32_t height = 1;
+            uint32_t depth = 1;
+            uint32_t mip_count = 1;
+            uint32_t layer_count = 1;
+            TextureFormat format = TextureFormat::rgba8_unorm;
+            uint32_t usage = texture_usage_sampled;
+        };
+
+        // How commands access a resource. Barriers are derived from the state before and after,
+        // for textures the state also decides the layout. Vertex input and indirect arguments are buffer only.
+        enum class ResourceState {
+            undefined,
+            transfer_src,
+            transfer_dst,
+            vertex_input,
+            indirect_argument,
+            shader_read,
+            shader_write,
+            color_attachment,
+            depth_stencil_attachment,
+            depth_stencil_read,
+            present
+        };
+
+        // Discarding skips the layout transition of the previous contents, e.g. when a texture takes
+        // over the memory of another one. The state before still orders the previous accesses.
+        struct TextureBarrier {
+            TextureHandle texture = {};
+            ResourceState state_before = ResourceState::undefined;
+            ResourceState state_after = ResourceState::undefined;
+            bool discard = false;
+        };
+
+        struct BufferBarrier {
+            BufferHandle buffer = {};
+            ResourceState state_before = ResourceState::undefined;
+            ResourceState state_after = ResourceState::undefined;
+        };
+
+        // Orders every access in the states before against the states after, whichever resource they touched.
+        // E.g. a texture taking over aliased memory waits for all textures that used it without a barrier on each.
+        struct MemoryBarrier {
+            // Bit masks of resource_state_bit.
+            uint32_t states_before = 0;
+            uint32_t states_after = 0;
+        };
+
+        static constexpr uint32_t resource_state_bit(ResourceState state) { return 1u << static_cast<uint32_t>(state); }
+
+        struct MemoryRequirements {
+            uint64_t size = 0;
+            uint64_t alignment = 1;
+            uint32_t memory_type_bits = 0;
+        };
+
+        enum class ShaderStage {
+            vertex,
+            fragment,
+            compute
+        };
+
+        struct ShaderSpecifications {
+            ShaderStage stage = ShaderStage::vertex;
+            std::vector<uint32_t> spirv = {};
+            std::string entry_point = "main";
+        };
+
+        enum class VertexFormat {
+            float1,
+            float2,
+            float3,
+            float4,
+            uint1,
+            rgba8_unorm
+        };
+
+        struct VertexBinding {
+            uint32_t binding = 0;
+            uint32_t stride = 0;
+            bool is_per_instance = false;
+        };
+
+        struct VertexAttribute {
+            uint32_t location = 0;
+            uint32_t binding = 0;
+            VertexFormat format = VertexFormat::float3;
+            uint32_t offset = 0;
+        };
+
+        enum class PrimitiveTopology {
+            triangle_list,
+            triangle_strip,
+            line_list,
+            point_list
+        };
+
+        enum class CullMode {
+            none,
+            front,
+            back
+        };
+
+        enum class CompareOp {
+            never,
+            less,
+            equal,
+            less_or_equal,
+            greater,
+            not_equal,
+            greater_or_equal,
+            always
+        };
+
+        // Every pipeline shares one layout, so the bindless sets stay bound across pipeline changes:
+        //   set 0, binding 0: sampled textures, indexed by texture_get_bindless_index
+        //   set 0, binding 1: the samplers below, indexed by BindlessSampler
+        //   set 1, binding 0: storage textures, indexed by texture_get_bindless_index
+        //   set 2, binding 0: storage buffers, indexed by buffer_get_bindless_index
+        // The arrays are partially bound, a shader must only read the slots of live resources.
+        enum class BindlessSampler {
+            linear_repeat,
+            linear_clamp,
+            nearest_repeat,
+            nearest_clamp
+        };
+
+        static constexpr uint32_t bindless_sampler_count = 4;
+        static constexpr uint32_t invalid_bindless_index = UINT32_MAX;
+        // The smallest limit Vulkan guarantees, shared by every stage.
+        static constexpr uint32_t max_push_constant_size = 128;
+
+        // A compute shader makes a compute pipeline, vertex and fragment shaders a graphics pipeline.
+        // Viewport and scissor are dynamic, the attachment formats only decide render pass compatibility.
+        struct PipelineSpecifications {
+            std::vector<ShaderSpecifications> shaders = {};
+            std::vector<VertexBinding> vertex_bindings = {};
+            std::vector<VertexAttribute> vertex_attributes = {};
+            PrimitiveTopology topology = PrimitiveTopology::triangle_list;
+            CullMode cull_mode = CullMode::back;
+            bool is_depth_test_enabled = false;
+            bool is_depth_write_enabled = false;
+            CompareOp depth_compare_op = CompareOp::less_or_equal;
+            // Alpha blending over the color attachments.
+            bool is_blend_enabled = false;
+            std::vector<TextureFormat> color_formats = {};
+            bool has_depth_stencil = false;
+            TextureFormat depth_stencil_format = TextureFormat::depth32_float;
+            // At most max_push_constant_size, e.g. the bindless indices of a draw.
+            uint32_t push_constant_size = 0;
+            // Bound instead while this pipeline compiles, e.g. one with simpler shaders. Not part of the state.
+            PipelineHandle fallback = {};
+        };
+
+        enum class PipelineStatus {
+            compiling,
+            ready,
+            failed
+        };
+
+        // What binding a pipeline that is still compiling does.
+        enum class PipelineBindPolicy {
+            // Blocks until it compiled, helping with the compilation when no worker picked it up yet.
+            wait,
+            // Binds the fallback pipeline when that one is ready, otherwise skips.
+            fallback,
+            // Binds nothing, the draws that need the pipeline are dropped for this frame.
+            skip
+        };
+
+        // Usage is what this device allocated in the heap, budget what it should stay below.
+        struct MemoryHeapStatistics {
+            uint64_t heap_size = 0;
+            uint64_t budget = 0;
+            uint64_t usage = 0;
+            uint64_t allocated = 0;
+            uint32_t block_count = 0;
+            uint32_t allocation_count = 0;
+            uint32_t dedicated_allocation_count = 0;
+            bool is_device_local = false;
+        };
+
+        // Submissions keep their lists inline, longer lists are an error.
+        static constexpr size_t max_submit_command_buffer_count = 16;
+        static constexpr size_t max_submit_semaphore_count = 8;
+        static constexpr size_t max_submit_batch_count = 8;
+
+        // Views the caller's storage, which only has to outlive the call.
         struct SubmitSpecifications {
             CommandQueueHandle command_queue = {};
-            std::vector<CommandBufferHandle> command_buffers = {};
+            std::span<const CommandBufferHandle> command_buffers = {};
+            // Waited on before any command of this submission, e.g. uploads from the copy queue.
+            // A wait is for the last signal submitted before it, so a semaphore can be reused right away.
+            std::span<const SemaphoreHandle> wait_semaphores = {};
+            std::span<const SemaphoreHandle> signal_semaphores = {};
+            // Marks this submission, or the last one on the queue when there is nothing to submit.
+            FenceHandle fence = {};
             SwapChainHandle swap_chain = {};
         };
 
         RenderDevice() = default;
         virtual ~RenderDevice() = default;
 
-        virtual void initialize(size_t index) = 0;
+        // Returns false when the adapter lacks a feature the renderer requires, the device is unusable then.
+        virtual bool initialize(size_t index) = 0;
         virtual CommandQueueFamilyHandle command_queue_family_get(CommandQueueFamilyType command_queue_family_type, SurfaceHandle surface) = 0;
         virtual CommandQueueHandle command_queue_create(CommandQueueFamilyHandle command_queue_family) = 0;
-        virtual void command_queue_execute_and_present(const SubmitSpecifications& submit_specs) = 0;
+        void command_queue_execute_and_present(const SubmitSpecifications& submit_specs) { command_queue_execute_and_present_batch({ &submit_specs, 1 }); }
+        // Every group goes to the same command queue. The groups are independent of each other and go out in
+        // one submission, the swap chains of the batch in one present, each swap chain at most once.
+        virtual void command_queue_execute_and_present_batch(std::span<const SubmitSpecifications> submits) = 0;
         virtual void command_queue_destroy(CommandQueueHandle command_queue) = 0;
         virtual CommandPoolHandle command_pool_create(CommandQueueFamilyHandle command_queue_family) = 0;
         virtual void command_pool_destroy(CommandPoolHandle command_pool) = 0;
+        // Resets every command buffer of the pool at once, none of them may still be pending.
+        virtual void command_pool_reset(CommandPoolHandle command_pool) = 0;
         virtual CommandBufferHandle command_buffer_create(CommandPoolHandle command_pool, CommandBufferType command_buffer_type) = 0;
         virtual void command_buffer_begin(CommandBufferHandle command_buffer) = 0;
         virtual void command_buffer_end(CommandBufferHandle command_buffer) = 0;
+        // Secondary command buffers record outside of render passes and execute in the given order.
+        virtual void command_buffer_execute_commands(CommandBufferHandle command_buffer, std::span<const CommandBufferHandle> secondary_command_buffers) = 0;
+        // Must happen before the command pool of the command buffer is destroyed.
+        virtual void command_buffer_destroy(CommandBufferHandle command_buffer) = 0;
         virtual FenceHandle fence_create() = 0;
+        // Returns immediately for a fence that was never submitted.
         virtual void fence_wait(FenceHandle fence) = 0;
+        // Never blocks.
+        virtual bool fence_is_signaled(FenceHandle fence) = 0;
         virtual void fence_destroy(FenceHandle fence) = 0;
         virtual SemaphoreHandle semaphore_create() = 0;
         virtual void semaphore_destroy(SemaphoreHandle semaphore) = 0;
+        virtual QueryPoolHandle timestamp_query_pool_create(uint32_t query_count) = 0;
+        virtual void timestamp_query_pool_reset(CommandBufferHandle command_buffer, QueryPoolHandle query_pool) = 0;
+        virtual void command_buffer_write_timestamp(CommandBufferHandle command_buffer, QueryPoolHandle query_pool, uint32_t query_index) = 0;
+        // Never blocks, returns false when the results are not available yet. Timestamps are in Timer ticks.
+        virtual bool timestamp_query_pool_get_results(QueryPoolHandle query_pool, uint32_t query_count, uint64_t* r_timestamps) = 0;
+        virtual void timestamp_query_pool_destroy(QueryPoolHandle query_pool) = 0;
+        virtual BufferHandle buffer_create(const BufferSpecifications& buffer_specs) = 0;
+        // Host visible buffers stay mapped for their whole lifetime, nullptr for gpu only buffers.
+        virtual void* buffer_get_mapped_data(BufferHandle buffer) = 0;
+        virtual void buffer_destroy(BufferHandle buffer) = 0;
+        virtual TextureHandle texture_create(const TextureSpecifications& texture_specs) = 0;
+        virtual void texture_destroy(TextureHandle texture) = 0;
+        // Stable for the lifetime of the resource and reused after it is destroyed. Invalid for textures without
+        // sampled or storage usage, buffers without storage usage and resources beyond the capacity of the sets.
+        virtual uint32_t texture_get_bindless_index(TextureHandle texture) = 0;
+        virtual uint32_t buffer_get_bindless_index(BufferHandle buffer) = 0;
+        // Textures with the same specifications always have the same requirements.
+        virtual void texture_get_memory_requirements(const TextureSpecifications& texture_specs, MemoryRequirements& r_memory_requirements) = 0;
+        // GPU only memory that textures are placed into at offsets chosen by the caller. Placed textures may
+        // overlap, the caller orders their accesses with discarding barriers. Must outlive its textures.
+        virtual TextureHeapHandle texture_heap_create(uint64_t size, uint32_t memory_type_bits) = 0;
+        virtual void texture_heap_destroy(TextureHeapHandle texture_heap) = 0;
+        // The offset must fit the alignment of the texture's memory requirements, destroyed with texture_destroy.
+        virtual TextureHandle texture_create_placed(const TextureSpecifications& texture_specs, TextureHeapHandle texture_heap, uint64_t offset) = 0;
+        // Records the barriers as one dependency, every barrier waits for the accesses of all states before.
+        // Covers every mip and layer, graphics stages are only valid on draw queues.
+        virtual void command_buffer_barrier(CommandBufferHandle command_buffer, std::span<const TextureBarrier> texture_barriers, std::span<const BufferBarrier> buffer_barriers, const MemoryBarrier& memory_barrier) = 0;
+        virtual void command_buffer_copy_buffer(CommandBufferHandle command_buffer, BufferHandle src_buffer, uint64_t src_offset, BufferHandle dst_buffer, uint64_t dst_offset, uint64_t size) = 0;
+        // Replaces the whole mip level of one layer, the texture is left ready for sampling.
+        virtual void command_buffer_copy_buffer_to_texture(CommandBufferHandle command_buffer, BufferHandle src_buffer, uint64_t src_offset, TextureHandle dst_texture, uint32_t mip, uint32_t layer) = 0;
+        virtual void memory_get_heap_statistics(std::vector<MemoryHeapStatistics>& r_heap_statistics) const = 0;
+        // Publishes object counts and memory usage as gauges. Call it on the thread that creates and destroys device objects.
+        virtual void metrics_update() const = 0;
+        // Compacts sparsely used memory blocks by moving buffers, waits for the queue to be idle. Returns the moved bytes.
+        virtual uint64_t memory_defragment(CommandQueueHandle command_queue, uint64_t max_bytes_to_move) = 0;
+        // Returns right away, the pipeline compiles on the thread pool. Identical states share one pipeline,
+        // every create needs its own destroy. The pipeline functions may be called from any thread.
+        virtual PipelineHandle pipeline_create(const PipelineSpecifications& pipeline_specs) = 0;
+        // Never blocks.
+        virtual PipelineStatus pipeline_get_status(PipelineHandle pipeline) = 0;
+        virtual void pipeline_wait(PipelineHandle pipeline) = 0;
+        // Cancels the compilations no worker started and waits for the others, e.g. before shutdown so no
+        // compile job outlives the device. Cancelled pipelines fail.
+        virtual void pipeline_compilations_drain() = 0;
+        // Waits for a compilation in progress, the pipeline must not be in use by the GPU anymore.
+        virtual void pipeline_destroy(PipelineHandle pipeline) = 0;
+        // Returns false when nothing was bound, the caller skips the draws that need the pipeline.
+        virtual bool command_buffer_bind_pipeline(CommandBufferHandle command_buffer, PipelineHandle pipeline, PipelineBindPolicy bind_policy) = 0;
+        // Visible to every stage, offset and size are multiples of four. Survives pipeline changes.
+        virtual void command_buffer_push_constants(CommandBufferHandle command_buffer, const void* data, uint32_t size, uint32_t offset = 0) = 0;
+        // Writes the compiled pipelines to disk, initialize loads them again on the same device and driver.
+        virtual void pipeline_cache_save() = 0;
         virtual SwapChainHandle swap_chain_create(SurfaceHandle surface) = 0;
         virtual FramebufferHandle swap_chain_acquire_next_framebuffer(CommandQueueHandle command_queue, SwapChainHandle swap_chain, SwapChainStatus& swap_chain_status) = 0;
         virtual void swap_chain_recreate_or_resize(CommandQueueHandle command_queue, SwapChainHandle swap_chain, uint32_t desired_framebuffer_count = 3) = 0;
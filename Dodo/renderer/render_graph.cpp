@@ -0,0 +1,457 @@
+#include "pch.h"
+#include "render_graph.h"
+
+namespace Dodo {
+
+    namespace Utils {
+
+        static bool is_write_state(RenderDevice::ResourceState state) {
+            switch (state) {
+                case RenderDevice::ResourceState::transfer_dst :
+                case RenderDevice::ResourceState::shader_write :
+                case RenderDevice::ResourceState::color_attachment :
+                case RenderDevice::ResourceState::depth_stencil_attachment : return true;
+                default : return false;
+            }
+        }
+
+        static uint64_t align_up(uint64_t value, uint64_t alignment) {
+            return ((value + alignment - 1) / alignment) * alignment;
+        }
+
+    }
+
+    RenderGraph::~RenderGraph() {
+        de_initialize();
+    }
+
+    void RenderGraph::initialize(Ref<RenderDevice> device) {
+        DODO_ASSERT(!_device);
+        _device = device;
+    }
+
+    void RenderGraph::de_initialize() {
+        if (!_device) {
+            return;
+        }
+
+        reset();
+        _device = nullptr;
+    }
+
+    void RenderGraph::reset() {
+        _transient_textures_destroy();
+        _resources.clear();
+        _passes.clear();
+        _compiled_passes.clear();
+        _texture_barriers.clear();
+        _buffer_barriers.clear();
+        _final_barriers = {};
+        _statistics = {};
+    }
+
+    RenderGraph::ResourceId RenderGraph::texture_create(const std::string& name, const RenderDevice::TextureSpecifications& texture_specs) {
+        Resource resource = {};
+        resource.name = name;
+        resource.kind = ResourceKind::texture;
+        resource.is_transient = true;
+        resource.texture_specs = texture_specs;
+        _resources.push_back(std::move(resource));
+        return static_cast<ResourceId>(_resources.size() - 1);
+    }
+
+    RenderGraph::ResourceId RenderGraph::texture_import(const std::string& name, TextureHandle texture, RenderDevice::ResourceState initial_state, RenderDevice::ResourceState final_state) {
+        DODO_ASSERT(texture);
+        Resource resource = {};
+        resource.name = name;
+        resource.kind = ResourceKind::texture;
+        resource.texture = texture;
+        resource.initial_state = initial_state;
+        resource.final_state = final_state;
+        _resources.push_back(std::move(resource));
+        return static_cast<ResourceId>(_resources.size() - 1);
+    }
+
+    RenderGraph::ResourceId RenderGraph::buffer_import(const std::string& name, BufferHandle buffer, RenderDevice::ResourceState initial_state, RenderDevice::ResourceState final_state) {
+        DODO_ASSERT(buffer);
+        Resource resource = {};
+        resource.name = name;
+        resource.kind = ResourceKind::buffer;
+        resource.buffer = buffer;
+        resource.initial_state = initial_state;
+        resource.final_state = final_state;
+        _resources.push_back(std::move(resource));
+        return static_cast<ResourceId>(_resources.size() - 1);
+    }
+
+    void RenderGraph::resource_mark_output(ResourceId resource) {
+        _resources.at(resource).is_output = true;
+    }
+
+    RenderGraph::PassId RenderGraph::pass_add(const std::string& name, std::initializer_list<Access> reads, std::initializer_list<Access> writes, Execute&& execute) {
+        Pass pass = {};
+        pass.name = name;
+        pass.profile_name = Profiler::name_intern(name);
+        pass.reads = reads;
+        pass.writes = writes;
+        pass.execute = std::move(execute);
+        for (const Access& access : pass.reads) {
+            DODO_ASSERT(access.resource < _resources.size());
+        }
+
+        for (const Access& access : pass.writes) {
+            DODO_ASSERT(access.resource < _resources.size());
+            if (!Utils::is_write_state(access.state)) {
+                DODO_LOG_WARNING_TAG("Renderer", "Pass '{0}' writes '{1}' in a read only state!", name, _resources.at(access.resource).name);
+            }
+        }
+
+        _passes.push_back(std::move(pass));
+        return static_cast<PassId>(_passes.size() - 1);
+    }
+
+    void RenderGraph::pass_mark_side_effects(PassId pass) {
+        _passes.at(pass).has_side_effects = true;
+    }
+
+    bool RenderGraph::compile() {
+        DODO_PROFILE_SCOPE("RenderGraph::compile");
+        DODO_ASSERT(_device);
+        _transient_textures_destroy();
+        _texture_barriers.clear();
+        _buffer_barriers.clear();
+        _statistics = {};
+
+        _cull_passes();
+        _compute_lifetimes();
+        if (!_create_transient_textures()) {
+            return false;
+        }
+
+        _compute_barriers();
+
+        _statistics.pass_count = static_cast<uint32_t>(_compiled_passes.size());
+        _statistics.culled_pass_count = static_cast<uint32_t>(_passes.size() - _compiled_passes.size());
+        _statistics.barrier_count += static_cast<uint32_t>(_texture_barriers.size() + _buffer_barriers.size());
+        DODO_LOG_INFO_TAG("Renderer", "Render graph: {0} passes ({1} culled), {2} barriers in {3} batches, {4} transient textures in {5} KiB ({6} KiB without aliasing).",
+                          _statistics.pass_count, _statistics.culled_pass_count, _statistics.barrier_count, _statistics.barrier_batch_count,
+                          _statistics.transient_texture_count, _statistics.transient_memory_size / 1024, _statistics.transient_unaliased_size / 1024);
+        DODO_METRIC_GAUGE_SET("renderer.render_graph_passes", static_cast<double>(_statistics.pass_count));
+        DODO_METRIC_GAUGE_SET("renderer.render_graph_transient_bytes", static_cast<double>(_statistics.transient_memory_size));
+        return true;
+    }
+
+    void RenderGraph::execute(CommandBufferHandle command_buffer) {
+        DODO_PROFILE_SCOPE("RenderGraph::execute");
+        DODO_ASSERT(_device && command_buffer);
+        for (const PassId pass_id : _compiled_passes) {
+            const Pass& pass = _passes.at(pass_id);
+            _barrier_batch_record(command_buffer, pass.barriers);
+            DODO_PROFILE_SCOPE(pass.profile_name);
+            pass.execute(command_buffer);
+        }
+
+        _barrier_batch_record(command_buffer, _final_barriers);
+    }
+
+    TextureHandle RenderGraph::texture_get(ResourceId resource) const {
+        return _resources.at(resource).texture;
+    }
+
+    BufferHandle RenderGraph::buffer_get(ResourceId resource) const {
+        return _resources.at(resource).buffer;
+    }
+
+    void RenderGraph::_cull_passes() {
+        // Walks backwards from the outputs. A write does not end the need for a resource, the graph
+        // can not tell whether a pass overwrites all of it, so earlier writers are kept as well.
+        std::vector<bool> is_needed(_resources.size(), false);
+        for (size_t i = 0; i < _resources.size(); i++) {
+            is_needed.at(i) = _resources.at(i).is_output;
+        }
+
+        for (size_t i = _passes.size(); i > 0; i--) {
+            Pass& pass = _passes.at(i - 1);
+            bool is_used = pass.has_side_effects;
+            for (const Access& access : pass.writes) {
+                is_used = is_used || is_needed.at(access.resource);
+            }
+
+            pass.is_culled = !is_used;
+            if (pass.is_culled) {
+                continue;
+            }
+
+            for (const Access& access : pass.reads) {
+                is_needed.at(access.resource) = true;
+            }
+        }
+
+        _compiled_passes.clear();
+        for (PassId pass_id = 0; pass_id < _passes.size(); pass_id++) {
+            if (!_passes.at(pass_id).is_culled) {
+                _compiled_passes.push_back(pass_id);
+            }
+        }
+    }
+
+    void RenderGraph::_compute_lifetimes() {
+        for (Resource& resource : _resources) {
+            resource.first_pass_index = invalid_pass_index;
+            resource.last_pass_index = 0;
+            resource.last_state = resource.initial_state;
+        }
+
+        for (uint32_t pass_index = 0; pass_index < _compiled_passes.size(); pass_index++) {
+            const Pass& pass = _passes.at(_compiled_passes.at(pass_index));
+            for (const std::vector<Access>* accesses : { &pass.reads, &pass.writes }) {
+                for (const Access& access : *accesses) {
+                    Resource& resource = _resources.at(access.resource);
+                    const bool is_accessed_in_pass = (resource.first_pass_index != invalid_pass_index) && (resource.last_pass_index == pass_index);
+                    if (is_accessed_in_pass && (resource.last_state != access.state)) {
+                        DODO_LOG_ERROR_TAG("Renderer", "Pass '{0}' accesses '{1}' in more than one state!", pass.name, resource.name);
+                    }
+
+                    if (resource.first_pass_index == invalid_pass_index) {
+                        resource.first_pass_index = pass_index;
+                    }
+
+                    resource.last_pass_index = pass_index;
+                    resource.last_state = access.state;
+                }
+            }
+        }
+    }
+
+    bool RenderGraph::_create_transient_textures() {
+        DODO_PROFILE_SCOPE("RenderGraph::create_transient_textures");
+        struct Placement {
+            ResourceId resource = 0;
+            RenderDevice::MemoryRequirements memory_requirements = {};
+        };
+
+        std::vector<Placement> placements = {};
+        for (ResourceId resource_id = 0; resource_id < _resources.size(); resource_id++) {
+            Resource& resource = _resources.at(resource_id);
+            resource.is_placed = false;
+            if (!resource.is_transient || (resource.first_pass_index == invalid_pass_index)) {
+                continue;
+            }
+
+            Placement placement = {};
+            placement.resource = resource_id;
+            _device->texture_get_memory_requirements(resource.texture_specs, placement.memory_requirements);
+            if (placement.memory_requirements.size == 0) {
+                DODO_LOG_ERROR_TAG("Renderer", "Render graph texture '{0}' has no valid specifications!", resource.name);
+                return false;
+            }
+
+            _statistics.transient_unaliased_size += placement.memory_requirements.size;
+            placements.push_back(placement);
+        }
+
+        // Largest first, smaller textures then fill the gaps between them. A texture goes at the lowest
+        // offset that no texture alive at the same time occupies.
+        std::ranges::stable_sort(placements, std::ranges::greater(), [](const Placement& placement) { return placement.memory_requirements.size; });
+        uint32_t memory_type_bits = UINT32_MAX;
+        uint64_t heap_size = 0;
+        std::vector<std::pair<uint64_t, uint64_t>> occupied_ranges = {};
+        for (size_t i = 0; i < placements.size(); i++) {
+            const RenderDevice::MemoryRequirements& memory_requirements = placements.at(i).memory_requirements;
+            Resource& resource = _resources.at(placements.at(i).resource);
+            if ((memory_type_bits & memory_requirements.memory_type_bits) == 0) {
+                continue;
+            }
+
+            occupied_ranges.clear();
+            for (size_t j = 0; j < i; j++) {
+                const Resource& other = _resources.at(placements.at(j).resource);
+                const bool is_alive_together = (other.first_pass_index <= resource.last_pass_index) && (resource.first_pass_index <= other.last_pass_index);
+                if (other.is_placed && is_alive_together) {
+                    occupied_ranges.emplace_back(other.memory_offset, other.memory_offset + other.memory_size);
+                }
+            }
+
+            std::ranges::sort(occupied_ranges);
+            uint64_t offset = 0;
+            for (const auto& [begin, end] : occupied_ranges) {
+                if ((Utils::align_up(offset, memory_requirements.alignment) + memory_requirements.size) <= begin) {
+                    break;
+                }
+
+                offset = std::max(offset, end);
+            }
+
+            memory_type_bits &= memory_requirements.memory_type_bits;
+            resource.is_placed = true;
+            resource.memory_offset = Utils::align_up(offset, memory_requirements.alignment);
+            resource.memory_size = memory_requirements.size;
+            heap_size = std::max(heap_size, resource.memory_offset + resource.memory_size);
+        }
+
+        if (heap_size > 0) {
+            _texture_heap = _device->texture_heap_create(heap_size, memory_type_bits);
+            if (!_texture_heap) {
+                DODO_LOG_ERROR_TAG("Renderer", "Failed to create the render graph texture heap of {0} bytes!", heap_size);
+                return false;
+            }
+        }
+
+        for (const Placement& placement : placements) {
+            Resource& resource = _resources.at(placement.resource);
+            if (resource.is_placed) {
+                resource.texture = _device->texture_create_placed(resource.texture_specs, _texture_heap, resource.memory_offset);
+            }
+            else {
+                // Its memory types do not fit the heap, it gets memory of its own instead.
+                resource.texture = _device->texture_create(resource.texture_specs);
+                _statistics.transient_memory_size += placement.memory_requirements.size;
+            }
+
+            if (!resource.texture) {
+                DODO_LOG_ERROR_TAG("Renderer", "Failed to create render graph texture '{0}'!", resource.name);
+                return false;
+            }
+        }
+
+        _statistics.transient_texture_count = static_cast<uint32_t>(placements.size());
+        _statistics.transient_memory_size += heap_size;
+        return true;
+    }
+
+    void RenderGraph::_compute_barriers() {
+        DODO_PROFILE_SCOPE("RenderGraph::compute_barriers");
+        // State at the start of a frame: imports come in their initial state, transient textures
+        // still are in the last state of the previous frame.
+        std::vector<RenderDevice::ResourceState> states(_resources.size());
+        std::vector<uint32_t> visited_pass_indices(_resources.size(), invalid_pass_index);
+        for (size_t i = 0; i < _resources.size(); i++) {
+            states.at(i) = _resources.at(i).is_transient ? _resources.at(i).last_state : _resources.at(i).initial_state;
+        }
+
+        const auto is_memory_shared = [](const Resource& a, const Resource& b) -> bool {
+            return a.is_placed && b.is_placed && (a.memory_offset < (b.memory_offset + b.memory_size)) && (b.memory_offset < (a.memory_offset + a.memory_size));
+        };
+
+        for (uint32_t pass_index = 0; pass_index < _compiled_passes.size(); pass_index++) {
+            Pass& pass = _passes.at(_compiled_passes.at(pass_index));
+            _barrier_batch_begin(pass.barriers);
+            for (const std::vector<Access>* accesses : { &pass.reads, &pass.writes }) {
+                for (const Access& access : *accesses) {
+                    Resource& resource = _resources.at(access.resource);
+                    if (visited_pass_indices.at(access.resource) == pass_index) {
+                        continue;
+                    }
+
+                    visited_pass_indices.at(access.resource) = pass_index;
+                    RenderDevice::ResourceState& state = states.at(access.resource);
+                    if (resource.is_transient && (resource.first_pass_index == pass_index)) {
+                        // The texture takes over its memory, the contents are discarded. It waits for the
+                        // textures that used the memory last: earlier ones of this frame, or when there are
+                        // none every texture sharing it, itself included, at the end of the previous frame.
+                        std::vector<ResourceId> predecessors = {};
+                        for (ResourceId other_id = 0; other_id < _resources.size(); other_id++) {
+                            const Resource& other = _resources.at(other_id);
+                            if ((other_id != access.resource) && is_memory_shared(resource, other) && (other.last_pass_index < pass_index)) {
+                                predecessors.push_back(other_id);
+                            }
+                        }
+
+                        if (predecessors.empty()) {
+                            predecessors.push_back(access.resource);
+                            for (ResourceId other_id = 0; other_id < _resources.size(); other_id++) {
+                                if ((other_id != access.resource) && is_memory_shared(resource, _resources.at(other_id))) {
+                                    predecessors.push_back(other_id);
+                                }
+                            }
+                        }
+
+                        std::ranges::sort(predecessors, std::ranges::greater(), [this](ResourceId id) { return _resources.at(id).last_pass_index; });
+                        _texture_barriers.push_back({ resource.texture, _resources.at(predecessors.front()).last_state, access.state, true });
+                        // The other textures may not be touched again, the global barrier of the batch orders their accesses.
+                        for (size_t i = 1; i < predecessors.size(); i++) {
+                            pass.barriers.memory_barrier.states_before |= RenderDevice::resource_state_bit(_resources.at(predecessors.at(i)).last_state);
+                            pass.barriers.memory_barrier.states_after |= RenderDevice::resource_state_bit(access.state);
+                        }
+                    }
+                    else if ((state != access.state) || Utils::is_write_state(access.state)) {
+                        if (resource.kind == ResourceKind::texture) {
+                            _texture_barriers.push_back({ resource.texture, state, access.state, false });
+                        }
+                        else {
+                            _buffer_barriers.push_back({ resource.buffer, state, access.state });
+                        }
+                    }
+
+                    state = access.state;
+                }
+            }
+
+            _barrier_batch_end(pass.barriers);
+        }
+
+        _barrier_batch_begin(_final_barriers);
+        for (size_t i = 0; i < _resources.size(); i++) {
+            const Resource& resource = _resources.at(i);
+            if (resource.is_transient || (states.at(i) == resource.final_state)) {
+                continue;
+            }
+
+            if (resource.kind == ResourceKind::texture) {
+                _texture_barriers.push_back({ resource.texture, states.at(i), resource.final_state, false });
+            }
+            else {
+                _buffer_barriers.push_back({ resource.buffer, states.at(i), resource.final_state });
+            }
+        }
+
+        _barrier_batch_end(_final_barriers);
+    }
+
+    void RenderGraph::_transient_textures_destroy() {
+        if (!_device) {
+            return;
+        }
+
+        for (Resource& resource : _resources) {
+            if (resource.is_transient && resource.texture) {
+                _device->texture_destroy(resource.texture);
+                resource.texture = {};
+            }
+        }
+
+        if (_texture_heap) {
+            _device->texture_heap_destroy(_texture_heap);
+            _texture_heap = {};
+        }
+    }
+
+    void RenderGraph::_barrier_batch_begin(BarrierBatch& r_batch) const {
+        r_batch = {};
+        r_batch.texture_barrier_begin = static_cast<uint32_t>(_texture_barriers.size());
+        r_batch.buffer_barrier_begin = static_cast<uint32_t>(_buffer_barriers.size());
+    }
+
+    void RenderGraph::_barrier_batch_end(BarrierBatch& r_batch) {
+        r_batch.texture_barrier_count = static_cast<uint32_t>(_texture_barriers.size()) - r_batch.texture_barrier_begin;
+        r_batch.buffer_barrier_count = static_cast<uint32_t>(_buffer_barriers.size()) - r_batch.buffer_barrier_begin;
+        if (r_batch.memory_barrier.states_before != 0) {
+            _statistics.barrier_count++;
+        }
+
+        if (((r_batch.texture_barrier_count + r_batch.buffer_barrier_count) > 0) || (r_batch.memory_barrier.states_before != 0)) {
+            _statistics.barrier_batch_count++;
+        }
+    }
+
+    void RenderGraph::_barrier_batch_record(CommandBufferHandle command_buffer, const BarrierBatch& batch) {
+        if (((batch.texture_barrier_count + batch.buffer_barrier_count) == 0) && (batch.memory_barrier.states_before == 0)) {
+            return;
+        }
+
+        const std::span<const RenderDevice::TextureBarrier> texture_barriers(_texture_barriers.data() + batch.texture_barrier_begin, batch.texture_barrier_count);
+        const std::span<const RenderDevice::BufferBarrier> buffer_barriers(_buffer_barriers.data() + batch.buffer_barrier_begin, batch.buffer_barrier_count);
+        _device->command_buffer_barrier(command_buffer, texture_barriers, buffer_barriers, batch.memory_barrier);
+    }
+
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "render_device.h"
+
+namespace Dodo {
+
+    // Orders the GPU work of a frame as passes that declare the resources they read and write.
+    // The graph is built and compiled once, e.g. after a resize, then executed every frame. Compiling
+    // culls the passes no output depends on, batches the barriers in front of every pass and places
+    // transient textures whose lifetimes do not overlap in the same memory.
+    class RenderGraph {
+    public:
+        using ResourceId = uint32_t;
+        using PassId = uint32_t;
+        using Execute = std::function<void(CommandBufferHandle command_buffer)>;
+
+        struct Access {
+            ResourceId resource = 0;
+            RenderDevice::ResourceState state = RenderDevice::ResourceState::undefined;
+        };
+
+        struct Statistics {
+            uint32_t pass_count = 0;
+            uint32_t culled_pass_count = 0;
+            uint32_t barrier_count = 0;
+            uint32_t barrier_batch_count = 0;
+            uint32_t transient_texture_count = 0;
+            uint64_t transient_memory_size = 0;
+            // What the transient textures would take without aliasing.
+            uint64_t transient_unaliased_size = 0;
+        };
+
+        RenderGraph() = default;
+        ~RenderGraph();
+
+        void initialize(Ref<RenderDevice> device);
+        void de_initialize();
+        // Forgets every pass and resource and destroys the transient textures, the GPU must be done with them.
+        void reset();
+
+        // Created by compile when a pass that is not culled uses it, its contents do not survive the frame.
+        ResourceId texture_create(const std::string& name, const RenderDevice::TextureSpecifications& texture_specs);
+        // Owned by the caller, every frame starts with the initial state and ends with the final state.
+        ResourceId texture_import(const std::string& name, TextureHandle texture, RenderDevice::ResourceState initial_state, RenderDevice::ResourceState final_state);
+        ResourceId buffer_import(const std::string& name, BufferHandle buffer, RenderDevice::ResourceState initial_state, RenderDevice::ResourceState final_state);
+        // The passes writing an output are kept, e.g. the image shown or read back.
+        void resource_mark_output(ResourceId resource);
+
+        // Passes run in the order they are added. A resource is accessed in one state per pass.
+        PassId pass_add(const std::string& name, std::initializer_list<Access> reads, std::initializer_list<Access> writes, Execute&& execute);
+        // Kept even when no output depends on it, e.g. work on resources the graph does not know about.
+        void pass_mark_side_effects(PassId pass);
+
+        // Creates the transient textures, the render thread must not use the device handle pools meanwhile.
+        bool compile();
+        // Records the passes that were not culled, each one after its batch of barriers.
+        void execute(CommandBufferHandle command_buffer);
+
+        // Valid after compile, null for transient textures that only culled passes use.
+        TextureHandle texture_get(ResourceId resource) const;
+        BufferHandle buffer_get(ResourceId resource) const;
+        const Statistics& statistics_get() const { return _statistics; }
+
+    private:
+        static constexpr uint32_t invalid_pass_index = UINT32_MAX;
+
+        enum class ResourceKind {
+            texture,
+            buffer
+        };
+
+        struct Resource {
+            std::string name = {};
+            ResourceKind kind = ResourceKind::texture;
+            bool is_transient = false;
+            bool is_output = false;
+            RenderDevice::TextureSpecifications texture_specs = {};
+            TextureHandle texture = {};
+            BufferHandle buffer = {};
+            RenderDevice::ResourceState initial_state = RenderDevice::ResourceState::undefined;
+            RenderDevice::ResourceState final_state = RenderDevice::ResourceState::undefined;
+
+            // Lifetime in the order of the compiled passes.
+            uint32_t first_pass_index = invalid_pass_index;
+            uint32_t last_pass_index = 0;
+            RenderDevice::ResourceState last_state = RenderDevice::ResourceState::undefined;
+            // Transient textures outside of the heap only alias themselves in the next frame.
+            bool is_placed = false;
+            uint64_t memory_offset = 0;
+            uint64_t memory_size = 0;
+        };
+
+        struct BarrierBatch {
+            uint32_t texture_barrier_begin = 0;
+            uint32_t texture_barrier_count = 0;
+            uint32_t buffer_barrier_begin = 0;
+            uint32_t buffer_barrier_count = 0;
+            RenderDevice::MemoryBarrier memory_barrier = {};
+        };
+
+        struct Pass {
+            std::string name = {};
+            // Interned once when added, so executing the pass does not take the profiler lock.
+            const char* profile_name = nullptr;
+            std::vector<Access> reads = {};
+            std::vector<Access> writes = {};
+            Execute execute = {};
+            bool has_side_effects = false;
+            bool is_culled = false;
+            BarrierBatch barriers = {};
+        };
+
+        void _cull_passes();
+        void _compute_lifetimes();
+        bool _create_transient_textures();
+        void _compute_barriers();
+        void _transient_textures_destroy();
+        void _barrier_batch_begin(BarrierBatch& r_batch) const;
+        void _barrier_batch_end(BarrierBatch& r_batch);
+        void _barrier_batch_record(CommandBufferHandle command_buffer, const BarrierBatch& batch);
+
+        Ref<RenderDevice> _device = nullptr;
+        std::vector<Resource> _resources = {};
+        std::vector<Pass> _passes = {};
+        // Passes that were not culled, in execution order.
+        std::vector<PassId> _compiled_passes = {};
+        std::vector<RenderDevice::TextureBarrier> _texture_barriers = {};
+        std::vector<RenderDevice::BufferBarrier> _buffer_barriers = {};
+        BarrierBatch _final_barriers = {};
+        TextureHeapHandle _texture_heap = {};
+        Statistics _statistics = {};
+    };
+
+}
@@ -8,9 +8,14 @@ namespace Dodo {
     template<typename Handle, typename Resource>
     class RenderHandlePool {
     public:
+        static constexpr uint32_t invalid_index = UINT32_MAX;
+
         Handle create(Resource&& resource);
         Resource* get_or_null(Handle handle) const;
+        // Dense and reused through the free list, e.g. to address the resource in a GPU side array.
+        uint32_t index_get(Handle handle) const;
         void destroy(Handle handle);
+        size_t count_get() const { return _size - _free_list.size(); }
 
     private:
         void _expand(size_t new_size);
@@ -18,7 +23,7 @@ namespace Dodo {
         bool _is_valid(uint32_t index, uint32_t version) const;
 
         std::vector<uint32_t> _versions = {};
-        std::vector<Resource> _data = {};
+        mutable std::vector<Resource> _data = {};
         size_t _size = 0;
         std::vector<uint32_t> _free_list = {};
     };
@@ -52,6 +57,12 @@ namespace Dodo {
         return &_data.at(index);
     }
 
+    template<typename Handle, typename Resource>
+    inline uint32_t RenderHandlePool<Handle, Resource>::index_get(Handle handle) const {
+        auto [index, version] = _unpack(handle);
+        return _is_valid(index, version) ? index : invalid_index;
+    }
+
     template<typename Handle, typename Resource>
     inline void RenderHandlePool<Handle, Resource>::destroy(Handle handle) {
         auto [index, version] = _unpack(handle);
@@ -60,7 +71,7 @@ namespace Dodo {
         }
 
         _versions.at(index)++;
-        _data.at(index).~Resource();
+        _data.at(index) = {};
         _free_list.push_back(index);
     }
 
@@ -0,0 +1,379 @@
+#include "pch.h"
+#include "shader_compiler.h"
+
+#include "core/Hash.h"
+
+#include <charconv>
+#include <shaderc/shaderc.hpp>
+
+namespace Dodo {
+
+    namespace Utils {
+
+        // Bumped whenever the manifest or SPIR-V layout or the meaning of the request hash changes.
+        static constexpr uint32_t shader_cache_version = 1;
+        static constexpr uint32_t shader_spirv_magic = 0x56505344;
+        static constexpr const char* shader_manifest_header = "dodo_shader_manifest";
+
+        struct ShaderDependency {
+            std::filesystem::path path = {};
+            size_t content_hash = 0;
+        };
+
+        struct ShaderSpirvHeader {
+            uint32_t magic = 0;
+            uint32_t version = 0;
+            uint64_t word_count = 0;
+            uint64_t data_hash = 0;
+        };
+
+        static std::string to_hex(size_t value) {
+            return std::format("{:016x}", value);
+        }
+
+        static bool from_hex(std::string_view text, size_t& r_value) {
+            const std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), r_value, 16);
+            return (result.ec == std::errc()) && (result.ptr == (text.data() + text.size()));
+        }
+
+        static bool read_file(const std::filesystem::path& path, std::string& r_content) {
+            std::ifstream is(path, std::ios::binary);
+            if (!is) {
+                return false;
+            }
+
+            r_content.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+            return !is.bad();
+        }
+
+        // Readers on other threads or runs never see a partially written file.
+        static bool write_file(const std::filesystem::path& path, const void* data, size_t size) {
+            std::filesystem::path temp_path = path;
+            temp_path += std::format(".{0}.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+            {
+                std::ofstream os(temp_path, std::ios::binary | std::ios::trunc);
+                os.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+                if (!os) {
+                    return false;
+                }
+            }
+
+            std::error_code error = {};
+            std::filesystem::rename(temp_path, path, error);
+            return !error;
+        }
+
+        static shaderc_shader_kind convert_to_shader_kind(RenderDevice::ShaderStage stage) {
+            switch (stage) {
+                case RenderDevice::ShaderStage::vertex : return shaderc_vertex_shader;
+                case RenderDevice::ShaderStage::fragment : return shaderc_fragment_shader;
+                case RenderDevice::ShaderStage::compute : return shaderc_compute_shader;
+            }
+
+            return shaderc_vertex_shader;
+        }
+
+        // The SPIR-V is addressed by the request and the exact contents of every file that went in.
+        static size_t hash_shader_contents(size_t request_hash, const std::vector<ShaderDependency>& dependencies) {
+            std::string contents = to_hex(request_hash);
+            for (const ShaderDependency& dependency : dependencies) {
+                contents += dependency.path.generic_string();
+                contents.push_back('\0');
+                contents += to_hex(dependency.content_hash);
+            }
+
+            return FNV1a()(contents);
+        }
+
+        // Resolves includes next to the including file first, then in the include directories,
+        // and records every file it hands to the compiler.
+        class ShaderIncluder : public shaderc::CompileOptions::IncluderInterface {
+        public:
+            explicit ShaderIncluder(const std::vector<std::filesystem::path>& include_directories)
+                : _include_directories(include_directories) {}
+
+            shaderc_include_result* GetInclude(const char* requested_source, shaderc_include_type type, const char* requesting_source, size_t include_depth) override {
+                auto* include = new Include();
+                std::filesystem::path resolved_path = {};
+                if (type == shaderc_include_type_relative) {
+                    const std::filesystem::path candidate = std::filesystem::path(requesting_source).parent_path() / requested_source;
+                    resolved_path = std::filesystem::exists(candidate) ? candidate : std::filesystem::path();
+                }
+
+                for (size_t i = 0; (i < _include_directories.size()) && resolved_path.empty(); i++) {
+                    const std::filesystem::path candidate = _include_directories.at(i) / requested_source;
+                    resolved_path = std::filesystem::exists(candidate) ? candidate : std::filesystem::path();
+                }
+
+                if (!resolved_path.empty() && read_file(resolved_path, include->content)) {
+                    resolved_path = resolved_path.lexically_normal();
+                    include->source_name = resolved_path.generic_string();
+                    _dependencies.push_back({ resolved_path, FNV1a()(include->content) });
+                }
+                else {
+                    // An empty source name reports the content as the error.
+                    include->content = std::format("Failed to resolve include {0}.", requested_source);
+                }
+
+                include->result.source_name = include->source_name.c_str();
+                include->result.source_name_length = include->source_name.size();
+                include->result.content = include->content.c_str();
+                include->result.content_length = include->content.size();
+                include->result.user_data = include;
+                return &include->result;
+            }
+
+            void ReleaseInclude(shaderc_include_result* data) override {
+                delete static_cast<Include*>(data->user_data);
+            }
+
+            const std::vector<ShaderDependency>& dependencies_get() const { return _dependencies; }
+
+        private:
+            struct Include {
+                shaderc_include_result result = {};
+                std::string source_name = {};
+                std::string content = {};
+            };
+
+            const std::vector<std::filesystem::path>& _include_directories;
+            std::vector<ShaderDependency> _dependencies = {};
+        };
+
+    }
+
+    ShaderCompiler::~ShaderCompiler() {
+        de_initialize();
+    }
+
+    void ShaderCompiler::initialize(const Specifications& specs) {
+        DODO_PROFILE_SCOPE("ShaderCompiler::initialize");
+        DODO_ASSERT(!_is_initialized);
+        _specs = specs;
+        std::error_code error = {};
+        std::filesystem::create_directories(_specs.cache_directory, error);
+        if (error) {
+            DODO_LOG_WARNING_TAG("Renderer", "Failed to create shader cache directory {0}, shaders are compiled every run.", _specs.cache_directory.string());
+        }
+
+        _is_initialized = true;
+    }
+
+    void ShaderCompiler::de_initialize() {
+        if (!_is_initialized) {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(_file_hash_mutex);
+        _file_hashes.clear();
+        _is_initialized = false;
+    }
+
+    ShaderCompiler::Result ShaderCompiler::compile(const Request& request) {
+        DODO_PROFILE_SCOPE("ShaderCompiler::compile");
+        DODO_ASSERT(_is_initialized);
+        const size_t request_hash = _request_hash(request);
+        Result result = {};
+        if (_cache_load(request_hash, result)) {
+            DODO_METRIC_COUNTER_ADD("renderer.shader_cache_hits", 1);
+            return result;
+        }
+
+        return _compile_and_store(request, request_hash);
+    }
+
+    void ShaderCompiler::compile(ThreadPool& thread_pool, std::span<const Request> requests, std::vector<Result>& r_results) {
+        DODO_PROFILE_SCOPE("ShaderCompiler::compile_batch");
+        r_results.assign(requests.size(), {});
+        std::vector<ThreadPool::TaskId> tasks = {};
+        tasks.reserve(requests.size());
+        for (size_t i = 0; i < requests.size(); i++) {
+            tasks.push_back(thread_pool.add_task([this, &requests, &r_results, i](void*) {
+                r_results.at(i) = compile(requests[i]);
+            }, "ShaderCompiler::compile"));
+        }
+
+        for (const ThreadPool::TaskId task : tasks) {
+            thread_pool.wait_on_task_to_complete(task);
+        }
+    }
+
+    size_t ShaderCompiler::_request_hash(const Request& request) const {
+        uint32_t spirv_version = 0;
+        uint32_t spirv_revision = 0;
+        shaderc_get_spv_version(&spirv_version, &spirv_revision);
+
+        std::string state = std::format("{0}:{1}.{2}:", Utils::shader_cache_version, spirv_version, spirv_revision);
+        state += request.path.lexically_normal().generic_string();
+        state += std::format(":{0}:{1}:{2}:", static_cast<uint32_t>(request.stage), static_cast<uint32_t>(request.language), request.entry_point);
+        for (const Define& define : request.defines) {
+            state += define.name;
+            state.push_back('=');
+            state += define.value;
+            state.push_back('\0');
+        }
+
+        state += std::format(":{0}:{1}:", _specs.is_optimization_enabled, _specs.is_debug_info_enabled);
+        for (const std::filesystem::path& include_directory : _specs.include_directories) {
+            state += include_directory.lexically_normal().generic_string();
+            state.push_back('\0');
+        }
+
+        return FNV1a()(state);
+    }
+
+    bool ShaderCompiler::_file_hash_get(const std::filesystem::path& path, size_t& r_content_hash) {
+        std::error_code error = {};
+        const std::filesystem::file_time_type write_time = std::filesystem::last_write_time(path, error);
+        if (error) {
+            return false;
+        }
+
+        const std::string key = path.generic_string();
+        {
+            std::unique_lock<std::mutex> lock(_file_hash_mutex);
+            const auto it = _file_hashes.find(key);
+            if ((it != _file_hashes.end()) && (it->second.write_time == write_time)) {
+                r_content_hash = it->second.content_hash;
+                return true;
+            }
+        }
+
+        std::string content = {};
+        if (!Utils::read_file(path, content)) {
+            return false;
+        }
+
+        r_content_hash = FNV1a()(content);
+        std::unique_lock<std::mutex> lock(_file_hash_mutex);
+        _file_hashes[key] = { write_time, r_content_hash };
+        return true;
+    }
+
+    bool ShaderCompiler::_cache_load(size_t request_hash, Result& r_result) {
+        DODO_PROFILE_SCOPE("ShaderCompiler::cache_load");
+        std::ifstream manifest(_specs.cache_directory / (Utils::to_hex(request_hash) + ".manifest"));
+        std::string line = {};
+        if (!manifest || !std::getline(manifest, line) || (line != std::format("{0} {1}", Utils::shader_manifest_header, Utils::shader_cache_version))) {
+            return false;
+        }
+
+        // "spirv <content hash>", then one "dep <content hash> <path>" per file the permutation was compiled from.
+        size_t contents_hash = 0;
+        if (!std::getline(manifest, line) || !line.starts_with("spirv ") || !Utils::from_hex(std::string_view(line).substr(6), contents_hash)) {
+            return false;
+        }
+
+        while (std::getline(manifest, line)) {
+            size_t expected_hash = 0;
+            size_t current_hash = 0;
+            if ((line.size() < 22) || !line.starts_with("dep ") || !Utils::from_hex(std::string_view(line).substr(4, 16), expected_hash)) {
+                return false;
+            }
+
+            if (!_file_hash_get(line.substr(21), current_hash) || (current_hash != expected_hash)) {
+                DODO_METRIC_COUNTER_ADD("renderer.shader_cache_stale", 1);
+                return false;
+            }
+        }
+
+        std::string spirv_file = {};
+        if (!Utils::read_file(_specs.cache_directory / (Utils::to_hex(contents_hash) + ".spv"), spirv_file) || (spirv_file.size() < sizeof(Utils::ShaderSpirvHeader))) {
+            return false;
+        }
+
+        Utils::ShaderSpirvHeader header = {};
+        std::memcpy(&header, spirv_file.data(), sizeof(header));
+        const size_t data_size = spirv_file.size() - sizeof(header);
+        const char* data = spirv_file.data() + sizeof(header);
+        const bool is_intact = (header.magic == Utils::shader_spirv_magic) && (header.version == Utils::shader_cache_version) &&
+                               ((header.word_count * sizeof(uint32_t)) == data_size) && (FNV1a()(data, data_size) == header.data_hash);
+        if (!is_intact) {
+            DODO_LOG_WARNING_TAG("Renderer", "Cached SPIR-V {0} is damaged, compiling again.", Utils::to_hex(contents_hash));
+            return false;
+        }
+
+        r_result = {};
+        r_result.spirv.resize(header.word_count);
+        std::memcpy(r_result.spirv.data(), data, data_size);
+        r_result.is_valid = true;
+        r_result.is_cache_hit = true;
+        return true;
+    }
+
+    ShaderCompiler::Result ShaderCompiler::_compile_and_store(const Request& request, size_t request_hash) {
+        DODO_PROFILE_SCOPE("ShaderCompiler::compile_and_store");
+        Result result = {};
+        std::string source = {};
+        if (!Utils::read_file(request.path, source)) {
+            result.error_message = std::format("Failed to read shader {0}.", request.path.string());
+            DODO_LOG_ERROR_TAG("Renderer", "{0}", result.error_message);
+            return result;
+        }
+
+        shaderc::CompileOptions options = {};
+        options.SetSourceLanguage((request.language == Language::hlsl) ? shaderc_source_language_hlsl : shaderc_source_language_glsl);
+        options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
+        options.SetOptimizationLevel(_specs.is_optimization_enabled ? shaderc_optimization_level_performance : shaderc_optimization_level_zero);
+        if (_specs.is_debug_info_enabled) {
+            options.SetGenerateDebugInfo();
+        }
+
+        for (const Define& define : request.defines) {
+            options.AddMacroDefinition(define.name, define.value);
+        }
+
+        // Owned by the options, which outlive every use of it below.
+        auto includer = std::make_unique<Utils::ShaderIncluder>(_specs.include_directories);
+        const Utils::ShaderIncluder* shader_includer = includer.get();
+        options.SetIncluder(std::move(includer));
+
+        Stopwatch stopwatch = {};
+        const std::string source_name = request.path.lexically_normal().generic_string();
+        const shaderc::Compiler compiler = {};
+        const shaderc::SpvCompilationResult compilation = compiler.CompileGlslToSpv(source, Utils::convert_to_shader_kind(request.stage), source_name.c_str(), request.entry_point.c_str(), options);
+        DODO_METRIC_HISTOGRAM_RECORD("renderer.shader_compile_us", static_cast<uint64_t>(stopwatch.get_milliseconds() * 1000.0));
+        if (compilation.GetCompilationStatus() != shaderc_compilation_status_success) {
+            result.error_message = compilation.GetErrorMessage();
+            DODO_LOG_ERROR_TAG("Renderer", "Failed to compile shader {0}:\n{1}", source_name, result.error_message);
+            DODO_METRIC_COUNTER_ADD("renderer.shader_compile_failures", 1);
+            return result;
+        }
+
+        result.spirv.assign(compilation.cbegin(), compilation.cend());
+        result.is_valid = true;
+        DODO_METRIC_COUNTER_ADD("renderer.shader_compiles", 1);
+
+        // Sorted and unique, a header included twice is one dependency.
+        std::vector<Utils::ShaderDependency> dependencies = shader_includer->dependencies_get();
+        dependencies.push_back({ request.path.lexically_normal(), FNV1a()(source) });
+        std::ranges::sort(dependencies, {}, [](const Utils::ShaderDependency& dependency) { return dependency.path.generic_string(); });
+        const auto duplicates = std::ranges::unique(dependencies, {}, [](const Utils::ShaderDependency& dependency) { return dependency.path.generic_string(); });
+        dependencies.erase(duplicates.begin(), duplicates.end());
+
+        const size_t contents_hash = Utils::hash_shader_contents(request_hash, dependencies);
+        std::string spirv_file(sizeof(Utils::ShaderSpirvHeader), '\0');
+        Utils::ShaderSpirvHeader header = {};
+        header.magic = Utils::shader_spirv_magic;
+        header.version = Utils::shader_cache_version;
+        header.word_count = result.spirv.size();
+        header.data_hash = FNV1a()(result.spirv.data(), result.spirv.size() * sizeof(uint32_t));
+        std::memcpy(spirv_file.data(), &header, sizeof(header));
+        spirv_file.append(reinterpret_cast<const char*>(result.spirv.data()), result.spirv.size() * sizeof(uint32_t));
+
+        std::string manifest = std::format("{0} {1}\nspirv {2}\n", Utils::shader_manifest_header, Utils::shader_cache_version, Utils::to_hex(contents_hash));
+        for (const Utils::ShaderDependency& dependency : dependencies) {
+            manifest += std::format("dep {0} {1}\n", Utils::to_hex(dependency.content_hash), dependency.path.generic_string());
+        }
+
+        // The SPIR-V goes first, a manifest never points at missing data.
+        const bool is_stored = Utils::write_file(_specs.cache_directory / (Utils::to_hex(contents_hash) + ".spv"), spirv_file.data(), spirv_file.size()) &&
+                               Utils::write_file(_specs.cache_directory / (Utils::to_hex(request_hash) + ".manifest"), manifest.data(), manifest.size());
+        if (!is_stored) {
+            DODO_LOG_WARNING_TAG("Renderer", "Failed to cache the SPIR-V of {0}.", source_name);
+        }
+
+        return result;
+    }
+
+}
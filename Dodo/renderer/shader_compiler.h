@@ -0,0 +1,76 @@
+#pragma once
+
+#include "render_device.h"
+#include "core/thread_pool.h"
+
+namespace Dodo {
+
+    // Compiles GLSL and HLSL to SPIR-V with shaderc and caches the results on disk. Every
+    // permutation, i.e. source, stage, entry point, defines and options, has a manifest with the
+    // content hashes of the files it was compiled from. A permutation is only compiled again when
+    // one of its own files changed, the SPIR-V is stored under the hash of everything that went in.
+    class ShaderCompiler {
+    public:
+        enum class Language {
+            glsl,
+            hlsl
+        };
+
+        struct Define {
+            std::string name = {};
+            std::string value = {};
+        };
+
+        struct Request {
+            std::filesystem::path path = {};
+            RenderDevice::ShaderStage stage = RenderDevice::ShaderStage::vertex;
+            Language language = Language::glsl;
+            std::string entry_point = "main";
+            std::vector<Define> defines = {};
+        };
+
+        struct Result {
+            bool is_valid = false;
+            bool is_cache_hit = false;
+            std::vector<uint32_t> spirv = {};
+            std::string error_message = {};
+        };
+
+        struct Specifications {
+            std::filesystem::path cache_directory = "dodo_shader_cache";
+            // Searched for includes after the directory of the including file.
+            std::vector<std::filesystem::path> include_directories = {};
+            bool is_optimization_enabled = true;
+            bool is_debug_info_enabled = false;
+        };
+
+        ShaderCompiler() = default;
+        ~ShaderCompiler();
+
+        void initialize(const Specifications& specs);
+        void de_initialize();
+
+        // Safe to call from several threads at once.
+        Result compile(const Request& request);
+        // Compiles the requests in parallel on the thread pool, the results are in request order.
+        void compile(ThreadPool& thread_pool, std::span<const Request> requests, std::vector<Result>& r_results);
+
+    private:
+        struct FileHash {
+            std::filesystem::file_time_type write_time = {};
+            size_t content_hash = 0;
+        };
+
+        size_t _request_hash(const Request& request) const;
+        bool _file_hash_get(const std::filesystem::path& path, size_t& r_content_hash);
+        bool _cache_load(size_t request_hash, Result& r_result);
+        Result _compile_and_store(const Request& request, size_t request_hash);
+
+        Specifications _specs = {};
+        bool _is_initialized = false;
+        // Content hashes of the files seen so far, valid as long as the write time does not change.
+        std::unordered_map<std::string, FileHash> _file_hashes = {};
+        std::mutex _file_hash_mutex = {};
+    };
+
+}
@@ -0,0 +1,216 @@
+#include "pch.h"
+#include "upload_manager.h"
+
+namespace Dodo {
+
+    // Covers the texel size of every texture format and the 4 byte offset rule of buffer to image copies.
+    static constexpr uint64_t staging_alignment = 16;
+
+    UploadManager::~UploadManager() {
+        de_initialize();
+    }
+
+    void UploadManager::initialize(Ref<RenderDevice> device, const Specifications& specs) {
+        DODO_PROFILE_SCOPE("UploadManager::initialize");
+        DODO_ASSERT(!_device);
+        DODO_ASSERT((specs.ring_size > 0) && (specs.batch_count > 0));
+        _device = device;
+        _specs = specs;
+
+        const CommandQueueFamilyHandle copy_queue_family = _device->command_queue_family_get(RenderDevice::CommandQueueFamilyType::copy, {});
+        _copy_queue = _device->command_queue_create(copy_queue_family);
+
+        RenderDevice::BufferSpecifications staging_specs = {};
+        staging_specs.size = _specs.ring_size;
+        staging_specs.usage = RenderDevice::buffer_usage_transfer_src;
+        staging_specs.memory_usage = RenderDevice::MemoryUsage::cpu_to_gpu;
+        _staging_buffer = _device->buffer_create(staging_specs);
+        _staging_data = static_cast<uint8_t*>(_device->buffer_get_mapped_data(_staging_buffer));
+        DODO_ASSERT(_staging_data);
+        _ring.initialize(_specs.ring_size);
+
+        _batches.resize(_specs.batch_count);
+        for (Batch& batch : _batches) {
+            batch.command_pool = _device->command_pool_create(copy_queue_family);
+            batch.command_buffer = _device->command_buffer_create(batch.command_pool, RenderDevice::CommandBufferType::primary);
+            batch.fence = _device->fence_create();
+        }
+
+        _batch_index = 0;
+        _has_unsignaled_submission = false;
+    }
+
+    void UploadManager::de_initialize() {
+        if (!_device) {
+            return;
+        }
+
+        for (Batch& batch : _batches) {
+            if (batch.is_recording) {
+                _device->command_buffer_end(batch.command_buffer);
+            }
+
+            if (batch.is_in_flight) {
+                _device->fence_wait(batch.fence);
+            }
+
+            _device->command_buffer_destroy(batch.command_buffer);
+            _device->command_pool_destroy(batch.command_pool);
+            _device->fence_destroy(batch.fence);
+        }
+
+        _batches.clear();
+        _device->buffer_destroy(_staging_buffer);
+        _device->command_queue_destroy(_copy_queue);
+        _staging_data = nullptr;
+        _device = nullptr;
+    }
+
+    void UploadManager::buffer_upload(BufferHandle buffer, uint64_t offset, const void* data, uint64_t size) {
+        DODO_PROFILE_SCOPE("UploadManager::buffer_upload");
+        DODO_ASSERT(_device && buffer && data);
+        DODO_METRIC_COUNTER_ADD("renderer.upload_bytes", size);
+        // Half a ring per piece, so the next piece is staged while the GPU copies the last one.
+        const uint64_t max_piece_size = std::max<uint64_t>(_ring.size_get() / 2, staging_alignment);
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        while (size > 0) {
+            const uint64_t piece_size = std::min(size, max_piece_size);
+            const uint64_t staging_offset = _staging_allocate(piece_size);
+            std::memcpy(_staging_data + staging_offset, bytes, piece_size);
+
+            Batch& batch = _batch_begin();
+            _device->command_buffer_copy_buffer(batch.command_buffer, _staging_buffer, staging_offset, buffer, offset, piece_size);
+            batch.ring_marker = _ring.head_get();
+
+            bytes += piece_size;
+            offset += piece_size;
+            size -= piece_size;
+        }
+    }
+
+    void UploadManager::texture_upload(TextureHandle texture, uint32_t mip, uint32_t layer, const void* data, uint64_t size) {
+        DODO_PROFILE_SCOPE("UploadManager::texture_upload");
+        DODO_ASSERT(_device && texture && data);
+        if (size > _ring.size_get()) {
+            DODO_LOG_ERROR_TAG("Renderer", "Texture upload of {0} bytes exceeds the staging ring of {1} bytes!", size, _ring.size_get());
+            return;
+        }
+
+        DODO_METRIC_COUNTER_ADD("renderer.upload_bytes", size);
+        const uint64_t staging_offset = _staging_allocate(size);
+        std::memcpy(_staging_data + staging_offset, data, size);
+
+        Batch& batch = _batch_begin();
+        _device->command_buffer_copy_buffer_to_texture(batch.command_buffer, _staging_buffer, staging_offset, texture, mip, layer);
+        batch.ring_marker = _ring.head_get();
+    }
+
+    bool UploadManager::flush(SemaphoreHandle signal_semaphore) {
+        DODO_PROFILE_SCOPE("UploadManager::flush");
+        DODO_ASSERT(_device && signal_semaphore);
+        _retire_signaled();
+        if (!_batches.at(_batch_index).is_recording) {
+            if (!_has_unsignaled_submission) {
+                return false;
+            }
+
+            // An empty batch only signals, it covers everything submitted before on the copy queue.
+            _batch_begin();
+        }
+
+        _batch_submit(signal_semaphore);
+        return true;
+    }
+
+    uint64_t UploadManager::_staging_allocate(uint64_t size) {
+        _retire_signaled();
+        uint64_t offset = _ring.allocate(size, staging_alignment);
+        while (offset == RingAllocator::invalid_offset) {
+            // The ring is full of copies still in flight or still being recorded.
+            if (_batches.at(_batch_index).is_recording) {
+                _batch_submit({});
+            }
+
+            Batch* oldest = nullptr;
+            for (uint32_t i = 0; (i < _batches.size()) && !oldest; i++) {
+                Batch& batch = _batches.at((_batch_index + i) % _batches.size());
+                oldest = batch.is_in_flight ? &batch : nullptr;
+            }
+
+            DODO_ASSERT(oldest);
+            if (!oldest) {
+                break;
+            }
+
+            DODO_PROFILE_SCOPE("UploadManager::ring_stall");
+            DODO_METRIC_COUNTER_ADD("renderer.upload_ring_stalls", 1);
+            _device->fence_wait(oldest->fence);
+            _batch_retire(*oldest);
+            offset = _ring.allocate(size, staging_alignment);
+        }
+
+        return offset;
+    }
+
+    UploadManager::Batch& UploadManager::_batch_begin() {
+        Batch& batch = _batches.at(_batch_index);
+        if (batch.is_recording) {
+            return batch;
+        }
+
+        if (batch.is_in_flight) {
+            DODO_METRIC_COUNTER_ADD("renderer.upload_batch_stalls", 1);
+            _device->fence_wait(batch.fence);
+            _batch_retire(batch);
+        }
+
+        _device->command_buffer_begin(batch.command_buffer);
+        batch.ring_marker = _ring.head_get();
+        batch.is_recording = true;
+        return batch;
+    }
+
+    void UploadManager::_batch_submit(SemaphoreHandle signal_semaphore) {
+        Batch& batch = _batches.at(_batch_index);
+        DODO_ASSERT(batch.is_recording);
+        _device->command_buffer_end(batch.command_buffer);
+
+        RenderDevice::SubmitSpecifications submit_specs = {};
+        submit_specs.command_queue = _copy_queue;
+        submit_specs.command_buffers = { &batch.command_buffer, 1 };
+        if (signal_semaphore) {
+            submit_specs.signal_semaphores = { &signal_semaphore, 1 };
+        }
+
+        submit_specs.fence = batch.fence;
+        _device->command_queue_execute_and_present(submit_specs);
+        DODO_METRIC_COUNTER_ADD("renderer.upload_batches", 1);
+
+        batch.is_recording = false;
+        batch.is_in_flight = true;
+        _batch_index = (_batch_index + 1) % static_cast<uint32_t>(_batches.size());
+        _has_unsignaled_submission = !signal_semaphore;
+    }
+
+    void UploadManager::_batch_retire(Batch& batch) {
+        _ring.release(batch.ring_marker);
+        batch.is_in_flight = false;
+    }
+
+    void UploadManager::_retire_signaled() {
+        // Batches complete in submission order, which starts at the next batch to record.
+        for (uint32_t i = 0; i < _batches.size(); i++) {
+            Batch& batch = _batches.at((_batch_index + i) % _batches.size());
+            if (!batch.is_in_flight) {
+                continue;
+            }
+
+            if (!_device->fence_is_signaled(batch.fence)) {
+                break;
+            }
+
+            _batch_retire(batch);
+        }
+    }
+
+}
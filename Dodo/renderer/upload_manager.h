@@ -0,0 +1,67 @@
+#pragma once
+
+#include "render_device.h"
+#include "memory/ring_allocator.h"
+
+namespace Dodo {
+
+    // Streams buffer and texture data to the GPU through one persistently mapped staging ring.
+    // Copies are batched into a single submission per frame on the copy queue, which signals a
+    // semaphore the draw submission of the frame waits on. Ring space is recycled as the fences
+    // of the batches signal, the caller only blocks when the whole ring is still in flight.
+    // Not thread safe, uploads and flushes happen on the thread that records frames.
+    class UploadManager {
+    public:
+        struct Specifications {
+            uint64_t ring_size = 32_mb;
+            uint32_t batch_count = 4;
+        };
+
+        UploadManager() = default;
+        ~UploadManager();
+
+        void initialize(Ref<RenderDevice> device, const Specifications& specs);
+        // Waits for every batch still in flight.
+        void de_initialize();
+
+        // Data larger than the ring is uploaded in pieces, flushing and waiting in between.
+        void buffer_upload(BufferHandle buffer, uint64_t offset, const void* data, uint64_t size);
+        // Size is the tightly packed size of the mip level. Transfer only queues can not copy depth.
+        void texture_upload(TextureHandle texture, uint32_t mip, uint32_t layer, const void* data, uint64_t size);
+
+        // Submits the recorded copies. Returns true when signal_semaphore was signaled, the next
+        // submission on the draw queue must wait on it then.
+        bool flush(SemaphoreHandle signal_semaphore);
+
+    private:
+        struct Batch {
+            CommandPoolHandle command_pool = {};
+            CommandBufferHandle command_buffer = {};
+            FenceHandle fence = {};
+            // Ring position after the last allocation of the batch, released once the fence signaled.
+            uint64_t ring_marker = 0;
+            bool is_recording = false;
+            bool is_in_flight = false;
+        };
+
+        // Returns the staging offset, blocks on the oldest batch while the ring is full.
+        uint64_t _staging_allocate(uint64_t size);
+        Batch& _batch_begin();
+        void _batch_submit(SemaphoreHandle signal_semaphore);
+        void _batch_retire(Batch& batch);
+        void _retire_signaled();
+
+        Ref<RenderDevice> _device = nullptr;
+        Specifications _specs = {};
+        CommandQueueHandle _copy_queue = {};
+        BufferHandle _staging_buffer = {};
+        uint8_t* _staging_data = nullptr;
+        RingAllocator _ring = {};
+        std::vector<Batch> _batches = {};
+        // The recording batch, or the next one to record. Batches are submitted in this order.
+        uint32_t _batch_index = 0;
+        // Batches submitted since the last flush without a semaphore, the next signal covers them.
+        bool _has_unsignaled_submission = false;
+    };
+
+}
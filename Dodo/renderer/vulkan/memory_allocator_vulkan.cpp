@@ -0,0 +1,493 @@
+#include "pch.h"
+
+#ifdef DODO_VULKAN
+
+#include "memory_allocator_vulkan.h"
+
+#include <bit>
+
+namespace Dodo {
+
+    ////////////////////////////////////////////////////////////////
+    // MEMORY ALLOCATOR VULKAN /////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    MemoryAllocatorVulkan::~MemoryAllocatorVulkan() {
+        finalize();
+    }
+
+    void MemoryAllocatorVulkan::initialize(VkPhysicalDevice physical_device, VkDevice device, const Specifications& specs) {
+        DODO_PROFILE_SCOPE("MemoryAllocatorVulkan::initialize");
+        std::unique_lock<std::mutex> lock(_mutex);
+        _physical_device = physical_device;
+        _device = device;
+        _specs = specs;
+
+        vkGetPhysicalDeviceMemoryProperties(_physical_device, &_memory_properties);
+        VkPhysicalDeviceProperties properties = {};
+        vkGetPhysicalDeviceProperties(_physical_device, &properties);
+        _max_allocation_count = properties.limits.maxMemoryAllocationCount;
+
+        _heaps.clear();
+        _heaps.resize(_memory_properties.memoryHeapCount);
+        for (uint32_t i = 0; i < _memory_properties.memoryHeapCount; i++) {
+            Heap& heap = _heaps.at(i);
+            heap.size = _memory_properties.memoryHeaps[i].size;
+            heap.is_device_local = (_memory_properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+            heap.usage_gauge = Metrics::gauge_register(std::format("renderer.memory.heap{0}.usage_bytes", i));
+            heap.budget_gauge = Metrics::gauge_register(std::format("renderer.memory.heap{0}.budget_bytes", i));
+        }
+
+        _block_lists.clear();
+        _block_lists.resize(static_cast<size_t>(_memory_properties.memoryTypeCount) * 2);
+    }
+
+    void MemoryAllocatorVulkan::finalize() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (!_device) {
+            return;
+        }
+
+        if ((_allocations.count_get() > 0) || (_linear_pools.count_get() > 0)) {
+            DODO_LOG_ERROR_TAG("Renderer", "{0} memory allocations and {1} linear pools leaked!", _allocations.count_get(), _linear_pools.count_get());
+            DODO_ASSERT(false);
+        }
+
+        for (BlockList& block_list : _block_lists) {
+            for (const std::unique_ptr<Block>& block : block_list) {
+                _device_memory_free(block->memory_type_index, block->size, block->memory);
+            }
+
+            block_list.clear();
+        }
+
+        _device = VK_NULL_HANDLE;
+    }
+
+    MemoryAllocationHandle MemoryAllocatorVulkan::allocate(const VkMemoryRequirements& requirements, MemoryUsage memory_usage, ResourceKind resource_kind, bool is_dedicated, uint64_t user_data) {
+        DODO_PROFILE_SCOPE("MemoryAllocatorVulkan::allocate");
+        std::unique_lock<std::mutex> lock(_mutex);
+        const uint32_t memory_type_index = _memory_type_find(requirements.memoryTypeBits, memory_usage);
+        if (memory_type_index == UINT32_MAX) {
+            DODO_LOG_ERROR_TAG("Renderer", "No memory type fits the requirements!");
+            return {};
+        }
+
+        Allocation allocation = {};
+        allocation.info.memory_type_index = memory_type_index;
+        allocation.info.size = requirements.size;
+        allocation.info.user_data = user_data;
+        allocation.alignment = requirements.alignment;
+
+        const VkDeviceSize full_block_size = _block_size_get(memory_type_index, SIZE_MAX);
+        const bool is_large = static_cast<double>(requirements.size) >= (static_cast<double>(full_block_size) * _specs.dedicated_threshold);
+        if (!is_dedicated && !is_large) {
+            const MemoryAllocationHandle allocation_handle = _allocations.create(std::move(allocation));
+            BlockList& block_list = _block_list_get(memory_type_index, resource_kind);
+            for (const std::unique_ptr<Block>& block : block_list) {
+                if (_block_allocate(block.get(), allocation_handle)) {
+                    return allocation_handle;
+                }
+            }
+
+            // Blocks start small and grow, halving again if the driver can not fit a new one.
+            VkDeviceSize block_size = std::max(_block_size_get(memory_type_index, block_list.size()), requirements.size);
+            void* mapped_data = nullptr;
+            VkDeviceMemory memory = _device_memory_allocate(memory_type_index, block_size, &mapped_data);
+            while (!memory && ((block_size / 2) >= requirements.size) && ((block_size / 2) >= 1_mb)) {
+                block_size /= 2;
+                memory = _device_memory_allocate(memory_type_index, block_size, &mapped_data);
+            }
+
+            if (memory) {
+                auto block = std::make_unique<Block>();
+                block->memory = memory;
+                block->memory_type_index = memory_type_index;
+                block->resource_kind = resource_kind;
+                block->size = block_size;
+                block->mapped_data = mapped_data;
+                block->tlsf.initialize(block_size);
+                _heap_get(memory_type_index).block_count++;
+                const bool is_allocated = _block_allocate(block.get(), allocation_handle);
+                DODO_ASSERT(is_allocated);
+                block_list.push_back(std::move(block));
+                return allocation_handle;
+            }
+
+            // A dedicated allocation of the exact size may still fit.
+            allocation = std::move(*_allocations.get_or_null(allocation_handle));
+            _allocations.destroy(allocation_handle);
+        }
+
+        void* mapped_data = nullptr;
+        VkDeviceMemory memory = _device_memory_allocate(memory_type_index, requirements.size, &mapped_data);
+        if (!memory) {
+            DODO_LOG_ERROR_TAG("Renderer", "Failed to allocate {0} bytes of device memory!", requirements.size);
+            return {};
+        }
+
+        allocation.info.memory = memory;
+        allocation.info.offset = 0;
+        allocation.info.mapped_data = mapped_data;
+        Heap& heap = _heap_get(memory_type_index);
+        heap.allocated += requirements.size;
+        heap.allocation_count++;
+        heap.dedicated_allocation_count++;
+        return _allocations.create(std::move(allocation));
+    }
+
+    MemoryAllocatorVulkan::AllocationInfo MemoryAllocatorVulkan::allocation_get_info(MemoryAllocationHandle allocation) const {
+        std::unique_lock<std::mutex> lock(_mutex);
+        const Allocation* alloc = _allocations.get_or_null(allocation);
+        return alloc ? alloc->info : AllocationInfo{};
+    }
+
+    void MemoryAllocatorVulkan::free(MemoryAllocationHandle allocation) {
+        DODO_PROFILE_SCOPE("MemoryAllocatorVulkan::free");
+        std::unique_lock<std::mutex> lock(_mutex);
+        Allocation* alloc = _allocations.get_or_null(allocation);
+        if (!alloc) {
+            return;
+        }
+
+        if (Block* block = alloc->block) {
+            _block_remove(alloc);
+            if (block->tlsf.is_empty()) {
+                _block_list_release_empty(_block_list_get(block->memory_type_index, block->resource_kind), 1);
+            }
+        }
+        else {
+            Heap& heap = _heap_get(alloc->info.memory_type_index);
+            heap.allocated -= alloc->info.size;
+            heap.allocation_count--;
+            heap.dedicated_allocation_count--;
+            _device_memory_free(alloc->info.memory_type_index, alloc->info.size, alloc->info.memory);
+        }
+
+        _allocations.destroy(allocation);
+    }
+
+    ////////////////////////////////////////////////////////////////
+    // LINEAR POOL /////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    LinearMemoryPoolHandle MemoryAllocatorVulkan::linear_pool_create(VkDeviceSize size, uint32_t memory_type_bits, MemoryUsage memory_usage) {
+        DODO_PROFILE_SCOPE("MemoryAllocatorVulkan::linear_pool_create");
+        std::unique_lock<std::mutex> lock(_mutex);
+        const uint32_t memory_type_index = _memory_type_find(memory_type_bits, memory_usage);
+        if (memory_type_index == UINT32_MAX) {
+            DODO_LOG_ERROR_TAG("Renderer", "No memory type fits the linear pool!");
+            return {};
+        }
+
+        LinearPool linear_pool = {};
+        linear_pool.memory = _device_memory_allocate(memory_type_index, size, &linear_pool.mapped_data);
+        if (!linear_pool.memory) {
+            DODO_LOG_ERROR_TAG("Renderer", "Failed to allocate a linear pool of {0} bytes!", size);
+            return {};
+        }
+
+        linear_pool.memory_type_index = memory_type_index;
+        linear_pool.size = size;
+        linear_pool.linear.initialize(size);
+        return _linear_pools.create(std::move(linear_pool));
+    }
+
+    bool MemoryAllocatorVulkan::linear_pool_allocate(LinearMemoryPoolHandle linear_pool, const VkMemoryRequirements& requirements, AllocationInfo& r_allocation_info) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        LinearPool* pool = _linear_pools.get_or_null(linear_pool);
+        if (!pool || ((requirements.memoryTypeBits & (1u << pool->memory_type_index)) == 0)) {
+            return false;
+        }
+
+        const uint64_t offset = pool->linear.allocate(requirements.size, std::max<VkDeviceSize>(requirements.alignment, 1));
+        if (offset == LinearAllocator::invalid_offset) {
+            return false;
+        }
+
+        r_allocation_info = {};
+        r_allocation_info.memory = pool->memory;
+        r_allocation_info.offset = offset;
+        r_allocation_info.size = requirements.size;
+        r_allocation_info.mapped_data = pool->mapped_data ? (static_cast<uint8_t*>(pool->mapped_data) + offset) : nullptr;
+        r_allocation_info.memory_type_index = pool->memory_type_index;
+        return true;
+    }
+
+    void MemoryAllocatorVulkan::linear_pool_reset(LinearMemoryPoolHandle linear_pool) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (LinearPool* pool = _linear_pools.get_or_null(linear_pool)) {
+            pool->linear.reset();
+        }
+    }
+
+    void MemoryAllocatorVulkan::linear_pool_destroy(LinearMemoryPoolHandle linear_pool) {
+        DODO_PROFILE_SCOPE("MemoryAllocatorVulkan::linear_pool_destroy");
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (LinearPool* pool = _linear_pools.get_or_null(linear_pool)) {
+            _device_memory_free(pool->memory_type_index, pool->size, pool->memory);
+            _linear_pools.destroy(linear_pool);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////
+    // DEFRAGMENTATION /////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    uint64_t MemoryAllocatorVulkan::defragment(const MoveCallback& move_callback, VkDeviceSize max_bytes_to_move) {
+        DODO_PROFILE_SCOPE("MemoryAllocatorVulkan::defragment");
+        std::unique_lock<std::mutex> lock(_mutex);
+        uint64_t moved_bytes = 0;
+        uint32_t moved_count = 0;
+        for (BlockList& block_list : _block_lists) {
+            if (block_list.size() < 2) {
+                continue;
+            }
+
+            // Sources are the emptiest blocks, targets the fullest ones.
+            std::vector<Block*> blocks = {};
+            blocks.reserve(block_list.size());
+            for (const std::unique_ptr<Block>& block : block_list) {
+                blocks.push_back(block.get());
+            }
+
+            std::ranges::sort(blocks, {}, [](const Block* block) { return block->tlsf.used_get(); });
+            for (size_t source_index = 0; (source_index + 1) < blocks.size(); source_index++) {
+                Block* source = blocks.at(source_index);
+                // Moves reorder the allocations of the source block, so walk a copy.
+                const std::vector<MemoryAllocationHandle> allocation_handles = source->allocations;
+                for (const MemoryAllocationHandle allocation_handle : allocation_handles) {
+                    Allocation* alloc = _allocations.get_or_null(allocation_handle);
+                    if ((moved_bytes + alloc->info.size) > max_bytes_to_move) {
+                        break;
+                    }
+
+                    for (size_t target_index = blocks.size() - 1; target_index > source_index; target_index--) {
+                        Block* target = blocks.at(target_index);
+                        const TlsfAllocator::Allocation range = target->tlsf.allocate(alloc->info.size, alloc->alignment);
+                        if (!range.is_valid()) {
+                            continue;
+                        }
+
+                        AllocationInfo to = alloc->info;
+                        to.memory = target->memory;
+                        to.offset = range.offset;
+                        to.mapped_data = target->mapped_data ? (static_cast<uint8_t*>(target->mapped_data) + range.offset) : nullptr;
+                        if (!move_callback(allocation_handle, alloc->info, to)) {
+                            target->tlsf.free(range);
+                            break;
+                        }
+
+                        _block_remove(alloc);
+                        _block_insert(target, allocation_handle, range);
+                        moved_bytes += alloc->info.size;
+                        moved_count++;
+                        break;
+                    }
+                }
+            }
+        }
+
+        DODO_METRIC_COUNTER_ADD("renderer.memory.defragment_moves", moved_count);
+        DODO_LOG_INFO_TAG("Renderer", "Defragmentation moved {0} allocations, {1} bytes.", moved_count, moved_bytes);
+        return moved_bytes;
+    }
+
+    void MemoryAllocatorVulkan::empty_blocks_release() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (BlockList& block_list : _block_lists) {
+            _block_list_release_empty(block_list, 0);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////
+    // STATISTICS //////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    void MemoryAllocatorVulkan::heap_statistics_get(std::vector<HeapStatistics>& r_heap_statistics) const {
+        std::unique_lock<std::mutex> lock(_mutex);
+        r_heap_statistics.clear();
+        r_heap_statistics.reserve(_heaps.size());
+        for (const Heap& heap : _heaps) {
+            HeapStatistics& heap_statistics = r_heap_statistics.emplace_back();
+            heap_statistics.heap_size = heap.size;
+            heap_statistics.budget = _budget_get(heap);
+            heap_statistics.usage = heap.usage;
+            heap_statistics.allocated = heap.allocated;
+            heap_statistics.block_count = heap.block_count;
+            heap_statistics.allocation_count = heap.allocation_count;
+            heap_statistics.dedicated_allocation_count = heap.dedicated_allocation_count;
+            heap_statistics.is_device_local = heap.is_device_local;
+        }
+    }
+
+    void MemoryAllocatorVulkan::update_metrics() const {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (const Heap& heap : _heaps) {
+            Metrics::gauge_set(heap.usage_gauge, static_cast<double>(heap.usage));
+            Metrics::gauge_set(heap.budget_gauge, static_cast<double>(_budget_get(heap)));
+        }
+
+        DODO_METRIC_GAUGE_SET("renderer.memory.device_allocations", static_cast<double>(_device_allocation_count));
+        DODO_METRIC_GAUGE_SET("renderer.memory.allocations", static_cast<double>(_allocations.count_get()));
+    }
+
+    ////////////////////////////////////////////////////////////////
+    // INTERNAL ////////////////////////////////////////////////////
+    ////////////////////////////////////////////////////////////////
+
+    uint32_t MemoryAllocatorVulkan::_memory_type_find(uint32_t memory_type_bits, MemoryUsage memory_usage) const {
+        VkMemoryPropertyFlags required_flags = 0;
+        VkMemoryPropertyFlags preferred_flags = 0;
+        VkMemoryPropertyFlags unwanted_flags = 0;
+        switch (memory_usage) {
+            case MemoryUsage::gpu_only: {
+                preferred_flags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+                // Keeps the small host visible device local heap free for uploads.
+                unwanted_flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+                break;
+            }
+
+            case MemoryUsage::cpu_to_gpu: {
+                required_flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+                unwanted_flags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+                break;
+            }
+
+            case MemoryUsage::gpu_to_cpu: {
+                required_flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+                preferred_flags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+                break;
+            }
+        }
+
+        uint32_t picked_memory_type_index = UINT32_MAX;
+        int picked_cost = std::numeric_limits<int>::max();
+        for (uint32_t i = 0; i < _memory_properties.memoryTypeCount; i++) {
+            const VkMemoryPropertyFlags flags = _memory_properties.memoryTypes[i].propertyFlags;
+            if (((memory_type_bits & (1u << i)) == 0) || ((flags & required_flags) != required_flags)) {
+                continue;
+            }
+
+            const int cost = std::popcount(preferred_flags & ~flags) + std::popcount(unwanted_flags & flags);
+            if (cost < picked_cost) {
+                picked_memory_type_index = i;
+                picked_cost = cost;
+            }
+        }
+
+        return picked_memory_type_index;
+    }
+
+    VkDeviceMemory MemoryAllocatorVulkan::_device_memory_allocate(uint32_t memory_type_index, VkDeviceSize size, void** r_mapped_data) {
+        DODO_PROFILE_SCOPE("MemoryAllocatorVulkan::device_memory_allocate");
+        *r_mapped_data = nullptr;
+        if (_device_allocation_count >= _max_allocation_count) {
+            DODO_LOG_ERROR_TAG("Renderer", "maxMemoryAllocationCount of {0} reached!", _max_allocation_count);
+            return VK_NULL_HANDLE;
+        }
+
+        Heap& heap = _heap_get(memory_type_index);
+        if ((heap.usage + size) > _budget_get(heap)) {
+            DODO_LOG_WARNING_TAG("Renderer", "Allocating {0} bytes exceeds the budget of heap {1}.", size, _memory_properties.memoryTypes[memory_type_index].heapIndex);
+        }
+
+        VkMemoryAllocateInfo allocate_info = {};
+        allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocate_info.allocationSize = size;
+        allocate_info.memoryTypeIndex = memory_type_index;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        if (vkAllocateMemory(_device, &allocate_info, nullptr, &memory) != VK_SUCCESS) {
+            return VK_NULL_HANDLE;
+        }
+
+        // Host visible memory is mapped once for its whole lifetime.
+        if ((_memory_properties.memoryTypes[memory_type_index].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0) {
+            DODO_ASSERT_VK_RESULT(vkMapMemory(_device, memory, 0, VK_WHOLE_SIZE, 0, r_mapped_data));
+        }
+
+        heap.usage += size;
+        _device_allocation_count++;
+        DODO_METRIC_COUNTER_ADD("renderer.memory.device_memory_allocations", 1);
+        return memory;
+    }
+
+    void MemoryAllocatorVulkan::_device_memory_free(uint32_t memory_type_index, VkDeviceSize size, VkDeviceMemory memory) {
+        DODO_PROFILE_SCOPE("MemoryAllocatorVulkan::device_memory_free");
+        // Freeing implicitly unmaps.
+        vkFreeMemory(_device, memory, nullptr);
+        _heap_get(memory_type_index).usage -= size;
+        _device_allocation_count--;
+    }
+
+    VkDeviceSize MemoryAllocatorVulkan::_block_size_get(uint32_t memory_type_index, size_t block_count) const {
+        const VkDeviceSize heap_size = _heaps.at(_memory_properties.memoryTypes[memory_type_index].heapIndex).size;
+        // Small heaps, e.g. the host visible device local one, would be exhausted by a few blocks.
+        const VkDeviceSize preferred_block_size = (heap_size <= 1024_mb) ? std::max<VkDeviceSize>(heap_size / 8, 1_mb) : _specs.preferred_block_size;
+        // The first blocks are smaller, so applications with little data do not reserve a full block per memory type.
+        const size_t shift = 3 - std::min<size_t>(block_count, 3);
+        return std::max<VkDeviceSize>(preferred_block_size >> shift, 1_mb);
+    }
+
+    VkDeviceSize MemoryAllocatorVulkan::_budget_get(const Heap& heap) const {
+        return static_cast<VkDeviceSize>(static_cast<double>(heap.size) * _specs.budget_fraction);
+    }
+
+    bool MemoryAllocatorVulkan::_block_allocate(Block* block, MemoryAllocationHandle allocation_handle) {
+        const Allocation* alloc = _allocations.get_or_null(allocation_handle);
+        const TlsfAllocator::Allocation range = block->tlsf.allocate(alloc->info.size, std::max<VkDeviceSize>(alloc->alignment, 1));
+        if (!range.is_valid()) {
+            return false;
+        }
+
+        _block_insert(block, allocation_handle, range);
+        return true;
+    }
+
+    void MemoryAllocatorVulkan::_block_insert(Block* block, MemoryAllocationHandle allocation_handle, TlsfAllocator::Allocation range) {
+        Allocation* alloc = _allocations.get_or_null(allocation_handle);
+        alloc->block = block;
+        alloc->range = range;
+        alloc->index_in_block = static_cast<uint32_t>(block->allocations.size());
+        alloc->info.memory = block->memory;
+        alloc->info.offset = range.offset;
+        alloc->info.mapped_data = block->mapped_data ? (static_cast<uint8_t*>(block->mapped_data) + range.offset) : nullptr;
+        block->allocations.push_back(allocation_handle);
+
+        Heap& heap = _heap_get(block->memory_type_index);
+        heap.allocated += alloc->info.size;
+        heap.allocation_count++;
+    }
+
+    void MemoryAllocatorVulkan::_block_remove(Allocation* allocation) {
+        Block* block = allocation->block;
+        block->tlsf.free(allocation->range);
+
+        const MemoryAllocationHandle last_handle = block->allocations.back();
+        block->allocations.at(allocation->index_in_block) = last_handle;
+        _allocations.get_or_null(last_handle)->index_in_block = allocation->index_in_block;
+        block->allocations.pop_back();
+
+        Heap& heap = _heap_get(block->memory_type_index);
+        heap.allocated -= allocation->info.size;
+        heap.allocation_count--;
+        allocation->block = nullptr;
+        allocation->range = {};
+    }
+
+    void MemoryAllocatorVulkan::_block_list_release_empty(BlockList& block_list, size_t spare_count) {
+        size_t empty_count = 0;
+        std::erase_if(block_list, [this, spare_count, &empty_count](const std::unique_ptr<Block>& block) {
+            if (!block->tlsf.is_empty() || (++empty_count <= spare_count)) {
+                return false;
+            }
+
+            _heap_get(block->memory_type_index).block_count--;
+            _device_memory_free(block->memory_type_index, block->size, block->memory);
+            return true;
+        });
+    }
+
+}
+
+#endif
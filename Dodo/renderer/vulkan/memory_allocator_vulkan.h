@@ -0,0 +1,157 @@
+#pragma once
+
+#ifdef DODO_VULKAN
+
+#include "vulkan_utils.h"
+#include "memory/linear_allocator.h"
+#include "memory/tlsf_allocator.h"
+#include "renderer/render_device.h"
+
+namespace Dodo {
+
+    DODO_DEFINE_RENDER_HANDLE(MemoryAllocation);
+    DODO_DEFINE_RENDER_HANDLE(LinearMemoryPool);
+
+    // Sub-allocates buffers and images from a few large VkDeviceMemory blocks per memory type,
+    // drivers only allow a few thousand vkAllocateMemory calls and each of them is slow.
+    // Large resources get a dedicated allocation, transient data goes into linear pools.
+    class MemoryAllocatorVulkan {
+    public:
+        using MemoryUsage = RenderDevice::MemoryUsage;
+        using HeapStatistics = RenderDevice::MemoryHeapStatistics;
+
+        // Buffers and optimal tiling images live in separate blocks, so bufferImageGranularity never applies.
+        enum class ResourceKind {
+            buffer,
+            image
+        };
+
+        struct Specifications {
+            VkDeviceSize preferred_block_size = 256_mb;
+            // Allocations at least this fraction of a block get their own VkDeviceMemory.
+            float dedicated_threshold = 0.5f;
+            // Share of each heap this device plans with, the rest is left to the driver and other processes.
+            float budget_fraction = 0.8f;
+        };
+
+        struct AllocationInfo {
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkDeviceSize offset = 0;
+            VkDeviceSize size = 0;
+            void* mapped_data = nullptr;
+            uint32_t memory_type_index = 0;
+            // Opaque value of the owner, passed back during defragmentation.
+            uint64_t user_data = 0;
+        };
+
+        // Called for every allocation picked to move. The callee copies the contents, binds its
+        // resource to the new range and returns true, or returns false to keep the allocation in place.
+        using MoveCallback = std::function<bool(MemoryAllocationHandle allocation, const AllocationInfo& from, const AllocationInfo& to)>;
+
+        MemoryAllocatorVulkan() = default;
+        ~MemoryAllocatorVulkan();
+
+        void initialize(VkPhysicalDevice physical_device, VkDevice device, const Specifications& specs);
+        // Releases every block, all allocations and linear pools must be destroyed by then.
+        void finalize();
+
+        MemoryAllocationHandle allocate(const VkMemoryRequirements& requirements, MemoryUsage memory_usage, ResourceKind resource_kind, bool is_dedicated = false, uint64_t user_data = 0);
+        // Returned by value, another thread may create allocations meanwhile. Memory is null for invalid handles.
+        AllocationInfo allocation_get_info(MemoryAllocationHandle allocation) const;
+        void free(MemoryAllocationHandle allocation);
+
+        // ---- LINEAR POOL ----
+
+        LinearMemoryPoolHandle linear_pool_create(VkDeviceSize size, uint32_t memory_type_bits, MemoryUsage memory_usage);
+        // The returned range lives until the pool is reset, returns false when the pool is exhausted.
+        bool linear_pool_allocate(LinearMemoryPoolHandle linear_pool, const VkMemoryRequirements& requirements, AllocationInfo& r_allocation_info);
+        void linear_pool_reset(LinearMemoryPoolHandle linear_pool);
+        void linear_pool_destroy(LinearMemoryPoolHandle linear_pool);
+
+        // ---- DEFRAGMENTATION ----
+
+        // Moves allocations out of the least used blocks of each pool into fuller ones. The callback
+        // must not call back into the allocator. Emptied blocks are kept, the old ranges are still
+        // read until the copies have executed.
+        uint64_t defragment(const MoveCallback& move_callback, VkDeviceSize max_bytes_to_move);
+        // Frees every empty block, once the GPU is done with the ranges moved out of them.
+        void empty_blocks_release();
+
+        // ---- STATISTICS ----
+
+        void heap_statistics_get(std::vector<HeapStatistics>& r_heap_statistics) const;
+        // Per heap gauges, updated once per frame through RenderDevice::metrics_update on the main thread.
+        void update_metrics() const;
+
+    private:
+        struct Block {
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            uint32_t memory_type_index = 0;
+            ResourceKind resource_kind = ResourceKind::buffer;
+            VkDeviceSize size = 0;
+            void* mapped_data = nullptr;
+            TlsfAllocator tlsf = {};
+            std::vector<MemoryAllocationHandle> allocations = {};
+        };
+
+        struct Allocation {
+            AllocationInfo info = {};
+            // Null for dedicated allocations.
+            Block* block = nullptr;
+            TlsfAllocator::Allocation range = {};
+            VkDeviceSize alignment = 1;
+            uint32_t index_in_block = 0;
+        };
+
+        struct LinearPool {
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            uint32_t memory_type_index = 0;
+            void* mapped_data = nullptr;
+            VkDeviceSize size = 0;
+            LinearAllocator linear = {};
+        };
+
+        struct Heap {
+            VkDeviceSize size = 0;
+            bool is_device_local = false;
+            // Everything allocated from the driver, blocks and linear pools included.
+            VkDeviceSize usage = 0;
+            VkDeviceSize allocated = 0;
+            uint32_t block_count = 0;
+            uint32_t allocation_count = 0;
+            uint32_t dedicated_allocation_count = 0;
+            Metrics::MetricId usage_gauge = Metrics::invalid_metric;
+            Metrics::MetricId budget_gauge = Metrics::invalid_metric;
+        };
+
+        using BlockList = std::vector<std::unique_ptr<Block>>;
+
+        uint32_t _memory_type_find(uint32_t memory_type_bits, MemoryUsage memory_usage) const;
+        VkDeviceMemory _device_memory_allocate(uint32_t memory_type_index, VkDeviceSize size, void** r_mapped_data);
+        void _device_memory_free(uint32_t memory_type_index, VkDeviceSize size, VkDeviceMemory memory);
+        VkDeviceSize _block_size_get(uint32_t memory_type_index, size_t block_count) const;
+        Heap& _heap_get(uint32_t memory_type_index) { return _heaps.at(_memory_properties.memoryTypes[memory_type_index].heapIndex); }
+        VkDeviceSize _budget_get(const Heap& heap) const;
+        BlockList& _block_list_get(uint32_t memory_type_index, ResourceKind resource_kind) { return _block_lists.at((memory_type_index * 2) + static_cast<uint32_t>(resource_kind)); }
+        bool _block_allocate(Block* block, MemoryAllocationHandle allocation_handle);
+        void _block_insert(Block* block, MemoryAllocationHandle allocation_handle, TlsfAllocator::Allocation range);
+        void _block_remove(Allocation* allocation);
+        // Keeps up to spare_count empty blocks around, so a free followed by an allocate does not hit the driver.
+        void _block_list_release_empty(BlockList& block_list, size_t spare_count);
+
+        VkPhysicalDevice _physical_device = VK_NULL_HANDLE;
+        VkDevice _device = VK_NULL_HANDLE;
+        Specifications _specs = {};
+        VkPhysicalDeviceMemoryProperties _memory_properties = {};
+        uint32_t _max_allocation_count = 0;
+        uint32_t _device_allocation_count = 0;
+        std::vector<Heap> _heaps = {};
+        std::vector<BlockList> _block_lists = {};
+        RenderHandlePool<MemoryAllocationHandle, Allocation> _allocations = {};
+        RenderHandlePool<LinearMemoryPoolHandle, LinearPool> _linear_pools = {};
+        mutable std::mutex _mutex = {};
+    };
+
+}
+
+#endif
@@ -133,6 +133,25 @@ namespace Dodo {
         }
     }
 
+    RenderBackend::VSyncMode RenderBackendVulkan::surface_get_vsync_mode(SurfaceHandle p_surface) {
+        DODO_ASSERT(!p_surface.is_null());
+        if (const Surface* surface = _surface_owner.get_or_null(p_surface)) {
+            return surface->vsync_mode;
+        }
+
+        return VSyncMode::disabled;
+    }
+
+    void RenderBackendVulkan::surface_set_vsync_mode(SurfaceHandle p_surface, VSyncMode vsync_mode) {
+        DODO_ASSERT(!p_surface.is_null());
+        if (Surface* surface = _surface_owner.get_or_null(p_surface)) {
+            if (surface->vsync_mode != vsync_mode) {
+                surface->vsync_mode = vsync_mode;
+                surface->needs_resize = true;
+            }
+        }
+    }
+
     void RenderBackendVulkan::surface_destroy(SurfaceHandle p_surface) {
         DODO_ASSERT(!p_surface.is_null());
         if (Surface* surface = _surface_owner.get_or_null(p_surface)) {
@@ -141,7 +160,10 @@ namespace Dodo {
             });
 
             if (found != _surfaces.end()) {
-                vkDestroySurfaceKHR(_instance, surface->vk_surface, VK_NULL_HANDLE);
+                if (surface->vk_surface) {
+                    vkDestroySurfaceKHR(_instance, surface->vk_surface, VK_NULL_HANDLE);
+                }
+
                 _surface_owner.destroy(p_surface);
                 _surfaces.erase(found);
             }
@@ -160,6 +182,10 @@ namespace Dodo {
         return _desired_api_version;
     }
 
+    bool RenderBackendVulkan::is_headless() const {
+        return _get_platform_surface_extension() == nullptr;
+    }
+
     VkInstance RenderBackendVulkan::instance_get() const {
         return _instance;
     }
@@ -191,6 +217,11 @@ namespace Dodo {
     bool RenderBackendVulkan::queue_family_supports_present(VkPhysicalDevice physical_device, uint32_t queue_family_index, SurfaceHandle surface) const {
         DODO_ASSERT(!surface.is_null());
         if (Surface* surface_info = _surface_owner.get_or_null(surface)) {
+            if (surface_info->vk_surface == VK_NULL_HANDLE) {
+                // Offscreen surfaces never present, any queue family will do.
+                return true;
+            }
+
             VkBool32 supports_present = VK_FALSE;
             DODO_ASSERT_VK_RESULT(_functions.GetPhysicalDeviceSurfaceSupportKHR(physical_device, queue_family_index, surface_info->vk_surface, &supports_present));
             return supports_present;
@@ -230,9 +261,11 @@ namespace Dodo {
             supported_extensions.insert(extension.extensionName);
         }
 
-        _request_extension(VK_KHR_SURFACE_EXTENSION_NAME, true);
         _request_extension(VK_EXT_DEBUG_UTILS_EXTENSION_NAME, false);
-        _request_extension(_get_platform_surface_extension(), true);
+        if (const char* platform_surface_extension = _get_platform_surface_extension()) {
+            _request_extension(VK_KHR_SURFACE_EXTENSION_NAME, true);
+            _request_extension(platform_surface_extension, true);
+        }
 
         for (const auto& [name, is_required] : _requested_extensions) {
             if (!supported_extensions.contains(name)) {
@@ -285,6 +318,7 @@ namespace Dodo {
         _functions.GetPhysicalDeviceSurfaceFormatsKHR = reinterpret_cast<PFN_vkGetPhysicalDeviceSurfaceFormatsKHR>(vkGetInstanceProcAddr(_instance, "vkGetPhysicalDeviceSurfaceFormatsKHR"));
         _functions.GetPhysicalDeviceSurfacePresentModesKHR = reinterpret_cast<PFN_vkGetPhysicalDeviceSurfacePresentModesKHR>(vkGetInstanceProcAddr(_instance, "vkGetPhysicalDeviceSurfacePresentModesKHR"));
         _functions.GetDeviceProcAddr = reinterpret_cast<PFN_vkGetDeviceProcAddr>(vkGetInstanceProcAddr(_instance, "vkGetDeviceProcAddr"));
+        _functions.GetPhysicalDeviceCalibrateableTimeDomainsEXT = reinterpret_cast<PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT>(vkGetInstanceProcAddr(_instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT"));
 
         if (_debug_utils_extension_enabled) {
             VkDebugUtilsMessengerCreateInfoEXT messenger_create_info = {};
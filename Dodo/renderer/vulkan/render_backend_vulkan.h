@@ -25,6 +25,7 @@ namespace Dodo {
             PFN_vkGetPhysicalDeviceSurfaceFormatsKHR GetPhysicalDeviceSurfaceFormatsKHR = nullptr;
             PFN_vkGetPhysicalDeviceSurfacePresentModesKHR GetPhysicalDeviceSurfacePresentModesKHR = nullptr;
             PFN_vkGetDeviceProcAddr GetDeviceProcAddr = nullptr;
+            PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT GetPhysicalDeviceCalibrateableTimeDomainsEXT = nullptr;
         };
 
         RenderBackendVulkan() = default;
@@ -41,10 +42,13 @@ namespace Dodo {
         void surface_set_size(SurfaceHandle surface, uint32_t width, uint32_t height) override;
         bool surface_get_needs_resize(SurfaceHandle surface) override;
         void surface_set_needs_resize(SurfaceHandle surface, bool needs_resize) override;
+        VSyncMode surface_get_vsync_mode(SurfaceHandle surface) override;
+        void surface_set_vsync_mode(SurfaceHandle surface, VSyncMode vsync_mode) override;
         void surface_destroy(SurfaceHandle surface) override;
         uint32_t adapter_get_count() const override;
         const Adapter& adapter_get(size_t index) const override;
         uint32_t supported_api_version_get() const;
+        bool is_headless() const;
         VkInstance instance_get() const;
         const Functions& functions_get() const;
         VkPhysicalDevice physical_device_get(size_t index) const;
@@ -54,6 +58,7 @@ namespace Dodo {
         bool queue_family_supports_present(VkPhysicalDevice physical_device, uint32_t queue_family_index, SurfaceHandle surface) const;
 
     protected:
+        // Null for backends without a window system, e.g. headless.
         virtual const char* _get_platform_surface_extension() const = 0;
 
         RenderHandlePool<SurfaceHandle, Surface> _surface_owner = {};
@@ -67,7 +72,7 @@ namespace Dodo {
         void _request_extension(const std::string& name, bool is_required);
         void _query_adapters_and_queue_families();
 
-        uint32_t _desired_api_version = VK_API_VERSION_1_0;
+        uint32_t _desired_api_version = VK_API_VERSION_1_2;
         std::map<std::string, bool> _requested_extensions = {};
         std::vector<const char*> _enabled_extensions = {};
         const char* _validation_layer_name = "VK_LAYER_KHRONOS_validation";
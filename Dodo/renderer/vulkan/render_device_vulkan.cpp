@@ -4,11 +4,23 @@
 
 #include "render_device_vulkan.h"
 #include "render_backend_vulkan.h"
+#include "core/Hash.h"
+#include "core/thread_pool.h"
+#include "renderer/pipeline_state.h"
+
+#include <bit>
 
 namespace Dodo {
 
     namespace Utils {
 
+        // The domain of Timer::host_now().
+#if defined(DODO_WINDOWS)
+        static constexpr VkTimeDomainEXT host_time_domain = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+#else
+        static constexpr VkTimeDomainEXT host_time_domain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+#endif
+
         static VkPresentModeKHR convert_to_present_mode(RenderBackend::VSyncMode vsync_mode) {
             switch (vsync_mode) {
                 case RenderBackend::VSyncMode::enabled : return VK_PRESENT_MODE_FIFO_KHR;
@@ -20,13 +32,199 @@ namespace Dodo {
             return VK_PRESENT_MODE_MAX_ENUM_KHR;
         }
 
+        static VkBufferUsageFlags convert_to_buffer_usage(uint32_t usage) {
+            // Every buffer can be copied, defragmentation moves buffers with transfers.
+            VkBufferUsageFlags vk_usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+            vk_usage |= (usage & RenderDevice::buffer_usage_uniform) ? VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT : 0;
+            vk_usage |= (usage & RenderDevice::buffer_usage_storage) ? VK_BUFFER_USAGE_STORAGE_BUFFER_BIT : 0;
+            vk_usage |= (usage & RenderDevice::buffer_usage_index) ? VK_BUFFER_USAGE_INDEX_BUFFER_BIT : 0;
+            vk_usage |= (usage & RenderDevice::buffer_usage_vertex) ? VK_BUFFER_USAGE_VERTEX_BUFFER_BIT : 0;
+            vk_usage |= (usage & RenderDevice::buffer_usage_indirect) ? VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT : 0;
+            return vk_usage;
+        }
+
+        static VkFormat convert_to_format(RenderDevice::TextureFormat format) {
+            switch (format) {
+                case RenderDevice::TextureFormat::rgba8_unorm     : return VK_FORMAT_R8G8B8A8_UNORM;
+                case RenderDevice::TextureFormat::rgba8_srgb      : return VK_FORMAT_R8G8B8A8_SRGB;
+                case RenderDevice::TextureFormat::bgra8_unorm     : return VK_FORMAT_B8G8R8A8_UNORM;
+                case RenderDevice::TextureFormat::bgra8_srgb      : return VK_FORMAT_B8G8R8A8_SRGB;
+                case RenderDevice::TextureFormat::rgba16_float    : return VK_FORMAT_R16G16B16A16_SFLOAT;
+                case RenderDevice::TextureFormat::rgba32_float    : return VK_FORMAT_R32G32B32A32_SFLOAT;
+                case RenderDevice::TextureFormat::r32_float       : return VK_FORMAT_R32_SFLOAT;
+                case RenderDevice::TextureFormat::depth32_float   : return VK_FORMAT_D32_SFLOAT;
+                case RenderDevice::TextureFormat::depth24_stencil8: return VK_FORMAT_D24_UNORM_S8_UINT;
+                default: break;
+            }
+
+            return VK_FORMAT_UNDEFINED;
+        }
+
+        static VkImageUsageFlags convert_to_image_usage(uint32_t usage) {
+            VkImageUsageFlags vk_usage = 0;
+            vk_usage |= (usage & RenderDevice::texture_usage_transfer_src) ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0;
+            vk_usage |= (usage & RenderDevice::texture_usage_transfer_dst) ? VK_IMAGE_USAGE_TRANSFER_DST_BIT : 0;
+            vk_usage |= (usage & RenderDevice::texture_usage_sampled) ? VK_IMAGE_USAGE_SAMPLED_BIT : 0;
+            vk_usage |= (usage & RenderDevice::texture_usage_storage) ? VK_IMAGE_USAGE_STORAGE_BIT : 0;
+            vk_usage |= (usage & RenderDevice::texture_usage_color_attachment) ? VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT : 0;
+            vk_usage |= (usage & RenderDevice::texture_usage_depth_stencil_attachment) ? VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT : 0;
+            return vk_usage;
+        }
+
+        static bool is_depth_format(RenderDevice::TextureFormat format) {
+            return (format == RenderDevice::TextureFormat::depth32_float) || (format == RenderDevice::TextureFormat::depth24_stencil8);
+        }
+
+        static VkShaderStageFlagBits convert_to_shader_stage(RenderDevice::ShaderStage stage) {
+            switch (stage) {
+                case RenderDevice::ShaderStage::vertex : return VK_SHADER_STAGE_VERTEX_BIT;
+                case RenderDevice::ShaderStage::fragment : return VK_SHADER_STAGE_FRAGMENT_BIT;
+                case RenderDevice::ShaderStage::compute : return VK_SHADER_STAGE_COMPUTE_BIT;
+            }
+
+            return VK_SHADER_STAGE_VERTEX_BIT;
+        }
+
+        static VkFormat convert_to_vertex_format(RenderDevice::VertexFormat format) {
+            switch (format) {
+                case RenderDevice::VertexFormat::float1 : return VK_FORMAT_R32_SFLOAT;
+                case RenderDevice::VertexFormat::float2 : return VK_FORMAT_R32G32_SFLOAT;
+                case RenderDevice::VertexFormat::float3 : return VK_FORMAT_R32G32B32_SFLOAT;
+                case RenderDevice::VertexFormat::float4 : return VK_FORMAT_R32G32B32A32_SFLOAT;
+                case RenderDevice::VertexFormat::uint1 : return VK_FORMAT_R32_UINT;
+                case RenderDevice::VertexFormat::rgba8_unorm : return VK_FORMAT_R8G8B8A8_UNORM;
+            }
+
+            return VK_FORMAT_UNDEFINED;
+        }
+
+        static VkPrimitiveTopology convert_to_primitive_topology(RenderDevice::PrimitiveTopology topology) {
+            switch (topology) {
+                case RenderDevice::PrimitiveTopology::triangle_list : return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+                case RenderDevice::PrimitiveTopology::triangle_strip : return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+                case RenderDevice::PrimitiveTopology::line_list : return VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+                case RenderDevice::PrimitiveTopology::point_list : return VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+            }
+
+            return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        }
+
+        static VkCullModeFlags convert_to_cull_mode(RenderDevice::CullMode cull_mode) {
+            switch (cull_mode) {
+                case RenderDevice::CullMode::none : return VK_CULL_MODE_NONE;
+                case RenderDevice::CullMode::front : return VK_CULL_MODE_FRONT_BIT;
+                case RenderDevice::CullMode::back : return VK_CULL_MODE_BACK_BIT;
+            }
+
+            return VK_CULL_MODE_NONE;
+        }
+
+        static VkCompareOp convert_to_compare_op(RenderDevice::CompareOp compare_op) {
+            switch (compare_op) {
+                case RenderDevice::CompareOp::never : return VK_COMPARE_OP_NEVER;
+                case RenderDevice::CompareOp::less : return VK_COMPARE_OP_LESS;
+                case RenderDevice::CompareOp::equal : return VK_COMPARE_OP_EQUAL;
+                case RenderDevice::CompareOp::less_or_equal : return VK_COMPARE_OP_LESS_OR_EQUAL;
+                case RenderDevice::CompareOp::greater : return VK_COMPARE_OP_GREATER;
+                case RenderDevice::CompareOp::not_equal : return VK_COMPARE_OP_NOT_EQUAL;
+                case RenderDevice::CompareOp::greater_or_equal : return VK_COMPARE_OP_GREATER_OR_EQUAL;
+                case RenderDevice::CompareOp::always : return VK_COMPARE_OP_ALWAYS;
+            }
+
+            return VK_COMPARE_OP_ALWAYS;
+        }
+
+        static constexpr VkShaderStageFlags bindless_shader_stages = VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT;
+        // Clamped to the limits of the device.
+        static constexpr uint32_t bindless_texture_capacity = 16384;
+        static constexpr uint32_t bindless_storage_texture_capacity = 4096;
+        static constexpr uint32_t bindless_buffer_capacity = 16384;
+
+        static VkSamplerCreateInfo make_bindless_sampler_create_info(RenderDevice::BindlessSampler sampler) {
+            const bool is_linear = (sampler == RenderDevice::BindlessSampler::linear_repeat) || (sampler == RenderDevice::BindlessSampler::linear_clamp);
+            const bool is_repeat = (sampler == RenderDevice::BindlessSampler::linear_repeat) || (sampler == RenderDevice::BindlessSampler::nearest_repeat);
+            const VkSamplerAddressMode address_mode = is_repeat ? VK_SAMPLER_ADDRESS_MODE_REPEAT : VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+            VkSamplerCreateInfo create_info = {};
+            create_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+            create_info.magFilter = is_linear ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+            create_info.minFilter = create_info.magFilter;
+            create_info.mipmapMode = is_linear ? VK_SAMPLER_MIPMAP_MODE_LINEAR : VK_SAMPLER_MIPMAP_MODE_NEAREST;
+            create_info.addressModeU = address_mode;
+            create_info.addressModeV = address_mode;
+            create_info.addressModeW = address_mode;
+            create_info.maxLod = VK_LOD_CLAMP_NONE;
+            return create_info;
+        }
+
+        // Ahead of the driver's cache data, which is only valid for the device and driver that wrote it.
+        struct PipelineCacheHeader {
+            uint32_t magic = 0;
+            uint32_t version = 0;
+            uint32_t vendor_id = 0;
+            uint32_t device_id = 0;
+            uint32_t driver_version = 0;
+            uint8_t pipeline_cache_uuid[VK_UUID_SIZE] = {};
+            uint64_t data_size = 0;
+            uint64_t data_hash = 0;
+        };
+
+        static constexpr uint32_t pipeline_cache_magic = 0x43504444;
+        static constexpr uint32_t pipeline_cache_version = 1;
+        static constexpr const char* pipeline_cache_path = "dodo_pipeline_cache.bin";
+
+        static PipelineCacheHeader make_pipeline_cache_header(const VkPhysicalDeviceProperties& properties) {
+            PipelineCacheHeader header = {};
+            header.magic = pipeline_cache_magic;
+            header.version = pipeline_cache_version;
+            header.vendor_id = properties.vendorID;
+            header.device_id = properties.deviceID;
+            header.driver_version = properties.driverVersion;
+            std::memcpy(header.pipeline_cache_uuid, properties.pipelineCacheUUID, VK_UUID_SIZE);
+            return header;
+        }
+
+        static bool is_pipeline_cache_header_compatible(const PipelineCacheHeader& header, const PipelineCacheHeader& expected_header) {
+            return (header.magic == expected_header.magic) && (header.version == expected_header.version) &&
+                   (header.vendor_id == expected_header.vendor_id) && (header.device_id == expected_header.device_id) &&
+                   (header.driver_version == expected_header.driver_version) &&
+                   (std::memcmp(header.pipeline_cache_uuid, expected_header.pipeline_cache_uuid, VK_UUID_SIZE) == 0);
+        }
+
+        struct ResourceStateInfo {
+            VkPipelineStageFlags stages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+            VkAccessFlags access = 0;
+            VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        };
+
+        static ResourceStateInfo convert_to_resource_state_info(RenderDevice::ResourceState state) {
+            static constexpr VkPipelineStageFlags shader_stages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+            static constexpr VkPipelineStageFlags depth_stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            switch (state) {
+                case RenderDevice::ResourceState::undefined : return { VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED };
+                case RenderDevice::ResourceState::transfer_src : return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL };
+                case RenderDevice::ResourceState::transfer_dst : return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL };
+                case RenderDevice::ResourceState::vertex_input : return { VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED };
+                case RenderDevice::ResourceState::indirect_argument : return { VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED };
+                case RenderDevice::ResourceState::shader_read : return { shader_stages, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+                case RenderDevice::ResourceState::shader_write : return { shader_stages, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL };
+                case RenderDevice::ResourceState::color_attachment : return { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+                case RenderDevice::ResourceState::depth_stencil_attachment : return { depth_stages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+                case RenderDevice::ResourceState::depth_stencil_read : return { depth_stages | shader_stages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
+                case RenderDevice::ResourceState::present : return { VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR };
+            }
+
+            return {};
+        }
+
     }
 
     RenderDeviceVulkan::RenderDeviceVulkan(Ref<RenderBackendVulkan> backend)
         : _backend(backend) {}
 
-    void RenderDeviceVulkan::initialize(size_t index) {
+    bool RenderDeviceVulkan::initialize(size_t index) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::initialize");
         _physical_device = _backend->physical_device_get(index);
+        _physical_device_properties = _backend->physical_device_properties_get(index);
 
         _queue_families.clear();
         const uint32_t queue_family_count = _backend->queue_family_get_count(index);
@@ -37,7 +235,32 @@ namespace Dodo {
 
         std::vector<VkDeviceQueueCreateInfo> queue_create_infos = {};
         _add_queue_create_infos(queue_create_infos);
-        _initialize_device(queue_create_infos);
+        if (!_initialize_device(queue_create_infos)) {
+            return false;
+        }
+
+        _memory_allocator.initialize(_physical_device, _device, {});
+        _pipeline_cache_load();
+        _bindless_initialize();
+
+        _resource_queue_family_indices.clear();
+        for (uint32_t i = 0; i < queue_family_count; i++) {
+            const VkQueueFlags queue_family_bits = _queue_families.at(i).queueFlags;
+            if ((_queue_families.at(i).queueCount > 0) && ((queue_family_bits & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT)) != 0)) {
+                _resource_queue_family_indices.push_back(i);
+            }
+        }
+
+        // Query pools are not tied to a queue family, keep the bits every family agrees on.
+        uint32_t timestamp_valid_bits = 64;
+        for (uint32_t i = 0; i < queue_family_count; i++) {
+            if ((_queue_families.at(i).queueCount > 0) && (_queue_families.at(i).timestampValidBits > 0)) {
+                timestamp_valid_bits = std::min(timestamp_valid_bits, _queue_families.at(i).timestampValidBits);
+            }
+        }
+
+        _timestamp_calibration.valid_mask = (timestamp_valid_bits >= 64) ? UINT64_MAX : ((uint64_t(1) << timestamp_valid_bits) - 1);
+        return true;
     }
 
     void RenderDeviceVulkan::_add_queue_create_infos(std::vector<VkDeviceQueueCreateInfo>& r_queue_create_infos) {
@@ -56,7 +279,7 @@ namespace Dodo {
             r_queue_create_infos.push_back(create_info);
 
             _queues.at(i).resize(queue_count);
-            for (uint32_t j = 0; j < _queues.at(i).size(); i++) {
+            for (uint32_t j = 0; j < _queues.at(i).size(); j++) {
                 Queue& queue = _queues.at(i).at(j);
                 queue.queue_family_index = i;
                 queue.queue_index = j;
@@ -64,7 +287,7 @@ namespace Dodo {
         }
     }
 
-    void RenderDeviceVulkan::_initialize_device(std::vector<VkDeviceQueueCreateInfo>& queue_create_infos) {
+    bool RenderDeviceVulkan::_initialize_device(std::vector<VkDeviceQueueCreateInfo>& queue_create_infos) {
         std::set<std::string> supported_extensions = {};
         uint32_t extension_count = 0;
         DODO_ASSERT_VK_RESULT(vkEnumerateDeviceExtensionProperties(_physical_device, nullptr, &extension_count, nullptr));
@@ -74,13 +297,18 @@ namespace Dodo {
             supported_extensions.insert(extension.extensionName);
         }
 
-        _request_extension(VK_KHR_SWAPCHAIN_EXTENSION_NAME, true);
+        // VK_KHR_swapchain depends on VK_KHR_surface, which headless backends do not enable.
+        if (!_backend->is_headless()) {
+            _request_extension(VK_KHR_SWAPCHAIN_EXTENSION_NAME, true);
+        }
+
+        _request_extension(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME, false);
 
         for (const auto& [name, is_required] : _requested_extensions) {
             if (!supported_extensions.contains(name)) {
                 if (is_required) {
                     DODO_LOG_ERROR_TAG("Renderer", "{0} required but not supported!", name);
-                    DODO_ASSERT(false);
+                    return false;
                 }
                 else {
                     DODO_LOG_WARNING_TAG("Renderer", "{0} not supported!", name);
@@ -88,381 +316,1979 @@ namespace Dodo {
                 }
             }
 
-            _enabled_extensions.push_back(name.c_str());
+            _enabled_extensions.push_back(name.c_str());
+        }
+
+        // Queues synchronize through timeline semaphores and resources are bound through descriptor indexing,
+        // both are core since Vulkan 1.2.
+        VkPhysicalDeviceVulkan12Features supported_features_12 = {};
+        supported_features_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        if (_physical_device_properties.apiVersion >= VK_API_VERSION_1_2) {
+            VkPhysicalDeviceFeatures2 supported_features = {};
+            supported_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            supported_features.pNext = &supported_features_12;
+            vkGetPhysicalDeviceFeatures2(_physical_device, &supported_features);
+        }
+
+        if (supported_features_12.timelineSemaphore != VK_TRUE) {
+            DODO_LOG_ERROR_TAG("Renderer", "Timeline semaphores required but not supported!");
+            return false;
+        }
+
+        const bool supports_bindless = (supported_features_12.runtimeDescriptorArray == VK_TRUE) &&
+                                       (supported_features_12.descriptorBindingPartiallyBound == VK_TRUE) &&
+                                       (supported_features_12.descriptorBindingUpdateUnusedWhilePending == VK_TRUE) &&
+                                       (supported_features_12.descriptorBindingSampledImageUpdateAfterBind == VK_TRUE) &&
+                                       (supported_features_12.descriptorBindingStorageImageUpdateAfterBind == VK_TRUE) &&
+                                       (supported_features_12.descriptorBindingStorageBufferUpdateAfterBind == VK_TRUE);
+        if (!supports_bindless) {
+            DODO_LOG_ERROR_TAG("Renderer", "Update after bind descriptor indexing required but not supported!");
+            return false;
+        }
+
+        VkPhysicalDeviceVulkan12Features enabled_features_12 = {};
+        enabled_features_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        enabled_features_12.timelineSemaphore = VK_TRUE;
+        enabled_features_12.descriptorIndexing = supported_features_12.descriptorIndexing;
+        enabled_features_12.runtimeDescriptorArray = VK_TRUE;
+        enabled_features_12.descriptorBindingPartiallyBound = VK_TRUE;
+        enabled_features_12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+        enabled_features_12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        enabled_features_12.descriptorBindingStorageImageUpdateAfterBind = VK_TRUE;
+        enabled_features_12.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+        // Lets shaders index with values that differ within a draw, e.g. a material index per instance.
+        enabled_features_12.shaderSampledImageArrayNonUniformIndexing = supported_features_12.shaderSampledImageArrayNonUniformIndexing;
+        enabled_features_12.shaderStorageImageArrayNonUniformIndexing = supported_features_12.shaderStorageImageArrayNonUniformIndexing;
+        enabled_features_12.shaderStorageBufferArrayNonUniformIndexing = supported_features_12.shaderStorageBufferArrayNonUniformIndexing;
+
+        VkDeviceCreateInfo device_create_info = {};
+        device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        device_create_info.pNext = &enabled_features_12;
+        device_create_info.queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size());
+        device_create_info.pQueueCreateInfos = queue_create_infos.data();
+        device_create_info.enabledExtensionCount = static_cast<uint32_t>(_enabled_extensions.size());
+        device_create_info.ppEnabledExtensionNames = _enabled_extensions.data();
+        DODO_ASSERT_VK_RESULT(vkCreateDevice(_physical_device, &device_create_info, nullptr, &_device));
+
+        for (uint32_t i = 0; i < _queues.size(); i++) {
+            for (uint32_t j = 0; j < _queues.at(i).size(); j++) {
+                vkGetDeviceQueue(_device, i, j, &_queues.at(i).at(j).queue);
+            }
+        }
+
+        const RenderBackendVulkan::Functions& backend_functions = _backend->functions_get();
+        _functions.CreateSwapchainKHR = reinterpret_cast<PFN_vkCreateSwapchainKHR>(backend_functions.GetDeviceProcAddr(_device, "vkCreateSwapchainKHR"));
+        _functions.GetSwapchainImagesKHR = reinterpret_cast<PFN_vkGetSwapchainImagesKHR>(backend_functions.GetDeviceProcAddr(_device, "vkGetSwapchainImagesKHR"));
+        _functions.AcquireNextImageKHR = reinterpret_cast<PFN_vkAcquireNextImageKHR>(backend_functions.GetDeviceProcAddr(_device, "vkAcquireNextImageKHR"));
+        _functions.QueuePresentKHR = reinterpret_cast<PFN_vkQueuePresentKHR>(backend_functions.GetDeviceProcAddr(_device, "vkQueuePresentKHR"));
+        _functions.DestroySwapchainKHR = reinterpret_cast<PFN_vkDestroySwapchainKHR>(backend_functions.GetDeviceProcAddr(_device, "vkDestroySwapchainKHR"));
+        if (_is_extension_enabled(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME) && backend_functions.GetPhysicalDeviceCalibrateableTimeDomainsEXT) {
+            _functions.GetCalibratedTimestampsEXT = reinterpret_cast<PFN_vkGetCalibratedTimestampsEXT>(backend_functions.GetDeviceProcAddr(_device, "vkGetCalibratedTimestampsEXT"));
+            uint32_t time_domain_count = 0;
+            backend_functions.GetPhysicalDeviceCalibrateableTimeDomainsEXT(_physical_device, &time_domain_count, nullptr);
+            std::vector<VkTimeDomainEXT> time_domains(time_domain_count);
+            backend_functions.GetPhysicalDeviceCalibrateableTimeDomainsEXT(_physical_device, &time_domain_count, time_domains.data());
+            const bool has_device_time_domain = std::ranges::find(time_domains, VK_TIME_DOMAIN_DEVICE_EXT) != time_domains.end();
+            _timestamp_calibration.has_host_time_domain = has_device_time_domain && (std::ranges::find(time_domains, Utils::host_time_domain) != time_domains.end());
+        }
+
+        return true;
+    }
+
+    void RenderDeviceVulkan::_request_extension(const std::string& name, bool is_required) {
+        DODO_ASSERT(!_requested_extensions.contains(name));
+        _requested_extensions.insert({ name, is_required });
+    }
+
+    bool RenderDeviceVulkan::_is_extension_enabled(const std::string& name) const {
+        return std::ranges::find(_enabled_extensions, name) != _enabled_extensions.end();
+    }
+
+    CommandQueueFamilyHandle RenderDeviceVulkan::command_queue_family_get(CommandQueueFamilyType command_queue_family_type, SurfaceHandle surface) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::command_queue_family_get");
+        VkQueueFlags desired_queue_family_bits = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+        if (command_queue_family_type == CommandQueueFamilyType::compute) {
+            desired_queue_family_bits = VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+        }
+        else if (command_queue_family_type == CommandQueueFamilyType::copy) {
+            desired_queue_family_bits = VK_QUEUE_TRANSFER_BIT;
+        }
+
+        uint32_t picked_queue_family_index = UINT32_MAX;
+        int picked_extra_bit_count = std::numeric_limits<int>::max();
+        for (uint32_t i = 0; i < _queues.size(); i++) {
+            if (_queues.at(i).empty()) {
+                continue;
+            }
+
+            if (surface && !_backend->queue_family_supports_present(_physical_device, i, surface)) {
+                continue;
+            }
+
+            const VkQueueFlags queue_family_bits = _queue_families.at(i).queueFlags;
+            const bool includes_desired_bits = (queue_family_bits & desired_queue_family_bits) == desired_queue_family_bits;
+            if (!includes_desired_bits) {
+                continue;
+            }
+
+            // The most specialized family wins, e.g. a transfer only family runs copies next to rendering.
+            const VkQueueFlags extra_bits = queue_family_bits & ~desired_queue_family_bits & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT);
+            const int extra_bit_count = std::popcount(extra_bits);
+            if (extra_bit_count < picked_extra_bit_count) {
+                picked_queue_family_index = i;
+                picked_extra_bit_count = extra_bit_count;
+            }
+        }
+
+        return CommandQueueFamilyHandle(picked_queue_family_index + 1);
+    }
+
+    CommandQueueHandle RenderDeviceVulkan::command_queue_create(CommandQueueFamilyHandle command_queue_family) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::command_queue_create");
+        DODO_ASSERT(command_queue_family);
+        const uint32_t queue_family_index = command_queue_family.get_id() - 1;
+
+        std::vector<Queue>& queues = _queues.at(queue_family_index);
+        uint32_t picked_queue_index = UINT32_MAX;
+        uint32_t picked_use_count = UINT32_MAX;
+        for (uint32_t i = 0; i < queues.size(); i++) {
+            const Queue& queue = queues.at(i);
+            if (queue.use_count < picked_use_count) {
+                picked_queue_index = i;
+                picked_use_count = queue.use_count;
+            }
+        }
+
+        queues.at(picked_queue_index).use_count++;
+
+        CommandQueue cmd_queue = {};
+        cmd_queue.queue_family_index = queue_family_index;
+        cmd_queue.queue_index = picked_queue_index;
+        cmd_queue.timeline_semaphore = _vk_timeline_semaphore_create();
+        return _command_queues.create(std::move(cmd_queue));
+    }
+
+    VkSemaphore RenderDeviceVulkan::_vk_timeline_semaphore_create() const {
+        VkSemaphoreTypeCreateInfo type_create_info = {};
+        type_create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        type_create_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        type_create_info.initialValue = 0;
+        VkSemaphoreCreateInfo create_info = {};
+        create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        create_info.pNext = &type_create_info;
+        VkSemaphore vk_semaphore = VK_NULL_HANDLE;
+        DODO_ASSERT_VK_RESULT(vkCreateSemaphore(_device, &create_info, VK_NULL_HANDLE, &vk_semaphore));
+        DODO_METRIC_COUNTER_ADD("renderer.semaphores_created", 1);
+        return vk_semaphore;
+    }
+
+    void RenderDeviceVulkan::_image_semaphores_reclaim(CommandQueue* r_command_queue) const {
+        if (r_command_queue->image_semaphores_in_flight.empty()) {
+            return;
+        }
+
+        uint64_t completed_value = 0;
+        DODO_ASSERT_VK_RESULT(vkGetSemaphoreCounterValue(_device, r_command_queue->timeline_semaphore, &completed_value));
+        std::vector<std::pair<uint64_t, uint32_t>>& in_flight = r_command_queue->image_semaphores_in_flight;
+        size_t completed_count = 0;
+        while ((completed_count < in_flight.size()) && (in_flight.at(completed_count).first <= completed_value)) {
+            r_command_queue->free_image_semaphores.push_back(in_flight.at(completed_count).second);
+            completed_count++;
+        }
+
+        in_flight.erase(in_flight.begin(), in_flight.begin() + completed_count);
+    }
+
+    void RenderDeviceVulkan::command_queue_execute_and_present_batch(std::span<const SubmitSpecifications> submits) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::command_queue_execute_and_present_batch");
+        DODO_ASSERT(!submits.empty() && (submits.size() <= max_submit_batch_count));
+        if (submits.empty()) {
+            return;
+        }
+
+        const CommandQueueHandle command_queue = submits.front().command_queue;
+        DODO_ASSERT(command_queue);
+        CommandQueue* cmd_queue = _command_queues.get_or_null(command_queue);
+        if (!cmd_queue) {
+            return;
+        }
+
+        // Room for the swap chain and queue timeline semaphores on top of the caller's, nothing here allocates.
+        static constexpr size_t max_semaphore_count = max_submit_semaphore_count + 4;
+        struct SubmitGroup {
+            FixedVector<VkSemaphore, max_semaphore_count> vk_wait_semaphores = {};
+            FixedVector<uint64_t, max_semaphore_count> vk_wait_values = {};
+            FixedVector<VkPipelineStageFlags, max_semaphore_count> vk_wait_stages = {};
+            FixedVector<VkCommandBuffer, max_submit_command_buffer_count> vk_command_buffers = {};
+            FixedVector<VkSemaphore, max_semaphore_count> vk_signal_semaphores = {};
+            FixedVector<uint64_t, max_semaphore_count> vk_signal_values = {};
+            VkTimelineSemaphoreSubmitInfo timeline_submit_info = {};
+            Fence* fence = nullptr;
+            SwapChain* swap_chain = nullptr;
+            uint32_t acquire_semaphore_index = UINT32_MAX;
+        };
+
+        const size_t group_count = std::min(submits.size(), max_submit_batch_count);
+        // Groups are large, only the ones in use are constructed.
+        FixedVector<SubmitGroup, max_submit_batch_count> groups = {};
+        for (size_t i = 0; i < group_count; i++) {
+            const SubmitSpecifications& submit_specs = submits[i];
+            DODO_ASSERT(submit_specs.command_queue == command_queue);
+            DODO_ASSERT(submit_specs.command_buffers.size() <= max_submit_command_buffer_count);
+            DODO_ASSERT(submit_specs.wait_semaphores.size() <= max_submit_semaphore_count);
+            DODO_ASSERT(submit_specs.signal_semaphores.size() <= max_submit_semaphore_count);
+            SubmitGroup& group = groups.emplace_back();
+            group.fence = submit_specs.fence ? _fences.get_or_null(submit_specs.fence) : nullptr;
+            SwapChain* swap_chain = submit_specs.swap_chain ? _swap_chains.get_or_null(submit_specs.swap_chain) : nullptr;
+            group.swap_chain = (swap_chain && swap_chain->vk_swap_chain) ? swap_chain : nullptr;
+
+            for (const CommandBufferHandle command_buffer_handle : submit_specs.command_buffers) {
+                if (const CommandBuffer* command_buffer = _command_buffers.get_or_null(command_buffer_handle)) {
+                    group.vk_command_buffers.push_back(command_buffer->vk_command_buffer);
+                }
+            }
+
+            for (const SemaphoreHandle semaphore : submit_specs.wait_semaphores) {
+                if (const Semaphore* semaphore_info = _semaphores.get_or_null(semaphore)) {
+                    group.vk_wait_semaphores.push_back(semaphore_info->vk_semaphore);
+                    group.vk_wait_values.push_back(semaphore_info->value);
+                    group.vk_wait_stages.push_back(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+                }
+            }
+        }
+
+        // Acquires of swap chains no group presents are waited on by the first group that executes.
+        size_t first_executing_group_index = SIZE_MAX;
+        for (size_t i = 0; i < group_count; i++) {
+            if (!groups[i].vk_command_buffers.empty()) {
+                first_executing_group_index = i;
+                break;
+            }
+        }
+
+        FixedVector<VkSubmitInfo, max_submit_batch_count> vk_submit_infos = {};
+        FixedVector<VkSemaphore, max_submit_batch_count + max_semaphore_count> vk_present_wait_semaphores = {};
+        FixedVector<VkSwapchainKHR, max_submit_batch_count> vk_swap_chains = {};
+        FixedVector<uint32_t, max_submit_batch_count> vk_image_indices = {};
+        FixedVector<SwapChain*, max_submit_batch_count> present_swap_chains = {};
+        std::array<VkResult, max_submit_batch_count> present_results = {};
+        {
+            // One lock, one submit and one present for the whole batch.
+            std::unique_lock<std::mutex> lock(_submit_mutex);
+
+            // Each group waits only for the image of the swap chain it presents.
+            std::vector<uint32_t>& pending_image_semaphores = cmd_queue->pending_image_semaphores;
+            for (size_t i = 0; i < group_count; i++) {
+                SubmitGroup& group = groups[i];
+                if (!group.swap_chain || (group.swap_chain->acquire_semaphore_index == UINT32_MAX)) {
+                    continue;
+                }
+
+                const auto pending_it = std::ranges::find(pending_image_semaphores, group.swap_chain->acquire_semaphore_index);
+                if (pending_it != pending_image_semaphores.end()) {
+                    group.acquire_semaphore_index = *pending_it;
+                    pending_image_semaphores.erase(pending_it);
+                }
+
+                group.swap_chain->acquire_semaphore_index = UINT32_MAX;
+            }
+
+            FixedVector<uint32_t, max_submit_batch_count + max_semaphore_count> present_image_semaphores = {};
+            for (size_t i = 0; i < group_count; i++) {
+                SubmitGroup& group = groups[i];
+                const SubmitSpecifications& submit_specs = submits[i];
+                if (group.swap_chain) {
+                    DODO_ASSERT(std::ranges::find(present_swap_chains, group.swap_chain) == present_swap_chains.end());
+                    present_swap_chains.push_back(group.swap_chain);
+                    vk_swap_chains.push_back(group.swap_chain->vk_swap_chain);
+                    vk_image_indices.push_back(group.swap_chain->image_index);
+                }
+
+                if (group.vk_command_buffers.empty()) {
+                    // Nothing to execute, the present consumes the acquire semaphore directly.
+                    if (group.acquire_semaphore_index != UINT32_MAX) {
+                        present_image_semaphores.push_back(group.acquire_semaphore_index);
+                        vk_present_wait_semaphores.push_back(cmd_queue->image_semaphores.at(group.acquire_semaphore_index));
+                    }
+
+                    if (group.fence) {
+                        group.fence->command_queue = command_queue;
+                        group.fence->value = cmd_queue->timeline_value;
+                    }
+
+                    continue;
+                }
+
+                // Binary semaphores ignore their value.
+                if (group.acquire_semaphore_index != UINT32_MAX) {
+                    group.vk_wait_semaphores.push_back(cmd_queue->image_semaphores.at(group.acquire_semaphore_index));
+                    group.vk_wait_values.push_back(0);
+                    group.vk_wait_stages.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+                }
+
+                if (i == first_executing_group_index) {
+                    for (const uint32_t semaphore_index : pending_image_semaphores) {
+                        group.vk_wait_semaphores.push_back(cmd_queue->image_semaphores.at(semaphore_index));
+                        group.vk_wait_values.push_back(0);
+                        group.vk_wait_stages.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+                    }
+                }
+
+                for (const SemaphoreHandle semaphore : submit_specs.signal_semaphores) {
+                    if (Semaphore* semaphore_info = _semaphores.get_or_null(semaphore)) {
+                        group.vk_signal_semaphores.push_back(semaphore_info->vk_semaphore);
+                        group.vk_signal_values.push_back(++semaphore_info->value);
+                    }
+                }
+
+                if (group.swap_chain) {
+                    const VkSemaphore present_semaphore = group.swap_chain->present_semaphores.at(group.swap_chain->frame_index);
+                    group.vk_signal_semaphores.push_back(present_semaphore);
+                    group.vk_signal_values.push_back(0);
+                    vk_present_wait_semaphores.push_back(present_semaphore);
+                }
+
+                cmd_queue->timeline_value++;
+                group.vk_signal_semaphores.push_back(cmd_queue->timeline_semaphore);
+                group.vk_signal_values.push_back(cmd_queue->timeline_value);
+                // An acquire semaphore can be reused once the submission waiting on it completes.
+                if (group.acquire_semaphore_index != UINT32_MAX) {
+                    cmd_queue->image_semaphores_in_flight.push_back({ cmd_queue->timeline_value, group.acquire_semaphore_index });
+                }
+
+                if (i == first_executing_group_index) {
+                    for (const uint32_t semaphore_index : pending_image_semaphores) {
+                        cmd_queue->image_semaphores_in_flight.push_back({ cmd_queue->timeline_value, semaphore_index });
+                    }
+
+                    pending_image_semaphores.clear();
+                }
+
+                if (group.fence) {
+                    group.fence->command_queue = command_queue;
+                    group.fence->value = cmd_queue->timeline_value;
+                }
+
+                group.timeline_submit_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+                group.timeline_submit_info.waitSemaphoreValueCount = static_cast<uint32_t>(group.vk_wait_values.size());
+                group.timeline_submit_info.pWaitSemaphoreValues = group.vk_wait_values.data();
+                group.timeline_submit_info.signalSemaphoreValueCount = static_cast<uint32_t>(group.vk_signal_values.size());
+                group.timeline_submit_info.pSignalSemaphoreValues = group.vk_signal_values.data();
+                VkSubmitInfo submit_info = {};
+                submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+                submit_info.pNext = &group.timeline_submit_info;
+                submit_info.waitSemaphoreCount = static_cast<uint32_t>(group.vk_wait_semaphores.size());
+                submit_info.pWaitSemaphores = group.vk_wait_semaphores.data();
+                submit_info.pWaitDstStageMask = group.vk_wait_stages.data();
+                submit_info.commandBufferCount = static_cast<uint32_t>(group.vk_command_buffers.size());
+                submit_info.pCommandBuffers = group.vk_command_buffers.data();
+                submit_info.signalSemaphoreCount = static_cast<uint32_t>(group.vk_signal_semaphores.size());
+                submit_info.pSignalSemaphores = group.vk_signal_semaphores.data();
+                vk_submit_infos.push_back(submit_info);
+            }
+
+            if (!vk_submit_infos.empty()) {
+                VkQueue vk_queue = _queues.at(cmd_queue->queue_family_index).at(cmd_queue->queue_index).queue;
+                DODO_ASSERT_VK_RESULT(vkQueueSubmit(vk_queue, static_cast<uint32_t>(vk_submit_infos.size()), vk_submit_infos.data(), VK_NULL_HANDLE));
+            }
+
+            if ((first_executing_group_index == SIZE_MAX) && !vk_swap_chains.empty()) {
+                // Nothing executes, the present consumes the unclaimed acquire semaphores as well.
+                for (const uint32_t semaphore_index : pending_image_semaphores) {
+                    present_image_semaphores.push_back(semaphore_index);
+                    vk_present_wait_semaphores.push_back(cmd_queue->image_semaphores.at(semaphore_index));
+                }
+
+                pending_image_semaphores.clear();
+            }
+
+            // Presents do not signal the timeline, the semaphores they consumed are reused after the next submission.
+            for (const uint32_t semaphore_index : present_image_semaphores) {
+                cmd_queue->image_semaphores_in_flight.push_back({ cmd_queue->timeline_value + 1, semaphore_index });
+            }
+
+            if (!vk_swap_chains.empty()) {
+                VkQueue vk_queue = _queues.at(cmd_queue->queue_family_index).at(cmd_queue->queue_index).queue;
+                VkPresentInfoKHR present_info = {};
+                present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+                present_info.waitSemaphoreCount = static_cast<uint32_t>(vk_present_wait_semaphores.size());
+                present_info.pWaitSemaphores = vk_present_wait_semaphores.data();
+                present_info.swapchainCount = static_cast<uint32_t>(vk_swap_chains.size());
+                present_info.pSwapchains = vk_swap_chains.data();
+                present_info.pImageIndices = vk_image_indices.data();
+                present_info.pResults = present_results.data();
+                _functions.QueuePresentKHR(vk_queue, &present_info);
+            }
+        }
+
+        for (size_t i = 0; i < present_swap_chains.size(); i++) {
+            SwapChain* swap_chain = present_swap_chains[i];
+            const VkResult result = present_results.at(i);
+            swap_chain->frame_index = (swap_chain->frame_index + 1) % std::max(swap_chain->framebuffer_count, 1u);
+            if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+                _backend->surface_set_needs_resize(swap_chain->surface, true);
+                continue;
+            }
+
+            DODO_ASSERT((result == VK_SUCCESS) || (result == VK_SUBOPTIMAL_KHR));
+        }
+    }
+
+    void RenderDeviceVulkan::metrics_update() const {
+        DODO_METRIC_GAUGE_SET("renderer.command_queues", static_cast<double>(_command_queues.count_get()));
+        DODO_METRIC_GAUGE_SET("renderer.command_pools", static_cast<double>(_command_pools.count_get()));
+        DODO_METRIC_GAUGE_SET("renderer.command_buffers", static_cast<double>(_command_buffers.count_get()));
+        DODO_METRIC_GAUGE_SET("renderer.fences", static_cast<double>(_fences.count_get()));
+        DODO_METRIC_GAUGE_SET("renderer.semaphores", static_cast<double>(_semaphores.count_get()));
+        DODO_METRIC_GAUGE_SET("renderer.query_pools", static_cast<double>(_query_pools.count_get()));
+        DODO_METRIC_GAUGE_SET("renderer.swap_chains", static_cast<double>(_swap_chains.count_get()));
+        DODO_METRIC_GAUGE_SET("renderer.pipelines", static_cast<double>(_pipelines.count_get()));
+        DODO_METRIC_GAUGE_SET("renderer.buffers", static_cast<double>(_buffers.count_get()));
+        DODO_METRIC_GAUGE_SET("renderer.textures", static_cast<double>(_textures.count_get()));
+        DODO_METRIC_GAUGE_SET("renderer.texture_heaps", static_cast<double>(_texture_heaps.count_get()));
+        _memory_allocator.update_metrics();
+    }
+
+    void RenderDeviceVulkan::command_queue_destroy(CommandQueueHandle command_queue) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::command_queue_destroy");
+        DODO_ASSERT(command_queue);
+        if (CommandQueue* cmd_queue = _command_queues.get_or_null(command_queue)) {
+            for (VkSemaphore semaphore : cmd_queue->image_semaphores) {
+                vkDestroySemaphore(_device, semaphore, VK_NULL_HANDLE);
+            }
+
+            vkDestroySemaphore(_device, cmd_queue->timeline_semaphore, VK_NULL_HANDLE);
+
+            _queues.at(cmd_queue->queue_family_index).at(cmd_queue->queue_index).use_count--;
+            _command_queues.destroy(command_queue);
+        }
+    }
+
+    CommandPoolHandle RenderDeviceVulkan::command_pool_create(CommandQueueFamilyHandle command_queue_family) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::command_pool_create");
+        DODO_ASSERT(!command_queue_family.is_null());
+        VkCommandPoolCreateInfo create_info = {};
+        create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        create_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        create_info.queueFamilyIndex = command_queue_family.get_id() - 1;
+        VkCommandPool vk_command_pool = VK_NULL_HANDLE;
+        DODO_ASSERT_VK_RESULT(vkCreateCommandPool(_device, &create_info, VK_NULL_HANDLE, &vk_command_pool));
+        return _command_pools.create(std::move(vk_command_pool));
+    }
+
+    void RenderDeviceVulkan::command_pool_destroy(CommandPoolHandle command_pool) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::command_pool_destroy");
+        DODO_ASSERT(!command_pool.is_null());
+        if (VkCommandPool* vk_command_pool = _command_pools.get_or_null(command_pool)) {
+            vkDestroyCommandPool(_device, *vk_command_pool, VK_NULL_HANDLE);
+            _command_pools.destroy(command_pool);
+        }
+    }
+
+    void RenderDeviceVulkan::command_pool_reset(CommandPoolHandle command_pool) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::command_pool_reset");
+        DODO_ASSERT(!command_pool.is_null());
+        if (VkCommandPool* vk_command_pool = _command_pools.get_or_null(command_pool)) {
+            DODO_ASSERT_VK_RESULT(vkResetCommandPool(_device, *vk_command_pool, 0));
+        }
+    }
+
+    CommandBufferHandle RenderDeviceVulkan::command_buffer_create(CommandPoolHandle command_pool, CommandBufferType command_buffer_type) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::command_buffer_create");
+        DODO_ASSERT(!command_pool.is_null());
+        VkCommandPool* vk_command_pool = _command_pools.get_or_null(command_pool);
+        if (!vk_command_pool) {
+            return CommandBufferHandle();
+        }
+
+        VkCommandBufferLevel command_buffer_level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        if (command_buffer_type == CommandBufferType::secondary) {
+            command_buffer_level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        }
+
+        VkCommandBufferAllocateInfo alloc_info = {};
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.commandPool = *vk_command_pool;
+        alloc_info.level = command_buffer_level;
+        alloc_info.commandBufferCount = 1;
+        VkCommandBuffer vk_command_buffer = VK_NULL_HANDLE;
+        DODO_ASSERT_VK_RESULT(vkAllocateCommandBuffers(_device, &alloc_info, &vk_command_buffer));
+
+        CommandBuffer command_buffer_info = {};
+        command_buffer_info.command_buffer_type = command_buffer_type;
+        command_buffer_info.vk_command_pool = *vk_command_pool;
+        command_buffer_info.vk_command_buffer = vk_command_buffer;
+        return _command_buffers.create(std::move(command_buffer_info));
+    }
+
+    void RenderDeviceVulkan::command_buffer_begin(CommandBufferHandle p_command_buffer) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::command_buffer_begin");
+        DODO_ASSERT(!p_command_buffer.is_null());
+        if (CommandBuffer* command_buffer = _command_buffers.get_or_null(p_command_buffer)) {
+            // Secondaries inherit nothing, they are recorded outside of render passes.
+            VkCommandBufferInheritanceInfo inheritance_info = {};
+            inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+            VkCommandBufferBeginInfo begin_info = {};
+            begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            if (command_buffer->command_buffer_type == CommandBufferType::secondary) {
+                begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+                begin_info.pInheritanceInfo = &inheritance_info;
+            }
+
+            DODO_ASSERT_VK_RESULT(vkBeginCommandBuffer(command_buffer->vk_command_buffer, &begin_info));
+            command_buffer->bindless_bind_points = 0;
+        }
+    }
+
+    void RenderDeviceVulkan::command_buffer_end(CommandBufferHandle p_command_buffer) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::command_buffer_end");
+        DODO_ASSERT(!p_command_buffer.is_null());
+        if (CommandBuffer* command_buffer = _command_buffers.get_or_null(p_command_buffer)) {
+            DODO_ASSERT_VK_RESULT(vkEndCommandBuffer(command_buffer->vk_command_buffer));
+        }
+    }
+
+    void RenderDeviceVulkan::command_buffer_execute_commands(CommandBufferHandle p_command_buffer, std::span<const CommandBufferHandle> secondary_command_buffers) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::command_buffer_execute_commands");
+        DODO_ASSERT(!p_command_buffer.is_null());
+        CommandBuffer* command_buffer = _command_buffers.get_or_null(p_command_buffer);
+        if (!command_buffer) {
+            return;
+        }
+
+        // Executed in chunks, so no list of every secondary has to be allocated.
+        FixedVector<VkCommandBuffer, 32> vk_command_buffers = {};
+        for (const CommandBufferHandle secondary_command_buffer : secondary_command_buffers) {
+            if (const CommandBuffer* secondary = _command_buffers.get_or_null(secondary_command_buffer)) {
+                DODO_ASSERT(secondary->command_buffer_type == CommandBufferType::secondary);
+                vk_command_buffers.push_back(secondary->vk_command_buffer);
+            }
+
+            if (vk_command_buffers.full()) {
+                vkCmdExecuteCommands(command_buffer->vk_command_buffer, static_cast<uint32_t>(vk_command_buffers.size()), vk_command_buffers.data());
+                vk_command_buffers.clear();
+            }
+        }
+
+        if (!vk_command_buffers.empty()) {
+            vkCmdExecuteCommands(command_buffer->vk_command_buffer, static_cast<uint32_t>(vk_command_buffers.size()), vk_command_buffers.data());
+        }
+    }
+
+    void RenderDeviceVulkan::command_buffer_destroy(CommandBufferHandle p_command_buffer) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::command_buffer_destroy");
+        DODO_ASSERT(!p_command_buffer.is_null());
+        if (CommandBuffer* command_buffer = _command_buffers.get_or_null(p_command_buffer)) {
+            vkFreeCommandBuffers(_device, command_buffer->vk_command_pool, 1, &command_buffer->vk_command_buffer);
+            _command_buffers.destroy(p_command_buffer);
+        }
+    }
+
+    FenceHandle RenderDeviceVulkan::fence_create() {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::fence_create");
+        return _fences.create(Fence());
+    }
+
+    void RenderDeviceVulkan::fence_wait(FenceHandle p_fence) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::fence_wait");
+        DODO_ASSERT(!p_fence.is_null());
+        const Fence* fence = _fences.get_or_null(p_fence);
+        const CommandQueue* cmd_queue = fence ? _command_queues.get_or_null(fence->command_queue) : nullptr;
+        if (!cmd_queue || (fence->value == 0)) {
+            return;
+        }
+
+        VkSemaphoreWaitInfo wait_info = {};
+        wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        wait_info.semaphoreCount = 1;
+        wait_info.pSemaphores = &cmd_queue->timeline_semaphore;
+        wait_info.pValues = &fence->value;
+
+        static const auto default_timeout = std::numeric_limits<uint64_t>::max();
+        const uint64_t wait_begin = Timer::now();
+        DODO_ASSERT_VK_RESULT(vkWaitSemaphores(_device, &wait_info, default_timeout));
+        DODO_METRIC_HISTOGRAM_RECORD("renderer.fence_wait_us", Timer::ticks_to_nanoseconds(Timer::now() - wait_begin) / 1000);
+    }
+
+    bool RenderDeviceVulkan::fence_is_signaled(FenceHandle p_fence) {
+        DODO_ASSERT(!p_fence.is_null());
+        const Fence* fence = _fences.get_or_null(p_fence);
+        const CommandQueue* cmd_queue = fence ? _command_queues.get_or_null(fence->command_queue) : nullptr;
+        if (!cmd_queue || (fence->value == 0)) {
+            return true;
+        }
+
+        uint64_t completed_value = 0;
+        DODO_ASSERT_VK_RESULT(vkGetSemaphoreCounterValue(_device, cmd_queue->timeline_semaphore, &completed_value));
+        return completed_value >= fence->value;
+    }
+
+    void RenderDeviceVulkan::fence_destroy(FenceHandle fence) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::fence_destroy");
+        DODO_ASSERT(!fence.is_null());
+        if (_fences.get_or_null(fence)) {
+            _fences.destroy(fence);
+        }
+    }
+
+    SemaphoreHandle RenderDeviceVulkan::semaphore_create() {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::semaphore_create");
+        Semaphore semaphore = {};
+        semaphore.vk_semaphore = _vk_timeline_semaphore_create();
+        return _semaphores.create(std::move(semaphore));
+    }
+
+    void RenderDeviceVulkan::semaphore_destroy(SemaphoreHandle semaphore) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::semaphore_destroy");
+        DODO_ASSERT(!semaphore.is_null());
+        if (Semaphore* semaphore_info = _semaphores.get_or_null(semaphore)) {
+            vkDestroySemaphore(_device, semaphore_info->vk_semaphore, VK_NULL_HANDLE);
+            _semaphores.destroy(semaphore);
+        }
+    }
+
+    QueryPoolHandle RenderDeviceVulkan::timestamp_query_pool_create(uint32_t query_count) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::timestamp_query_pool_create");
+        if (_physical_device_properties.limits.timestampComputeAndGraphics == VK_FALSE) {
+            DODO_LOG_WARNING_TAG("Renderer", "Device does not support timestamps on all graphics and compute queues!");
+            return QueryPoolHandle();
+        }
+
+        VkQueryPoolCreateInfo create_info = {};
+        create_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        create_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        create_info.queryCount = query_count;
+        VkQueryPool vk_query_pool = VK_NULL_HANDLE;
+        DODO_ASSERT_VK_RESULT(vkCreateQueryPool(_device, &create_info, VK_NULL_HANDLE, &vk_query_pool));
+
+        if (!_timestamp_calibration.is_valid) {
+            _calibrate_timestamps();
+        }
+
+        QueryPool query_pool = {};
+        query_pool.vk_query_pool = vk_query_pool;
+        query_pool.query_count = query_count;
+        return _query_pools.create(std::move(query_pool));
+    }
+
+    void RenderDeviceVulkan::timestamp_query_pool_reset(CommandBufferHandle p_command_buffer, QueryPoolHandle p_query_pool) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::timestamp_query_pool_reset");
+        DODO_ASSERT(!p_command_buffer.is_null());
+        DODO_ASSERT(!p_query_pool.is_null());
+        CommandBuffer* command_buffer = _command_buffers.get_or_null(p_command_buffer);
+        QueryPool* query_pool = _query_pools.get_or_null(p_query_pool);
+        if (command_buffer && query_pool) {
+            vkCmdResetQueryPool(command_buffer->vk_command_buffer, query_pool->vk_query_pool, 0, query_pool->query_count);
+        }
+    }
+
+    void RenderDeviceVulkan::command_buffer_write_timestamp(CommandBufferHandle p_command_buffer, QueryPoolHandle p_query_pool, uint32_t query_index) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::command_buffer_write_timestamp");
+        DODO_ASSERT(!p_command_buffer.is_null());
+        DODO_ASSERT(!p_query_pool.is_null());
+        CommandBuffer* command_buffer = _command_buffers.get_or_null(p_command_buffer);
+        QueryPool* query_pool = _query_pools.get_or_null(p_query_pool);
+        if (command_buffer && query_pool) {
+            DODO_ASSERT(query_index < query_pool->query_count);
+            vkCmdWriteTimestamp(command_buffer->vk_command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, query_pool->vk_query_pool, query_index);
+        }
+    }
+
+    bool RenderDeviceVulkan::timestamp_query_pool_get_results(QueryPoolHandle p_query_pool, uint32_t query_count, uint64_t* r_timestamps) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::timestamp_query_pool_get_results");
+        DODO_ASSERT(!p_query_pool.is_null());
+        QueryPool* query_pool = _query_pools.get_or_null(p_query_pool);
+        if (!query_pool || (query_count == 0)) {
+            return false;
+        }
+
+        DODO_ASSERT(query_count <= query_pool->query_count);
+        _query_results.resize(query_count);
+        // No VK_QUERY_RESULT_WAIT_BIT, the results are read once the frame's fence has signaled.
+        const VkResult result = vkGetQueryPoolResults(_device, query_pool->vk_query_pool, 0, query_count, query_count * sizeof(uint64_t), _query_results.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+        if (result != VK_SUCCESS) {
+            return false;
+        }
+
+        // Keep the CPU and GPU clocks from drifting apart over long sessions.
+        static constexpr uint64_t recalibration_interval = 1000000000;
+        if (Timer::ticks_to_nanoseconds(Timer::now() - _timestamp_calibration.calibrated_at) > recalibration_interval) {
+            _calibrate_timestamps();
+        }
+
+        for (uint32_t i = 0; i < query_count; i++) {
+            r_timestamps[i] = _convert_gpu_timestamp(_query_results.at(i));
+        }
+
+        return true;
+    }
+
+    void RenderDeviceVulkan::timestamp_query_pool_destroy(QueryPoolHandle p_query_pool) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::timestamp_query_pool_destroy");
+        DODO_ASSERT(!p_query_pool.is_null());
+        if (QueryPool* query_pool = _query_pools.get_or_null(p_query_pool)) {
+            vkDestroyQueryPool(_device, query_pool->vk_query_pool, VK_NULL_HANDLE);
+            _query_pools.destroy(p_query_pool);
+        }
+    }
+
+    void RenderDeviceVulkan::_calibrate_timestamps() {
+        if (_functions.GetCalibratedTimestampsEXT && _timestamp_calibration.has_host_time_domain) {
+            // Sample both domains in one call, the driver reports how far apart the
+            // two samples may be. Keep the tightest of a few attempts.
+            static constexpr uint32_t attempt_count = 4;
+            std::array<VkCalibratedTimestampInfoEXT, 2> timestamp_infos = {};
+            timestamp_infos.at(0).sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+            timestamp_infos.at(0).timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+            timestamp_infos.at(1).sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+            timestamp_infos.at(1).timeDomain = Utils::host_time_domain;
+            std::array<uint64_t, 2> best_timestamps = {};
+            uint64_t best_deviation = UINT64_MAX;
+            for (uint32_t i = 0; i < attempt_count; i++) {
+                std::array<uint64_t, 2> timestamps = {};
+                uint64_t max_deviation = 0;
+                if ((_functions.GetCalibratedTimestampsEXT(_device, static_cast<uint32_t>(timestamp_infos.size()), timestamp_infos.data(), timestamps.data(), &max_deviation) == VK_SUCCESS) && (max_deviation < best_deviation)) {
+                    best_timestamps = timestamps;
+                    best_deviation = max_deviation;
+                }
+            }
+
+            if (best_deviation != UINT64_MAX) {
+                _timestamp_calibration.is_valid = true;
+                _timestamp_calibration.gpu_timestamp = best_timestamps.at(0) & _timestamp_calibration.valid_mask;
+                _timestamp_calibration.cpu_ticks = Timer::host_to_ticks(best_timestamps.at(1));
+                _timestamp_calibration.calibrated_at = Timer::now();
+                DODO_METRIC_GAUGE_SET("renderer.timestamp_calibration_deviation_ns", static_cast<double>(best_deviation));
+                return;
+            }
+        }
+
+        if (_timestamp_calibration.is_valid) {
+            // The fallback below stalls a queue, only run it once.
+            _timestamp_calibration.calibrated_at = Timer::now();
+            return;
+        }
+
+        // Without VK_EXT_calibrated_timestamps, write a single timestamp on an idle queue
+        // and pair it with the middle of the CPU interval around the submission.
+        uint32_t queue_family_index = UINT32_MAX;
+        for (uint32_t i = 0; i < _queues.size(); i++) {
+            const bool supports_timestamps = (_queue_families.at(i).timestampValidBits > 0) && ((_queue_families.at(i).queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) != 0);
+            if (!_queues.at(i).empty() && supports_timestamps) {
+                queue_family_index = i;
+                break;
+            }
+        }
+
+        if (queue_family_index == UINT32_MAX) {
+            return;
+        }
+
+        VkCommandPoolCreateInfo command_pool_create_info = {};
+        command_pool_create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        command_pool_create_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        command_pool_create_info.queueFamilyIndex = queue_family_index;
+        VkCommandPool vk_command_pool = VK_NULL_HANDLE;
+        DODO_ASSERT_VK_RESULT(vkCreateCommandPool(_device, &command_pool_create_info, VK_NULL_HANDLE, &vk_command_pool));
+
+        VkCommandBufferAllocateInfo alloc_info = {};
+        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.commandPool = vk_command_pool;
+        alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandBufferCount = 1;
+        VkCommandBuffer vk_command_buffer = VK_NULL_HANDLE;
+        DODO_ASSERT_VK_RESULT(vkAllocateCommandBuffers(_device, &alloc_info, &vk_command_buffer));
+
+        VkQueryPoolCreateInfo query_pool_create_info = {};
+        query_pool_create_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        query_pool_create_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        query_pool_create_info.queryCount = 1;
+        VkQueryPool vk_query_pool = VK_NULL_HANDLE;
+        DODO_ASSERT_VK_RESULT(vkCreateQueryPool(_device, &query_pool_create_info, VK_NULL_HANDLE, &vk_query_pool));
+
+        VkCommandBufferBeginInfo begin_info = {};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        DODO_ASSERT_VK_RESULT(vkBeginCommandBuffer(vk_command_buffer, &begin_info));
+        vkCmdResetQueryPool(vk_command_buffer, vk_query_pool, 0, 1);
+        vkCmdWriteTimestamp(vk_command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vk_query_pool, 0);
+        DODO_ASSERT_VK_RESULT(vkEndCommandBuffer(vk_command_buffer));
+
+        VkSubmitInfo submit_info = {};
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &vk_command_buffer;
+        VkQueue vk_queue = _queues.at(queue_family_index).front().queue;
+        uint64_t cpu_ticks_before = 0;
+        uint64_t cpu_ticks_after = 0;
+        {
+            // The queue is shared with the render thread.
+            std::unique_lock<std::mutex> lock(_submit_mutex);
+            cpu_ticks_before = Timer::now();
+            DODO_ASSERT_VK_RESULT(vkQueueSubmit(vk_queue, 1, &submit_info, VK_NULL_HANDLE));
+            DODO_ASSERT_VK_RESULT(vkQueueWaitIdle(vk_queue));
+            cpu_ticks_after = Timer::now();
+        }
+
+        uint64_t gpu_timestamp = 0;
+        if (vkGetQueryPoolResults(_device, vk_query_pool, 0, 1, sizeof(uint64_t), &gpu_timestamp, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) == VK_SUCCESS) {
+            _timestamp_calibration.is_valid = true;
+            _timestamp_calibration.gpu_timestamp = gpu_timestamp & _timestamp_calibration.valid_mask;
+            _timestamp_calibration.cpu_ticks = cpu_ticks_before + (cpu_ticks_after - cpu_ticks_before) / 2;
+            _timestamp_calibration.calibrated_at = cpu_ticks_after;
+        }
+
+        vkDestroyQueryPool(_device, vk_query_pool, VK_NULL_HANDLE);
+        vkDestroyCommandPool(_device, vk_command_pool, VK_NULL_HANDLE);
+    }
+
+    uint64_t RenderDeviceVulkan::_convert_gpu_timestamp(uint64_t gpu_timestamp) const {
+        // Queries can land on either side of the calibration point. Differences are
+        // taken modulo the valid bits, so a counter that wrapped since the
+        // calibration still lands on the right side.
+        const double period = static_cast<double>(_physical_device_properties.limits.timestampPeriod);
+        const uint64_t mask = _timestamp_calibration.valid_mask;
+        const uint64_t forward = ((gpu_timestamp & mask) - _timestamp_calibration.gpu_timestamp) & mask;
+        if (forward <= (mask >> 1)) {
+            const auto nanoseconds = static_cast<uint64_t>(static_cast<double>(forward) * period);
+            return _timestamp_calibration.cpu_ticks + Timer::nanoseconds_to_ticks(nanoseconds);
+        }
+
+        const uint64_t backward = (mask - forward) + 1;
+        const auto nanoseconds = static_cast<uint64_t>(static_cast<double>(backward) * period);
+        return _timestamp_calibration.cpu_ticks - std::min(_timestamp_calibration.cpu_ticks, Timer::nanoseconds_to_ticks(nanoseconds));
+    }
+
+    BufferHandle RenderDeviceVulkan::buffer_create(const BufferSpecifications& buffer_specs) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::buffer_create");
+        DODO_ASSERT(buffer_specs.size > 0);
+        Buffer buffer = {};
+        buffer.vk_usage = Utils::convert_to_buffer_usage(buffer_specs.usage);
+        buffer.size = buffer_specs.size;
+        buffer.vk_buffer = _vk_buffer_create(buffer.size, buffer.vk_usage);
+        if (!buffer.vk_buffer) {
+            return {};
+        }
+
+        VkMemoryRequirements memory_requirements = {};
+        vkGetBufferMemoryRequirements(_device, buffer.vk_buffer, &memory_requirements);
+        const VkBuffer vk_buffer = buffer.vk_buffer;
+        // The handle is the user data of the allocation, defragmentation finds the buffer through it.
+        const BufferHandle buffer_handle = _buffers.create(std::move(buffer));
+        const MemoryAllocationHandle allocation = _memory_allocator.allocate(memory_requirements, buffer_specs.memory_usage, MemoryAllocatorVulkan::ResourceKind::buffer, false, buffer_handle.get_id());
+        if (!allocation) {
+            vkDestroyBuffer(_device, vk_buffer, VK_NULL_HANDLE);
+            _buffers.destroy(buffer_handle);
+            return {};
+        }
+
+        const MemoryAllocatorVulkan::AllocationInfo allocation_info = _memory_allocator.allocation_get_info(allocation);
+        DODO_ASSERT_VK_RESULT(vkBindBufferMemory(_device, vk_buffer, allocation_info.memory, allocation_info.offset));
+        Buffer* buf = _buffers.get_or_null(buffer_handle);
+        buf->allocation = allocation;
+        _bindless_buffer_write(_buffers.index_get(buffer_handle), *buf);
+        return buffer_handle;
+    }
+
+    void* RenderDeviceVulkan::buffer_get_mapped_data(BufferHandle buffer) {
+        DODO_ASSERT(buffer);
+        const Buffer* buf = _buffers.get_or_null(buffer);
+        return buf ? _memory_allocator.allocation_get_info(buf->allocation).mapped_data : nullptr;
+    }
+
+    uint32_t RenderDeviceVulkan::buffer_get_bindless_index(BufferHandle buffer) {
+        const Buffer* buf = _buffers.get_or_null(buffer);
+        const uint32_t index = _buffers.index_get(buffer);
+        const bool is_bound = buf && ((buf->vk_usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT) != 0) && (index < _bindless.buffer_capacity);
+        return is_bound ? index : invalid_bindless_index;
+    }
+
+    void RenderDeviceVulkan::buffer_destroy(BufferHandle buffer) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::buffer_destroy");
+        DODO_ASSERT(buffer);
+        if (Buffer* buf = _buffers.get_or_null(buffer)) {
+            vkDestroyBuffer(_device, buf->vk_buffer, VK_NULL_HANDLE);
+            _memory_allocator.free(buf->allocation);
+            _buffers.destroy(buffer);
+        }
+    }
+
+    VkBuffer RenderDeviceVulkan::_vk_buffer_create(uint64_t size, VkBufferUsageFlags vk_usage) const {
+        VkBufferCreateInfo create_info = {};
+        create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        create_info.size = size;
+        create_info.usage = vk_usage;
+        create_info.sharingMode = (_resource_queue_family_indices.size() > 1) ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+        create_info.queueFamilyIndexCount = static_cast<uint32_t>(_resource_queue_family_indices.size());
+        create_info.pQueueFamilyIndices = _resource_queue_family_indices.data();
+        VkBuffer vk_buffer = VK_NULL_HANDLE;
+        if (vkCreateBuffer(_device, &create_info, VK_NULL_HANDLE, &vk_buffer) != VK_SUCCESS) {
+            DODO_LOG_ERROR_TAG("Renderer", "Failed to create a buffer of {0} bytes!", size);
+            return VK_NULL_HANDLE;
+        }
+
+        return vk_buffer;
+    }
+
+    bool RenderDeviceVulkan::_vk_image_create(const TextureSpecifications& texture_specs, Texture& r_texture) const {
+        r_texture.format = Utils::convert_to_format(texture_specs.format);
+        r_texture.aspect = Utils::is_depth_format(texture_specs.format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+        r_texture.usage = texture_specs.usage;
+        r_texture.extent = { texture_specs.width, texture_specs.height, texture_specs.depth };
+        r_texture.mip_count = texture_specs.mip_count;
+        r_texture.layer_count = texture_specs.layer_count;
+        DODO_ASSERT(r_texture.format != VK_FORMAT_UNDEFINED);
+
+        VkImageCreateInfo image_create_info = {};
+        image_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        image_create_info.imageType = (texture_specs.depth > 1) ? VK_IMAGE_TYPE_3D : VK_IMAGE_TYPE_2D;
+        image_create_info.format = r_texture.format;
+        image_create_info.extent = r_texture.extent;
+        image_create_info.mipLevels = r_texture.mip_count;
+        image_create_info.arrayLayers = r_texture.layer_count;
+        image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+        image_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+        image_create_info.usage = Utils::convert_to_image_usage(texture_specs.usage);
+        // Concurrent sharing saves the ownership transfers between the copy and the draw queue.
+        image_create_info.sharingMode = (_resource_queue_family_indices.size() > 1) ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+        image_create_info.queueFamilyIndexCount = static_cast<uint32_t>(_resource_queue_family_indices.size());
+        image_create_info.pQueueFamilyIndices = _resource_queue_family_indices.data();
+        image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        if (vkCreateImage(_device, &image_create_info, VK_NULL_HANDLE, &r_texture.vk_image) != VK_SUCCESS) {
+            DODO_LOG_ERROR_TAG("Renderer", "Failed to create a {0}x{1} texture!", texture_specs.width, texture_specs.height);
+            return false;
+        }
+
+        return true;
+    }
+
+    void RenderDeviceVulkan::_vk_image_view_create(const TextureSpecifications& texture_specs, Texture& r_texture) const {
+        VkImageViewCreateInfo view_create_info = {};
+        view_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        view_create_info.image = r_texture.vk_image;
+        view_create_info.viewType = (texture_specs.depth > 1) ? VK_IMAGE_VIEW_TYPE_3D : ((r_texture.layer_count > 1) ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D);
+        view_create_info.format = r_texture.format;
+        view_create_info.subresourceRange.aspectMask = r_texture.aspect;
+        view_create_info.subresourceRange.levelCount = r_texture.mip_count;
+        view_create_info.subresourceRange.layerCount = r_texture.layer_count;
+        DODO_ASSERT_VK_RESULT(vkCreateImageView(_device, &view_create_info, VK_NULL_HANDLE, &r_texture.vk_image_view));
+    }
+
+    TextureHandle RenderDeviceVulkan::texture_create(const TextureSpecifications& texture_specs) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::texture_create");
+        Texture texture = {};
+        if (!_vk_image_create(texture_specs, texture)) {
+            return {};
+        }
+
+        // Render targets are resized and recreated as a whole, drivers prefer them in their own allocation.
+        const bool is_render_target = (texture_specs.usage & (texture_usage_color_attachment | texture_usage_depth_stencil_attachment)) != 0;
+        VkMemoryRequirements memory_requirements = {};
+        vkGetImageMemoryRequirements(_device, texture.vk_image, &memory_requirements);
+        texture.allocation = _memory_allocator.allocate(memory_requirements, MemoryUsage::gpu_only, MemoryAllocatorVulkan::ResourceKind::image, is_render_target);
+        if (!texture.allocation) {
+            vkDestroyImage(_device, texture.vk_image, VK_NULL_HANDLE);
+            return {};
+        }
+
+        const MemoryAllocatorVulkan::AllocationInfo allocation_info = _memory_allocator.allocation_get_info(texture.allocation);
+        DODO_ASSERT_VK_RESULT(vkBindImageMemory(_device, texture.vk_image, allocation_info.memory, allocation_info.offset));
+        _vk_image_view_create(texture_specs, texture);
+        const TextureHandle texture_handle = _textures.create(std::move(texture));
+        _bindless_texture_write(_textures.index_get(texture_handle), *_textures.get_or_null(texture_handle));
+        return texture_handle;
+    }
+
+    void RenderDeviceVulkan::texture_destroy(TextureHandle texture) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::texture_destroy");
+        DODO_ASSERT(texture);
+        if (Texture* tex = _textures.get_or_null(texture)) {
+            vkDestroyImageView(_device, tex->vk_image_view, VK_NULL_HANDLE);
+            vkDestroyImage(_device, tex->vk_image, VK_NULL_HANDLE);
+            _memory_allocator.free(tex->allocation);
+            _textures.destroy(texture);
+        }
+    }
+
+    uint32_t RenderDeviceVulkan::texture_get_bindless_index(TextureHandle texture) {
+        const Texture* tex = _textures.get_or_null(texture);
+        const uint32_t index = _textures.index_get(texture);
+        if (!tex || ((tex->usage & (texture_usage_sampled | texture_usage_storage)) == 0)) {
+            return invalid_bindless_index;
+        }
+
+        // The index has to address every array the texture is in.
+        const bool fits_sampled = ((tex->usage & texture_usage_sampled) == 0) || (index < _bindless.texture_capacity);
+        const bool fits_storage = ((tex->usage & texture_usage_storage) == 0) || (index < _bindless.storage_texture_capacity);
+        return (fits_sampled && fits_storage) ? index : invalid_bindless_index;
+    }
+
+    void RenderDeviceVulkan::texture_get_memory_requirements(const TextureSpecifications& texture_specs, MemoryRequirements& r_memory_requirements) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::texture_get_memory_requirements");
+        r_memory_requirements = {};
+        // Vulkan 1.2 only reports requirements of existing images, a temporary one is cheap without memory.
+        Texture texture = {};
+        if (!_vk_image_create(texture_specs, texture)) {
+            return;
+        }
+
+        VkMemoryRequirements memory_requirements = {};
+        vkGetImageMemoryRequirements(_device, texture.vk_image, &memory_requirements);
+        vkDestroyImage(_device, texture.vk_image, VK_NULL_HANDLE);
+        r_memory_requirements.size = memory_requirements.size;
+        r_memory_requirements.alignment = memory_requirements.alignment;
+        r_memory_requirements.memory_type_bits = memory_requirements.memoryTypeBits;
+    }
+
+    TextureHeapHandle RenderDeviceVulkan::texture_heap_create(uint64_t size, uint32_t memory_type_bits) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::texture_heap_create");
+        DODO_ASSERT(size > 0);
+        TextureHeap texture_heap = {};
+        texture_heap.linear_pool = _memory_allocator.linear_pool_create(size, memory_type_bits, MemoryUsage::gpu_only);
+        if (!texture_heap.linear_pool) {
+            return {};
+        }
+
+        VkMemoryRequirements memory_requirements = {};
+        memory_requirements.size = size;
+        memory_requirements.alignment = 1;
+        memory_requirements.memoryTypeBits = memory_type_bits;
+        MemoryAllocatorVulkan::AllocationInfo allocation_info = {};
+        const bool is_allocated = _memory_allocator.linear_pool_allocate(texture_heap.linear_pool, memory_requirements, allocation_info);
+        DODO_ASSERT(is_allocated);
+        texture_heap.memory = allocation_info.memory;
+        texture_heap.offset = allocation_info.offset;
+        texture_heap.size = size;
+        texture_heap.memory_type_index = allocation_info.memory_type_index;
+        return _texture_heaps.create(std::move(texture_heap));
+    }
+
+    void RenderDeviceVulkan::texture_heap_destroy(TextureHeapHandle texture_heap) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::texture_heap_destroy");
+        DODO_ASSERT(texture_heap);
+        if (TextureHeap* heap = _texture_heaps.get_or_null(texture_heap)) {
+            _memory_allocator.linear_pool_destroy(heap->linear_pool);
+            _texture_heaps.destroy(texture_heap);
+        }
+    }
+
+    TextureHandle RenderDeviceVulkan::texture_create_placed(const TextureSpecifications& texture_specs, TextureHeapHandle texture_heap, uint64_t offset) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::texture_create_placed");
+        const TextureHeap* heap = _texture_heaps.get_or_null(texture_heap);
+        if (!heap) {
+            return {};
+        }
+
+        Texture texture = {};
+        if (!_vk_image_create(texture_specs, texture)) {
+            return {};
+        }
+
+        VkMemoryRequirements memory_requirements = {};
+        vkGetImageMemoryRequirements(_device, texture.vk_image, &memory_requirements);
+        const bool is_compatible = ((memory_requirements.memoryTypeBits & (1u << heap->memory_type_index)) != 0) && ((offset % memory_requirements.alignment) == 0);
+        if (!is_compatible || ((offset + memory_requirements.size) > heap->size)) {
+            DODO_LOG_ERROR_TAG("Renderer", "A {0}x{1} texture does not fit its texture heap at offset {2}!", texture_specs.width, texture_specs.height, offset);
+            vkDestroyImage(_device, texture.vk_image, VK_NULL_HANDLE);
+            return {};
+        }
+
+        DODO_ASSERT_VK_RESULT(vkBindImageMemory(_device, texture.vk_image, heap->memory, heap->offset + offset));
+        _vk_image_view_create(texture_specs, texture);
+        const TextureHandle texture_handle = _textures.create(std::move(texture));
+        _bindless_texture_write(_textures.index_get(texture_handle), *_textures.get_or_null(texture_handle));
+        return texture_handle;
+    }
+
+    void RenderDeviceVulkan::command_buffer_barrier(CommandBufferHandle p_command_buffer, std::span<const TextureBarrier> texture_barriers, std::span<const BufferBarrier> buffer_barriers, const MemoryBarrier& memory_barrier) {
+        DODO_ASSERT(p_command_buffer);
+        const CommandBuffer* command_buffer = _command_buffers.get_or_null(p_command_buffer);
+        const bool has_memory_barrier = (memory_barrier.states_before != 0) && (memory_barrier.states_after != 0);
+        if (!command_buffer || (texture_barriers.empty() && buffer_barriers.empty() && !has_memory_barrier)) {
+            return;
+        }
+
+        // Barriers go out in chunks, the stage masks of the whole batch keep it one dependency.
+        static constexpr size_t max_chunk_barrier_count = 32;
+        FixedVector<VkImageMemoryBarrier, max_chunk_barrier_count> image_barriers = {};
+        FixedVector<VkBufferMemoryBarrier, max_chunk_barrier_count> vk_buffer_barriers = {};
+        VkPipelineStageFlags src_stages = 0;
+        VkPipelineStageFlags dst_stages = 0;
+        for (const TextureBarrier& barrier : texture_barriers) {
+            src_stages |= Utils::convert_to_resource_state_info(barrier.state_before).stages;
+            dst_stages |= Utils::convert_to_resource_state_info(barrier.state_after).stages;
+        }
+
+        for (const BufferBarrier& barrier : buffer_barriers) {
+            src_stages |= Utils::convert_to_resource_state_info(barrier.state_before).stages;
+            dst_stages |= Utils::convert_to_resource_state_info(barrier.state_after).stages;
+        }
+
+        VkMemoryBarrier vk_memory_barrier = {};
+        vk_memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        if (has_memory_barrier) {
+            for (uint32_t state = 0; state <= static_cast<uint32_t>(ResourceState::present); state++) {
+                const Utils::ResourceStateInfo info = Utils::convert_to_resource_state_info(static_cast<ResourceState>(state));
+                if (memory_barrier.states_before & (1u << state)) {
+                    src_stages |= info.stages;
+                    vk_memory_barrier.srcAccessMask |= info.access;
+                }
+
+                if (memory_barrier.states_after & (1u << state)) {
+                    dst_stages |= info.stages;
+                    vk_memory_barrier.dstAccessMask |= info.access;
+                }
+            }
+        }
+
+        // The memory barrier goes out with the first chunk.
+        uint32_t memory_barrier_count = has_memory_barrier ? 1 : 0;
+        const auto flush = [&]() {
+            vkCmdPipelineBarrier(command_buffer->vk_command_buffer, src_stages, dst_stages, 0, memory_barrier_count, &vk_memory_barrier,
+                                 static_cast<uint32_t>(vk_buffer_barriers.size()), vk_buffer_barriers.data(), static_cast<uint32_t>(image_barriers.size()), image_barriers.data());
+            image_barriers.clear();
+            vk_buffer_barriers.clear();
+            memory_barrier_count = 0;
+        };
+
+        for (const TextureBarrier& barrier : texture_barriers) {
+            const Texture* texture = _textures.get_or_null(barrier.texture);
+            if (!texture) {
+                continue;
+            }
+
+            const Utils::ResourceStateInfo before = Utils::convert_to_resource_state_info(barrier.state_before);
+            const Utils::ResourceStateInfo after = Utils::convert_to_resource_state_info(barrier.state_after);
+            VkImageMemoryBarrier image_barrier = {};
+            image_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            image_barrier.srcAccessMask = before.access;
+            image_barrier.dstAccessMask = after.access;
+            image_barrier.oldLayout = barrier.discard ? VK_IMAGE_LAYOUT_UNDEFINED : before.layout;
+            image_barrier.newLayout = after.layout;
+            image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            image_barrier.image = texture->vk_image;
+            image_barrier.subresourceRange.aspectMask = texture->aspect;
+            image_barrier.subresourceRange.levelCount = texture->mip_count;
+            image_barrier.subresourceRange.layerCount = texture->layer_count;
+            image_barriers.push_back(image_barrier);
+            if (image_barriers.full()) {
+                flush();
+            }
+        }
+
+        for (const BufferBarrier& barrier : buffer_barriers) {
+            const Buffer* buffer = _buffers.get_or_null(barrier.buffer);
+            if (!buffer) {
+                continue;
+            }
+
+            VkBufferMemoryBarrier buffer_barrier = {};
+            buffer_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            buffer_barrier.srcAccessMask = Utils::convert_to_resource_state_info(barrier.state_before).access;
+            buffer_barrier.dstAccessMask = Utils::convert_to_resource_state_info(barrier.state_after).access;
+            buffer_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            buffer_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            buffer_barrier.buffer = buffer->vk_buffer;
+            buffer_barrier.size = VK_WHOLE_SIZE;
+            vk_buffer_barriers.push_back(buffer_barrier);
+            if (vk_buffer_barriers.full()) {
+                flush();
+            }
+        }
+
+        if (!image_barriers.empty() || !vk_buffer_barriers.empty() || (memory_barrier_count > 0)) {
+            flush();
         }
 
-        VkDeviceCreateInfo device_create_info = {};
-        device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-        device_create_info.queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size());
-        device_create_info.pQueueCreateInfos = queue_create_infos.data();
-        device_create_info.enabledExtensionCount = static_cast<uint32_t>(_enabled_extensions.size());
-        device_create_info.ppEnabledExtensionNames = _enabled_extensions.data();
-        DODO_ASSERT_VK_RESULT(vkCreateDevice(_physical_device, &device_create_info, nullptr, &_device));
+        DODO_METRIC_COUNTER_ADD("renderer.barriers", texture_barriers.size() + buffer_barriers.size() + (has_memory_barrier ? 1 : 0));
+    }
 
-        for (uint32_t i = 0; i < _queues.size(); i++) {
-            for (uint32_t j = 0; j < _queues.at(i).size(); j++) {
-                vkGetDeviceQueue(_device, i, j, &_queues.at(i).at(j).queue);
-            }
+    void RenderDeviceVulkan::command_buffer_copy_buffer(CommandBufferHandle p_command_buffer, BufferHandle src_buffer, uint64_t src_offset, BufferHandle dst_buffer, uint64_t dst_offset, uint64_t size) {
+        DODO_ASSERT(p_command_buffer && src_buffer && dst_buffer);
+        const CommandBuffer* command_buffer = _command_buffers.get_or_null(p_command_buffer);
+        const Buffer* src = _buffers.get_or_null(src_buffer);
+        const Buffer* dst = _buffers.get_or_null(dst_buffer);
+        if (!command_buffer || !src || !dst) {
+            return;
         }
 
-        const RenderBackendVulkan::Functions& backend_functions = _backend->functions_get();
-        _functions.CreateSwapchainKHR = reinterpret_cast<PFN_vkCreateSwapchainKHR>(backend_functions.GetDeviceProcAddr(_device, "vkCreateSwapchainKHR"));
-        _functions.GetSwapchainImagesKHR = reinterpret_cast<PFN_vkGetSwapchainImagesKHR>(backend_functions.GetDeviceProcAddr(_device, "vkGetSwapchainImagesKHR"));
-        _functions.AcquireNextImageKHR = reinterpret_cast<PFN_vkAcquireNextImageKHR>(backend_functions.GetDeviceProcAddr(_device, "vkAcquireNextImageKHR"));
-        _functions.QueuePresentKHR = reinterpret_cast<PFN_vkQueuePresentKHR>(backend_functions.GetDeviceProcAddr(_device, "vkQueuePresentKHR"));
-        _functions.DestroySwapchainKHR = reinterpret_cast<PFN_vkDestroySwapchainKHR>(backend_functions.GetDeviceProcAddr(_device, "vkDestroySwapchainKHR"));
+        DODO_ASSERT(((src_offset + size) <= src->size) && ((dst_offset + size) <= dst->size));
+        VkBufferCopy region = {};
+        region.srcOffset = src_offset;
+        region.dstOffset = dst_offset;
+        region.size = size;
+        vkCmdCopyBuffer(command_buffer->vk_command_buffer, src->vk_buffer, dst->vk_buffer, 1, &region);
     }
 
-    void RenderDeviceVulkan::_request_extension(const std::string& name, bool is_required) {
-        DODO_ASSERT(!_requested_extensions.contains(name));
-        _requested_extensions.insert({ name, is_required });
+    void RenderDeviceVulkan::command_buffer_copy_buffer_to_texture(CommandBufferHandle p_command_buffer, BufferHandle src_buffer, uint64_t src_offset, TextureHandle dst_texture, uint32_t mip, uint32_t layer) {
+        DODO_ASSERT(p_command_buffer && src_buffer && dst_texture);
+        const CommandBuffer* command_buffer = _command_buffers.get_or_null(p_command_buffer);
+        const Buffer* src = _buffers.get_or_null(src_buffer);
+        const Texture* dst = _textures.get_or_null(dst_texture);
+        if (!command_buffer || !src || !dst) {
+            return;
+        }
+
+        DODO_ASSERT((mip < dst->mip_count) && (layer < dst->layer_count));
+        // The previous contents are discarded, the copy replaces the whole subresource.
+        VkImageMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = dst->vk_image;
+        barrier.subresourceRange.aspectMask = dst->aspect;
+        barrier.subresourceRange.baseMipLevel = mip;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.baseArrayLayer = layer;
+        barrier.subresourceRange.layerCount = 1;
+        vkCmdPipelineBarrier(command_buffer->vk_command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        VkBufferImageCopy region = {};
+        region.bufferOffset = src_offset;
+        region.imageSubresource.aspectMask = dst->aspect;
+        region.imageSubresource.mipLevel = mip;
+        region.imageSubresource.baseArrayLayer = layer;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent.width = std::max(dst->extent.width >> mip, 1u);
+        region.imageExtent.height = std::max(dst->extent.height >> mip, 1u);
+        region.imageExtent.depth = std::max(dst->extent.depth >> mip, 1u);
+        vkCmdCopyBufferToImage(command_buffer->vk_command_buffer, src->vk_buffer, dst->vk_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+        // Visibility for the consuming queue comes from the semaphore it waits on.
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = 0;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = (dst->usage & texture_usage_sampled) ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+        vkCmdPipelineBarrier(command_buffer->vk_command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
     }
 
-    CommandQueueFamilyHandle RenderDeviceVulkan::command_queue_family_get(CommandQueueFamilyType command_queue_family_type, SurfaceHandle surface) {
-        VkQueueFlags desired_queue_family_bits = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
-        if (command_queue_family_type == CommandQueueFamilyType::compute) {
-            desired_queue_family_bits = VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
-        }
-        else if (command_queue_family_type == CommandQueueFamilyType::copy) {
-            desired_queue_family_bits = VK_QUEUE_TRANSFER_BIT;
+    void RenderDeviceVulkan::memory_get_heap_statistics(std::vector<MemoryHeapStatistics>& r_heap_statistics) const {
+        _memory_allocator.heap_statistics_get(r_heap_statistics);
+    }
+
+    uint64_t RenderDeviceVulkan::memory_defragment(CommandQueueHandle command_queue, uint64_t max_bytes_to_move) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::memory_defragment");
+        DODO_ASSERT(command_queue);
+        const CommandQueue* cmd_queue = _command_queues.get_or_null(command_queue);
+        if (!cmd_queue) {
+            return 0;
         }
 
-        uint32_t picked_queue_family_index = UINT32_MAX;
-        for (uint32_t i = 0; i < _queues.size(); i++) {
-            if (_queues.at(i).empty()) {
-                continue;
-            }
+        // Nothing may use the moved ranges, moving also invalidates the VkBuffer of a buffer handle.
+        std::unique_lock<std::mutex> lock(_submit_mutex);
+        DODO_ASSERT_VK_RESULT(vkDeviceWaitIdle(_device));
 
-            if (surface && !_backend->queue_family_supports_present(_physical_device, i, surface)) {
-                continue;
+        VkCommandPoolCreateInfo pool_create_info = {};
+        pool_create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        pool_create_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        pool_create_info.queueFamilyIndex = cmd_queue->queue_family_index;
+        VkCommandPool vk_command_pool = VK_NULL_HANDLE;
+        DODO_ASSERT_VK_RESULT(vkCreateCommandPool(_device, &pool_create_info, VK_NULL_HANDLE, &vk_command_pool));
+
+        VkCommandBufferAllocateInfo allocate_info = {};
+        allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocate_info.commandPool = vk_command_pool;
+        allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocate_info.commandBufferCount = 1;
+        VkCommandBuffer vk_command_buffer = VK_NULL_HANDLE;
+        DODO_ASSERT_VK_RESULT(vkAllocateCommandBuffers(_device, &allocate_info, &vk_command_buffer));
+
+        VkCommandBufferBeginInfo begin_info = {};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        DODO_ASSERT_VK_RESULT(vkBeginCommandBuffer(vk_command_buffer, &begin_info));
+
+        // Textures are never moved, their layouts are not tracked yet.
+        std::vector<VkBuffer> retired_buffers = {};
+        std::vector<BufferHandle> moved_buffers = {};
+        const uint64_t moved_bytes = _memory_allocator.defragment([&](MemoryAllocationHandle, const MemoryAllocatorVulkan::AllocationInfo&, const MemoryAllocatorVulkan::AllocationInfo& to) {
+            Buffer* buffer = _buffers.get_or_null(BufferHandle(to.user_data));
+            if (!buffer) {
+                return false;
             }
 
-            const VkQueueFlags queue_family_bits = _queue_families.at(i).queueFlags;
-            const bool includes_desired_bits = (queue_family_bits & desired_queue_family_bits) == desired_queue_family_bits;
-            if (includes_desired_bits) {
-                picked_queue_family_index = i;
-                break;
+            const VkBuffer vk_buffer = _vk_buffer_create(buffer->size, buffer->vk_usage);
+            if (!vk_buffer) {
+                return false;
             }
-        }
 
-        return CommandQueueFamilyHandle(picked_queue_family_index + 1);
-    }
+            DODO_ASSERT_VK_RESULT(vkBindBufferMemory(_device, vk_buffer, to.memory, to.offset));
+            VkBufferCopy region = {};
+            region.size = buffer->size;
+            vkCmdCopyBuffer(vk_command_buffer, buffer->vk_buffer, vk_buffer, 1, &region);
+
+            // A range written by one copy may be the source of a later one.
+            VkMemoryBarrier barrier = {};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+            vkCmdPipelineBarrier(vk_command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+            retired_buffers.push_back(buffer->vk_buffer);
+            moved_buffers.push_back(BufferHandle(to.user_data));
+            buffer->vk_buffer = vk_buffer;
+            return true;
+        }, max_bytes_to_move);
+
+        DODO_ASSERT_VK_RESULT(vkEndCommandBuffer(vk_command_buffer));
+        if (!retired_buffers.empty()) {
+            VkSubmitInfo submit_info = {};
+            submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submit_info.commandBufferCount = 1;
+            submit_info.pCommandBuffers = &vk_command_buffer;
+            const VkQueue vk_queue = _queues.at(cmd_queue->queue_family_index).at(cmd_queue->queue_index).queue;
+            DODO_ASSERT_VK_RESULT(vkQueueSubmit(vk_queue, 1, &submit_info, VK_NULL_HANDLE));
+            DODO_ASSERT_VK_RESULT(vkQueueWaitIdle(vk_queue));
+        }
 
-    CommandQueueHandle RenderDeviceVulkan::command_queue_create(CommandQueueFamilyHandle command_queue_family) {
-        DODO_ASSERT(command_queue_family);
-        const uint32_t queue_family_index = command_queue_family.get_id() - 1;
+        // The queue is idle, so the slots of the moved buffers are not in use anymore.
+        for (const BufferHandle buffer : moved_buffers) {
+            _bindless_buffer_write(_buffers.index_get(buffer), *_buffers.get_or_null(buffer));
+        }
 
-        std::vector<Queue>& queues = _queues.at(queue_family_index);
-        uint32_t picked_queue_index = UINT32_MAX;
-        uint32_t picked_use_count = UINT32_MAX;
-        for (uint32_t i = 0; i < queues.size(); i++) {
-            const Queue& queue = queues.at(i);
-            if (queue.use_count < picked_use_count) {
-                picked_queue_index = i;
-                picked_use_count = queue.use_count;
-            }
+        for (const VkBuffer vk_buffer : retired_buffers) {
+            vkDestroyBuffer(_device, vk_buffer, VK_NULL_HANDLE);
         }
 
-        queues.at(picked_queue_index).use_count++;
+        _memory_allocator.empty_blocks_release();
 
-        CommandQueue cmd_queue = {};
-        cmd_queue.queue_family_index = queue_family_index;
-        cmd_queue.queue_index = picked_queue_index;
-        cmd_queue.queue = queues.at(cmd_queue.queue_index).queue;
-        return _command_queues.create(std::move(cmd_queue));
+        vkDestroyCommandPool(_device, vk_command_pool, VK_NULL_HANDLE);
+        return moved_bytes;
     }
 
-    void RenderDeviceVulkan::command_queue_execute_and_present(const SubmitSpecifications& submit_specs) {
-        DODO_ASSERT(submit_specs.command_queue);
-        if (CommandQueue* cmd_queue = _command_queues.get_or_null(submit_specs.command_queue)) {
-            std::vector<VkSemaphore> vk_wait_semaphores = {};
-            std::vector<VkPipelineStageFlags> vk_wait_stages = {};
-            std::vector<VkCommandBuffer> vk_command_buffers = {};
-            std::vector<VkSemaphore> vk_signal_semaphores = {};
-            VkQueue vk_queue = _queues.at(cmd_queue->queue_family_index).at(cmd_queue->queue_index);
-
-            if (!cmd_queue->pending_image_semaphores.empty()) {
-                for (uint32_t i = 0; i < cmd_queue->pending_image_semaphores.size(); i++) {
-                    const uint32_t semaphore_index = cmd_queue->pending_image_semaphores.at(i);
-                    VkSemaphore wait_semaphore = cmd_queue->image_semaphores.at(semaphore_index);
-                    vk_wait_semaphores.push_back(wait_semaphore);
-                    const VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-                    vk_wait_stages.push_back(wait_stage);
+    void RenderDeviceVulkan::_pipeline_cache_load() {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::pipeline_cache_load");
+        const Utils::PipelineCacheHeader expected_header = Utils::make_pipeline_cache_header(_physical_device_properties);
+        std::vector<char> data = {};
+        std::error_code error = {};
+        const uint64_t file_size = std::filesystem::file_size(Utils::pipeline_cache_path, error);
+        std::ifstream is(Utils::pipeline_cache_path, std::ios::binary);
+        if (is && !error && (file_size >= sizeof(Utils::PipelineCacheHeader))) {
+            Utils::PipelineCacheHeader header = {};
+            is.read(reinterpret_cast<char*>(&header), sizeof(header));
+            if (Utils::is_pipeline_cache_header_compatible(header, expected_header) && (header.data_size == (file_size - sizeof(header)))) {
+                data.resize(header.data_size);
+                is.read(data.data(), static_cast<std::streamsize>(data.size()));
+                if (!is || (FNV1a()(data.data(), data.size()) != header.data_hash)) {
+                    DODO_LOG_WARNING_TAG("Renderer", "Pipeline cache {0} is damaged, starting with an empty one.", Utils::pipeline_cache_path);
+                    data.clear();
                 }
+            }
+            else {
+                DODO_LOG_INFO_TAG("Renderer", "Pipeline cache {0} was written by another device or driver, starting with an empty one.", Utils::pipeline_cache_path);
+            }
+        }
+
+        VkPipelineCacheCreateInfo create_info = {};
+        create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        create_info.initialDataSize = data.size();
+        create_info.pInitialData = data.empty() ? nullptr : data.data();
+        DODO_ASSERT_VK_RESULT(vkCreatePipelineCache(_device, &create_info, VK_NULL_HANDLE, &_pipeline_cache));
+        if (!data.empty()) {
+            DODO_LOG_INFO_TAG("Renderer", "Loaded {0} KiB of pipeline cache.", data.size() / 1024);
+        }
+    }
+
+    void RenderDeviceVulkan::pipeline_cache_save() {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::pipeline_cache_save");
+        if (!_pipeline_cache) {
+            return;
+        }
 
-                cmd_queue->pending_image_semaphores.clear();
+        size_t data_size = 0;
+        DODO_ASSERT_VK_RESULT(vkGetPipelineCacheData(_device, _pipeline_cache, &data_size, nullptr));
+        std::vector<char> data(data_size);
+        // Pipelines compiling meanwhile may grow the cache, incomplete data is still valid.
+        const VkResult result = vkGetPipelineCacheData(_device, _pipeline_cache, &data_size, data.data());
+        if ((result != VK_SUCCESS) && (result != VK_INCOMPLETE)) {
+            DODO_LOG_ERROR_TAG("Renderer", "Failed to read the pipeline cache!");
+            return;
+        }
+
+        data.resize(data_size);
+        Utils::PipelineCacheHeader header = Utils::make_pipeline_cache_header(_physical_device_properties);
+        header.data_size = data.size();
+        header.data_hash = FNV1a()(data.data(), data.size());
+
+        // Replaces the old file only once the new one is complete.
+        const std::filesystem::path temp_path = std::string(Utils::pipeline_cache_path) + ".tmp";
+        {
+            std::ofstream os(temp_path, std::ios::binary | std::ios::trunc);
+            os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            os.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!os) {
+                DODO_LOG_ERROR_TAG("Renderer", "Failed to write pipeline cache {0}!", temp_path.string());
+                return;
             }
+        }
 
-            if (!cmd_queue->pending_command_semaphores.empty()) {
-                for (uint32_t i = 0; i < cmd_queue->pending_command_semaphores.size(); i++) {
-                    const uint32_t semaphore_index = cmd_queue->pending_command_semaphores.at(i);
-                    VkSemaphore wait_semaphore = cmd_queue->command_semaphores.at(semaphore_index);
-                    vk_wait_semaphores.push_back(wait_semaphore);
-                    const VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-                    vk_wait_stages.push_back(wait_stage);
-                }
+        std::error_code error = {};
+        std::filesystem::rename(temp_path, Utils::pipeline_cache_path, error);
+        if (error) {
+            DODO_LOG_ERROR_TAG("Renderer", "Failed to replace pipeline cache {0}: {1}", Utils::pipeline_cache_path, error.message());
+            return;
+        }
+
+        DODO_LOG_INFO_TAG("Renderer", "Saved {0} KiB of pipeline cache.", data.size() / 1024);
+    }
 
-                cmd_queue->pending_command_semaphores.clear();
+    PipelineHandle RenderDeviceVulkan::pipeline_create(const PipelineSpecifications& pipeline_specs) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::pipeline_create");
+        DODO_ASSERT(!pipeline_specs.shaders.empty());
+        DODO_ASSERT(pipeline_specs.push_constant_size <= max_push_constant_size);
+        // Looked up by hash, a collision must not hand out a different pipeline so the state keys are compared too.
+        std::string state_key = PipelineState::key_make(pipeline_specs);
+        const size_t state_hash = FNV1a()(state_key);
+        std::unique_lock<std::mutex> lock(_pipeline_mutex);
+        const auto [state_begin, state_end] = _pipelines_by_state.equal_range(state_hash);
+        for (auto it = state_begin; it != state_end; it++) {
+            Pipeline* pipeline = _pipelines.get_or_null(it->second);
+            if (pipeline && (pipeline->state_key == state_key)) {
+                pipeline->reference_count++;
+                DODO_METRIC_COUNTER_ADD("renderer.pipeline_state_hits", 1);
+                return it->second;
             }
+        }
 
-            if (!submit_specs.command_buffers.empty()) {
-                for (uint32_t i = 0; i < submit_specs.command_buffers.size(); i++) {
-                    if (CommandBuffer* command_buffer = _command_buffers.get_or_null(submit_specs.command_buffers.at(i))) {
-                        vk_command_buffers.push_back(command_buffer->vk_command_buffer);
-                    }
+        Pipeline pipeline = {};
+        pipeline.compilation = std::make_shared<PipelineCompilation>();
+        pipeline.compilation->specs = pipeline_specs;
+        pipeline.reference_count = 1;
+        pipeline.fallback = pipeline_specs.fallback;
+        pipeline.state_hash = state_hash;
+        pipeline.state_key = std::move(state_key);
+        const std::shared_ptr<PipelineCompilation> compilation = pipeline.compilation;
+        const PipelineHandle handle = _pipelines.create(std::move(pipeline));
+        _pipelines_by_state.emplace(state_hash, handle);
+        lock.unlock();
+
+        if (ThreadPool* thread_pool = ThreadPool::get_singleton()) {
+            thread_pool->add_task([this, compilation](void*) {
+                if (!compilation->is_claimed.exchange(true)) {
+                    _pipeline_compile(*compilation);
                 }
+            }, "RenderDeviceVulkan::pipeline_compile");
+        }
+        else {
+            _pipeline_compilation_wait(*compilation);
+        }
 
-                if (!vk_command_buffers.empty()) {
-                    uint32_t semaphore_index = 0;
-                    if (cmd_queue->free_command_semaphores.empty()) {
-                        VkSemaphoreCreateInfo create_info = {};
-                        create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-                        VkSemaphore semaphore = VK_NULL_HANDLE;
-                        DODO_ASSERT_VK_RESULT(vkCreateSemaphore(_device, &create_info, VK_NULL_HANDLE, &semaphore));
-                        semaphore_index = cmd_queue->command_semaphores.size();
-                        cmd_queue->command_semaphores.push_back(semaphore);
-                    }
-                    else {
-                        semaphore_index = cmd_queue->free_command_semaphores.back();
-                        cmd_queue->free_command_semaphores.pop_back();
-                    }
+        return handle;
+    }
 
-                    cmd_queue->pending_command_semaphores.push_back(semaphore_index);
-                    cmd_queue->pending_command_semaphores_for_fences.push_back(semaphore_index);
-                    vk_signal_semaphores.push_back(cmd_queue->command_semaphores.at(semaphore_index));
-
-                    if (SwapChain* swap_chain = _swap_chains.get_or_null(submit_specs.swap_chain)) {
-                        VkSemaphore present_semaphore = VK_NULL_HANDLE;
-                        if (swap_chain->present_semaphores.empty()) {
-                            VkSemaphoreCreateInfo create_info = {};
-                            create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-                            VkSemaphore semaphore = VK_NULL_HANDLE;
-                            for (uint32_t i = 0; i < swap_chain->framebuffer_count; i++) {
-                                DODO_ASSERT_VK_RESULT(vkCreateSemaphore(_device, &create_info, VK_NULL_HANDLE, &semaphore));
-                                swap_chain->present_semaphores.push_back(semaphore);
-                            }
-                        }
-
-                        present_semaphore = swap_chain->present_semaphores.at(swap_chain->frame_index);
-                        vk_signal_semaphores.push_back(present_semaphore);
-                    }
+    RenderDevice::PipelineStatus RenderDeviceVulkan::pipeline_get_status(PipelineHandle p_pipeline) {
+        const std::shared_ptr<PipelineCompilation> compilation = _pipeline_compilation_get(p_pipeline);
+        return compilation ? compilation->status.load(std::memory_order_acquire) : PipelineStatus::failed;
+    }
+
+    void RenderDeviceVulkan::pipeline_wait(PipelineHandle p_pipeline) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::pipeline_wait");
+        if (const std::shared_ptr<PipelineCompilation> compilation = _pipeline_compilation_get(p_pipeline)) {
+            _pipeline_compilation_wait(*compilation);
+        }
+    }
 
-                    VkSubmitInfo submit_info = {};
-                    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-                    submit_info.waitSemaphoreCount = static_cast<uint32_t>(vk_wait_semaphores.size());
-                    submit_info.pWaitSemaphores = vk_wait_semaphores.data();
-                    submit_info.pWaitDstStageMask = vk_wait_stages.data();
-                    submit_info.commandBufferCount = static_cast<uint32_t>(vk_command_buffers.size());
-                    submit_info.pCommandBuffers = vk_command_buffers.data();
-                    submit_info.signalSemaphoreCount = static_cast<uint32_t>(vk_signal_semaphores.size());
-                    submit_info.pSignalSemaphores = vk_signal_semaphores.data();
-                    DODO_ASSERT_VK_RESULT(vkQueueSubmit(vk_queue, 1, &submit_info, VK_NULL_HANDLE));
+    void RenderDeviceVulkan::pipeline_compilations_drain() {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::pipeline_compilations_drain");
+        std::vector<std::shared_ptr<PipelineCompilation>> compilations = {};
+        {
+            std::unique_lock<std::mutex> lock(_pipeline_mutex);
+            for (const auto& [state_hash, handle] : _pipelines_by_state) {
+                if (const Pipeline* pipeline = _pipelines.get_or_null(handle)) {
+                    compilations.push_back(pipeline->compilation);
                 }
             }
+        }
 
-            if (SwapChain* swap_chain = _swap_chains.get_or_null(submit_specs.swap_chain)) {
+        for (const std::shared_ptr<PipelineCompilation>& compilation : compilations) {
+            if (!compilation->is_claimed.exchange(true)) {
+                compilation->status.store(PipelineStatus::failed, std::memory_order_release);
+                compilation->status.notify_all();
+                continue;
+            }
 
+            compilation->status.wait(PipelineStatus::compiling, std::memory_order_acquire);
+        }
+    }
 
-                VkPresentInfoKHR present_info = {};
-                present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-                present_info.waitSemaphoreCount = static_cast<uint32_t>(vk_wait_semaphores.size());
-                present_info.pWaitSemaphores = vk_wait_semaphores.data();
-                present_info.swapchainCount = 1;
-                present_info.pSwapchains = &swap_chain->vk_swap_chain;
-                present_info.pImageIndices = &swap_chain->image_index;
-                VkResult result = _functions.QueuePresentKHR(queue, &present_info);
+    void RenderDeviceVulkan::pipeline_destroy(PipelineHandle p_pipeline) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::pipeline_destroy");
+        DODO_ASSERT(p_pipeline);
+        std::shared_ptr<PipelineCompilation> compilation = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(_pipeline_mutex);
+            Pipeline* pipeline = _pipelines.get_or_null(p_pipeline);
+            if (!pipeline) {
+                return;
             }
-        }
 
-        for (queueFlagsueFamilyIndext32_t i = 0; i < p_signal_semaphores.size(); i++) {
-            VkSemaphore* semaphore = _semaphore_owner.get_or_null(p_signal_semaphores.at(i));
-            signal_semaphores.push_back(*semaphore);
-        }
+            DODO_ASSERT(pipeline->reference_count > 0);
+            if (--pipeline->reference_count > 0) {
+                return;
+            }
 
-        VkSemaphore present_semaphore = VK_NULL_HANDLE;
-        if (swap_chain) {
-            if (cmd_queue->present_semaphores.empty()) {
-                VkSemaphore semaphore = VK_NULL_HANDLE;
-                VkSemaphoreCreateInfo create_info = {};
-                create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-                for (uint32_t i = 0; i < swap_chain->framebuffer_count; i++) {
-                    DODO_ASSERT_VK_RESULT(vkCreateSemaphore(_device, &create_info, VK_NULL_HANDLE, &semaphore));
-                    cmd_queue->present_semaphores.push_back(semaphore);
+            compilation = pipeline->compilation;
+            const auto [state_begin, state_end] = _pipelines_by_state.equal_range(pipeline->state_hash);
+            for (auto it = state_begin; it != state_end; it++) {
+                if (it->second == p_pipeline) {
+                    _pipelines_by_state.erase(it);
+                    break;
                 }
             }
 
-            present_semaphore = cmd_queue->present_semaphores.at(cmd_queue->present_semaphore_index);
-            signal_semaphores.push_back(present_semaphore);
-            cmd_queue->present_semaphore_index = (cmd_queue->present_semaphore_index + 1) % static_cast<uint32_t>(cmd_queue->present_semaphores.size());
+            _pipelines.destroy(p_pipeline);
         }
 
-        if (!wait_fence) {
-            for (uint32_t i = 0; i < cmd_queue->pending_image_semaphores_for_fences.size(); i++) {
-                cmd_queue->image_semaphores_for_fences.push_back({ wait_fence, cmd_queue->pending_image_semaphores_for_fences.at(i) });
-            }
+        // Claiming an unstarted compilation cancels it, one in progress has to finish first.
+        if (compilation->is_claimed.exchange(true)) {
+            compilation->status.wait(PipelineStatus::compiling, std::memory_order_acquire);
+        }
+
+        if (compilation->vk_pipeline) {
+            vkDestroyPipeline(_device, compilation->vk_pipeline, VK_NULL_HANDLE);
+        }
+    }
 
-            cmd_queue->pending_image_semaphores_for_fences.clear();
-            wait_fence->command_queue_to_signal = cmd_queue;
+    bool RenderDeviceVulkan::command_buffer_bind_pipeline(CommandBufferHandle p_command_buffer, PipelineHandle p_pipeline, PipelineBindPolicy bind_policy) {
+        DODO_ASSERT(p_command_buffer && p_pipeline);
+        CommandBuffer* command_buffer = _command_buffers.get_or_null(p_command_buffer);
+        std::shared_ptr<PipelineCompilation> compilation = nullptr;
+        std::shared_ptr<PipelineCompilation> fallback_compilation = nullptr;
+        {
+            // Recording threads bind while the main thread creates and destroys pipelines, the copies keep
+            // the compilations alive until the bind is done.
+            std::unique_lock<std::mutex> lock(_pipeline_mutex);
+            if (const Pipeline* pipeline = _pipelines.get_or_null(p_pipeline)) {
+                compilation = pipeline->compilation;
+                const Pipeline* fallback = pipeline->fallback ? _pipelines.get_or_null(pipeline->fallback) : nullptr;
+                fallback_compilation = fallback ? fallback->compilation : nullptr;
+            }
         }
 
-        if (present_semaphore) {
-            wait_semaphores.clear();
-            wait_semaphores.push_back(present_semaphore);
+        if (!command_buffer || !compilation) {
+            return false;
         }
 
-        if (swap_chain) {
-            if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-                _backend->surface_set_needs_resize(swap_chain->surface, true);
-                return false;
+        const PipelineStatus fallback_status = fallback_compilation ? fallback_compilation->status.load(std::memory_order_acquire) : PipelineStatus::failed;
+        switch (PipelineState::bind_action_resolve(compilation->status.load(std::memory_order_acquire), bind_policy, fallback_status)) {
+            case PipelineState::BindAction::bind : {
+                break;
+            }
+            case PipelineState::BindAction::wait : {
+                DODO_PROFILE_SCOPE("RenderDeviceVulkan::pipeline_bind_wait");
+                DODO_METRIC_COUNTER_ADD("renderer.pipeline_bind_waits", 1);
+                _pipeline_compilation_wait(*compilation);
+                break;
             }
+            case PipelineState::BindAction::bind_fallback : {
+                compilation = fallback_compilation;
+                DODO_METRIC_COUNTER_ADD("renderer.pipeline_bind_fallbacks", 1);
+                break;
+            }
+            case PipelineState::BindAction::skip : {
+                compilation = nullptr;
+                DODO_METRIC_COUNTER_ADD("renderer.pipeline_bind_skips", 1);
+                break;
+            }
+        }
 
-            DODO_ASSERT((result == VK_SUCCESS) || (result == VK_SUBOPTIMAL_KHR));
+        if (!compilation || (compilation->status.load(std::memory_order_acquire) != PipelineStatus::ready)) {
+            return false;
+        }
+
+        vkCmdBindPipeline(command_buffer->vk_command_buffer, compilation->vk_bind_point, compilation->vk_pipeline);
+        // Every pipeline shares the bindless layout, the sets are bound once per bind point and command buffer.
+        const uint32_t bind_point_bit = 1u << static_cast<uint32_t>(compilation->vk_bind_point);
+        if ((command_buffer->bindless_bind_points & bind_point_bit) == 0) {
+            vkCmdBindDescriptorSets(command_buffer->vk_command_buffer, compilation->vk_bind_point, _bindless.pipeline_layout, 0, bindless_set_count, _bindless.sets.data(), 0, nullptr);
+            command_buffer->bindless_bind_points |= bind_point_bit;
         }
 
         return true;
     }
 
-    void RenderDeviceVulkan::command_queue_destroy(CommandQueueHandle command_queue) {
-        DODO_ASSERT(command_queue);
-        if (CommandQueue* cmd_queue = _command_queues.get_or_null(command_queue)) {
-            _queues.at(cmd_queue->queue_family_index).at(cmd_queue->queue_index).virtual_count--;
-            _command_queues.destroy(command_queue);
+    void RenderDeviceVulkan::command_buffer_push_constants(CommandBufferHandle p_command_buffer, const void* data, uint32_t size, uint32_t offset) {
+        DODO_ASSERT(p_command_buffer && data);
+        DODO_ASSERT(((offset % 4) == 0) && ((size % 4) == 0) && ((offset + size) <= max_push_constant_size));
+        if (const CommandBuffer* command_buffer = _command_buffers.get_or_null(p_command_buffer)) {
+            vkCmdPushConstants(command_buffer->vk_command_buffer, _bindless.pipeline_layout, Utils::bindless_shader_stages, offset, size, data);
         }
     }
 
-    CommandPoolHandle RenderDeviceVulkan::command_pool_create(CommandQueueFamilyHandle command_queue_family) {
-        DODO_ASSERT(!command_queue_family.is_null());
-        VkCommandPoolCreateInfo create_info = {};
-        create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        create_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-        create_info.queueFamilyIndex = command_queue_family.get_id() - 1;
-        VkCommandPool vk_command_pool = VK_NULL_HANDLE;
-        DODO_ASSERT_VK_RESULT(vkCreateCommandPool(_device, &create_info, VK_NULL_HANDLE, &vk_command_pool));
-        return _command_pool_owner.create(vk_command_pool);
+    std::shared_ptr<RenderDeviceVulkan::PipelineCompilation> RenderDeviceVulkan::_pipeline_compilation_get(PipelineHandle pipeline) {
+        std::unique_lock<std::mutex> lock(_pipeline_mutex);
+        const Pipeline* pipeline_info = _pipelines.get_or_null(pipeline);
+        return pipeline_info ? pipeline_info->compilation : nullptr;
     }
 
-    void RenderDeviceVulkan::command_pool_destroy(CommandPoolHandle command_pool) {
-        DODO_ASSERT(!command_pool.is_null());
-        if (VkCommandPool* vk_command_pool = _command_pool_owner.get_or_null(command_pool)) {
-            vkDestroyCommandPool(_device, vk_command_pool, VK_NULL_HANDLE);
-            _command_pool_owner.destroy(command_pool);
+    void RenderDeviceVulkan::_pipeline_compilation_wait(PipelineCompilation& r_compilation) {
+        if (!r_compilation.is_claimed.exchange(true)) {
+            _pipeline_compile(r_compilation);
+            return;
         }
+
+        r_compilation.status.wait(PipelineStatus::compiling, std::memory_order_acquire);
     }
 
-    CommandBufferHandle RenderDeviceVulkan::command_buffer_create(CommandPoolHandle command_pool, CommandBufferType command_buffer_type) {
-        DODO_ASSERT(!command_pool.is_null());
-        VkCommandPool* vk_command_pool = _command_pool_owner.get_or_null(command_pool);
-        if (!vk_command_pool) {
-            return CommandBufferHandle();
+    void RenderDeviceVulkan::_pipeline_compile(PipelineCompilation& r_compilation) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::pipeline_compile");
+        Stopwatch stopwatch = {};
+        const PipelineSpecifications& specs = r_compilation.specs;
+        bool is_compute = false;
+        bool is_valid = true;
+        std::vector<VkShaderModule> shader_modules = {};
+        std::vector<VkPipelineShaderStageCreateInfo> stage_create_infos = {};
+        for (const ShaderSpecifications& shader : specs.shaders) {
+            VkShaderModuleCreateInfo module_create_info = {};
+            module_create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+            module_create_info.codeSize = shader.spirv.size() * sizeof(uint32_t);
+            module_create_info.pCode = shader.spirv.data();
+            VkShaderModule shader_module = VK_NULL_HANDLE;
+            if (shader.spirv.empty() || (vkCreateShaderModule(_device, &module_create_info, VK_NULL_HANDLE, &shader_module) != VK_SUCCESS)) {
+                is_valid = false;
+                break;
+            }
+
+            shader_modules.push_back(shader_module);
+            VkPipelineShaderStageCreateInfo stage_create_info = {};
+            stage_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            stage_create_info.stage = Utils::convert_to_shader_stage(shader.stage);
+            stage_create_info.module = shader_module;
+            stage_create_info.pName = shader.entry_point.c_str();
+            stage_create_infos.push_back(stage_create_info);
+            is_compute = is_compute || (shader.stage == ShaderStage::compute);
         }
 
-        VkCommandBufferLevel command_buffer_level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        if (command_buffer_type == COMMAND_BUFFER_TYPE_SECONDARY) {
-            command_buffer_level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        if (is_valid && is_compute) {
+            DODO_ASSERT(stage_create_infos.size() == 1);
+            VkComputePipelineCreateInfo create_info = {};
+            create_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+            create_info.stage = stage_create_infos.front();
+            create_info.layout = _bindless.pipeline_layout;
+            is_valid = vkCreateComputePipelines(_device, _pipeline_cache, 1, &create_info, VK_NULL_HANDLE, &r_compilation.vk_pipeline) == VK_SUCCESS;
+            r_compilation.vk_bind_point = VK_PIPELINE_BIND_POINT_COMPUTE;
         }
+        else if (is_valid) {
+            std::vector<VkVertexInputBindingDescription> binding_descriptions = {};
+            for (const VertexBinding& binding : specs.vertex_bindings) {
+                binding_descriptions.push_back({ binding.binding, binding.stride, binding.is_per_instance ? VK_VERTEX_INPUT_RATE_INSTANCE : VK_VERTEX_INPUT_RATE_VERTEX });
+            }
 
-        VkCommandBufferAllocateInfo alloc_info = {};
-        alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        alloc_info.commandPool = vk_command_pool;
-        alloc_info.level = command_buffer_level;
-        alloc_info.commandBufferCount = 1;
-        VkCommandBuffer vk_command_buffer = VK_NULL_HANDLE;
-        DODO_ASSERT_VK_RESULT(vkAllocateCommandBuffers(_device, &alloc_info, &vk_command_buffer));
+            std::vector<VkVertexInputAttributeDescription> attribute_descriptions = {};
+            for (const VertexAttribute& attribute : specs.vertex_attributes) {
+                attribute_descriptions.push_back({ attribute.location, attribute.binding, Utils::convert_to_vertex_format(attribute.format), attribute.offset });
+            }
 
-        CommandBuffer command_buffer_info = {};
-        command_buffer_info.command_buffer_type = command_buffer_type;
-        command_buffer_info.vk_command_buffer = vk_command_buffer;
-        return _command_buffer_pool.create(command_buffer_info);
-    }
+            VkPipelineVertexInputStateCreateInfo vertex_input_state = {};
+            vertex_input_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+            vertex_input_state.vertexBindingDescriptionCount = static_cast<uint32_t>(binding_descriptions.size());
+            vertex_input_state.pVertexBindingDescriptions = binding_descriptions.data();
+            vertex_input_state.vertexAttributeDescriptionCount = static_cast<uint32_t>(attribute_descriptions.size());
+            vertex_input_state.pVertexAttributeDescriptions = attribute_descriptions.data();
+
+            VkPipelineInputAssemblyStateCreateInfo input_assembly_state = {};
+            input_assembly_state.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+            input_assembly_state.topology = Utils::convert_to_primitive_topology(specs.topology);
+
+            VkPipelineViewportStateCreateInfo viewport_state = {};
+            viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+            viewport_state.viewportCount = 1;
+            viewport_state.scissorCount = 1;
+
+            VkPipelineRasterizationStateCreateInfo rasterization_state = {};
+            rasterization_state.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+            rasterization_state.polygonMode = VK_POLYGON_MODE_FILL;
+            rasterization_state.cullMode = Utils::convert_to_cull_mode(specs.cull_mode);
+            rasterization_state.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+            rasterization_state.lineWidth = 1.0f;
+
+            VkPipelineMultisampleStateCreateInfo multisample_state = {};
+            multisample_state.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+            multisample_state.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+            VkPipelineDepthStencilStateCreateInfo depth_stencil_state = {};
+            depth_stencil_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+            depth_stencil_state.depthTestEnable = specs.is_depth_test_enabled ? VK_TRUE : VK_FALSE;
+            depth_stencil_state.depthWriteEnable = specs.is_depth_write_enabled ? VK_TRUE : VK_FALSE;
+            depth_stencil_state.depthCompareOp = Utils::convert_to_compare_op(specs.depth_compare_op);
+
+            VkPipelineColorBlendAttachmentState blend_attachment_state = {};
+            blend_attachment_state.blendEnable = specs.is_blend_enabled ? VK_TRUE : VK_FALSE;
+            blend_attachment_state.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+            blend_attachment_state.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            blend_attachment_state.colorBlendOp = VK_BLEND_OP_ADD;
+            blend_attachment_state.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+            blend_attachment_state.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            blend_attachment_state.alphaBlendOp = VK_BLEND_OP_ADD;
+            blend_attachment_state.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+            const std::vector<VkPipelineColorBlendAttachmentState> blend_attachment_states(specs.color_formats.size(), blend_attachment_state);
+            VkPipelineColorBlendStateCreateInfo color_blend_state = {};
+            color_blend_state.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+            color_blend_state.attachmentCount = static_cast<uint32_t>(blend_attachment_states.size());
+            color_blend_state.pAttachments = blend_attachment_states.data();
+
+            const std::array<VkDynamicState, 2> dynamic_states = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+            VkPipelineDynamicStateCreateInfo dynamic_state = {};
+            dynamic_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+            dynamic_state.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
+            dynamic_state.pDynamicStates = dynamic_states.data();
+
+            VkGraphicsPipelineCreateInfo create_info = {};
+            create_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+            create_info.stageCount = static_cast<uint32_t>(stage_create_infos.size());
+            create_info.pStages = stage_create_infos.data();
+            create_info.pVertexInputState = &vertex_input_state;
+            create_info.pInputAssemblyState = &input_assembly_state;
+            create_info.pViewportState = &viewport_state;
+            create_info.pRasterizationState = &rasterization_state;
+            create_info.pMultisampleState = &multisample_state;
+            create_info.pDepthStencilState = &depth_stencil_state;
+            create_info.pColorBlendState = &color_blend_state;
+            create_info.pDynamicState = &dynamic_state;
+            create_info.layout = _bindless.pipeline_layout;
+            create_info.renderPass = _compatible_render_pass_get(specs);
+            is_valid = vkCreateGraphicsPipelines(_device, _pipeline_cache, 1, &create_info, VK_NULL_HANDLE, &r_compilation.vk_pipeline) == VK_SUCCESS;
+            r_compilation.vk_bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        }
 
-    void RenderDeviceVulkan::command_buffer_begin(CommandBufferHandle p_command_buffer) {
-        DODO_ASSERT(!p_command_buffer.is_null());
-        if (CommandBuffer* command_buffer = _command_buffer_pool.get_or_null(p_command_buffer)) {
-            VkCommandBufferBeginInfo begin_info = {};
-            begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-            DODO_ASSERT_VK_RESULT(vkBeginCommandBuffer(command_buffer->vk_command_buffer, &begin_info));
+        for (VkShaderModule shader_module : shader_modules) {
+            vkDestroyShaderModule(_device, shader_module, VK_NULL_HANDLE);
         }
-    }
 
-    void RenderDeviceVulkan::command_buffer_end(CommandBufferHandle p_command_buffer) {
-        DODO_ASSERT(!p_command_buffer.is_null());
-        if (CommandBuffer* command_buffer = _command_buffer_pool.get_or_null(p_command_buffer)) {
-            DODO_ASSERT_VK_RESULT(vkEndCommandBuffer(command_buffer->vk_command_buffer));
+        if (!is_valid) {
+            DODO_LOG_ERROR_TAG("Renderer", "Failed to compile a pipeline with {0} shaders!", specs.shaders.size());
         }
+
+        // The SPIR-V is not needed anymore, the fallback lives on in the pipeline.
+        r_compilation.specs = {};
+        r_compilation.status.store(is_valid ? PipelineStatus::ready : PipelineStatus::failed, std::memory_order_release);
+        r_compilation.status.notify_all();
+        DODO_METRIC_COUNTER_ADD("renderer.pipelines_compiled", 1);
+        DODO_METRIC_HISTOGRAM_RECORD("renderer.pipeline_compile_us", static_cast<uint64_t>(stopwatch.get_milliseconds() * 1000.0));
     }
 
-    FenceHandle RenderDeviceVulkan::fence_create() {
-        VkFenceCreateInfo create_info = {};
-        create_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        create_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-        VkFence vk_fence  = VK_NULL_HANDLE;
-        DODO_ASSERT_VK_RESULT(vkCreateFence(_device, &create_info, VK_NULL_HANDLE, &vk_fence));
+    VkRenderPass RenderDeviceVulkan::_compatible_render_pass_get(const PipelineSpecifications& pipeline_specs) {
+        std::string render_pass_key = PipelineState::render_pass_key_make(pipeline_specs);
+        std::unique_lock<std::mutex> lock(_compatible_render_pass_mutex);
+        if (const auto it = _compatible_render_passes.find(render_pass_key); it != _compatible_render_passes.end()) {
+            return it->second;
+        }
+
+        // Compatibility only depends on formats and sample counts, load and store operations do not matter.
+        std::vector<VkAttachmentDescription> attachments = {};
+        std::vector<VkAttachmentReference> color_attachment_refs = {};
+        for (const TextureFormat format : pipeline_specs.color_formats) {
+            VkAttachmentDescription attachment = {};
+            attachment.format = Utils::convert_to_format(format);
+            attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+            attachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+            attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            attachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            attachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            color_attachment_refs.push_back({ static_cast<uint32_t>(attachments.size()), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
+            attachments.push_back(attachment);
+        }
+
+        VkAttachmentReference depth_attachment_ref = {};
+        if (pipeline_specs.has_depth_stencil) {
+            VkAttachmentDescription attachment = {};
+            attachment.format = Utils::convert_to_format(pipeline_specs.depth_stencil_format);
+            attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+            attachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+            attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            attachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            attachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            depth_attachment_ref = { static_cast<uint32_t>(attachments.size()), VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+            attachments.push_back(attachment);
+        }
 
-        Fence fence = {};
-        fence.vk_fence = vk_fence;
-        return _fence_owner.create(std::move(fence));
+        VkSubpassDescription subpass = {};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = static_cast<uint32_t>(color_attachment_refs.size());
+        subpass.pColorAttachments = color_attachment_refs.data();
+        subpass.pDepthStencilAttachment = pipeline_specs.has_depth_stencil ? &depth_attachment_ref : nullptr;
+        VkRenderPassCreateInfo create_info = {};
+        create_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        create_info.attachmentCount = static_cast<uint32_t>(attachments.size());
+        create_info.pAttachments = attachments.data();
+        create_info.subpassCount = 1;
+        create_info.pSubpasses = &subpass;
+        VkRenderPass render_pass = VK_NULL_HANDLE;
+        DODO_ASSERT_VK_RESULT(vkCreateRenderPass(_device, &create_info, nullptr, &render_pass));
+        _compatible_render_passes.emplace(std::move(render_pass_key), render_pass);
+        return render_pass;
     }
 
-    void RenderDeviceVulkan::fence_wait(FenceHandle p_fence) {
-        DODO_ASSERT(!p_fence.is_null());
-        Fence* fence = _fence_owner.get_or_null(p_fence);
-        if (!fence) {
-            return;
+    void RenderDeviceVulkan::_bindless_initialize() {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::bindless_initialize");
+        VkPhysicalDeviceVulkan12Properties properties_12 = {};
+        properties_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+        VkPhysicalDeviceProperties2 properties = {};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties.pNext = &properties_12;
+        vkGetPhysicalDeviceProperties2(_physical_device, &properties);
+
+        // Every stage sees all arrays, so they split the resources a stage may access.
+        const uint32_t max_per_stage_resources = properties_12.maxPerStageUpdateAfterBindResources / bindless_set_count;
+        _bindless.texture_capacity = std::min({ Utils::bindless_texture_capacity, max_per_stage_resources,
+            properties_12.maxPerStageDescriptorUpdateAfterBindSampledImages, properties_12.maxDescriptorSetUpdateAfterBindSampledImages });
+        _bindless.storage_texture_capacity = std::min({ Utils::bindless_storage_texture_capacity, max_per_stage_resources,
+            properties_12.maxPerStageDescriptorUpdateAfterBindStorageImages, properties_12.maxDescriptorSetUpdateAfterBindStorageImages });
+        _bindless.buffer_capacity = std::min({ Utils::bindless_buffer_capacity, max_per_stage_resources,
+            properties_12.maxPerStageDescriptorUpdateAfterBindStorageBuffers, properties_12.maxDescriptorSetUpdateAfterBindStorageBuffers });
+
+        for (uint32_t i = 0; i < bindless_sampler_count; i++) {
+            const VkSamplerCreateInfo sampler_create_info = Utils::make_bindless_sampler_create_info(static_cast<BindlessSampler>(i));
+            DODO_ASSERT_VK_RESULT(vkCreateSampler(_device, &sampler_create_info, VK_NULL_HANDLE, &_bindless.samplers.at(i)));
         }
 
-        static const auto default_timeout = std::numeric_limits<uint64_t>::max();
-        DODO_ASSERT_VK_RESULT(vkWaitForFences(_device, 1, &fence->vk_fence, VK_TRUE, default_timeout));
-        // DODO_ASSERT_VK_RESULT(vkResetFences(_device, 1, &fence->vk_fence));
-        if (!fence->command_queue_to_signal) {
-            return;
+        const std::array<std::pair<VkDescriptorType, uint32_t>, bindless_set_count> arrays = {{
+            { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, _bindless.texture_capacity },
+            { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _bindless.storage_texture_capacity },
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, _bindless.buffer_capacity }
+        }};
+
+        for (uint32_t i = 0; i < bindless_set_count; i++) {
+            // The samplers are immutable and ride along with the sampled textures.
+            const std::array<VkDescriptorSetLayoutBinding, 2> bindings = {{
+                { 0, arrays.at(i).first, arrays.at(i).second, Utils::bindless_shader_stages, nullptr },
+                { 1, VK_DESCRIPTOR_TYPE_SAMPLER, bindless_sampler_count, Utils::bindless_shader_stages, _bindless.samplers.data() }
+            }};
+
+            const std::array<VkDescriptorBindingFlags, 2> binding_flags = {
+                VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT,
+                0
+            };
+
+            const uint32_t binding_count = (i == 0) ? 2 : 1;
+            VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_create_info = {};
+            binding_flags_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+            binding_flags_create_info.bindingCount = binding_count;
+            binding_flags_create_info.pBindingFlags = binding_flags.data();
+            VkDescriptorSetLayoutCreateInfo create_info = {};
+            create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            create_info.pNext = &binding_flags_create_info;
+            create_info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+            create_info.bindingCount = binding_count;
+            create_info.pBindings = bindings.data();
+            DODO_ASSERT_VK_RESULT(vkCreateDescriptorSetLayout(_device, &create_info, VK_NULL_HANDLE, &_bindless.set_layouts.at(i)));
         }
 
-        auto free_semaphores_for_fences = [fence](std::vector<std::pair<Fence*, uint32_t>>& semaphores_for_fences, std::vector<uint32_t>& free_semaphores) {
-        free_semaphores_for_fences(command_queue->render_complete_semaphores_for_fences, command_queue->free_render_complete_semaphores);
+        const std::array<VkDescriptorPoolSize, 4> pool_sizes = {{
+            { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, _bindless.texture_capacity },
+            { VK_DESCRIPTOR_TYPE_SAMPLER, bindless_sampler_count },
+            { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, _bindless.storage_texture_capacity },
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, _bindless.buffer_capacity }
+        }};
+
+        VkDescriptorPoolCreateInfo pool_create_info = {};
+        pool_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        pool_create_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+        pool_create_info.maxSets = bindless_set_count;
+        pool_create_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+        pool_create_info.pPoolSizes = pool_sizes.data();
+        DODO_ASSERT_VK_RESULT(vkCreateDescriptorPool(_device, &pool_create_info, VK_NULL_HANDLE, &_bindless.descriptor_pool));
+
+        VkDescriptorSetAllocateInfo allocate_info = {};
+        allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocate_info.descriptorPool = _bindless.descriptor_pool;
+        allocate_info.descriptorSetCount = bindless_set_count;
+        allocate_info.pSetLayouts = _bindless.set_layouts.data();
+        DODO_ASSERT_VK_RESULT(vkAllocateDescriptorSets(_device, &allocate_info, _bindless.sets.data()));
+
+        VkPushConstantRange push_constant_range = {};
+        push_constant_range.stageFlags = Utils::bindless_shader_stages;
+        push_constant_range.size = max_push_constant_size;
+        VkPipelineLayoutCreateInfo layout_create_info = {};
+        layout_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        layout_create_info.setLayoutCount = bindless_set_count;
+        layout_create_info.pSetLayouts = _bindless.set_layouts.data();
+        layout_create_info.pushConstantRangeCount = 1;
+        layout_create_info.pPushConstantRanges = &push_constant_range;
+        DODO_ASSERT_VK_RESULT(vkCreatePipelineLayout(_device, &layout_create_info, VK_NULL_HANDLE, &_bindless.pipeline_layout));
+
+        DODO_LOG_INFO_TAG("Renderer", "Bindless sets hold {0} textures, {1} storage textures and {2} storage buffers.",
+            _bindless.texture_capacity, _bindless.storage_texture_capacity, _bindless.buffer_capacity);
+    }
 
-        };
+    void RenderDeviceVulkan::_bindless_texture_write(uint32_t index, const Texture& texture) {
+        const bool is_sampled = (texture.usage & texture_usage_sampled) != 0;
+        const bool is_storage = (texture.usage & texture_usage_storage) != 0;
+        if ((is_sampled && (index >= _bindless.texture_capacity)) || (is_storage && (index >= _bindless.storage_texture_capacity))) {
+            DODO_LOG_WARNING_TAG("Renderer", "Texture slot {0} is beyond the bindless capacity, the texture has no bindless index!", index);
+            return;
+        }
 
-        CommandQueue* command_queue = fence->command_queue_to_signal;
-        uint32_t i = 0;
-        while (i < semaphores_for_fences.size()) {
-            const std::pair<Fence*, uint32_t>& semaphore_for_fence = semaphores_for_fences.at(i);
-            if (fence == semaphore_for_fence.first) {
-                free_semaphores.push_back(semaphore_for_fence.second);
-                semaphores_for_fences.erase(semaphores_for_fences.begin() + i);
-            }
-            else {
-                i++;
-            }
+        // Sampled depth textures are read in the depth stencil read state.
+        VkDescriptorImageInfo sampled_image_info = {};
+        sampled_image_info.imageView = texture.vk_image_view;
+        sampled_image_info.imageLayout = ((texture.aspect & VK_IMAGE_ASPECT_DEPTH_BIT) != 0) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        VkDescriptorImageInfo storage_image_info = {};
+        storage_image_info.imageView = texture.vk_image_view;
+        storage_image_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        FixedVector<VkWriteDescriptorSet, 2> writes = {};
+        if (is_sampled) {
+            VkWriteDescriptorSet write = {};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = _bindless.sets.at(0);
+            write.dstArrayElement = index;
+            write.descriptorCount = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+            write.pImageInfo = &sampled_image_info;
+            writes.push_back(write);
         }
-        free_semaphores_for_fences(command_queue->image_semaphores_for_fences, command_queue->free_image_semaphores);
-        fence->command_queue_to_signal = nullptr;
-    }
 
-    void RenderDeviceVulkan::fence_destroy(FenceHandle fence) {
-        DODO_ASSERT(!fence.is_null());
-        if (VkFence* vk_fence = _fence_owner.get_or_null(fence)) {
-            vkDestroyFence(_device, vk_fence, VK_NULL_HANDLE);
-            _fence_owner.destroy(fence);
+        if (is_storage) {
+            VkWriteDescriptorSet write = {};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = _bindless.sets.at(1);
+            write.dstArrayElement = index;
+            write.descriptorCount = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            write.pImageInfo = &storage_image_info;
+            writes.push_back(write);
         }
-    }
 
-    SemaphoreHandle RenderDeviceVulkan::semaphore_create() {
-        VkSemaphoreCreateInfo create_info = {};
-        create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-        VkSemaphore vk_semaphore = VK_NULL_HANDLE;
-        DODO_ASSERT_VK_RESULT(vkCreateSemaphore(_device, &create_info, VK_NULL_HANDLE, &vk_semaphore));
-        return _semaphore_owner.create(vk_semaphore);
+        if (!writes.empty()) {
+            vkUpdateDescriptorSets(_device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+        }
     }
 
-    void RenderDeviceVulkan::semaphore_destroy(SemaphoreHandle semaphore) {
-        DODO_ASSERT(!semaphore.is_null());
-        if (VkSemaphore* vk_semaphore = _semaphore_owner.get_or_null(semaphore)) {
-            vkDestroySemaphore(_device, *vk_semaphore, VK_NULL_HANDLE);
-            _semaphore_owner.destroy(semaphore);
+    void RenderDeviceVulkan::_bindless_buffer_write(uint32_t index, const Buffer& buffer) {
+        if ((buffer.vk_usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT) == 0) {
+            return;
         }
+
+        if (index >= _bindless.buffer_capacity) {
+            DODO_LOG_WARNING_TAG("Renderer", "Buffer slot {0} is beyond the bindless capacity, the buffer has no bindless index!", index);
+            return;
+        }
+
+        VkDescriptorBufferInfo buffer_info = {};
+        buffer_info.buffer = buffer.vk_buffer;
+        buffer_info.range = VK_WHOLE_SIZE;
+        VkWriteDescriptorSet write = {};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = _bindless.sets.at(2);
+        write.dstArrayElement = index;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.pBufferInfo = &buffer_info;
+        vkUpdateDescriptorSets(_device, 1, &write, 0, nullptr);
     }
 
     SwapChainHandle RenderDeviceVulkan::swap_chain_create(SurfaceHandle p_surface) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::swap_chain_create");
         DODO_ASSERT(!p_surface.is_null());
         const RenderBackendVulkan::Functions& backend_functions = _backend->functions_get();
         RenderBackendVulkan::Surface* surface = _backend->surface_get(p_surface);
@@ -470,13 +2296,20 @@ namespace Dodo {
             return SwapChainHandle();
         }
 
-        uint32_t format_count = 0;
-        DODO_ASSERT_VK_RESULT(backend_functions.GetPhysicalDeviceSurfaceFormatsKHR(_physical_device, surface->vk_surface, &format_count, nullptr));
-        std::vector<VkSurfaceFormatKHR> formats(format_count);
-        DODO_ASSERT_VK_RESULT(backend_functions.GetPhysicalDeviceSurfaceFormatsKHR(_physical_device, surface->vk_surface, &format_count, formats.data()));
-
         const VkFormat desired_format = VK_FORMAT_B8G8R8A8_SRGB;
         const VkColorSpaceKHR desired_color_space = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+        std::vector<VkSurfaceFormatKHR> formats = {};
+        if (surface->vk_surface) {
+            uint32_t format_count = 0;
+            DODO_ASSERT_VK_RESULT(backend_functions.GetPhysicalDeviceSurfaceFormatsKHR(_physical_device, surface->vk_surface, &format_count, nullptr));
+            formats.resize(format_count);
+            DODO_ASSERT_VK_RESULT(backend_functions.GetPhysicalDeviceSurfaceFormatsKHR(_physical_device, surface->vk_surface, &format_count, formats.data()));
+        }
+        else {
+            // Offscreen surface, nothing is ever presented.
+            formats.push_back({ desired_format, desired_color_space });
+        }
+
         VkFormat picked_format = formats.back().format;
         VkColorSpaceKHR picked_color_space = formats.back().colorSpace;
         for (const VkSurfaceFormatKHR& format : formats) {
@@ -517,31 +2350,44 @@ namespace Dodo {
         swap_chain_info.format = picked_format;
         swap_chain_info.color_space = picked_color_space;
         swap_chain_info.render_pass = render_pass;
-        return _swap_chain_owner.create(swap_chain_info);
+        return _swap_chains.create(std::move(swap_chain_info));
     }
 
     FramebufferHandle RenderDeviceVulkan::swap_chain_acquire_next_framebuffer(CommandQueueHandle p_command_queue, SwapChainHandle p_swap_chain, SwapChainStatus& r_swap_chain_status) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::swap_chain_acquire_next_framebuffer");
         DODO_ASSERT(!p_command_queue.is_null());
         DODO_ASSERT(!p_swap_chain.is_null());
         CommandQueue* command_queue = _command_queues.get_or_null(p_command_queue);
-        SwapChain* swap_chain = _swap_chain_owner.get_or_null(p_swap_chain);
+        SwapChain* swap_chain = _swap_chains.get_or_null(p_swap_chain);
         if (!command_queue || !swap_chain) {
             r_swap_chain_status = SwapChainStatus::error;
             return FramebufferHandle();
         }
 
-        if ((swap_chain->vk_swap_chain == VK_NULL_HANDLE) && _backend->surface_get_needs_resize(swap_chain->surface)) {
+        const RenderBackendVulkan::Surface* surface = _backend->surface_get(swap_chain->surface);
+        if (surface && (surface->vk_surface == VK_NULL_HANDLE)) {
+            // Offscreen surfaces have no images, frames are submitted without a present.
+            r_swap_chain_status = SwapChainStatus::success;
+            return FramebufferHandle();
+        }
+
+        if ((swap_chain->vk_swap_chain == VK_NULL_HANDLE) || _backend->surface_get_needs_resize(swap_chain->surface)) {
             r_swap_chain_status = SwapChainStatus::out_of_date;
             return FramebufferHandle();
         }
 
+        if (command_queue->free_image_semaphores.empty()) {
+            _image_semaphores_reclaim(command_queue);
+        }
+
         uint32_t semaphore_index = 0;
         if (command_queue->free_image_semaphores.empty()) {
             VkSemaphoreCreateInfo create_info = {};
             create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
             VkSemaphore semaphore = VK_NULL_HANDLE;
             DODO_ASSERT_VK_RESULT(vkCreateSemaphore(_device, &create_info, VK_NULL_HANDLE, &semaphore));
-            semaphore_index = command_queue->image_semaphores.size();
+            DODO_METRIC_COUNTER_ADD("renderer.semaphores_created", 1);
+            semaphore_index = static_cast<uint32_t>(command_queue->image_semaphores.size());
             command_queue->image_semaphores.push_back(semaphore);
         }
         else {
@@ -551,43 +2397,54 @@ namespace Dodo {
 
         static const auto default_timeout = std::numeric_limits<uint64_t>::max();
         const VkResult result = _functions.AcquireNextImageKHR(_device, swap_chain->vk_swap_chain, default_timeout, command_queue->image_semaphores.at(semaphore_index), VK_NULL_HANDLE, &swap_chain->image_index);
-        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-            r_swap_chain_status = SwapChainStatus::out_of_date;
+        if ((result != VK_SUCCESS) && (result != VK_SUBOPTIMAL_KHR)) {
+            // A failed acquire leaves the semaphore unsignaled, it can be used again right away.
+            command_queue->free_image_semaphores.push_back(semaphore_index);
+            r_swap_chain_status = (result == VK_ERROR_OUT_OF_DATE_KHR) ? SwapChainStatus::out_of_date : SwapChainStatus::error;
             return FramebufferHandle();
         }
 
         r_swap_chain_status = SwapChainStatus::success;
-        if ((result != VK_SUCCESS) && (result != VK_SUBOPTIMAL_KHR)) {
-            r_swap_chain_status = SwapChainStatus::error;
-            return FramebufferHandle();
-        }
 
         command_queue->pending_image_semaphores.push_back(semaphore_index);
-        command_queue->pending_image_semaphores_for_fences.push_back(semaphore_index);
+        swap_chain->acquire_semaphore_index = semaphore_index;
 
-        return FramebufferHandle(swap_chain->framebuffers.at(swap_chain->image_index));
+        return FramebufferHandle(reinterpret_cast<uint64_t>(swap_chain->framebuffers.at(swap_chain->image_index)));
     }
 
-    void RenderDeviceVulkan::swap_chain_resize(CommandQueueHandle p_command_queue, SwapChainHandle p_swap_chain, uint32_t p_desired_framebuffer_count) {
+    void RenderDeviceVulkan::swap_chain_recreate_or_resize(CommandQueueHandle p_command_queue, SwapChainHandle p_swap_chain, uint32_t p_desired_framebuffer_count) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::swap_chain_recreate_or_resize");
+        DODO_ASSERT(!p_command_queue.is_null());
         DODO_ASSERT(!p_swap_chain.is_null());
-        SwapChain* swap_chain = _swap_chain_owner.get_or_null(p_swap_chain);
-        if (!swap_chain) {
+        CommandQueue* cmd_queue = _command_queues.get_or_null(p_command_queue);
+        SwapChain* swap_chain = _swap_chains.get_or_null(p_swap_chain);
+        RenderBackendVulkan::Surface* surface = swap_chain ? _backend->surface_get(swap_chain->surface) : nullptr;
+        if (!cmd_queue || !swap_chain || !surface) {
+            return;
+        }
+
+        if (surface->vk_surface == VK_NULL_HANDLE) {
+            surface->needs_resize = false;
             return;
         }
 
+        // Waiting for the device idles every queue, and presents use the swap chain being replaced.
+        std::unique_lock<std::mutex> lock(_submit_mutex);
+        DODO_ASSERT_VK_RESULT(vkDeviceWaitIdle(_device));
         _swap_chain_release(swap_chain);
+        DODO_METRIC_COUNTER_ADD("renderer.swap_chain_recreations", 1);
 
-        if (!_backend->queue_family_supports_present(_physical_device, cmd_queue->queue_family_index, swap_chain->surface_handle)) {
+        if (!_backend->queue_family_supports_present(_physical_device, cmd_queue->queue_family_index, swap_chain->surface)) {
             DODO_ASSERT(false);
             DODO_LOG_ERROR_TAG("Renderer", "Surface not supported by device!");
         }
 
-        const RenderContextVulkan::Functions& context_functions = _backend->functions_get();
-        auto surface = swap_chain->surface_handle.cast_to<RenderContextVulkan::Surface*>();
+        const RenderBackendVulkan::Functions& backend_functions = _backend->functions_get();
         VkSurfaceCapabilitiesKHR surface_caps = {};
-        DODO_ASSERT_VK_RESULT(context_functions.GetPhysicalDeviceSurfaceCapabilitiesKHR(_physical_device, surface->surface_vk, &surface_caps));
+        DODO_ASSERT_VK_RESULT(backend_functions.GetPhysicalDeviceSurfaceCapabilitiesKHR(_physical_device, surface->vk_surface, &surface_caps));
 
-        uint32_t picked_image_count = std::max(p_desired_framebuffer_count, surface_caps.minImageCount + 1);
+        // The desired count is honored down to the minimum, frames in flight are limited by the engine.
+        uint32_t picked_image_count = std::max(p_desired_framebuffer_count, surface_caps.minImageCount);
         // A max image count of 0 means we can have any number of images.
         if (surface_caps.maxImageCount > 0) {
             picked_image_count = std::min(picked_image_count, surface_caps.maxImageCount);
@@ -605,9 +2462,9 @@ namespace Dodo {
         }
 
         uint32_t present_mode_count = 0;
-        context_functions.GetPhysicalDeviceSurfacePresentModesKHR(_physical_device, surface->surface_vk, &present_mode_count, nullptr);
+        backend_functions.GetPhysicalDeviceSurfacePresentModesKHR(_physical_device, surface->vk_surface, &present_mode_count, nullptr);
         std::vector<VkPresentModeKHR> present_modes(present_mode_count);
-        context_functions.GetPhysicalDeviceSurfacePresentModesKHR(_physical_device, surface->surface_vk, &present_mode_count, present_modes.data());
+        backend_functions.GetPhysicalDeviceSurfacePresentModesKHR(_physical_device, surface->vk_surface, &present_mode_count, present_modes.data());
         const VkPresentModeKHR desired_present_mode = Utils::convert_to_present_mode(surface->vsync_mode);
         VkPresentModeKHR picked_present_mode = VK_PRESENT_MODE_FIFO_KHR;
         for (size_t i = 0; i < present_modes.size(); i++) {
@@ -619,7 +2476,7 @@ namespace Dodo {
 
         VkSwapchainCreateInfoKHR swap_chain_create_info = {};
         swap_chain_create_info.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
-        swap_chain_create_info.surface = surface->surface_vk;
+        swap_chain_create_info.surface = surface->vk_surface;
         swap_chain_create_info.minImageCount = picked_image_count;
         swap_chain_create_info.imageFormat = swap_chain->format;
         swap_chain_create_info.imageColorSpace = swap_chain->color_space;
@@ -668,12 +2525,28 @@ namespace Dodo {
             framebuffer_create_info.pAttachments = &swap_chain->image_views.at(i);
             DODO_ASSERT_VK_RESULT(vkCreateFramebuffer(_device, &framebuffer_create_info, nullptr, &swap_chain->framebuffers.at(i)));
         }
+
+        // Created up front, so submissions never create semaphores.
+        VkSemaphoreCreateInfo semaphore_create_info = {};
+        semaphore_create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        swap_chain->present_semaphores.resize(image_count);
+        for (size_t i = 0; i < swap_chain->present_semaphores.size(); i++) {
+            DODO_ASSERT_VK_RESULT(vkCreateSemaphore(_device, &semaphore_create_info, nullptr, &swap_chain->present_semaphores.at(i)));
+            DODO_METRIC_COUNTER_ADD("renderer.semaphores_created", 1);
+        }
+
+        swap_chain->framebuffer_count = image_count;
+        swap_chain->frame_index = 0;
+        _backend->surface_set_needs_resize(swap_chain->surface, false);
     }
 
     void RenderDeviceVulkan::swap_chain_destroy(SwapChainHandle p_swap_chain) {
+        DODO_PROFILE_SCOPE("RenderDeviceVulkan::swap_chain_destroy");
         DODO_ASSERT(!p_swap_chain.is_null());
-        if (SwapChain* swap_chain = _swap_chain_owner.get_or_null(p_swap_chain)) {
+        if (SwapChain* swap_chain = _swap_chains.get_or_null(p_swap_chain)) {
             _swap_chain_release(swap_chain);
+            vkDestroyRenderPass(_device, swap_chain->render_pass, nullptr);
+            _swap_chains.destroy(p_swap_chain);
         }
     }
 
@@ -689,8 +2562,17 @@ namespace Dodo {
 
         r_swap_chain->image_views.clear();
 
+        for (size_t i = 0; i < r_swap_chain->present_semaphores.size(); i++) {
+            vkDestroySemaphore(_device, r_swap_chain->present_semaphores.at(i), nullptr);
+        }
+
+        r_swap_chain->present_semaphores.clear();
+        // A pending acquire stays with its command queue, the next submission waits on it.
+        r_swap_chain->acquire_semaphore_index = UINT32_MAX;
+
         if (r_swap_chain->vk_swap_chain) {
             _functions.DestroySwapchainKHR(_device, r_swap_chain->vk_swap_chain, nullptr);
+            r_swap_chain->vk_swap_chain = VK_NULL_HANDLE;
         }
     }
 
@@ -3,6 +3,8 @@
 #ifdef DODO_VULKAN
 
 #include "vulkan_utils.h"
+#include "memory_allocator_vulkan.h"
+#include "core/fixed_vector.h"
 #include "renderer/render_device.h"
 
 namespace Dodo {
@@ -14,23 +16,57 @@ namespace Dodo {
     public:
         RenderDeviceVulkan(Ref<RenderBackendVulkan> p_backend);
 
-        void initialize(size_t index) override;
+        bool initialize(size_t index) override;
         CommandQueueFamilyHandle command_queue_family_get(CommandQueueFamilyType command_queue_family_type, SurfaceHandle surface) override;
         CommandQueueHandle command_queue_create(CommandQueueFamilyHandle command_queue_family) override;
-        void command_queue_execute_and_present(const SubmitSpecifications& submit_specs) override;
+        void command_queue_execute_and_present_batch(std::span<const SubmitSpecifications> submits) override;
         void command_queue_destroy(CommandQueueHandle command_queue) override;
         CommandPoolHandle command_pool_create(CommandQueueFamilyHandle command_queue_family) override;
         void command_pool_destroy(CommandPoolHandle command_pool) override;
+        void command_pool_reset(CommandPoolHandle command_pool) override;
         CommandBufferHandle command_buffer_create(CommandPoolHandle command_pool, CommandBufferType command_buffer_type) override;
         void command_buffer_begin(CommandBufferHandle command_buffer) override;
         void command_buffer_end(CommandBufferHandle command_buffer) override;
+        void command_buffer_execute_commands(CommandBufferHandle command_buffer, std::span<const CommandBufferHandle> secondary_command_buffers) override;
+        void command_buffer_destroy(CommandBufferHandle command_buffer) override;
         FenceHandle fence_create() override;
         void fence_wait(FenceHandle fence) override;
+        bool fence_is_signaled(FenceHandle fence) override;
         void fence_destroy(FenceHandle fence) override;
         SemaphoreHandle semaphore_create() override;
         void semaphore_destroy(SemaphoreHandle semaphore) override;
+        QueryPoolHandle timestamp_query_pool_create(uint32_t query_count) override;
+        void timestamp_query_pool_reset(CommandBufferHandle command_buffer, QueryPoolHandle query_pool) override;
+        void command_buffer_write_timestamp(CommandBufferHandle command_buffer, QueryPoolHandle query_pool, uint32_t query_index) override;
+        bool timestamp_query_pool_get_results(QueryPoolHandle query_pool, uint32_t query_count, uint64_t* r_timestamps) override;
+        void timestamp_query_pool_destroy(QueryPoolHandle query_pool) override;
+        BufferHandle buffer_create(const BufferSpecifications& buffer_specs) override;
+        void* buffer_get_mapped_data(BufferHandle buffer) override;
+        void buffer_destroy(BufferHandle buffer) override;
+        TextureHandle texture_create(const TextureSpecifications& texture_specs) override;
+        void texture_destroy(TextureHandle texture) override;
+        uint32_t texture_get_bindless_index(TextureHandle texture) override;
+        uint32_t buffer_get_bindless_index(BufferHandle buffer) override;
+        void texture_get_memory_requirements(const TextureSpecifications& texture_specs, MemoryRequirements& r_memory_requirements) override;
+        TextureHeapHandle texture_heap_create(uint64_t size, uint32_t memory_type_bits) override;
+        void texture_heap_destroy(TextureHeapHandle texture_heap) override;
+        TextureHandle texture_create_placed(const TextureSpecifications& texture_specs, TextureHeapHandle texture_heap, uint64_t offset) override;
+        void command_buffer_barrier(CommandBufferHandle command_buffer, std::span<const TextureBarrier> texture_barriers, std::span<const BufferBarrier> buffer_barriers, const MemoryBarrier& memory_barrier) override;
+        void command_buffer_copy_buffer(CommandBufferHandle command_buffer, BufferHandle src_buffer, uint64_t src_offset, BufferHandle dst_buffer, uint64_t dst_offset, uint64_t size) override;
+        void command_buffer_copy_buffer_to_texture(CommandBufferHandle command_buffer, BufferHandle src_buffer, uint64_t src_offset, TextureHandle dst_texture, uint32_t mip, uint32_t layer) override;
+        void memory_get_heap_statistics(std::vector<MemoryHeapStatistics>& r_heap_statistics) const override;
+        void metrics_update() const override;
+        uint64_t memory_defragment(CommandQueueHandle command_queue, uint64_t max_bytes_to_move) override;
+        PipelineHandle pipeline_create(const PipelineSpecifications& pipeline_specs) override;
+        PipelineStatus pipeline_get_status(PipelineHandle pipeline) override;
+        void pipeline_wait(PipelineHandle pipeline) override;
+        void pipeline_compilations_drain() override;
+        void pipeline_destroy(PipelineHandle pipeline) override;
+        bool command_buffer_bind_pipeline(CommandBufferHandle command_buffer, PipelineHandle pipeline, PipelineBindPolicy bind_policy) override;
+        void command_buffer_push_constants(CommandBufferHandle command_buffer, const void* data, uint32_t size, uint32_t offset = 0) override;
+        void pipeline_cache_save() override;
         SwapChainHandle swap_chain_create(SurfaceHandle surface) override;
-        FramebufferHandle swap_chain_acquire_next_framebuffer(SwapChainHandle swap_chain, SwapChainStatus& swap_chain_status) override;
+        FramebufferHandle swap_chain_acquire_next_framebuffer(CommandQueueHandle command_queue, SwapChainHandle swap_chain, SwapChainStatus& swap_chain_status) override;
         void swap_chain_recreate_or_resize(CommandQueueHandle command_queue, SwapChainHandle swap_chain, uint32_t desired_framebuffer_count = 3) override;
         void swap_chain_destroy(SwapChainHandle p_swap_chain) override;
 
@@ -41,6 +77,7 @@ namespace Dodo {
             PFN_vkAcquireNextImageKHR AcquireNextImageKHR = nullptr;
             PFN_vkQueuePresentKHR QueuePresentKHR = nullptr;
             PFN_vkDestroySwapchainKHR DestroySwapchainKHR = nullptr;
+            PFN_vkGetCalibratedTimestampsEXT GetCalibratedTimestampsEXT = nullptr;
         };
 
         struct Queue {
@@ -51,23 +88,45 @@ namespace Dodo {
         };
 
         void _add_queue_create_infos(std::vector<VkDeviceQueueCreateInfo>& queue_create_infos);
-        void _initialize_device(std::vector<VkDeviceQueueCreateInfo>& queue_create_infos);
+        bool _initialize_device(std::vector<VkDeviceQueueCreateInfo>& queue_create_infos);
         void _request_extension(const std::string& name, bool is_required);
+        bool _is_extension_enabled(const std::string& name) const;
 
         Ref<RenderBackendVulkan> _backend = nullptr;
         VkPhysicalDevice _physical_device = nullptr;
+        VkPhysicalDeviceProperties _physical_device_properties = {};
         std::vector<VkQueueFamilyProperties> _queue_families = {};
         std::map<std::string, bool> _requested_extensions = {};
         std::vector<const char*> _enabled_extensions = {};
         VkDevice _device = nullptr;
         std::vector<std::vector<Queue>> _queues = {};
         Functions _functions = {};
+        // Queues may be shared between command queues submitted from different threads.
+        std::mutex _submit_mutex = {};
+        // Resources are shared concurrently between these families, e.g. uploads on a transfer only family.
+        std::vector<uint32_t> _resource_queue_family_indices = {};
+        MemoryAllocatorVulkan _memory_allocator = {};
 
     public:
         // ---- COMMAND QUEUE ----
 
     private:
-        struct Fence;
+        struct CommandQueue {
+            uint32_t queue_family_index = 0;
+            uint32_t queue_index = 0;
+            // Every submission waits on the previous value and signals the next one, fences are points on it.
+            VkSemaphore timeline_semaphore = VK_NULL_HANDLE;
+            uint64_t timeline_value = 0;
+            // Binary semaphores are only left for swap chain acquires. They are recycled once the
+            // timeline passed the value of the submission that waited on them.
+            std::vector<VkSemaphore> image_semaphores = {};
+            std::vector<uint32_t> free_image_semaphores = {};
+            std::vector<uint32_t> pending_image_semaphores = {};
+            std::vector<std::pair<uint64_t, uint32_t>> image_semaphores_in_flight = {};
+        };
+
+        VkSemaphore _vk_timeline_semaphore_create() const;
+        void _image_semaphores_reclaim(CommandQueue* r_command_queue) const;
 
         RenderHandlePool<CommandQueueHandle, CommandQueue> _command_queues = {};
 
@@ -75,7 +134,7 @@ namespace Dodo {
         // ---- COMMAND POOL ----
 
     private:
-        RenderHandlePool<CommandPoolHandle, VkCommandPool> _command_pool_owner = {};
+        RenderHandlePool<CommandPoolHandle, VkCommandPool> _command_pools = {};
 
     public:
         // ---- COMMAND BUFFER ----
@@ -83,7 +142,10 @@ namespace Dodo {
     private:
         struct CommandBuffer {
             CommandBufferType command_buffer_type = CommandBufferType::primary;
+            VkCommandPool vk_command_pool = VK_NULL_HANDLE;
             VkCommandBuffer vk_command_buffer = VK_NULL_HANDLE;
+            // Bind points the bindless sets are bound to since the command buffer began, one bit per VkPipelineBindPoint.
+            uint32_t bindless_bind_points = 0;
         };
 
         RenderHandlePool<CommandBufferHandle, CommandBuffer> _command_buffers = {};
@@ -92,37 +154,170 @@ namespace Dodo {
         // ---- FENCE ----
 
     private:
+        // The timeline point of the last submission the fence was passed to, zero before the first one.
         struct Fence {
-            VkFence vk_fence = VK_NULL_HANDLE;
-            CommandQueue* command_queue_to_signal = nullptr;
+            CommandQueueHandle command_queue = {};
+            uint64_t value = 0;
         };
 
         RenderHandlePool<FenceHandle, Fence> _fences = {};
-        RenderHandlePool<SemaphoreHandle, VkSemaphore> _semaphores = {};
 
     public:
         // ---- SEMAPHORE ----
 
     private:
+        // Timeline semaphore, every signal advances the value and waits are for the last signaled value.
+        struct Semaphore {
+            VkSemaphore vk_semaphore = VK_NULL_HANDLE;
+            uint64_t value = 0;
+        };
+
+        RenderHandlePool<SemaphoreHandle, Semaphore> _semaphores = {};
 
     public:
-        // ---- SWAP CHAIN ----
+        // ---- QUERY POOL ----
 
     private:
-        struct CommandQueue {
-            uint32_t queue_family_index = 0;
-            uint32_t queue_index = 0;
-            std::vector<VkSemaphore> image_semaphores = {};
-            std::vector<uint32_t> free_image_semaphores = {};
-            std::vector<uint32_t> pending_image_semaphores = {};
-            std::vector<uint32_t> pending_image_semaphores_for_fences = {};
-            std::vector<std::pair<VkFence, uint32_t>> image_semaphores_for_fences = {};
-            std::vector<VkSemaphore> command_semaphores = {};
-            std::vector<uint32_t> free_command_semaphores = {};
-            std::vector<uint32_t> pending_command_semaphores = {};
-            std::vector<uint32_t> pending_command_semaphores_for_fences = {};
-            std::vector<std::pair<VkFence, uint32_t>> command_semaphores_for_fences = {};
+        struct QueryPool {
+            VkQueryPool vk_query_pool = VK_NULL_HANDLE;
+            uint32_t query_count = 0;
+        };
+
+        // Pairs a device timestamp with the Timer ticks at the same moment.
+        struct TimestampCalibration {
+            bool is_valid = false;
+            bool has_host_time_domain = false;
+            // Timestamps only have timestampValidBits meaningful bits, the rest is undefined.
+            uint64_t valid_mask = UINT64_MAX;
+            uint64_t gpu_timestamp = 0;
+            uint64_t cpu_ticks = 0;
+            uint64_t calibrated_at = 0;
+        };
+
+        void _calibrate_timestamps();
+        uint64_t _convert_gpu_timestamp(uint64_t gpu_timestamp) const;
+
+        RenderHandlePool<QueryPoolHandle, QueryPool> _query_pools = {};
+        TimestampCalibration _timestamp_calibration = {};
+        std::vector<uint64_t> _query_results = {};
+
+    public:
+        // ---- BUFFER ----
+
+    private:
+        struct Buffer {
+            VkBuffer vk_buffer = VK_NULL_HANDLE;
+            VkBufferUsageFlags vk_usage = 0;
+            uint64_t size = 0;
+            MemoryAllocationHandle allocation = {};
+        };
+
+        VkBuffer _vk_buffer_create(uint64_t size, VkBufferUsageFlags vk_usage) const;
+
+        RenderHandlePool<BufferHandle, Buffer> _buffers = {};
+
+    public:
+        // ---- TEXTURE ----
+
+    private:
+        struct Texture {
+            VkImage vk_image = VK_NULL_HANDLE;
+            VkImageView vk_image_view = VK_NULL_HANDLE;
+            VkFormat format = VK_FORMAT_UNDEFINED;
+            VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+            uint32_t usage = 0;
+            VkExtent3D extent = {};
+            uint32_t mip_count = 1;
+            uint32_t layer_count = 1;
+            // Null for textures placed in a texture heap.
+            MemoryAllocationHandle allocation = {};
+        };
+
+        // One linear pool allocation spanning the whole pool, textures are bound at offsets into it.
+        struct TextureHeap {
+            LinearMemoryPoolHandle linear_pool = {};
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkDeviceSize offset = 0;
+            VkDeviceSize size = 0;
+            uint32_t memory_type_index = 0;
+        };
+
+        bool _vk_image_create(const TextureSpecifications& texture_specs, Texture& r_texture) const;
+        void _vk_image_view_create(const TextureSpecifications& texture_specs, Texture& r_texture) const;
+
+        RenderHandlePool<TextureHandle, Texture> _textures = {};
+        RenderHandlePool<TextureHeapHandle, TextureHeap> _texture_heaps = {};
+
+    public:
+        // ---- PIPELINE ----
+
+    private:
+        // Shared with the compile job, which may outlive the pipeline's place in the handle pool.
+        struct PipelineCompilation {
+            PipelineSpecifications specs = {};
+            // Set by whoever compiles, a worker or a thread waiting for the pipeline.
+            std::atomic<bool> is_claimed = false;
+            std::atomic<PipelineStatus> status = PipelineStatus::compiling;
+            VkPipeline vk_pipeline = VK_NULL_HANDLE;
+            VkPipelineBindPoint vk_bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        };
+
+        struct Pipeline {
+            std::shared_ptr<PipelineCompilation> compilation = nullptr;
+            // The map is keyed on the hash of the state key, the key itself only resolves collisions.
+            size_t state_hash = 0;
+            std::string state_key = {};
+            uint32_t reference_count = 0;
+            PipelineHandle fallback = {};
         };
+
+        void _pipeline_cache_load();
+        void _pipeline_compile(PipelineCompilation& r_compilation);
+        // Compiles on the calling thread when no worker claimed the compilation yet.
+        void _pipeline_compilation_wait(PipelineCompilation& r_compilation);
+        // Keeps the compilation alive while the caller uses it, even when the pipeline is destroyed meanwhile.
+        std::shared_ptr<PipelineCompilation> _pipeline_compilation_get(PipelineHandle pipeline);
+        VkRenderPass _compatible_render_pass_get(const PipelineSpecifications& pipeline_specs);
+
+        // Guards the pipeline pool and its index, pipelines are bound on recording threads.
+        std::mutex _pipeline_mutex = {};
+        RenderHandlePool<PipelineHandle, Pipeline> _pipelines = {};
+        std::unordered_multimap<size_t, PipelineHandle> _pipelines_by_state = {};
+        VkPipelineCache _pipeline_cache = VK_NULL_HANDLE;
+        // Render passes that only describe attachment formats, pipelines compile against them.
+        std::unordered_map<std::string, VkRenderPass> _compatible_render_passes = {};
+        std::mutex _compatible_render_pass_mutex = {};
+
+    public:
+        // ---- BINDLESS ----
+
+    private:
+        static constexpr uint32_t bindless_set_count = 3;
+
+        // Update after bind sets, one per descriptor type, whose slots are the indices of the handle pools.
+        // Descriptors are written when a resource is created, slots of destroyed resources are left stale.
+        struct Bindless {
+            VkDescriptorPool descriptor_pool = VK_NULL_HANDLE;
+            std::array<VkDescriptorSetLayout, bindless_set_count> set_layouts = {};
+            std::array<VkDescriptorSet, bindless_set_count> sets = {};
+            std::array<VkSampler, bindless_sampler_count> samplers = {};
+            VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
+            uint32_t texture_capacity = 0;
+            uint32_t storage_texture_capacity = 0;
+            uint32_t buffer_capacity = 0;
+        };
+
+        void _bindless_initialize();
+        // Rewrites the descriptors of a slot, the GPU must be done with the resource that used it before.
+        void _bindless_texture_write(uint32_t index, const Texture& texture);
+        void _bindless_buffer_write(uint32_t index, const Buffer& buffer);
+
+        Bindless _bindless = {};
+
+    public:
+        // ---- SWAP CHAIN ----
+
+    private:
         struct SwapChain {
             SurfaceHandle surface = {};
             VkFormat format = VK_FORMAT_UNDEFINED;
@@ -134,9 +329,10 @@ namespace Dodo {
             std::vector<VkImageView> image_views = {};
             std::vector<VkFramebuffer> framebuffers = {};
             uint32_t image_index = 0;
-            std::vector<VkFence> wait_fences = {};
             std::vector<VkSemaphore> present_semaphores = {};
             uint32_t frame_index = 0;
+            // Image semaphore of the command queue that signals the last acquire, until a submission waits on it.
+            uint32_t acquire_semaphore_index = UINT32_MAX;
         };
 
         void _swap_chain_release(SwapChain* r_swap_chain) const;
@@ -1,13 +1,12 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
-#include <vma/vk_mem_alloc.h>
 
 #ifndef DODO_VERIFY_VK_RESULT
 #   ifdef DODO_DEBUG
 #       define DODO_ASSERT_VK_RESULT(VK_RESULT) DODO_ASSERT((VK_RESULT) == VK_SUCCESS)
 #   else
-#       define DODO_ASSERT_VK_RESULT(...)
+#       define DODO_ASSERT_VK_RESULT(VK_RESULT) (void)(VK_RESULT)
 #   endif
 #endif
 
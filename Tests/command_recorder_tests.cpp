@@ -0,0 +1,121 @@
+#include "pch.h"
+#include "test.h"
+#include "mock_render_device.h"
+
+#include "renderer/command_recorder.h"
+
+namespace Dodo {
+
+    namespace Utils {
+
+        // Jobs that note which command buffer recorded them, in any thread.
+        struct JobLog {
+            std::mutex mutex = {};
+            std::unordered_map<uint64_t, uint32_t> job_indices = {};
+
+            std::vector<CommandRecorder::Job> jobs_make(uint32_t job_count) {
+                std::vector<CommandRecorder::Job> jobs = {};
+                for (uint32_t i = 0; i < job_count; i++) {
+                    jobs.push_back([this, i](CommandBufferHandle command_buffer) {
+                        // Uneven job lengths shuffle the order in which the threads finish.
+                        std::this_thread::sleep_for(std::chrono::microseconds(((i * 7) % 5) * 200));
+                        std::unique_lock<std::mutex> lock(mutex);
+                        job_indices[command_buffer.get_id()] = i;
+                    });
+                }
+
+                return jobs;
+            }
+        };
+
+    }
+
+    DODO_TEST(command_recorder, executes_secondaries_in_job_order) {
+        ThreadPool thread_pool = {};
+        Ref<MockRenderDevice> device = Ref<MockRenderDevice>::create();
+        CommandRecorder recorder = {};
+        recorder.initialize(device, {}, 2, thread_pool.thread_count_get(), 16);
+
+        Utils::JobLog job_log = {};
+        const std::vector<CommandRecorder::Job> jobs = job_log.jobs_make(12);
+        recorder.begin_frame(0);
+        recorder.record(thread_pool, CommandBufferHandle(1000), jobs);
+
+        const MockRenderDevice::Calls calls = device->calls_get();
+        DODO_EXPECT(calls.executed_commands.size() == 1);
+        DODO_EXPECT(calls.executed_commands.front().size() == jobs.size());
+        DODO_EXPECT(job_log.job_indices.size() == jobs.size());
+        for (uint32_t i = 0; i < calls.executed_commands.front().size(); i++) {
+            const uint64_t command_buffer = calls.executed_commands.front()[i].get_id();
+            DODO_EXPECT(job_log.job_indices.at(command_buffer) == i);
+            DODO_EXPECT(calls.recorded_command_buffers.at(command_buffer) == 1);
+            DODO_EXPECT(calls.open_command_buffers.at(command_buffer) == 0);
+        }
+    }
+
+    DODO_TEST(command_recorder, drops_jobs_beyond_the_maximum) {
+        ThreadPool thread_pool = {};
+        Ref<MockRenderDevice> device = Ref<MockRenderDevice>::create();
+        CommandRecorder recorder = {};
+        recorder.initialize(device, {}, 1, thread_pool.thread_count_get(), 4);
+
+        Utils::JobLog job_log = {};
+        const std::vector<CommandRecorder::Job> jobs = job_log.jobs_make(3);
+        recorder.begin_frame(0);
+        recorder.record(thread_pool, CommandBufferHandle(1000), jobs);
+        recorder.record(thread_pool, CommandBufferHandle(1000), jobs);
+
+        // The second record only fits one more job.
+        const MockRenderDevice::Calls calls = device->calls_get();
+        DODO_EXPECT(calls.executed_commands.size() == 2);
+        DODO_EXPECT(calls.executed_commands.back().size() == 1);
+        DODO_EXPECT(job_log.job_indices.size() == 4);
+
+        recorder.record(thread_pool, CommandBufferHandle(1000), jobs);
+        DODO_EXPECT(device->calls_get().executed_commands.size() == 2);
+    }
+
+    DODO_TEST(command_recorder, resets_only_pools_of_the_frame) {
+        ThreadPool thread_pool = {};
+        Ref<MockRenderDevice> device = Ref<MockRenderDevice>::create();
+        CommandRecorder recorder = {};
+        recorder.initialize(device, {}, 2, thread_pool.thread_count_get(), 16);
+
+        Utils::JobLog job_log = {};
+        const std::vector<CommandRecorder::Job> jobs = job_log.jobs_make(4);
+        recorder.begin_frame(0);
+        recorder.record(thread_pool, CommandBufferHandle(1000), jobs);
+
+        recorder.begin_frame(1);
+        DODO_EXPECT(device->calls_get().command_pool_reset_count == 0);
+        recorder.record(thread_pool, CommandBufferHandle(1000), jobs);
+
+        // Frame 1 recorded into its own command buffers.
+        MockRenderDevice::Calls calls = device->calls_get();
+        for (const CommandBufferHandle& command_buffer : calls.executed_commands.back()) {
+            const auto& first_frame = calls.executed_commands.front();
+            DODO_EXPECT(std::find(first_frame.begin(), first_frame.end(), command_buffer) == first_frame.end());
+        }
+
+        recorder.begin_frame(0);
+        calls = device->calls_get();
+        DODO_EXPECT(calls.command_pool_reset_count > 0);
+        DODO_EXPECT(calls.command_pool_reset_count <= std::min<uint32_t>(4, thread_pool.thread_count_get() + 1));
+    }
+
+    DODO_TEST(command_recorder, de_initialize_destroys_what_it_created) {
+        ThreadPool thread_pool = {};
+        Ref<MockRenderDevice> device = Ref<MockRenderDevice>::create();
+        {
+            CommandRecorder recorder = {};
+            recorder.initialize(device, {}, 3, thread_pool.thread_count_get(), 8);
+        }
+
+        const MockRenderDevice::Calls calls = device->calls_get();
+        DODO_EXPECT(calls.command_pool_create_count == (3 * (thread_pool.thread_count_get() + 1)));
+        DODO_EXPECT(calls.command_pool_destroy_count == calls.command_pool_create_count);
+        DODO_EXPECT(calls.command_buffer_create_count == (calls.command_pool_create_count * 8));
+        DODO_EXPECT(calls.command_buffer_destroy_count == calls.command_buffer_create_count);
+    }
+
+}
@@ -0,0 +1,92 @@
+#include "pch.h"
+#include "test.h"
+
+#include "core/fixed_vector.h"
+
+namespace Dodo {
+
+    namespace Utils {
+
+        // Counts live instances, so the tests see exactly which elements a vector constructed.
+        struct Counted {
+            static inline int32_t s_live_count = 0;
+
+            Counted(uint32_t value = 0) : value(value) { s_live_count++; }
+            Counted(const Counted& other) : value(other.value) { s_live_count++; }
+            Counted& operator=(const Counted& other) = default;
+            ~Counted() { s_live_count--; }
+
+            uint32_t value = 0;
+        };
+
+    }
+
+    DODO_TEST(fixed_vector, constructs_only_pushed_elements) {
+        {
+            FixedVector<Utils::Counted, 16> values = {};
+            DODO_EXPECT(Utils::Counted::s_live_count == 0);
+
+            values.push_back(Utils::Counted(1));
+            values.emplace_back(2u);
+            DODO_EXPECT(Utils::Counted::s_live_count == 2);
+            DODO_EXPECT((values.size() == 2) && (values[0].value == 1) && (values[1].value == 2));
+
+            values.clear();
+            DODO_EXPECT(values.empty());
+            DODO_EXPECT(Utils::Counted::s_live_count == 0);
+
+            values.emplace_back(3u);
+        }
+
+        DODO_EXPECT(Utils::Counted::s_live_count == 0);
+    }
+
+    DODO_TEST(fixed_vector, copies_elements) {
+        {
+            FixedVector<Utils::Counted, 4> values = {};
+            values.emplace_back(1u);
+            values.emplace_back(2u);
+
+            FixedVector<Utils::Counted, 4> copy = values;
+            DODO_EXPECT((copy.size() == 2) && (copy[0].value == 1) && (copy[1].value == 2));
+
+            FixedVector<Utils::Counted, 4> assigned = {};
+            assigned.emplace_back(7u);
+            assigned.emplace_back(8u);
+            assigned.emplace_back(9u);
+            assigned = values;
+            DODO_EXPECT((assigned.size() == 2) && (assigned[1].value == 2));
+            DODO_EXPECT(Utils::Counted::s_live_count == 6);
+        }
+
+        DODO_EXPECT(Utils::Counted::s_live_count == 0);
+    }
+
+    DODO_TEST(fixed_vector, append_stops_at_capacity) {
+        FixedVector<uint32_t, 4> values = {};
+        const std::array<uint32_t, 3> first = { 1, 2, 3 };
+        const std::array<uint32_t, 3> second = { 4, 5, 6 };
+
+        DODO_EXPECT(values.append(first));
+        DODO_EXPECT(!values.append(second));
+        DODO_EXPECT(values.full());
+
+        const std::span<const uint32_t> span = values;
+        DODO_EXPECT((span.size() == 4) && (span[3] == 4));
+    }
+
+    DODO_TEST(fixed_vector, holds_types_without_default_constructor) {
+        struct Pair {
+            Pair(uint32_t first, uint32_t second) : first(first), second(second) {}
+
+            uint32_t first = 0;
+            uint32_t second = 0;
+        };
+
+        FixedVector<Pair, 2> pairs = {};
+        const Pair& pair = pairs.emplace_back(1u, 2u);
+        DODO_EXPECT((pair.first == 1) && (pair.second == 2));
+        DODO_EXPECT(&pair == pairs.begin());
+    }
+
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "renderer/render_device.h"
+
+namespace Dodo {
+
+    // Records what the renderer asks of a device without any GPU behind it. Handles are unique
+    // counters, textures need 4 bytes per texel aligned to 256 bytes. Thread safe, so command
+    // buffers may be recorded from the thread pool.
+    class MockRenderDevice : public RenderDevice {
+    public:
+        struct Barrier {
+            CommandBufferHandle command_buffer = {};
+            std::vector<TextureBarrier> texture_barriers = {};
+            std::vector<BufferBarrier> buffer_barriers = {};
+            MemoryBarrier memory_barrier = {};
+        };
+
+        struct PlacedTexture {
+            TextureHandle texture = {};
+            TextureHeapHandle texture_heap = {};
+            uint64_t offset = 0;
+            uint64_t size = 0;
+        };
+
+        struct Calls {
+            uint32_t command_pool_create_count = 0;
+            uint32_t command_pool_destroy_count = 0;
+            uint32_t command_pool_reset_count = 0;
+            uint32_t command_buffer_create_count = 0;
+            uint32_t command_buffer_destroy_count = 0;
+            // Per command buffer id, begin adds one and end removes it again.
+            std::unordered_map<uint64_t, int32_t> open_command_buffers = {};
+            std::unordered_map<uint64_t, uint32_t> recorded_command_buffers = {};
+            std::vector<std::vector<CommandBufferHandle>> executed_commands = {};
+            std::vector<Barrier> barriers = {};
+            uint32_t texture_create_count = 0;
+            uint32_t texture_destroy_count = 0;
+            std::vector<PlacedTexture> placed_textures = {};
+            std::vector<uint64_t> texture_heap_sizes = {};
+            uint32_t texture_heap_destroy_count = 0;
+        };
+
+        static constexpr uint64_t texture_alignment = 256;
+
+        // Copies, so the caller does not race with recording threads.
+        Calls calls_get() const {
+            std::unique_lock<std::mutex> lock(_mutex);
+            return _calls;
+        }
+
+        static uint64_t texture_size_get(const TextureSpecifications& texture_specs) {
+            const uint64_t size = uint64_t(texture_specs.width) * texture_specs.height * texture_specs.depth * texture_specs.layer_count * 4;
+            return (size + texture_alignment - 1) & ~(texture_alignment - 1);
+        }
+
+        bool initialize(size_t) override { return true; }
+        CommandQueueFamilyHandle command_queue_family_get(CommandQueueFamilyType, SurfaceHandle) override { return _handle_make(); }
+        CommandQueueHandle command_queue_create(CommandQueueFamilyHandle) override { return _handle_make(); }
+        void command_queue_execute_and_present_batch(std::span<const SubmitSpecifications>) override {}
+        void command_queue_destroy(CommandQueueHandle) override {}
+
+        CommandPoolHandle command_pool_create(CommandQueueFamilyHandle) override {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _calls.command_pool_create_count++;
+            return ++_next_id;
+        }
+
+        void command_pool_destroy(CommandPoolHandle) override {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _calls.command_pool_destroy_count++;
+        }
+
+        void command_pool_reset(CommandPoolHandle) override {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _calls.command_pool_reset_count++;
+        }
+
+        CommandBufferHandle command_buffer_create(CommandPoolHandle, CommandBufferType) override {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _calls.command_buffer_create_count++;
+            return ++_next_id;
+        }
+
+        void command_buffer_begin(CommandBufferHandle command_buffer) override {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _calls.open_command_buffers[command_buffer.get_id()]++;
+        }
+
+        void command_buffer_end(CommandBufferHandle command_buffer) override {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _calls.open_command_buffers[command_buffer.get_id()]--;
+            _calls.recorded_command_buffers[command_buffer.get_id()]++;
+        }
+
+        void command_buffer_execute_commands(CommandBufferHandle, std::span<const CommandBufferHandle> secondary_command_buffers) override {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _calls.executed_commands.emplace_back(secondary_command_buffers.begin(), secondary_command_buffers.end());
+        }
+
+        void command_buffer_destroy(CommandBufferHandle) override {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _calls.command_buffer_destroy_count++;
+        }
+
+        FenceHandle fence_create() override { return _handle_make(); }
+        void fence_wait(FenceHandle) override {}
+        bool fence_is_signaled(FenceHandle) override { return true; }
+        void fence_destroy(FenceHandle) override {}
+        SemaphoreHandle semaphore_create() override { return _handle_make(); }
+        void semaphore_destroy(SemaphoreHandle) override {}
+        QueryPoolHandle timestamp_query_pool_create(uint32_t) override { return _handle_make(); }
+        void timestamp_query_pool_reset(CommandBufferHandle, QueryPoolHandle) override {}
+        void command_buffer_write_timestamp(CommandBufferHandle, QueryPoolHandle, uint32_t) override {}
+        bool timestamp_query_pool_get_results(QueryPoolHandle, uint32_t, uint64_t*) override { return false; }
+        void timestamp_query_pool_destroy(QueryPoolHandle) override {}
+        BufferHandle buffer_create(const BufferSpecifications&) override { return _handle_make(); }
+        void* buffer_get_mapped_data(BufferHandle) override { return nullptr; }
+        void buffer_destroy(BufferHandle) override {}
+
+        TextureHandle texture_create(const TextureSpecifications&) override {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _calls.texture_create_count++;
+            return ++_next_id;
+        }
+
+        void texture_destroy(TextureHandle) override {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _calls.texture_destroy_count++;
+        }
+
+        uint32_t texture_get_bindless_index(TextureHandle) override { return invalid_bindless_index; }
+        uint32_t buffer_get_bindless_index(BufferHandle) override { return invalid_bindless_index; }
+
+        void texture_get_memory_requirements(const TextureSpecifications& texture_specs, MemoryRequirements& r_memory_requirements) override {
+            r_memory_requirements = { texture_size_get(texture_specs), texture_alignment, 1 };
+        }
+
+        TextureHeapHandle texture_heap_create(uint64_t size, uint32_t) override {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _calls.texture_heap_sizes.push_back(size);
+            return ++_next_id;
+        }
+
+        void texture_heap_destroy(TextureHeapHandle) override {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _calls.texture_heap_destroy_count++;
+        }
+
+        TextureHandle texture_create_placed(const TextureSpecifications& texture_specs, TextureHeapHandle texture_heap, uint64_t offset) override {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _calls.texture_create_count++;
+            const TextureHandle texture = ++_next_id;
+            _calls.placed_textures.push_back({ texture, texture_heap, offset, texture_size_get(texture_specs) });
+            return texture;
+        }
+
+        void command_buffer_barrier(CommandBufferHandle command_buffer, std::span<const TextureBarrier> texture_barriers, std::span<const BufferBarrier> buffer_barriers, const MemoryBarrier& memory_barrier) override {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _calls.barriers.push_back({ command_buffer, { texture_barriers.begin(), texture_barriers.end() }, { buffer_barriers.begin(), buffer_barriers.end() }, memory_barrier });
+        }
+
+        void command_buffer_copy_buffer(CommandBufferHandle, BufferHandle, uint64_t, BufferHandle, uint64_t, uint64_t) override {}
+        void command_buffer_copy_buffer_to_texture(CommandBufferHandle, BufferHandle, uint64_t, TextureHandle, uint32_t, uint32_t) override {}
+        void memory_get_heap_statistics(std::vector<MemoryHeapStatistics>& r_heap_statistics) const override { r_heap_statistics.clear(); }
+        void metrics_update() const override {}
+        uint64_t memory_defragment(CommandQueueHandle, uint64_t) override { return 0; }
+        PipelineHandle pipeline_create(const PipelineSpecifications&) override { return _handle_make(); }
+        PipelineStatus pipeline_get_status(PipelineHandle) override { return PipelineStatus::ready; }
+        void pipeline_wait(PipelineHandle) override {}
+        void pipeline_compilations_drain() override {}
+        void pipeline_destroy(PipelineHandle) override {}
+        bool command_buffer_bind_pipeline(CommandBufferHandle, PipelineHandle, PipelineBindPolicy) override { return true; }
+        void command_buffer_push_constants(CommandBufferHandle, const void*, uint32_t, uint32_t) override {}
+        void pipeline_cache_save() override {}
+        SwapChainHandle swap_chain_create(SurfaceHandle) override { return _handle_make(); }
+
+        FramebufferHandle swap_chain_acquire_next_framebuffer(CommandQueueHandle, SwapChainHandle, SwapChainStatus& swap_chain_status) override {
+            swap_chain_status = SwapChainStatus::error;
+            return {};
+        }
+
+        void swap_chain_recreate_or_resize(CommandQueueHandle, SwapChainHandle, uint32_t) override {}
+        void swap_chain_destroy(SwapChainHandle) override {}
+
+    private:
+        uint64_t _handle_make() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            return ++_next_id;
+        }
+
+        mutable std::mutex _mutex = {};
+        uint64_t _next_id = 0;
+        Calls _calls = {};
+    };
+
+}
@@ -0,0 +1,101 @@
+#include "pch.h"
+#include "test.h"
+
+#include "renderer/pipeline_state.h"
+
+namespace Dodo {
+
+    namespace Utils {
+
+        static RenderDevice::PipelineSpecifications pipeline_specs_make() {
+            RenderDevice::PipelineSpecifications specs = {};
+            specs.shaders.push_back({ RenderDevice::ShaderStage::vertex, { 0x07230203, 1, 2, 3 }, "main" });
+            specs.shaders.push_back({ RenderDevice::ShaderStage::fragment, { 0x07230203, 4, 5, 6 }, "main" });
+            specs.vertex_bindings.push_back({ 0, 32, false });
+            specs.vertex_attributes.push_back({ 0, 0, RenderDevice::VertexFormat::float3, 0 });
+            specs.vertex_attributes.push_back({ 1, 0, RenderDevice::VertexFormat::float2, 12 });
+            specs.color_formats.push_back(RenderDevice::TextureFormat::bgra8_srgb);
+            specs.has_depth_stencil = true;
+            specs.is_depth_test_enabled = true;
+            specs.push_constant_size = 16;
+            return specs;
+        }
+
+    }
+
+    using Status = RenderDevice::PipelineStatus;
+    using Policy = RenderDevice::PipelineBindPolicy;
+    using BindAction = PipelineState::BindAction;
+
+    DODO_TEST(pipeline_state, equal_states_share_a_key) {
+        RenderDevice::PipelineSpecifications specs = Utils::pipeline_specs_make();
+        RenderDevice::PipelineSpecifications other_specs = Utils::pipeline_specs_make();
+        DODO_EXPECT(PipelineState::key_make(specs) == PipelineState::key_make(other_specs));
+
+        // The fallback is bound instead of the pipeline, it does not change the pipeline itself.
+        other_specs.fallback = PipelineHandle(42);
+        DODO_EXPECT(PipelineState::key_make(specs) == PipelineState::key_make(other_specs));
+    }
+
+    DODO_TEST(pipeline_state, key_does_not_hold_the_spirv) {
+        RenderDevice::PipelineSpecifications specs = Utils::pipeline_specs_make();
+        const size_t key_size = PipelineState::key_make(specs).size();
+        specs.shaders[0].spirv.resize(64 * 1024, 0x12345678);
+        DODO_EXPECT(PipelineState::key_make(specs).size() == key_size);
+    }
+
+    DODO_TEST(pipeline_state, every_field_changes_the_key) {
+        const RenderDevice::PipelineSpecifications specs = Utils::pipeline_specs_make();
+        const std::string key = PipelineState::key_make(specs);
+        const std::vector<std::function<void(RenderDevice::PipelineSpecifications&)>> changes = {
+            [](RenderDevice::PipelineSpecifications& r_specs) { r_specs.shaders[1].spirv.back()++; },
+            [](RenderDevice::PipelineSpecifications& r_specs) { r_specs.shaders[0].entry_point = "vs_main"; },
+            [](RenderDevice::PipelineSpecifications& r_specs) { r_specs.shaders[0].stage = RenderDevice::ShaderStage::compute; },
+            [](RenderDevice::PipelineSpecifications& r_specs) { r_specs.vertex_bindings[0].stride = 48; },
+            [](RenderDevice::PipelineSpecifications& r_specs) { r_specs.vertex_bindings[0].is_per_instance = true; },
+            [](RenderDevice::PipelineSpecifications& r_specs) { r_specs.vertex_attributes[1].offset = 16; },
+            [](RenderDevice::PipelineSpecifications& r_specs) { r_specs.vertex_attributes.pop_back(); },
+            [](RenderDevice::PipelineSpecifications& r_specs) { r_specs.topology = RenderDevice::PrimitiveTopology::line_list; },
+            [](RenderDevice::PipelineSpecifications& r_specs) { r_specs.cull_mode = RenderDevice::CullMode::none; },
+            [](RenderDevice::PipelineSpecifications& r_specs) { r_specs.is_depth_test_enabled = false; },
+            [](RenderDevice::PipelineSpecifications& r_specs) { r_specs.is_depth_write_enabled = true; },
+            [](RenderDevice::PipelineSpecifications& r_specs) { r_specs.depth_compare_op = RenderDevice::CompareOp::greater; },
+            [](RenderDevice::PipelineSpecifications& r_specs) { r_specs.is_blend_enabled = true; },
+            [](RenderDevice::PipelineSpecifications& r_specs) { r_specs.color_formats[0] = RenderDevice::TextureFormat::rgba16_float; },
+            [](RenderDevice::PipelineSpecifications& r_specs) { r_specs.has_depth_stencil = false; },
+            [](RenderDevice::PipelineSpecifications& r_specs) { r_specs.depth_stencil_format = RenderDevice::TextureFormat::depth24_stencil8; },
+            [](RenderDevice::PipelineSpecifications& r_specs) { r_specs.push_constant_size = 32; }
+        };
+
+        for (const auto& change : changes) {
+            RenderDevice::PipelineSpecifications changed_specs = specs;
+            change(changed_specs);
+            DODO_EXPECT(PipelineState::key_make(changed_specs) != key);
+        }
+    }
+
+    DODO_TEST(pipeline_state, render_pass_key_only_depends_on_attachments) {
+        const RenderDevice::PipelineSpecifications specs = Utils::pipeline_specs_make();
+        RenderDevice::PipelineSpecifications other_specs = specs;
+        other_specs.shaders.pop_back();
+        other_specs.is_blend_enabled = true;
+        DODO_EXPECT(PipelineState::render_pass_key_make(specs) == PipelineState::render_pass_key_make(other_specs));
+
+        other_specs.color_formats.push_back(RenderDevice::TextureFormat::rgba8_unorm);
+        DODO_EXPECT(PipelineState::render_pass_key_make(specs) != PipelineState::render_pass_key_make(other_specs));
+    }
+
+    DODO_TEST(pipeline_state, bind_action_follows_the_policy) {
+        for (const Policy policy : { Policy::wait, Policy::fallback, Policy::skip }) {
+            DODO_EXPECT(PipelineState::bind_action_resolve(Status::ready, policy, Status::failed) == BindAction::bind);
+            DODO_EXPECT(PipelineState::bind_action_resolve(Status::failed, policy, Status::ready) == BindAction::skip);
+        }
+
+        DODO_EXPECT(PipelineState::bind_action_resolve(Status::compiling, Policy::wait, Status::failed) == BindAction::wait);
+        DODO_EXPECT(PipelineState::bind_action_resolve(Status::compiling, Policy::skip, Status::ready) == BindAction::skip);
+        DODO_EXPECT(PipelineState::bind_action_resolve(Status::compiling, Policy::fallback, Status::ready) == BindAction::bind_fallback);
+        DODO_EXPECT(PipelineState::bind_action_resolve(Status::compiling, Policy::fallback, Status::compiling) == BindAction::skip);
+        DODO_EXPECT(PipelineState::bind_action_resolve(Status::compiling, Policy::fallback, Status::failed) == BindAction::skip);
+    }
+
+}
@@ -0,0 +1,188 @@
+#include "pch.h"
+#include "test.h"
+#include "mock_render_device.h"
+
+#include "renderer/render_graph.h"
+
+namespace Dodo {
+
+    namespace Utils {
+
+        static RenderDevice::TextureSpecifications texture_specs_make(uint32_t size) {
+            RenderDevice::TextureSpecifications texture_specs = {};
+            texture_specs.width = size;
+            texture_specs.height = size;
+            texture_specs.usage = RenderDevice::texture_usage_color_attachment | RenderDevice::texture_usage_sampled;
+            return texture_specs;
+        }
+
+    }
+
+    using State = RenderDevice::ResourceState;
+
+    DODO_TEST(render_graph, culls_passes_no_output_depends_on) {
+        Ref<MockRenderDevice> device = Ref<MockRenderDevice>::create();
+        RenderGraph graph = {};
+        graph.initialize(device);
+
+        const RenderGraph::ResourceId back_buffer = graph.texture_import("back_buffer", TextureHandle(1000), State::undefined, State::present);
+        const RenderGraph::ResourceId scene = graph.texture_create("scene", Utils::texture_specs_make(64));
+        const RenderGraph::ResourceId unused = graph.texture_create("unused", Utils::texture_specs_make(64));
+        graph.resource_mark_output(back_buffer);
+
+        std::vector<std::string> executed_passes = {};
+        graph.pass_add("scene", {}, { { scene, State::color_attachment } }, [&](CommandBufferHandle) { executed_passes.push_back("scene"); });
+        graph.pass_add("unused", { { scene, State::shader_read } }, { { unused, State::color_attachment } }, [&](CommandBufferHandle) { executed_passes.push_back("unused"); });
+        const RenderGraph::PassId capture = graph.pass_add("capture", { { scene, State::shader_read } }, {}, [&](CommandBufferHandle) { executed_passes.push_back("capture"); });
+        graph.pass_add("compose", { { scene, State::shader_read } }, { { back_buffer, State::color_attachment } }, [&](CommandBufferHandle) { executed_passes.push_back("compose"); });
+        graph.pass_mark_side_effects(capture);
+
+        DODO_EXPECT(graph.compile());
+        graph.execute(CommandBufferHandle(2000));
+
+        DODO_EXPECT((executed_passes == std::vector<std::string>{ "scene", "capture", "compose" }));
+        DODO_EXPECT(graph.statistics_get().pass_count == 3);
+        DODO_EXPECT(graph.statistics_get().culled_pass_count == 1);
+        DODO_EXPECT(graph.texture_get(scene));
+        DODO_EXPECT(!graph.texture_get(unused));
+        DODO_EXPECT(graph.statistics_get().transient_texture_count == 1);
+    }
+
+    DODO_TEST(render_graph, aliases_textures_with_disjoint_lifetimes) {
+        Ref<MockRenderDevice> device = Ref<MockRenderDevice>::create();
+        RenderGraph graph = {};
+        graph.initialize(device);
+
+        const RenderGraph::ResourceId back_buffer = graph.texture_import("back_buffer", TextureHandle(1000), State::undefined, State::present);
+        const RenderGraph::ResourceId a = graph.texture_create("a", Utils::texture_specs_make(64));
+        const RenderGraph::ResourceId b = graph.texture_create("b", Utils::texture_specs_make(64));
+        const RenderGraph::ResourceId c = graph.texture_create("c", Utils::texture_specs_make(32));
+        graph.resource_mark_output(back_buffer);
+
+        // a lives in passes 0 and 1, b in 1 and 2, c in 2 and 3: a and c can share memory, b can not share with either.
+        graph.pass_add("write_a", {}, { { a, State::color_attachment } }, [](CommandBufferHandle) {});
+        graph.pass_add("a_to_b", { { a, State::shader_read } }, { { b, State::color_attachment } }, [](CommandBufferHandle) {});
+        graph.pass_add("b_to_c", { { b, State::shader_read } }, { { c, State::color_attachment } }, [](CommandBufferHandle) {});
+        graph.pass_add("compose", { { c, State::shader_read } }, { { back_buffer, State::color_attachment } }, [](CommandBufferHandle) {});
+        DODO_EXPECT(graph.compile());
+
+        const MockRenderDevice::Calls calls = device->calls_get();
+        DODO_EXPECT(calls.texture_heap_sizes.size() == 1);
+        DODO_EXPECT(calls.placed_textures.size() == 3);
+
+        std::unordered_map<uint64_t, MockRenderDevice::PlacedTexture> placed_textures = {};
+        for (const MockRenderDevice::PlacedTexture& placed_texture : calls.placed_textures) {
+            DODO_EXPECT((placed_texture.offset % MockRenderDevice::texture_alignment) == 0);
+            placed_textures[placed_texture.texture.get_id()] = placed_texture;
+        }
+
+        const auto is_overlapping = [&](RenderGraph::ResourceId first, RenderGraph::ResourceId second) -> bool {
+            const MockRenderDevice::PlacedTexture& x = placed_textures.at(graph.texture_get(first).get_id());
+            const MockRenderDevice::PlacedTexture& y = placed_textures.at(graph.texture_get(second).get_id());
+            return (x.offset < (y.offset + y.size)) && (y.offset < (x.offset + x.size));
+        };
+
+        DODO_EXPECT(is_overlapping(a, c));
+        DODO_EXPECT(!is_overlapping(a, b));
+        DODO_EXPECT(!is_overlapping(b, c));
+
+        const uint64_t large_size = MockRenderDevice::texture_size_get(Utils::texture_specs_make(64));
+        const uint64_t small_size = MockRenderDevice::texture_size_get(Utils::texture_specs_make(32));
+        DODO_EXPECT(calls.texture_heap_sizes.front() == (2 * large_size));
+        DODO_EXPECT(graph.statistics_get().transient_memory_size == (2 * large_size));
+        DODO_EXPECT(graph.statistics_get().transient_unaliased_size == ((2 * large_size) + small_size));
+
+        graph.de_initialize();
+        const MockRenderDevice::Calls destroyed_calls = device->calls_get();
+        DODO_EXPECT(destroyed_calls.texture_destroy_count == 3);
+        DODO_EXPECT(destroyed_calls.texture_heap_destroy_count == 1);
+    }
+
+    DODO_TEST(render_graph, batches_barriers_in_front_of_passes) {
+        Ref<MockRenderDevice> device = Ref<MockRenderDevice>::create();
+        RenderGraph graph = {};
+        graph.initialize(device);
+
+        const TextureHandle back_buffer_texture = TextureHandle(1000);
+        const BufferHandle readback_buffer = BufferHandle(1001);
+        const RenderGraph::ResourceId back_buffer = graph.texture_import("back_buffer", back_buffer_texture, State::undefined, State::present);
+        const RenderGraph::ResourceId readback = graph.buffer_import("readback", readback_buffer, State::transfer_dst, State::transfer_dst);
+        graph.resource_mark_output(back_buffer);
+        graph.resource_mark_output(readback);
+
+        graph.pass_add("draw", {}, { { back_buffer, State::color_attachment } }, [](CommandBufferHandle) {});
+        graph.pass_add("copy", { { back_buffer, State::transfer_src } }, { { readback, State::transfer_dst } }, [](CommandBufferHandle) {});
+        DODO_EXPECT(graph.compile());
+        graph.execute(CommandBufferHandle(2000));
+
+        // One batch per pass and the transition to the final states.
+        const MockRenderDevice::Calls calls = device->calls_get();
+        DODO_EXPECT(calls.barriers.size() == 3);
+        DODO_EXPECT(graph.statistics_get().barrier_batch_count == 3);
+        DODO_EXPECT(graph.statistics_get().barrier_count == 4);
+        if (calls.barriers.size() != 3) {
+            return;
+        }
+
+        const std::vector<RenderDevice::TextureBarrier>& draw_barriers = calls.barriers[0].texture_barriers;
+        DODO_EXPECT((draw_barriers.size() == 1) && (draw_barriers[0].texture == back_buffer_texture));
+        DODO_EXPECT((draw_barriers[0].state_before == State::undefined) && (draw_barriers[0].state_after == State::color_attachment));
+
+        // Writes are ordered against earlier writes in the same state, e.g. the readback of the previous frame.
+        const MockRenderDevice::Barrier& copy_barrier = calls.barriers[1];
+        DODO_EXPECT((copy_barrier.texture_barriers.size() == 1) && (copy_barrier.texture_barriers[0].state_after == State::transfer_src));
+        DODO_EXPECT((copy_barrier.buffer_barriers.size() == 1) && (copy_barrier.buffer_barriers[0].buffer == readback_buffer));
+        DODO_EXPECT(copy_barrier.buffer_barriers[0].state_before == State::transfer_dst);
+
+        const MockRenderDevice::Barrier& final_barrier = calls.barriers[2];
+        DODO_EXPECT((final_barrier.texture_barriers.size() == 1) && final_barrier.buffer_barriers.empty());
+        DODO_EXPECT((final_barrier.texture_barriers[0].state_before == State::transfer_src) && (final_barrier.texture_barriers[0].state_after == State::present));
+    }
+
+    DODO_TEST(render_graph, orders_aliased_memory_with_a_memory_barrier) {
+        Ref<MockRenderDevice> device = Ref<MockRenderDevice>::create();
+        RenderGraph graph = {};
+        graph.initialize(device);
+
+        // Three textures in one pass each share the same memory.
+        const RenderGraph::ResourceId a = graph.texture_create("a", Utils::texture_specs_make(64));
+        const RenderGraph::ResourceId b = graph.texture_create("b", Utils::texture_specs_make(64));
+        const RenderGraph::ResourceId c = graph.texture_create("c", Utils::texture_specs_make(64));
+        graph.pass_mark_side_effects(graph.pass_add("write_a", {}, { { a, State::color_attachment } }, [](CommandBufferHandle) {}));
+        graph.pass_mark_side_effects(graph.pass_add("write_b", {}, { { b, State::shader_write } }, [](CommandBufferHandle) {}));
+        graph.pass_mark_side_effects(graph.pass_add("write_c", {}, { { c, State::transfer_dst } }, [](CommandBufferHandle) {}));
+        DODO_EXPECT(graph.compile());
+        graph.execute(CommandBufferHandle(2000));
+
+        const MockRenderDevice::Calls calls = device->calls_get();
+        DODO_EXPECT(calls.texture_heap_sizes.size() == 1);
+        DODO_EXPECT(calls.texture_heap_sizes.front() == MockRenderDevice::texture_size_get(Utils::texture_specs_make(64)));
+        DODO_EXPECT(calls.barriers.size() == 3);
+        DODO_EXPECT(graph.statistics_get().barrier_count == 5);
+        if (calls.barriers.size() != 3) {
+            return;
+        }
+
+        // a follows the last users of the memory in the previous frame: c with a discard, b and a itself with the memory barrier.
+        const MockRenderDevice::Barrier& a_barrier = calls.barriers[0];
+        DODO_EXPECT((a_barrier.texture_barriers.size() == 1) && a_barrier.texture_barriers[0].discard);
+        DODO_EXPECT(a_barrier.texture_barriers[0].texture == graph.texture_get(a));
+        DODO_EXPECT(a_barrier.texture_barriers[0].state_before == State::transfer_dst);
+        DODO_EXPECT(a_barrier.memory_barrier.states_before == (RenderDevice::resource_state_bit(State::shader_write) | RenderDevice::resource_state_bit(State::color_attachment)));
+        DODO_EXPECT(a_barrier.memory_barrier.states_after == RenderDevice::resource_state_bit(State::color_attachment));
+
+        // b only follows a.
+        const MockRenderDevice::Barrier& b_barrier = calls.barriers[1];
+        DODO_EXPECT((b_barrier.texture_barriers.size() == 1) && b_barrier.texture_barriers[0].discard);
+        DODO_EXPECT(b_barrier.texture_barriers[0].state_before == State::color_attachment);
+        DODO_EXPECT(b_barrier.memory_barrier.states_before == 0);
+
+        // c follows b with a discard and a with the memory barrier.
+        const MockRenderDevice::Barrier& c_barrier = calls.barriers[2];
+        DODO_EXPECT((c_barrier.texture_barriers.size() == 1) && c_barrier.texture_barriers[0].discard);
+        DODO_EXPECT(c_barrier.texture_barriers[0].state_before == State::shader_write);
+        DODO_EXPECT(c_barrier.memory_barrier.states_before == RenderDevice::resource_state_bit(State::color_attachment));
+        DODO_EXPECT(c_barrier.memory_barrier.states_after == RenderDevice::resource_state_bit(State::transfer_dst));
+    }
+
+}
@@ -0,0 +1,68 @@
+#include "pch.h"
+#include "test.h"
+
+#include "renderer/render_device.h"
+
+namespace Dodo {
+
+    namespace Utils {
+
+        struct TestTexture {
+            uint32_t id = 0;
+        };
+
+        using TestTexturePool = RenderHandlePool<TextureHandle, TestTexture>;
+
+    }
+
+    // Bindless slots are the pool indices, so these are the guarantees texture_get_bindless_index relies on.
+    DODO_TEST(render_handle, indices_are_dense) {
+        Utils::TestTexturePool pool = {};
+        for (uint32_t i = 0; i < 100; i++) {
+            const TextureHandle texture = pool.create({ i });
+            DODO_EXPECT(pool.index_get(texture) == i);
+            DODO_EXPECT(pool.get_or_null(texture) && (pool.get_or_null(texture)->id == i));
+        }
+
+        DODO_EXPECT(pool.count_get() == 100);
+    }
+
+    DODO_TEST(render_handle, destroyed_slots_are_reused) {
+        Utils::TestTexturePool pool = {};
+        std::vector<TextureHandle> textures = {};
+        for (uint32_t i = 0; i < 8; i++) {
+            textures.push_back(pool.create({ i }));
+        }
+
+        const uint32_t freed_index = pool.index_get(textures[3]);
+        pool.destroy(textures[3]);
+        DODO_EXPECT(pool.count_get() == 7);
+
+        // The slot goes to the next texture instead of growing the bindless arrays.
+        const TextureHandle texture = pool.create({ 100 });
+        DODO_EXPECT(pool.index_get(texture) == freed_index);
+        DODO_EXPECT(pool.count_get() == 8);
+        DODO_EXPECT(pool.index_get(pool.create({ 101 })) == 8);
+    }
+
+    DODO_TEST(render_handle, stale_handles_lose_their_slot) {
+        Utils::TestTexturePool pool = {};
+        const TextureHandle texture = pool.create({ 1 });
+        pool.destroy(texture);
+        DODO_EXPECT(pool.index_get(texture) == Utils::TestTexturePool::invalid_index);
+        DODO_EXPECT(pool.get_or_null(texture) == nullptr);
+
+        // A new texture in the same slot is not reachable through the old handle.
+        const TextureHandle reused_texture = pool.create({ 2 });
+        DODO_EXPECT(reused_texture != texture);
+        DODO_EXPECT(pool.index_get(reused_texture) == 0);
+        DODO_EXPECT(pool.index_get(texture) == Utils::TestTexturePool::invalid_index);
+
+        // Destroying twice must not free the slot of the new texture.
+        pool.destroy(texture);
+        DODO_EXPECT(pool.get_or_null(reused_texture) && (pool.get_or_null(reused_texture)->id == 2));
+        DODO_EXPECT(pool.count_get() == 1);
+        DODO_EXPECT(!pool.get_or_null(TextureHandle()));
+    }
+
+}
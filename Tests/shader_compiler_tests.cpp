@@ -0,0 +1,133 @@
+#include "pch.h"
+#include "test.h"
+
+#include "renderer/shader_compiler.h"
+
+namespace Dodo {
+
+    namespace Utils {
+
+        static constexpr const char* shader_source =
+            "#version 450\n"
+            "#include \"common.glsl\"\n"
+            "layout(location = 0) out vec4 out_color;\n"
+            "void main() { out_color = dodo_color(); }\n";
+
+        // A fresh directory with a fragment shader that includes common.glsl and an empty shader cache.
+        class ShaderDirectory {
+        public:
+            explicit ShaderDirectory(const std::string& name)
+                : _directory(std::filesystem::temp_directory_path() / "dodo_tests" / name) {
+                std::filesystem::remove_all(_directory);
+                std::filesystem::create_directories(_directory);
+                file_write("shader.frag", shader_source);
+                file_write("common.glsl", "vec4 dodo_color() { return vec4(1.0, 0.5, 0.25, 1.0); }\n");
+            }
+
+            ~ShaderDirectory() {
+                std::error_code error = {};
+                std::filesystem::remove_all(_directory, error);
+            }
+
+            // Moves the write time forward as well, file systems with coarse times would otherwise keep it.
+            void file_write(const std::string& name, const std::string& content) {
+                const std::filesystem::path path = _directory / name;
+                const bool has_existed = std::filesystem::exists(path);
+                const std::filesystem::file_time_type write_time = has_existed ? std::filesystem::last_write_time(path) : std::filesystem::file_time_type();
+                std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+                if (has_existed) {
+                    std::filesystem::last_write_time(path, write_time + std::chrono::seconds(2));
+                }
+            }
+
+            ShaderCompiler::Specifications compiler_specs_get() const {
+                ShaderCompiler::Specifications specs = {};
+                specs.cache_directory = _directory / "cache";
+                return specs;
+            }
+
+            ShaderCompiler::Request request_get() const {
+                ShaderCompiler::Request request = {};
+                request.path = _directory / "shader.frag";
+                request.stage = RenderDevice::ShaderStage::fragment;
+                return request;
+            }
+
+        private:
+            std::filesystem::path _directory = {};
+        };
+
+    }
+
+    DODO_TEST(shader_compiler, hits_the_cache_for_unchanged_sources) {
+        Utils::ShaderDirectory directory("cache_hit");
+        ShaderCompiler compiler = {};
+        compiler.initialize(directory.compiler_specs_get());
+
+        const ShaderCompiler::Result compiled = compiler.compile(directory.request_get());
+        DODO_EXPECT(compiled.is_valid && !compiled.is_cache_hit);
+        DODO_EXPECT(!compiled.spirv.empty() && (compiled.spirv.front() == 0x07230203));
+
+        const ShaderCompiler::Result cached = compiler.compile(directory.request_get());
+        DODO_EXPECT(cached.is_valid && cached.is_cache_hit);
+        DODO_EXPECT(cached.spirv == compiled.spirv);
+
+        // The cache is on disk, the next run starts with it.
+        ShaderCompiler next_run_compiler = {};
+        next_run_compiler.initialize(directory.compiler_specs_get());
+        const ShaderCompiler::Result next_run = next_run_compiler.compile(directory.request_get());
+        DODO_EXPECT(next_run.is_valid && next_run.is_cache_hit);
+        DODO_EXPECT(next_run.spirv == compiled.spirv);
+    }
+
+    DODO_TEST(shader_compiler, compiles_again_when_an_include_changed) {
+        Utils::ShaderDirectory directory("stale_include");
+        ShaderCompiler compiler = {};
+        compiler.initialize(directory.compiler_specs_get());
+
+        const ShaderCompiler::Result compiled = compiler.compile(directory.request_get());
+        DODO_EXPECT(compiled.is_valid && !compiled.is_cache_hit);
+
+        directory.file_write("common.glsl", "vec4 dodo_color() { return vec4(0.0, 0.5, 0.25, 1.0); }\n");
+        const ShaderCompiler::Result recompiled = compiler.compile(directory.request_get());
+        DODO_EXPECT(recompiled.is_valid && !recompiled.is_cache_hit);
+        DODO_EXPECT(recompiled.spirv != compiled.spirv);
+
+        const ShaderCompiler::Result cached = compiler.compile(directory.request_get());
+        DODO_EXPECT(cached.is_valid && cached.is_cache_hit);
+        DODO_EXPECT(cached.spirv == recompiled.spirv);
+
+        // Only the content counts, touching a file keeps the cache valid.
+        directory.file_write("common.glsl", "vec4 dodo_color() { return vec4(0.0, 0.5, 0.25, 1.0); }\n");
+        DODO_EXPECT(compiler.compile(directory.request_get()).is_cache_hit);
+    }
+
+    DODO_TEST(shader_compiler, keeps_permutations_apart) {
+        Utils::ShaderDirectory directory("permutations");
+        ShaderCompiler compiler = {};
+        compiler.initialize(directory.compiler_specs_get());
+        DODO_EXPECT(compiler.compile(directory.request_get()).is_valid);
+
+        ShaderCompiler::Request request = directory.request_get();
+        request.defines.push_back({ "DODO_VARIANT", "1" });
+        const ShaderCompiler::Result variant = compiler.compile(request);
+        DODO_EXPECT(variant.is_valid && !variant.is_cache_hit);
+        DODO_EXPECT(compiler.compile(request).is_cache_hit);
+        DODO_EXPECT(compiler.compile(directory.request_get()).is_cache_hit);
+    }
+
+    DODO_TEST(shader_compiler, reports_errors_without_caching_them) {
+        Utils::ShaderDirectory directory("errors");
+        ShaderCompiler compiler = {};
+        compiler.initialize(directory.compiler_specs_get());
+
+        directory.file_write("shader.frag", "#version 450\nvoid main() { this is an error; }\n");
+        const ShaderCompiler::Result failed = compiler.compile(directory.request_get());
+        DODO_EXPECT(!failed.is_valid && !failed.error_message.empty());
+
+        directory.file_write("shader.frag", Utils::shader_source);
+        const ShaderCompiler::Result fixed = compiler.compile(directory.request_get());
+        DODO_EXPECT(fixed.is_valid && !fixed.is_cache_hit);
+    }
+
+}
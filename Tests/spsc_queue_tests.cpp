@@ -0,0 +1,80 @@
+#include "pch.h"
+#include "test.h"
+
+#include "core/spsc_queue.h"
+
+namespace Dodo {
+
+    DODO_TEST(spsc_queue, push_fails_when_full) {
+        SpscQueue<uint32_t, 4> queue = {};
+        for (uint32_t i = 0; i < 4; i++) {
+            DODO_EXPECT(queue.push(i));
+        }
+
+        DODO_EXPECT(!queue.push(4));
+        DODO_EXPECT(queue.size_approx() == 4);
+
+        uint32_t value = 0;
+        DODO_EXPECT(queue.pop(value) && (value == 0));
+        DODO_EXPECT(queue.push(4));
+    }
+
+    DODO_TEST(spsc_queue, pop_fails_when_empty) {
+        SpscQueue<uint32_t, 2> queue = {};
+        uint32_t value = 7;
+        DODO_EXPECT(!queue.pop(value));
+        DODO_EXPECT(value == 7);
+        DODO_EXPECT(queue.front() == nullptr);
+    }
+
+    DODO_TEST(spsc_queue, wraps_around_in_order) {
+        SpscQueue<uint32_t, 4> queue = {};
+        uint32_t next_pushed = 0;
+        uint32_t next_popped = 0;
+        // Three values per round against a capacity of four moves head and tail across the end of the ring.
+        for (uint32_t round = 0; round < 10; round++) {
+            for (uint32_t i = 0; i < 3; i++) {
+                DODO_EXPECT(queue.push(next_pushed++));
+            }
+
+            DODO_EXPECT(queue.size_approx() == 3);
+            for (uint32_t i = 0; i < 3; i++) {
+                uint32_t value = UINT32_MAX;
+                DODO_EXPECT(queue.pop(value));
+                DODO_EXPECT(value == next_popped++);
+            }
+        }
+
+        DODO_EXPECT(queue.front() == nullptr);
+    }
+
+    DODO_TEST(spsc_queue, producer_and_consumer_threads_keep_order) {
+        constexpr uint32_t value_count = 100000;
+        SpscQueue<uint32_t, 64> queue = {};
+
+        std::thread producer([&queue]() {
+            for (uint32_t i = 0; i < value_count; i++) {
+                while (!queue.push(i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        bool is_in_order = true;
+        for (uint32_t expected = 0; expected < value_count;) {
+            uint32_t value = 0;
+            if (!queue.pop(value)) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            is_in_order &= (value == expected);
+            expected++;
+        }
+
+        producer.join();
+        DODO_EXPECT(is_in_order);
+        DODO_EXPECT(queue.front() == nullptr);
+    }
+
+}
@@ -0,0 +1,68 @@
+#include "pch.h"
+#include "test.h"
+
+#include "core/task_graph.h"
+
+namespace Dodo {
+
+    DODO_TEST(task_graph, runs_every_node_once) {
+        ThreadPool thread_pool = {};
+        TaskGraph graph = {};
+        constexpr uint32_t node_count = 64;
+        std::array<std::atomic<uint32_t>, node_count> run_counts = {};
+        for (uint32_t i = 0; i < node_count; i++) {
+            graph.node_add("node", [&run_counts, i]() { run_counts[i]++; });
+        }
+
+        graph.execute(thread_pool);
+        for (const std::atomic<uint32_t>& run_count : run_counts) {
+            DODO_EXPECT(run_count == 1);
+        }
+    }
+
+    DODO_TEST(task_graph, dependents_start_after_their_dependencies) {
+        ThreadPool thread_pool = {};
+        TaskGraph graph = {};
+        std::atomic<uint32_t> completed_count = 0;
+        std::atomic<bool> is_order_kept = true;
+        auto work_make = [&](uint32_t expected_completed_count) {
+            return [&, expected_completed_count]() {
+                is_order_kept = is_order_kept && (completed_count >= expected_completed_count);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                completed_count++;
+            };
+        };
+
+        // A diamond, the join waits on both branches.
+        const TaskGraph::NodeId root = graph.node_add("root", work_make(0));
+        const TaskGraph::NodeId left = graph.node_add("left", work_make(1), { root });
+        const TaskGraph::NodeId right = graph.node_add("right", work_make(1), { root });
+        graph.node_add("join", work_make(3), { left, right });
+        graph.execute(thread_pool);
+
+        DODO_EXPECT(is_order_kept);
+        DODO_EXPECT(completed_count == 4);
+
+        const std::vector<TaskGraph::NodeTiming> timings = graph.timings_get();
+        DODO_EXPECT(timings.size() == 4);
+        DODO_EXPECT(timings[3].name == "join");
+        DODO_EXPECT(timings[1].end <= timings[3].begin);
+        DODO_EXPECT(timings[2].end <= timings[3].begin);
+    }
+
+    DODO_TEST(task_graph, main_thread_nodes_run_on_the_calling_thread) {
+        ThreadPool thread_pool = {};
+        TaskGraph graph = {};
+        const std::thread::id main_thread_id = std::this_thread::get_id();
+        std::thread::id worker_node_thread_id = {};
+        std::thread::id main_node_thread_id = {};
+
+        const TaskGraph::NodeId worker_node = graph.node_add("worker", [&]() { worker_node_thread_id = std::this_thread::get_id(); });
+        graph.node_add("main", [&]() { main_node_thread_id = std::this_thread::get_id(); }, { worker_node }, TaskGraph::Affinity::main_thread);
+        graph.execute(thread_pool);
+
+        DODO_EXPECT(worker_node_thread_id != main_thread_id);
+        DODO_EXPECT(main_node_thread_id == main_thread_id);
+    }
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+namespace Dodo::Tests {
+
+    // A test case is a function of a suite, failed expectations are reported
+    // and counted but do not stop the case.
+    struct TestCase {
+        const char* suite = nullptr;
+        const char* name = nullptr;
+        void (*function)() = nullptr;
+    };
+
+    std::vector<TestCase>& test_cases_get();
+    void expectation_fail(const char* file, int line, const char* expression);
+
+    struct TestRegistration {
+        TestRegistration(const char* suite, const char* name, void (*function)()) {
+            test_cases_get().push_back({ suite, name, function });
+        }
+    };
+
+}
+
+#define DODO_TEST(suite, name)                                                                                    \
+    static void suite##_##name();                                                                                 \
+    static const Dodo::Tests::TestRegistration suite##_##name##_registration(#suite, #name, &suite##_##name);   \
+    static void suite##_##name()
+
+#define DODO_EXPECT(condition)                                                      \
+    do {                                                                            \
+        if (!(condition)) {                                                         \
+            Dodo::Tests::expectation_fail(__FILE__, __LINE__, #condition);          \
+        }                                                                           \
+    } while (false)
@@ -0,0 +1,49 @@
+#include "pch.h"
+#include "test.h"
+
+namespace Dodo::Tests {
+
+    static const TestCase* s_current_test_case = nullptr;
+    static uint32_t s_failed_expectation_count = 0;
+
+    std::vector<TestCase>& test_cases_get() {
+        static std::vector<TestCase> test_cases = {};
+        return test_cases;
+    }
+
+    void expectation_fail(const char* file, int line, const char* expression) {
+        std::cerr << file << "(" << line << "): " << s_current_test_case->suite << "." << s_current_test_case->name << " expected " << expression << "\n";
+        s_failed_expectation_count++;
+    }
+
+}
+
+// Runs the test cases of the suite given as the first argument, or every suite without one.
+int main(int argc, char** argv) {
+    using namespace Dodo::Tests;
+
+    Dodo::Log::init();
+
+    const std::string_view suite = (argc > 1) ? argv[1] : "";
+    uint32_t run_count = 0;
+    uint32_t failed_count = 0;
+    for (const TestCase& test_case : test_cases_get()) {
+        if (!suite.empty() && (suite != test_case.suite)) {
+            continue;
+        }
+
+        s_current_test_case = &test_case;
+        const uint32_t failed_expectation_count = s_failed_expectation_count;
+        test_case.function();
+        run_count++;
+
+        const bool is_passed = (s_failed_expectation_count == failed_expectation_count);
+        failed_count += is_passed ? 0 : 1;
+        std::cout << (is_passed ? "[PASSED] " : "[FAILED] ") << test_case.suite << "." << test_case.name << "\n";
+    }
+
+    Dodo::Log::de_init();
+
+    std::cout << run_count << " test cases, " << failed_count << " failed.\n";
+    return ((run_count > 0) && (failed_count == 0)) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "test.h"
+
+#include <random>
+
+#include "memory/tlsf_allocator.h"
+
+namespace Dodo {
+
+    DODO_TEST(tlsf_allocator, respects_alignment) {
+        TlsfAllocator allocator(1_mb);
+        DODO_EXPECT(allocator.allocate(24).is_valid());
+        for (const uint64_t alignment : { 16ull, 256ull, 4096ull, 65536ull }) {
+            const TlsfAllocator::Allocation allocation = allocator.allocate(100, alignment);
+            DODO_EXPECT(allocation.is_valid());
+            DODO_EXPECT((allocation.offset % alignment) == 0);
+        }
+    }
+
+    DODO_TEST(tlsf_allocator, fails_when_no_range_fits) {
+        TlsfAllocator allocator(4096);
+        const TlsfAllocator::Allocation allocation = allocator.allocate(4096);
+        DODO_EXPECT(allocation.is_valid());
+        DODO_EXPECT(!allocator.allocate(16).is_valid());
+
+        allocator.free(allocation);
+        DODO_EXPECT(!allocator.allocate(8192).is_valid());
+        DODO_EXPECT(allocator.is_empty());
+    }
+
+    DODO_TEST(tlsf_allocator, freeing_merges_neighbours) {
+        TlsfAllocator allocator(64 * 1024);
+        std::vector<TlsfAllocator::Allocation> allocations = {};
+        for (uint32_t i = 0; i < 16; i++) {
+            allocations.push_back(allocator.allocate(4096));
+            DODO_EXPECT(allocations.back().is_valid());
+        }
+
+        DODO_EXPECT(allocator.used_get() == allocator.size_get());
+
+        // Every other range first, so the rest only become one range again by merging.
+        for (size_t i = 0; i < allocations.size(); i += 2) {
+            allocator.free(allocations[i]);
+        }
+
+        DODO_EXPECT(allocator.largest_free_range_get() == 4096);
+        for (size_t i = 1; i < allocations.size(); i += 2) {
+            allocator.free(allocations[i]);
+        }
+
+        DODO_EXPECT(allocator.is_empty());
+        DODO_EXPECT(allocator.used_get() == 0);
+        DODO_EXPECT(allocator.largest_free_range_get() == allocator.size_get());
+        DODO_EXPECT(allocator.allocate(allocator.size_get()).is_valid());
+    }
+
+    DODO_TEST(tlsf_allocator, allocations_never_overlap) {
+        TlsfAllocator allocator(4_mb);
+        std::mt19937 random(1234);
+        std::vector<std::pair<TlsfAllocator::Allocation, uint64_t>> allocations = {};
+        bool is_disjoint = true;
+        for (uint32_t i = 0; i < 4000; i++) {
+            if (!allocations.empty() && ((random() % 3) == 0)) {
+                const size_t index = random() % allocations.size();
+                allocator.free(allocations[index].first);
+                allocations[index] = allocations.back();
+                allocations.pop_back();
+                continue;
+            }
+
+            const uint64_t size = 1 + (random() % 16384);
+            const uint64_t alignment = uint64_t(1) << (random() % 10);
+            const TlsfAllocator::Allocation allocation = allocator.allocate(size, alignment);
+            if (!allocation.is_valid()) {
+                continue;
+            }
+
+            is_disjoint &= ((allocation.offset % alignment) == 0) && ((allocation.offset + size) <= allocator.size_get());
+            for (const auto& [other, other_size] : allocations) {
+                is_disjoint &= ((allocation.offset + size) <= other.offset) || ((other.offset + other_size) <= allocation.offset);
+            }
+
+            allocations.push_back({ allocation, size });
+        }
+
+        DODO_EXPECT(is_disjoint);
+        DODO_EXPECT(allocator.allocation_count_get() == allocations.size());
+        for (const auto& [allocation, size] : allocations) {
+            allocator.free(allocation);
+        }
+
+        DODO_EXPECT(allocator.is_empty());
+        DODO_EXPECT(allocator.largest_free_range_get() == allocator.size_get());
+    }
+
+}